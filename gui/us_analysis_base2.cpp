@@ -231,8 +231,11 @@ US_AnalysisBase2::US_AnalysisBase2() : US_Widgets()
    controlsLayout->setColumnStretch( 0, 1 );
    controlsLayout->setColumnStretch( 1, 1 );
 
-   dataLoaded = false;
-   buffLoaded = false;
+   dataLoaded   = false;
+   buffLoaded   = false;
+   trans_flags  = 0;
+   trans_points = 400;
+   time_correction = 0.0;
 
    dfilter    = "";
    etype_filt = "velocity";
@@ -300,6 +303,8 @@ void US_AnalysisBase2::load( void )
    allExcls.fill( excludedScans, dataList.size() );
    rinoises.fill( US_Noise(),    dataList.size() );
    tinoises.fill( US_Noise(),    dataList.size() );
+   transforms.clear();
+   transforms.resize( dataList.size() );
 
    connect( lw_triples, SIGNAL( currentRowChanged( int ) ), 
                         SLOT  ( new_triple       ( int ) ) );
@@ -315,6 +320,14 @@ void US_AnalysisBase2::load( void )
    connect( ct_from, SIGNAL( valueChanged( double ) ),
                      SLOT  ( exclude_from( double ) ) );
 
+   if ( trans_flags != 0 )
+   {  // Transform all triples up front, so triple changes are immediate
+      time_correction = US_Math2::time_correction( dataList );
+      QApplication::setOverrideCursor( QCursor( Qt::WaitCursor ) );
+      transform_triples();
+      QApplication::restoreOverrideCursor();
+   }
+
    dataLoaded = true;
    emit dataAreLoaded();
    qApp->processEvents();
@@ -946,7 +959,11 @@ void US_AnalysisBase2::new_triple( int index )
 
 double US_AnalysisBase2::calc_baseline( void ) const
 {
-   int    row   = lw_triples->currentRow();
+   return calc_baseline( lw_triples->currentRow() );
+}
+
+double US_AnalysisBase2::calc_baseline( int row ) const
+{
    const US_DataIO::Scan*
           scan  = &dataList[ row ].scanData.last();
    int    point = US_DataIO::index( dataList[ row ].xvalues, 
@@ -1653,3 +1670,40 @@ bool US_AnalysisBase2::has_intensity_profile( const QString& runID,
    return ! ripxml.isEmpty();
 }
 
+// Bring cached transforms of triples up to date, concurrently by triple
+void US_AnalysisBase2::transform_triples( const QList< int >& trows )
+{
+   int ntrip   = dataList.size();
+   int crow    = lw_triples->currentRow();
+   QList< int >            rows = trows;
+   QVector< double >       baselines;
+   QList< QList< int > >   excludes;
+
+   if ( rows.isEmpty() )
+   {
+      for ( int ii = 0; ii < ntrip; ii++ )
+         rows << ii;
+   }
+
+   for ( int ii = 0; ii < rows.size(); ii++ )
+   {  // Gather each triple's own parameters
+      int row     = rows[ ii ];
+      baselines << calc_baseline( row );
+      excludes  << ( ( row == crow ) ? excludedScans : allExcls[ row ] );
+   }
+
+   US_Transform::transform( dataList, transforms, rows, baselines, excludes,
+         trans_flags, trans_points,
+         ct_boundaryPos    ->value() / 100.0,
+         ct_boundaryPercent->value() / 100.0,
+         time_correction );
+}
+
+// Return the up-to-date cached transforms of a triple
+const US_AnalysisBase2::TransformData& US_AnalysisBase2::triple_transform(
+      int row )
+{
+   transform_triples( QList< int >() << row );
+
+   return transforms[ row ];
+}
@@ -12,6 +12,7 @@
 #include "us_analyte.h"
 #include "us_buffer.h"
 #include "us_noise.h"
+#include "us_transform.h"
 
 #include "qwt_counter.h"
 
@@ -26,6 +27,13 @@ class US_GUI_EXTERN US_AnalysisBase2 : public US_Widgets
    public:
       US_AnalysisBase2();
 
+      //! Transforms of one triple, as computed by US_Transform
+      typedef US_Transform::TransformData TransformData;
+
+      //! Flags selecting the transforms to compute for triples
+      enum TransformType { TR_DCDT   = US_Transform::TR_DCDT,
+                           TR_MOMENT = US_Transform::TR_MOMENT };
+
    protected:
       //! A set of edited data for the analysis
       QVector< US_DataIO::EditedData >  dataList;
@@ -71,6 +79,10 @@ class US_GUI_EXTERN US_AnalysisBase2 : public US_Widgets
       //! A class to display help in the US Help viewer
       US_Help      showHelp;
 
+      QVector< TransformData > transforms; //!< Cached transforms, by triple
+      int          trans_flags;     //!< Transforms computed (TransformType)
+      int          trans_points;    //!< Points in the average g*(s) curve
+
       double       time_correction; //!< Time correction, centrifuge acceler.
       double       density;         //!< Density of the buffer
       double       viscosity;       //!< Viscosity of the buffer
@@ -135,6 +147,16 @@ class US_GUI_EXTERN US_AnalysisBase2 : public US_Widgets
       //! A utility to create a directory
       bool         mkdir     ( const QString&, const QString& );
 
+      //! \brief Bring cached transforms of triples up to date, computing
+      //!        those of changed data or parameters concurrently
+      //! \param rows  Triple indexes (empty for all loaded triples)
+      void         transform_triples( const QList< int >& = QList< int >() );
+
+      //! \brief Return the up-to-date cached transforms of a triple
+      //! \param row   Triple index
+      //! \returns     Transforms of the triple's current data
+      const TransformData& triple_transform( int );
+
    protected slots:
       //! Resets the class to a default state.
       virtual void reset        ( void );
@@ -190,6 +212,9 @@ class US_GUI_EXTERN US_AnalysisBase2 : public US_Widgets
       //! available above the boundary.
       double       calc_baseline( void )                           const;
 
+      //! Calculate the baseline of a given triple's boundary
+      double       calc_baseline( int )                            const;
+
       //! Copy report files to the database
       void         reportFilesToDB( QStringList& );
 
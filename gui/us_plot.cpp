@@ -19,6 +19,7 @@
 #include "us_gui_util.h"
 #include "us_pixmaps.h"
 #include "us_settings.h"
+#include "us_parallel.h"
 
 #include "qwt_text_label.h"
 #include "qwt_plot_layout.h"
@@ -2139,4 +2140,261 @@ void US_PlotPicker::widgetMouseMoveEvent( QMouseEvent* e )
    QwtPlotPicker::widgetMouseMoveEvent( e );
 }
 
+/*********************    US_PlotLodData Class    *************************/
 
+// Create level-of-detail data from arrays of points
+US_PlotLodData::US_PlotLodData( const double* xx, const double* yy, int np )
+{
+   np          = qMax( np, 0 );
+   xfull.resize( np );
+   yfull.resize( np );
+   ordered     = true;
+   xmin        = ( np > 0 ) ? xx[ 0 ] : 0.0;
+   xmax        = xmin;
+   ymin        = ( np > 0 ) ? yy[ 0 ] : 0.0;
+   ymax        = ymin;
+
+   for ( int ii = 0; ii < np; ii++ )
+   {
+      xfull[ ii ] = xx[ ii ];
+      yfull[ ii ] = yy[ ii ];
+      xmin        = qMin( xmin, xx[ ii ] );
+      xmax        = qMax( xmax, xx[ ii ] );
+      ymin        = qMin( ymin, yy[ ii ] );
+      ymax        = qMax( ymax, yy[ ii ] );
+
+      if ( ii > 0  &&  xx[ ii ] < xx[ ii - 1 ] )
+         ordered     = false;
+   }
+
+   vfirst      = 0;
+   vcount      = np;
+}
+
+// Build the pyramid of bucket minimum,maximum points
+void US_PlotLodData::build_levels( void )
+{
+   const int   min_buckets = 16;
+   int         npoint      = xfull.size();
+   const double* yy        = yfull.constData();
+   lpoints.clear();
+
+   if ( ! ordered  ||  npoint < min_buckets * 4 )
+      return;
+
+   // Each bucket of a level joins two buckets of the level below it;
+   //  the level below the first is the points themselves
+   int nprev   = npoint;
+
+   while ( nprev > min_buckets * 2 )
+   {
+      int            nbuck  = ( nprev + 1 ) / 2;
+      QVector< int > level( nbuck * 2 );
+      const int*     prev   = lpoints.isEmpty() ? NULL
+                              : lpoints.last().constData();
+
+      for ( int bb = 0; bb < nbuck; bb++ )
+      {
+         int jb      = bb * 2;
+         int kb      = qMin( jb + 1, nprev - 1 );
+         int jmin    = prev ? prev[ jb * 2     ] : jb;
+         int jmax    = prev ? prev[ jb * 2 + 1 ] : jb;
+         int kmin    = prev ? prev[ kb * 2     ] : kb;
+         int kmax    = prev ? prev[ kb * 2 + 1 ] : kb;
+
+         level[ bb * 2     ] = ( yy[ kmin ] < yy[ jmin ] ) ? kmin : jmin;
+         level[ bb * 2 + 1 ] = ( yy[ kmax ] > yy[ jmax ] ) ? kmax : jmax;
+      }
+
+      lpoints << level;
+      nprev       = nbuck;
+   }
+}
+
+// Select the points to present for a visible x range and pixel width
+void US_PlotLodData::select( double xlo, double xhi, int npix )
+{
+   int npoint  = xfull.size();
+   vpoints.clear();
+   vfirst      = 0;
+   vcount      = npoint;
+
+   if ( npoint < 2  ||  ! ordered )
+      return;
+
+   // Find the visible points, plus one beyond each end for continuity
+   const double* xx = xfull.constData();
+   int ilo     = (int)( qLowerBound( xx, xx + npoint, xlo ) - xx ) - 1;
+   int ihi     = (int)( qUpperBound( xx, xx + npoint, xhi ) - xx );
+   ilo         = qMax( ilo, 0 );
+   ihi         = qMax( qMin( ihi, npoint - 1 ), ilo );
+   int count   = ihi - ilo + 1;
+   npix        = qMax( npix, 16 );
+   vfirst      = ilo;
+   vcount      = count;
+
+   if ( count <= npix  ||  lpoints.isEmpty() )
+      return;              // Full detail for the visible range
+
+   // Use the finest level with no more than one bucket per two pixels
+   int lx      = 0;
+   int nlevel  = lpoints.size();
+
+   while ( lx < nlevel - 1  &&  ( count >> ( lx + 1 ) ) > npix / 2 )
+      lx++;
+
+   const int* level = lpoints[ lx ].constData();
+   int blo     = ilo >> ( lx + 1 );
+   int bhi     = ihi >> ( lx + 1 );
+   vpoints.reserve( ( bhi - blo + 1 ) * 2 );
+
+   for ( int bb = blo; bb <= bhi; bb++ )
+   {  // Present the minimum and maximum of each bucket in x order
+      int imin    = level[ bb * 2     ];
+      int imax    = level[ bb * 2 + 1 ];
+
+      vpoints << qMin( imin, imax );
+
+      if ( imax != imin )
+         vpoints << qMax( imin, imax );
+   }
+
+   vcount      = vpoints.size();
+}
+
+// Return the full-data index of a presented point
+int US_PlotLodData::point( size_t ii ) const
+{
+   return vpoints.isEmpty() ? ( vfirst + (int)ii ) : vpoints[ (int)ii ];
+}
+
+size_t US_PlotLodData::size( void ) const
+{
+   return (size_t)vcount;
+}
+
+#if QT_VERSION < 0x050000
+QwtData* US_PlotLodData::copy( void ) const
+{
+   return new US_PlotLodData( *this );
+}
+
+double US_PlotLodData::x( size_t ii ) const
+{
+   return xfull[ point( ii ) ];
+}
+
+double US_PlotLodData::y( size_t ii ) const
+{
+   return yfull[ point( ii ) ];
+}
+
+// The bounding rectangle is that of the full data, whatever is presented
+QwtDoubleRect US_PlotLodData::boundingRect( void ) const
+{
+   return QwtDoubleRect( xmin, ymin, xmax - xmin, ymax - ymin );
+}
+#else
+QPointF US_PlotLodData::sample( size_t ii ) const
+{
+   int jj      = point( ii );
+   return QPointF( xfull[ jj ], yfull[ jj ] );
+}
+
+// The bounding rectangle is that of the full data, whatever is presented
+QRectF US_PlotLodData::boundingRect( void ) const
+{
+   return QRectF( xmin, ymin, xmax - xmin, ymax - ymin );
+}
+#endif
+
+/*********************    US_PlotLodCurve Class    ************************/
+
+// Create a level-of-detail curve and attach it to a plot
+US_PlotLodCurve::US_PlotLodCurve( QwtPlot* plot, const QString& title )
+   : QwtPlotCurve( title )
+{
+   setPen       ( QPen( US_GuiSettings::plotCurve() ) );
+   setYAxis     ( QwtPlot::yLeft );
+   attach       ( plot );
+}
+
+// Set the curve points
+void US_PlotLodCurve::setLodData( const double* xx, const double* yy,
+      int np )
+{
+#if QT_VERSION < 0x050000
+   setData( US_PlotLodData( xx, yy, np ) );
+#else
+   setData( new US_PlotLodData( xx, yy, np ) );
+#endif
+}
+
+// Return the level-of-detail data, or NULL if other data was set
+US_PlotLodData* US_PlotLodCurve::lodData( void ) const
+{
+   US_PlotLodCurve* curve = const_cast< US_PlotLodCurve* >( this );
+#if QT_VERSION < 0x050000
+   return dynamic_cast< US_PlotLodData* >( &curve->data() );
+#else
+   return dynamic_cast< US_PlotLodData* >( curve->data() );
+#endif
+}
+
+// Task that builds the pyramids of a range of curves' data
+class US_PlotLodTask : public US_RangeTask
+{
+   public:
+      QVector< US_PlotLodData* > ldata;   // Data of each curve
+
+      void run_range( int begin, int end, int )
+      {
+         for ( int ii = begin; ii < end; ii++ )
+            ldata[ ii ]->build_levels();
+      }
+};
+
+// Build the pyramids of a list of curves, spread over the thread pool
+void US_PlotLodCurve::build_levels( const QList< US_PlotLodCurve* >& curves )
+{
+   US_PlotLodTask task;
+
+   for ( int ii = 0; ii < curves.size(); ii++ )
+   {
+      US_PlotLodData* ldat = curves[ ii ]->lodData();
+
+      if ( ldat != NULL )
+         task.ldata << ldat;
+   }
+
+   US_Parallel::run( &task, task.ldata.size(), 0, 4 );
+}
+
+// Select the presented points for the x range and width of the canvas
+void US_PlotLodCurve::select_view( const QwtScaleMap& xMap ) const
+{
+   US_PlotLodData* ldat = lodData();
+
+   if ( ldat != NULL )
+   {
+      int npix    = qRound( qAbs( xMap.p2() - xMap.p1() ) );
+      ldat->select( qMin( xMap.s1(), xMap.s2() ),
+                    qMax( xMap.s1(), xMap.s2() ), npix );
+   }
+}
+
+#if QT_VERSION < 0x050000
+void US_PlotLodCurve::draw( QPainter* painter, const QwtScaleMap& xMap,
+      const QwtScaleMap& yMap, int, int ) const
+{
+   select_view( xMap );
+   QwtPlotCurve::draw( painter, xMap, yMap, 0, -1 );
+}
+#else
+void US_PlotLodCurve::drawSeries( QPainter* painter, const QwtScaleMap& xMap,
+      const QwtScaleMap& yMap, const QRectF& canvasRect, int, int ) const
+{
+   select_view( xMap );
+   QwtPlotCurve::drawSeries( painter, xMap, yMap, canvasRect, 0, -1 );
+}
+#endif
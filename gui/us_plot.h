@@ -16,6 +16,14 @@
 #include "qwt_plot_curve.h"
 #include "qwt_plot_canvas.h"
 #include "qwt_symbol.h"
+#include "qwt_scale_map.h"
+#if QT_VERSION < 0x050000
+#include "qwt_data.h"
+#define US_PlotLodBase QwtData
+#else
+#include "qwt_series_data.h"
+#define US_PlotLodBase QwtSeriesData< QPointF >
+#endif
 
 
 //! \brief A class to implement plot zooming
@@ -355,5 +363,111 @@ class US_GUI_EXTERN US_PlotPicker : public QwtPlotPicker
       //! \brief Slot to handle mouse move event
       void widgetMouseMoveEvent   ( QMouseEvent* ); 
 };
+
+//! \brief Curve data with a min/max-preserving level-of-detail pyramid
+
+/*! \class US_PlotLodData
+    The data holds all the points of a curve, whose x values should be in
+    non-decreasing order. Each level of the pyramid divides the points into
+    buckets twice the size of those of the level below it and records the
+    points of minimum and maximum y in each bucket, so that peaks and
+    spikes survive at every level.
+
+    When a curve is drawn, only the points within the visible x range are
+    presented. They are at full detail if there are no more of them than
+    pixels across the canvas. Otherwise they come from the finest level
+    with at most one bucket per two pixels.
+*/
+class US_GUI_EXTERN US_PlotLodData : public US_PlotLodBase
+{
+   public:
+      //! \brief Create the data from arrays of points
+      //! \param xx  Array of x values
+      //! \param yy  Array of y values
+      //! \param np  Number of points
+      US_PlotLodData( const double*, const double*, int );
+
+      //! \brief Build the level-of-detail pyramid
+      void build_levels( void );
+
+      //! \brief Select the points presented for a visible x range
+      //! \param xlo   Low x of the visible range
+      //! \param xhi   High x of the visible range
+      //! \param npix  Width in pixels of the visible range
+      void select      ( double, double, int );
+
+      //! \brief Return the number of points in the full data
+      int  full_size   ( void ) const { return xfull.size(); }
+
+#if QT_VERSION < 0x050000
+      QwtData*      copy        ( void ) const;
+      size_t        size        ( void ) const;
+      double        x           ( size_t ) const;
+      double        y           ( size_t ) const;
+      QwtDoubleRect boundingRect( void ) const;
+#else
+      size_t        size        ( void ) const;
+      QPointF       sample      ( size_t ) const;
+      QRectF        boundingRect( void ) const;
 #endif
 
+   private:
+      QVector< double >          xfull;    // X values of all points
+      QVector< double >          yfull;    // Y values of all points
+      QVector< QVector< int > >  lpoints;  // Min,max point of buckets, by level
+      QVector< int >             vpoints;  // Presented points, if decimated
+
+      int     vfirst;   // First presented point, if not decimated
+      int     vcount;   // Number of presented points
+      bool    ordered;  // Flag if x values are in non-decreasing order
+      double  xmin;     // Bounding values of the full data
+      double  xmax;
+      double  ymin;
+      double  ymax;
+
+      int     point     ( size_t ) const;
+};
+
+//! \brief A plot curve drawn from level-of-detail data
+
+/*! \class US_PlotLodCurve
+    This curve is used in place of a QwtPlotCurve for scans with many
+    points. Before each draw it selects from its US_PlotLodData the points
+    that suit the current zoom and canvas width.
+*/
+class US_GUI_EXTERN US_PlotLodCurve : public QwtPlotCurve
+{
+   public:
+      //! \brief Create a curve styled as by us_curve() and attach it
+      //! \param plot   Plot to which to attach the curve
+      //! \param title  Title of the curve
+      US_PlotLodCurve( QwtPlot*, const QString& );
+
+      //! \brief Set the curve points. The pyramid is built separately.
+      //! \param xx  Array of x values
+      //! \param yy  Array of y values
+      //! \param np  Number of points
+      void setLodData  ( const double*, const double*, int );
+
+      //! \brief Return the level-of-detail data of the curve
+      US_PlotLodData* lodData( void ) const;
+
+      //! \brief Build the pyramids of a list of curves on worker threads
+      //! \param curves  Curves whose data pyramids are to be built
+      static void build_levels( const QList< US_PlotLodCurve* >& );
+
+#if QT_VERSION < 0x050000
+      using QwtPlotCurve::draw;
+      //! \brief Select the points to present, then draw them
+      void draw      ( QPainter*, const QwtScaleMap&, const QwtScaleMap&,
+                       int, int ) const;
+#else
+      //! \brief Select the points to present, then draw them
+      void drawSeries( QPainter*, const QwtScaleMap&, const QwtScaleMap&,
+                       const QRectF&, int, int ) const;
+#endif
+
+   private:
+      void select_view( const QwtScaleMap& ) const;
+};
+#endif
@@ -7,9 +7,76 @@
 #include "us_math2.h"
 #include "us_settings.h"
 #include "us_colorgradIO.h"
+#include "us_parallel.h"
 
 using namespace Qwt3D;
 
+#define KERN_NPTS 4096    // number of decay kernel table intervals
+
+// Range task to sum model point peaks into a tile of raster x indexes.
+//  The decay for each raster point is interpolated from a table
+//  indexed by squared distance from the model point.
+class US_Plot3DRaster : public US_RangeTask
+{
+   public:
+      const double* xyz;      // model x,y,z triples
+      const double* ktab;     // decay kernel by squared distance
+      double*       zbase;    // raster sums (ncols x nrows)
+      int     ncomp;
+      int     nrows;
+      int     ncols;
+      int     nxd;
+      int     nyd;
+      double  xpinc;
+      double  ypinc;
+      double  dsqmx;
+      double  dsinc;
+
+      void run_range( int begin, int end, int )
+      {
+         for ( int kk = 0; kk < ncomp; kk++ )
+         {  // calculate spread of each model point to a radius of raster points
+            double xval  = xyz[ kk * 3     ];
+            double yval  = xyz[ kk * 3 + 1 ];
+            double zval  = xyz[ kk * 3 + 2 ];
+
+            int rx       = (int)( xval * xpinc );     // raster index of model x
+            int fx       = qMax( rx - nxd, begin );   // range of x to work on
+            int lx       = qMin( rx + nxd, end   );
+            lx           = qMin( lx, ncols );
+
+            int ry       = (int)( yval * ypinc );     // raster index of model y
+            int fy       = qMax( ry - nyd, 0     );   // range of y to work on
+            int ly       = qMin( ry + nyd, nrows );
+
+            for ( int ii = fx; ii < lx; ii++ )
+            {  // find square of difference of x-raster and x-model
+               double  xdif  = sq( (double)ii / xpinc - xval );
+               double* zrow  = zbase + ii * nrows;
+
+               for ( int jj = fy; jj < ly; jj++ )
+               {  // squared distance of raster point from model point
+                  double dsq    = xdif + sq( (double)jj / ypinc - yval );
+
+                  // If distance is within beta, sum in the z value for
+                  //  this raster point:
+                  //   OutZ  = InZ + ModlZ * Cosine( Dist * PI/2 / Beta )
+                  //                         raised to the Alpha power.
+                  //  The user Z scale factor is applied to the whole sum.
+                  if ( dsq <= dsqmx )
+                  {
+                     double rk     = dsq * dsinc;
+                     int    jk     = (int)rk;
+                     double fk     = rk - (double)jk;
+                     zrow[ jj ]   += zval * ( ktab[ jk ] +
+                                       fk * ( ktab[ jk + 1 ] - ktab[ jk ] ) );
+                  }
+               }
+            }
+         }
+      }
+};
+
 // constructor:  3-d plot mainwindow widget
 US_Plot3D::US_Plot3D( QWidget* p, US_Model* m )
    : QMainWindow( p, Qt::Dialog )
@@ -17,6 +84,8 @@ US_Plot3D::US_Plot3D( QWidget* p, US_Model* m )
    model     = m;
    dbg_level = US_Settings::us_debug();
    ncols     = nrows = 0;
+   ralpha    = 0.0;
+   rbeta     = 0.0;
 
    // lay out the GUI
    setWindowTitle( tr( "Model Solute 3-Dimensional Viewer" ) );
@@ -461,10 +530,7 @@ void US_Plot3D::setParameters( double z_scale, double a_gridr,
    nrows       = ncols;
 
    // set size of raster data
-   zdata.resize( ncols );
-
-   for ( int ii = 0; ii < ncols; ii++ )
-      zdata[ ii ].resize( nrows );
+   zdata.resize( ncols * nrows );
 
    // calculate the raster z data from the given model
 
@@ -472,7 +538,7 @@ void US_Plot3D::setParameters( double z_scale, double a_gridr,
 }
 
 // calculate raster data from model data
-void US_Plot3D::calculateData( QVector< QVector< double > >& zdat )
+void US_Plot3D::calculateData( QVector< double >& zdat )
 {
    US_Model::SimulationComponent* sc;
    int    ncomp  = model->components.size();
@@ -482,19 +548,7 @@ void US_Plot3D::calculateData( QVector< QVector< double > >& zdat )
    int    loyd   = 5;
    int    nxd    = hixd;
    int    nyd    = hiyd;
-   int    fx;
-   int    lx;
-   int    rx;
-   int    fy;
-   int    ly;
-   int    ry;
-   double xval;
-   double yval;
-   double zval   = zmin;
-   double dist;
-   double dfac   = M_PI * 0.5 / beta;  // dist-related scale factor
    double xdif;
-   double ydif;
    double xpinc  = (double)( nrows - 1 ) / ( xmax - xmin ); // xy points/value
    double ypinc  = (double)( ncols - 1 ) / ( ymax - ymin );
    double zfact  = zscale;
@@ -528,71 +582,71 @@ DbgLv(2) << " xdif nxd nyd" << xdif << nxd << nyd;
    nyd  = ( nyd > loyd ) ? nyd : loyd;
 DbgLv(2) << "  nxd nyd" << nxd << nyd;
 
-   for ( int ii = 0; ii < nrows; ii++ )      // initialize raster to zmin
-      for ( int jj = 0; jj < ncols; jj++ )
-         zdat[ ii ][ jj ] = zval;
+   // Gather the x,y,z of each model point relative to the raster origin,
+   //  followed by the raster scale, as the key of the raster to compute
+   QVector< double > xyz( ncomp * 3 + 2 );
+   xyz[ ncomp * 3     ] = xpinc;
+   xyz[ ncomp * 3 + 1 ] = ypinc;
 
    for ( int kk = 0; kk < ncomp; kk++ )
-   {  // calculate spread of each model point to a radius of raster points
-      sc         = &model->components[ kk ];  // current component and xyz
-      xval       = comp_value( sc, typex,  x_norm ) - xmin;
-      yval       = comp_value( sc, typey,  y_norm ) - ymin;
-      zval       = comp_value( sc, -typez, z_norm );
-
-      rx         = (int)( xval * xpinc );     // raster index of model x
-      fx         = rx - nxd;                  // range of x to work on
-      lx         = rx + nxd;
-      fx         = ( fx > 0 )     ? fx : 0;
-      lx         = ( lx < ncols ) ? lx : ncols;
-
-      ry         = (int)( yval * ypinc );     // raster index of model y
-      fy         = ry - nyd;                  // range of y to work on
-      ly         = ry + nyd;
-      fy         = ( fy > 0 )     ? fy : 0;
-      ly         = ( ly < nrows ) ? ly : nrows;
-
-      for ( int ii = fx; ii < lx; ii++ )
-      {  // find square of difference of x-raster and x-model
-         xdif       = sq( (double)ii / xpinc - xval );
-
-         for ( int jj = fy; jj < ly; jj++ )
-         {  // find square of difference of y-raster and y-model
-            ydif       = sq( (double)jj / ypinc - yval );
-            // distance of raster point from model point
-            dist       = sqrt( xdif + ydif );
-
-            // If distance is within beta, calculate and sum in the z value
-            // for this raster point. Here is what the following amounts to.
-            //   for InZ,   the previous raster point Z;
-            //       OutZ,  the new raster point Z;
-            //       ModlZ, the peak model point Z;
-            //       Alpha, the user-specified peak smoothing factor;
-            //       Beta,  the user-specified peak width factor;
-            //       Dist,  the calculated model-to-raster point distance;
-            //       Scale, the calculated Z decay at this distance;
-            //       Zfact, the user-specified Z scaling factor;
-            //   Scale = Cosine( Dist * PI/2 / Beta ) raised to the Alpha power
-            //   OutZ  = InZ + ( ModlZ * Scale * Zfact )
-            if ( dist <= beta )
-            {
-               zdat[ ii ][ jj ] += ( ( zval *
-                     ( pow( cos( dist * dfac ), alpha ) ) ) * zfact );
-            }
-//else {DbgLv(3) << "  *dist>beta* dist beta iijj" << dist << beta << ii << jj;}
-//*DBG*
-//if ( kk>(ncomp/2-2) && kk<(ncomp/2+2) ) {
-//if ( ii>3 && ii<9 && jj>5 && jj<11 ) {
-// DbgLv(3) << "kk" << kk << "rx ry ii jj" << rx << ry << ii << jj
-//  << "zout"  << zdat[ii][jj] << " zfac" << (pow(cos(dist*dfac),alpha));
-// DbgLv(3) << "  dist" << dist << "dfac alpha beta zval" << dfac
-//  << alpha << beta << zval;
-//}
-//*DBG*
-         }
+   {
+      sc              = &model->components[ kk ];
+      xyz[ kk * 3     ] = comp_value( sc, typex,  x_norm ) - xmin;
+      xyz[ kk * 3 + 1 ] = comp_value( sc, typey,  y_norm ) - ymin;
+      xyz[ kk * 3 + 2 ] = comp_value( sc, -typez, z_norm );
+   }
+
+   // Only the z scale factor changed since the last raster:  the unscaled
+   //  sums are still good, so simply rescale them
+   bool same    = ( xyz == rxyz  &&  alpha == ralpha  &&  beta == rbeta  &&
+                    zbase.size() == ncols * nrows );
+
+   if ( ! same )
+   {
+      rxyz         = xyz;
+      ralpha       = alpha;
+      rbeta        = beta;
+      zbase.fill( 0.0, ncols * nrows );
+
+      // Tabulate the decay kernel, pow( cos( dist * dfac ), alpha ), by
+      //  squared distance, so raster points need no sqrt, cos or pow
+      double dfac  = M_PI * 0.5 / beta;  // dist-related scale factor
+      double dsqmx = beta * beta;
+      double dsinc = (double)KERN_NPTS / dsqmx;
+      QVector< double > ktab( KERN_NPTS + 2 );
+
+      for ( int jj = 0; jj <= KERN_NPTS; jj++ )
+      {
+         double dist  = sqrt( (double)jj / dsinc );
+         ktab[ jj ]   = pow( cos( dist * dfac ), alpha );
       }
-//DbgLv(3) << "P3D:cD:  kk fx lx fy ly" << kk << fx << lx << fy << ly
-// << "  xval yval zval" << xval << yval << zval;
+      ktab[ KERN_NPTS + 1 ] = 0.0;
+
+      US_Plot3DRaster rtask;
+      rtask.xyz    = xyz.constData();
+      rtask.ktab   = ktab.constData();
+      rtask.zbase  = zbase.data();
+      rtask.ncomp  = ncomp;
+      rtask.nrows  = nrows;
+      rtask.ncols  = ncols;
+      rtask.nxd    = nxd;
+      rtask.nyd    = nyd;
+      rtask.xpinc  = xpinc;
+      rtask.ypinc  = ypinc;
+      rtask.dsqmx  = dsqmx;
+      rtask.dsinc  = dsinc;
+
+      // Each thread sums all model points into its own tile of raster x
+      US_Parallel::run( &rtask, ncols, 0, 4 );
    }
+else DbgLv(2) << "P3D:cD: raster reused; zscale" << zfact;
+
+   // Raster z is the floor plus the scaled sum
+   const double* zbas = zbase.constData();
+   double*       zout = zdat.data();
+
+   for ( int jj = 0; jj < ncols * nrows; jj++ )
+      zout[ jj ]   = zmin + zbas[ jj ] * zfact;
 }
 
 void US_Plot3D::replot()
@@ -613,7 +667,7 @@ if ((ii&63)==1) DbgLv(2) << "P3D:  rp: row" << ii;
 
       for ( int jj = 0; jj < nrows; jj++ )
       {
-         double zval       = zdata[ ii ][ jj ];
+         double zval       = zdata[ ii * nrows + jj ];
          wdata[ ii ][ jj ] = zval;
          zdmx              = zdmx > zval ? zdmx : zval;
 if ((ii&63)==1&&(jj&63)==1) DbgLv(2) << "P3D:    rp: col" << jj
@@ -1372,13 +1426,9 @@ DbgLv(2) << "open_file";
 void US_Plot3D::close_all( ) 
 {
 DbgLv(2) << "close_all";
-   if ( ( ncols = zdata.size() ) != 0 )
-   {
-      for ( int ii = 0; ii < ncols; ii++ )
-         zdata[ ii ].clear();
-
-      zdata.clear();
-   }
+   zdata.clear();
+   zbase.clear();
+   rxyz .clear();
 
    close();
 }
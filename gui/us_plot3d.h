@@ -42,9 +42,11 @@ class US_GUI_EXTERN US_Plot3D : public QMainWindow
       //! \param y_scale  Relative Y scale factor
       void setParameters( double, double, double, double,
                           double = 1.0, double = 1.0 );
-      //! \brief Public function to (re)calculate Z values at fixed increments
-      //! \param zdat     Z data vector of vectors
-      void calculateData( QVector< QVector< double > >& );
+      //! \brief Public function to (re)calculate Z values at fixed increments.
+      //!        Peak sums are kept between calls, so a change of only the
+      //!        Z scale factor does not recompute the raster.
+      //! \param zdat     Z data raster, ncols vectors of nrows, contiguous
+      void calculateData( QVector< double >& );
       //! \brief Public function to replot the 3D data
       void replot       ( void );
       //! \brief Public function to return the data widget pointer
@@ -166,6 +168,8 @@ class US_GUI_EXTERN US_Plot3D : public QMainWindow
       double        z_scale;
       double        alpha;
       double        beta;
+      double        ralpha;
+      double        rbeta;
 
       QString       xatitle;
       QString       yatitle;
@@ -175,7 +179,9 @@ class US_GUI_EXTERN US_Plot3D : public QMainWindow
 
       QTimer*       timer;
 
-      QVector< QVector< double > > zdata;
+      QVector< double >            zdata;   // raster z (ncols x nrows)
+      QVector< double >            zbase;   // raster unscaled peak sums
+      QVector< double >            rxyz;    // model x,y,z of zbase
 
       Qwt3D::SurfacePlot*          dataWidget;
 
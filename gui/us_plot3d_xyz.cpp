@@ -981,6 +981,15 @@ bool US_Plot3Dxyz::save_plot( const QString filename, const QString imagetype )
    return IO::save( dataWidget, filename, imagetype );
 }
 
+// Public method to render the plot to an image, to be saved by the caller
+QImage US_Plot3Dxyz::plot_image( void )
+{
+   dataWidget->updateData();
+   dataWidget->updateGL();
+
+   return dataWidget->grabFrameBuffer();
+}
+
 QString US_Plot3Dxyz::xyAxisTitle( int type, double sclnorm )
 {
    QString atitle = tr( "s" );
@@ -74,6 +74,10 @@ class US_GUI_EXTERN US_Plot3Dxyz : public QMainWindow
       //! \return          Flag if save was successful
       bool save_plot( const QString, const QString );
 
+      //! \brief Public function to render the plot to an image
+      //! \return          Image of the plot
+      QImage plot_image( void );
+
    signals:
       //! \brief A signal emitted when this dialog has been closed.
       void has_closed( void );
@@ -3,9 +3,139 @@
 #include "us_spectrodata.h"
 #include "us_defines.h"
 #include "us_settings.h"
+#include "us_parallel.h"
 
 #define LO_DTERM 0.2500    // low decay-term point (1/4)
 
+// Range task that splats solute Gaussians into the raster.
+//  Phase 0 runs over points and tabulates each point's extent, z value
+//  and x-terms; phase 1 runs over raster rows and, for every point that
+//  reaches a row, combines its y-term with the tabulated x-terms.
+class US_SplatTask : public US_RangeTask
+{
+   public:
+      QList< S_Solute >* solu;     // distribution points
+      double*            rdata;    // raster values (nyscn rows of nxpsc)
+      QVector< double >  xterms;   // x-terms per point (nxt each)
+      QVector< double >  zvals;    // z value per point
+      QVector< int >     fxs;      // first raster x per point
+      QVector< int >     nxs;      // number of raster x per point
+      QVector< int >     fys;      // first raster y per point
+      QVector< int >     lys;      // last raster y (+1) per point
+      int     phase;
+      int     nxpsc;
+      int     nyscn;
+      int     nxd;
+      int     nyd;
+      int     nxt;
+      double  xmin;
+      double  ymax;
+      double  xinc;
+      double  yinc;
+      double  zmin;
+      double  zminr;
+      double  sssc;
+      double  fssc;
+      bool    flat;                // flag: resolution 100, flat circles
+
+      void run_range( int begin, int end, int )
+      {
+         if ( phase == 0 )
+            tabulate( begin, end );
+         else
+            splat   ( begin, end );
+      }
+
+   private:
+      void tabulate( int begin, int end )
+      {
+         for ( int kk = begin; kk < end; kk++ )
+         {
+            double xval  = solu->at( kk ).s;
+            double yval  = solu->at( kk ).k;
+            double zval  = solu->at( kk ).c;
+
+            if ( ! flat )
+               zval      = qMax( 0.0, zval - zminr ); // z in 0,zrng range
+
+            int rx  = (int)( ( xval - xmin ) * xinc );    // x index of point
+            int fx  = rx - nxd;                           // first reasonable x
+            int lx  = rx + nxd;                           // last reasonable x
+            fx      = ( fx > 0 )     ? fx : 0;
+            lx      = ( lx < nxpsc ) ? lx : nxpsc;
+            int ry  = (int)( ( ymax - yval ) * yinc );    // y index of point
+            int fy  = ry - nyd;                           // first reasonable y
+            int ly  = ry + nyd;                           // last reasonable y
+            fy      = ( fy > 0 )     ? fy : 0;
+            ly      = ( ly < nyscn ) ? ly : nyscn;
+
+            fxs  [ kk ] = fx;
+            nxs  [ kk ] = qMax( 0, lx - fx );
+            fys  [ kk ] = fy;
+            lys  [ kk ] = ly;
+            zvals[ kk ] = zval;
+
+            double* xtrm = xterms.data() + kk * nxt;
+
+            for ( int jj = fx; jj < lx; jj++ )
+            {
+               double xras   = (double)jj / xinc + xmin;
+               double xdif   = xras - xval;
+               *(xtrm++)     = exp( xdif * xdif * sssc );
+            }
+         }
+      }
+
+      void splat( int begin, int end )
+      {
+         int nsol  = zvals.size();
+
+         for ( int kk = 0; kk < nsol; kk++ )
+         {
+            int fy     = qMax( fys[ kk ], begin );
+            int ly     = qMin( lys[ kk ], end );
+            int nx     = nxs[ kk ];
+
+            if ( fy >= ly  ||  nx < 1 )
+               continue;
+
+            double  yval   = solu->at( kk ).k;
+            double  zval   = zvals[ kk ];
+            const double* xtrm = xterms.constData() + kk * nxt;
+
+            for ( int ii = fy; ii < ly; ii++ )
+            {   // calculate y-term, then combine it with the row of x-terms
+               double yras   = ymax - ( (double)ii / yinc );
+               double ydif   = yras - yval;
+               double yterm  = exp( ydif * ydif * fssc );
+               double* rrow  = rdata + ii * nxpsc + fxs[ kk ];
+
+               if ( ! flat )
+               {  // Output value according to Gaussian distribution factor.
+                  // Note that the expression below adds zmin back in to a
+                  // value that is really:
+                  //   zval * exp( -pow( xdif, 2.0 ) / pow( 2 * ssigma, 2.0 ) )
+                  //        * exp( -pow( ydif, 2.0 ) / pow( 2 * fsigma, 2.0 ) )
+                  // Only replace the input if the new value is greater.
+                  double zterm  = zval * yterm;
+
+                  for ( int jj = 0; jj < nx; jj++ )
+                     rrow[ jj ]    = qMax( rrow[ jj ], zmin + zterm * xtrm[ jj ] );
+               }
+
+               else
+               {  // Replace input if within distr radius and zval>zin
+                  double xlow   = LO_DTERM / yterm;
+
+                  for ( int jj = 0; jj < nx; jj++ )
+                     rrow[ jj ]    = ( xtrm[ jj ] > xlow )
+                                   ? qMax( rrow[ jj ], zval ) : rrow[ jj ];
+               }
+            }
+         }
+      }
+};
+
 // Provides raster data for QwtSpectrogram
 US_SpectrogramData::US_SpectrogramData() : QwtRasterData()
 {
@@ -245,12 +375,7 @@ qDebug() << "sRaDa: setBounding... zminr zmax" << zminr << zmax;
 #endif
 
    // Initialize raster to zmin (zero)
-   rdata.clear();
-
-   for ( int ii = 0; ii < nxypt; ii++ )
-   {
-      rdata.append( 0.0 );
-   }
+   rdata.fill( 0.0, nxypt );
 
    // Populate raster with z values derived from a Gaussian distribution
    //  around each distribution point.
@@ -271,102 +396,37 @@ qDebug() << "sRaDa: setBounding... zminr zmax" << zminr << zmax;
    nxd          = ( nxd < 10 ) ? 10 : ( ( nxd > hixd ) ? hixd : nxd );
    nyd          = ( nyd < 10 ) ? 10 : ( ( nyd > hiyd ) ? hiyd : nyd );
 
-   if ( resol != 100.0 )
-   {
-      for ( int kk = 0; kk < nsol; kk++ )
-      {   // spread z values for each distribution point
-         xval    = solu->at( kk ).s;                   // x,y,z
-         yval    = solu->at( kk ).k;
-         zval    = solu->at( kk ).c - zminr;           // use z in 0,zrng range
-         zval    = qMax( 0.0, zval );
-
-         int rx  = (int)( ( xval - xmin ) * xinc );    // x index of this point
-         int fx  = rx - nxd;                           // first reasonable x
-         int lx  = rx + nxd;                           // last reasonable x
-         fx      = ( fx > 0 )     ? fx : 0;
-         lx      = ( lx < nxpsc ) ? lx : nxpsc;
-         int ry  = (int)( ( ymax - yval ) * yinc );    // y index of this point
-         int fy  = ry - nyd;                           // first reasonable y
-         int ly  = ry + nyd;                           // last reasonable y
-         fy      = ( fy > 0 )     ? fy : 0;
-         ly      = ( ly < nyscn ) ? ly : nyscn;
-
-         for ( int ii = fy; ii < ly; ii++ )
-         {   // calculate y-term and x range for each y
-            double yras   = ymax - ( (double)ii / yinc );
-            double ydif   = yras - yval;
-            double yterm  = exp( ydif * ydif * fssc ); // y term
-            double zterm  = zval * yterm;              // combine z-value,y-term
-            int kr        = ii * nxpsc + fx;           // start rast point index
-
-            for ( int jj = fx; jj < lx; jj++ )
-            {  // calculate x-term then calculate z-value for raster point
-               double xras   = (double)jj / xinc + xmin;
-               double xdif   = xras - xval;
-               double xterm  = exp( xdif * xdif * sssc );
-
-               double zin    = rdata.at( kr );         // current value there
-
-               // Output value according to Gaussian distribution factor.
-               // Note that the expression below adds zmin back in to a
-               // value that is really:
-               //   zval * exp( -pow( xdif, 2.0 ) / pow( 2 * ssigma, 2.0 ) )
-               //        * exp( -pow( ydif, 2.0 ) / pow( 2 * fsigma, 2.0 ) )
-               double zout   = zmin + zterm * xterm;
-
-               // only replace input if new value is greater
-               if ( zout > zin )
-                  rdata.replace( kr, zout );
-
-               kr++;                                   // bump rast point index
-            }
-         }
-      }
-   }
-   else
-   {   // for resolution=100, make all points in circle have zval value
-      for ( int kk = 0; kk < nsol; kk++ )
-      {   // spread z values for each distribution point
-         xval    = solu->at( kk ).s;                   // x,y,z
-         yval    = solu->at( kk ).k;
-         zval    = solu->at( kk ).c;
-
-         int rx  = (int)( ( xval - xmin ) * xinc );    // x index of this point
-         int fx  = rx - nxd;                           // first reasonable x
-         int lx  = rx + nxd;                           // last reasonable x
-         fx      = ( fx > 0 )     ? fx : 0;
-         lx      = ( lx < nxpsc ) ? lx : nxpsc;
-         int ry  = (int)( ( ymax - yval ) * yinc );    // y index of this point
-         int fy  = ry - nyd;                           // first reasonable y
-         int ly  = ry + nyd;                           // last reasonable y
-         fy      = ( fy > 0 )     ? fy : 0;
-         ly      = ( ly < nyscn ) ? ly : nyscn;
-
-         for ( int ii = fy; ii < ly; ii++ )
-         {   // calculate y-term and x range for each y
-            double yras   = ymax - ( (double)ii / yinc );
-            double ydif   = yras - yval;
-            double yterm  = exp( ydif * ydif * fssc ); // y term
-            int kr        = ii * nxpsc + fx;           // start rast point index
-
-            for ( int jj = fx; jj < lx; jj++ )
-            {  // calculate x-term then calculate z-value for raster point
-               double xras   = (double)jj / xinc + xmin;
-               double xdif   = xras - xval;
-               double xterm  = exp( xdif * xdif * sssc );
-
-               double zin    = rdata.at( kr );         // current value there
-               double zdecay = yterm * xterm;          // composite decay term
-
-               // replace input if within distr radius and zout>zin
-               if ( zdecay > LO_DTERM  &&  zval > zin)
-                  rdata.replace( kr, zval );
-
-               kr++;                                   // bump rast point index
-            }
-         }
-      }
-   }
+   // The Gaussian is separable:  tabulate the x-terms of each point once,
+   //  then let each thread splat all points into its own band of rows.
+   US_SplatTask splat;
+   splat.solu   = solu;
+   splat.rdata  = rdata.data();
+   splat.nxpsc  = nxpsc;
+   splat.nyscn  = nyscn;
+   splat.nxd    = nxd;
+   splat.nyd    = nyd;
+   splat.nxt    = nxd * 2;
+   splat.xmin   = xmin;
+   splat.ymax   = ymax;
+   splat.xinc   = xinc;
+   splat.yinc   = yinc;
+   splat.zmin   = zmin;
+   splat.zminr  = zminr;
+   splat.sssc   = sssc;
+   splat.fssc   = fssc;
+   splat.flat   = ( resol == 100.0 );
+   splat.xterms.fill( 0.0, nsol * splat.nxt );
+   splat.fxs   .fill( 0,   nsol );
+   splat.nxs   .fill( 0,   nsol );
+   splat.fys   .fill( 0,   nsol );
+   splat.lys   .fill( 0,   nsol );
+   splat.zvals .fill( 0.0, nsol );
+
+   splat.phase  = 0;                  // Per-point tables
+   US_Parallel::run( &splat, nsol, 0, 256 );
+
+   splat.phase  = 1;                  // Row bands of the raster
+   US_Parallel::run( &splat, nyscn, 0, 8 );
 qDebug() << "SD:sRaDa: RETURN:";
 }
 
@@ -101,7 +101,7 @@ public:
 
 private:
 
-   QList< double > rdata;        //!< Raster data: z-values at each pixel
+   QVector< double > rdata;      //!< Raster data: z-values at each pixel
    QRectF          drecti;       //!< Data rectangle for x,y plot ranges
 
    double          xmin;         //!< X minimum
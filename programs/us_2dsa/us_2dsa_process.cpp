@@ -32,6 +32,7 @@ US_2dsaProcess::US_2dsaProcess( QList< SS_DATASET* >& dsets,
    mmtype           = 0;              // meniscus/montecarlo type (NONE)
    mmiters          = 0;              // meniscus/montecarlo iterations
    fnoionly         = US_Settings::debug_match( "2dsaFinalNoiseOnly" );
+   adaptive         = false;          // adaptive grid refinement flag
   
    itvaris  .clear();                 // iteration variances
    ical_sols.clear();                 // iteration final calculated solutes
@@ -103,6 +104,7 @@ void US_2dsaProcess::start_fit( double sll, double sul,  int nss,
    orig_sols.clear();
    itvaris  .clear();
    ical_sols.clear();
+   simcache .clear();
 
 DbgLv(1) << "2P: sll sul nss" << slolim << suplim << nssteps
  << " kll kul nks" << klolim << kuplim << nksteps
@@ -201,6 +203,12 @@ DbgLv(1) << "2P:    kgref kgrefsq kksubg" << kgref << kgrefsq << kksubg;
             for ( int jj = 0; jj < orig_sols[ ii ].count(); jj++ )
                orig_sols[ ii ][ jj ].k  = cnstff0;
       }
+
+      if ( adaptive )
+      {  // Index the grid solutes for adaptive refinement
+         solgrid.define( ssllim, ssulim, nssteps,
+                         klolim, kuplim, nksteps, vbar20 );
+      }
    }
 
    else if ( jgrefine == (-1) )
@@ -334,6 +342,12 @@ void US_2dsaProcess::set_iters( int    mxiter, int    mciter, int    mniter,
    DbgLv(1) << "2PSI: cnstff0 jgrefine stype" << cnstff0 << jgrefine << stype;
 }
 
+// Set adaptive grid refinement
+void US_2dsaProcess::set_adaptive( bool adapt )
+{
+   adaptive   = adapt;
+}
+
 // Abort a fit run
 void US_2dsaProcess::stop_fit()
 {
@@ -385,6 +399,8 @@ void US_2dsaProcess::clear_data()
    sdata .scanData.clear();
    sdata1.scanData.clear();
    rdata .scanData.clear();
+   simcache.clear();
+   solgrid .clear();
 }
 
 // Slot for thread step progress:  signal control progress bar
@@ -411,6 +427,7 @@ void US_2dsaProcess::final_computes()
    wtask.depth    = maxdepth;
    wtask.noisf    = noisflag;    // in this case, we use the noise flag
    wtask.dsets    = dsets;
+   wtask.simcache = adaptive ? &simcache : NULL;
    wtask.csolutes.clear();
    wtask.ti_noise.clear();
    wtask.ri_noise.clear();
@@ -897,6 +914,9 @@ void US_2dsaProcess::submit_job( WorkPacket2D& wtask, int thrx )
 {
    wtask.thrn         = thrx + 1;
 
+   // Only adaptive refinement revisits solutes enough to need the cache
+   wtask.simcache     = adaptive ? &simcache : NULL;
+
    WorkerThread2D* wthr = new WorkerThread2D( this );
    wthreads[ thrx ]   = wthr;
    wkstates[ thrx ]   = WORKING;
@@ -1239,11 +1259,23 @@ for(int jj=0; jj<ncsol; jj++ )
 int ktadd=0;
 //*DEBUG
 
+   // For adaptive refinement, tasks are of new grid points around the
+   // calculated solutes, instead of the original subgrids
+   bool adaptv  = ( adaptive  &&  dsets[ 0 ]->solute_type == 0 );
+   QList< QVector< US_Solute > > task_sols;
+
+   if ( adaptv )
+   {
+      adaptive_tasks( csolutes, task_sols );
+      nsubgrid     = task_sols.size();
+   }
+
    // Build and queue the subgrid tasks
    for ( ktask = 0; ktask < nsubgrid; ktask++ )
    {
       // Get the solutes originally created for this subgrid
-      isolutes = orig_sols[ ktask ];
+      //  (or the new refinement solutes of this adaptive task)
+      isolutes = adaptv ? task_sols[ ktask ] : orig_sols[ ktask ];
 
       // Add in any calculated solutes not already in this subgrid
       for ( int cc = 0; cc < ncsol; cc++ )
@@ -1252,7 +1284,7 @@ int ktadd=0;
             isolutes << csolutes[ cc ];
       }
 //*DEBUG
-int kosz=orig_sols[ktask].size();
+int kosz=adaptv?task_sols[ktask].size():orig_sols[ktask].size();
 int kasz=isolutes.size();
 int kadd=kasz-kosz;
 ktadd += (ncsol-kadd);
@@ -1270,7 +1302,7 @@ DbgLv(1) << "ITER: kt" << ktask << "iterate nisol o a c +"
    }
 
 //*DEBUG
-if(ktadd<ncsol) {
+if(ktadd<ncsol && !adaptv) {
  for(int kt=0;kt<nsubgrid;kt++)
   for(int cc=0;cc<orig_sols[kt].size();cc++)
    DbgLv(1) << "ITER          kt cc" << kt << cc << " s k c"
@@ -1285,14 +1317,17 @@ if(ktadd<ncsol) {
    // Start the first threads. This will begin the first work units (subgrids).
    // Thereafter, work units are started in new threads when threads signal
    // that they have completed their work.
-   for ( int ii = 0; ii < nthreads; ii++ )
+   // (Adaptive refinement may have fewer tasks than threads.)
+   kstask = 0;
+
+   for ( int ii = 0; ii < nthreads  &&  ! job_queue.isEmpty(); ii++ )
    {
       WorkPacket2D wtask = job_queue.takeFirst();
       submit_job( wtask, ii );
+      kstask++;           // count of started tasks is initially thread count
    }
 
    max_rss();
-   kstask = nthreads;     // count of started tasks is initially thread count
 
    emit message_update(
       tr( "Starting iteration %1 computations of %2 subgrids\n"
@@ -1301,6 +1336,39 @@ if(ktadd<ncsol) {
 
 }
 
+// Build adaptive refinement tasks of new grid points around solutes
+void US_2dsaProcess::adaptive_tasks( QVector< US_Solute >& csolutes,
+                                     QList< QVector< US_Solute > >& task_sols )
+{
+   if ( r_iter == 1 )
+   {  // At the first refinement, the index holds just the original grid
+      solgrid.clear();
+      solgrid.add_solutes( orig_sols );
+   }
+
+   // Get the grid points not yet simulated around the calculated solutes
+   QVector< US_Solute > nsols = solgrid.refine( csolutes, r_iter );
+   int nnsol    = nsols.size();
+   int ktsize   = qMax( mintsols, orig_sols[ 0 ].size() );
+   int ntask    = qMax( 1, ( nnsol + ktsize - 1 ) / ktsize );
+   ktsize       = ( nnsol + ntask - 1 ) / ntask;
+
+   // Divide the new solutes evenly among tasks; calculated solutes are
+   //  added to each, and their simulations come from the cache.
+   task_sols.clear();
+
+   for ( int ktask = 0; ktask < ntask; ktask++ )
+      task_sols << nsols.mid( ktask * ktsize, ktsize );
+
+DbgLv(1) << "ADAPT: r_iter" << r_iter << "ncsol" << csolutes.size()
+ << "nnsol" << nnsol << "ntask ktsize" << ntask << ktsize
+ << "indexed" << solgrid.count() << "cached" << simcache.count()
+ << "hits" << simcache.hits();
+   emit message_update(
+      tr( "Adaptive refinement:  %1 new grid points around %2 solutes" )
+      .arg( nnsol ).arg( csolutes.size() ), true );
+}
+
 // Free up a worker thread
 void US_2dsaProcess::free_worker( int tx )
 {
@@ -1415,6 +1483,7 @@ void US_2dsaProcess::set_meniscus()
    double smeniscus   = bmeniscus - menrange * 0.5;
    edata->meniscus    = smeniscus + (double)mm_iter * mendelta;
    simparms->meniscus = edata->meniscus;
+   simcache.clear();                // simulations differ for a new meniscus
 DbgLv(1) << "MENISC: mm_iter meniscus" << mm_iter << edata->meniscus;
 
    // Re-queue all the original subgrid tasks
@@ -1466,6 +1535,9 @@ void US_2dsaProcess::requeue_tasks()
    int jdpth = 0;
    int jnois = 0;
 
+   if ( adaptive  &&  jgrefine > 0 )
+      nsubgrid  = orig_sols.size();  // restore count after adaptive tasks
+
    for ( int ktask = 0; ktask < nsubgrid; ktask++ )
    {
       double llss = orig_sols[ ktask ][ 0 ].s;
@@ -70,6 +70,16 @@ class US_2dsaProcess : public QObject
       //! \param jgref   Flag of refine/solute type
       void set_iters( int, int, int, double, double, double, int );
 
+      //! \brief Set adaptive refinement of iterations
+      //!
+      //! Iterations after the first refine the uniform s,f/f0 grid only
+      //! around the solutes of nonzero concentration, halving the spacing
+      //! at each iteration, and simulate only grid points that are new.
+      //! This applies when the grid has constant vbar; otherwise each
+      //! iteration re-fits all subgrids.
+      //! \param adapt  Flag to use adaptive refinement
+      void set_adaptive( bool );
+
       //! \brief Get results upon completion of all refinements
       //! \param da_sim  Calculated simulation data
       //! \param da_res  Residuals data (exper - simul)
@@ -128,6 +138,9 @@ private:
       QList< QVector< US_Solute > > orig_sols;  // original solutes
       QList< QVector< US_Solute > > ical_sols;  // iteration calculated solutes
 
+      US_SolveSim::SimCache      simcache;   // nonzero solute simulations
+      US_SoluteGrid              solgrid;    // index of simulated solutes
+
       US_DataIO::EditedData*     edata;      // experimental data (mc_iter)
       US_DataIO::EditedData*     bdata;      // base experimental data
       US_DataIO::EditedData      wdata;      // work experimental data
@@ -175,6 +188,7 @@ private:
 
       bool       abort;        // flag used with stop_fit clicked
       bool       fnoionly;     // flag to use noise flag on final call only
+      bool       adaptive;     // flag to use adaptive grid refinement
 
       double     slolim;       // s lower limit
       double     suplim;       // s upper limit
@@ -198,6 +212,8 @@ private:
       void step_progress(    int );
       void final_computes(   void );
       void iterate(          void );
+      void adaptive_tasks(   QVector< US_Solute >&,
+                             QList< QVector< US_Solute > >& );
       void set_meniscus(     void );
       void set_monteCarlo(   void );
       void set_gaussians(    void );
@@ -146,6 +146,8 @@ DbgLv(1) << "idealThrCout" << nthr;
 
    QLayout*  lo_iters   =
       us_checkbox( tr( "Use Iterative Method"    ), ck_iters,  false );
+   QLayout*  lo_adaptv  =
+      us_checkbox( tr( "Adaptive Refinement"     ), ck_adaptv, false );
    QLayout*  lo_unifgr  =
       us_checkbox( tr( "Uniform Grid"            ), ck_unifgr, true  );
    QLayout*  lo_custgr  =
@@ -236,6 +238,7 @@ DbgLv(1) << "idealThrCout" << nthr;
    optimizeLayout->addLayout( lo_iters,      row++, 0, 1, 4 );
    optimizeLayout->addWidget( lb_iters,      row,   0, 1, 2 );
    optimizeLayout->addWidget( ct_iters,      row++, 2, 1, 2 );
+   optimizeLayout->addLayout( lo_adaptv,     row++, 0, 1, 4 );
    optimizeLayout->addWidget( pb_anorm,      row++, 0, 1, 4 );
    optimizeLayout->addWidget( lb_tolnorm,    row ,  0, 1, 1 );
    optimizeLayout->addWidget( ct_tol,        row++, 1, 1, 3 );
@@ -255,6 +258,7 @@ DbgLv(1) << "idealThrCout" << nthr;
    ck_custgr->setChecked( false );
    ck_iters ->setEnabled( true  );
    ct_iters ->setEnabled( false );
+   ck_adaptv->setEnabled( false );
 
    optimize_options();
 
@@ -442,8 +446,12 @@ void US_AnalysisControl2D::checkRegular(  bool checked )
 // handle iterations checked
 void US_AnalysisControl2D::checkIterate(  bool checked )
 {
-   ct_iters->setEnabled( checked );
-   ct_iters->setValue( ( checked ? 3 : 1 ) );
+   ct_iters ->setEnabled( checked );
+   ct_iters ->setValue( ( checked ? 3 : 1 ) );
+   ck_adaptv->setEnabled( checked );
+
+   if ( ! checked )
+      ck_adaptv->setChecked( false );
 }
 
 // handle vary-vbar checked
@@ -647,6 +655,7 @@ DbgLv(1) << "AnaC:St: sdelt kdelt" << sdelt << kdelt
 
    // Begin the fit
    processor->set_iters( mxiter, mciter, mniter, vtoler, menrng, cff0, ngrr );
+   processor->set_adaptive( ck_adaptv->isChecked() );
 
    processor->start_fit( slo, sup, nss, klo, kup, nks,
          ngrr, nthr, noif );
@@ -125,6 +125,7 @@ class US_AnalysisControl2D : public US_WidgetsDialog
       QCheckBox*    ck_clipcs;
       QCheckBox*    ck_mcarlo;
       QCheckBox*    ck_iters;
+      QCheckBox*    ck_adaptv;
       QCheckBox*    ck_varvbar;
       QCheckBox*    ck_norm;
 
@@ -17,6 +17,7 @@ WorkerThread2D::WorkerThread2D( QObject* parent )
    dbg_level  = US_Settings::us_debug();
    abort      = false;
    solvesim   = NULL;
+   simcache   = NULL;
    thrn       = -1;
 DbgLv(1) << "2P(WT): Thread created";
 }
@@ -49,6 +50,7 @@ void WorkerThread2D::define_work( WorkPacket2D& workin )
    menmcx      = workin.menmcx;
    noisflag    = workin.noisf;
    typeref     = workin.typeref;
+   simcache    = workin.simcache;
 
    solutes_i   = workin.isolutes;
 
@@ -133,6 +135,8 @@ void WorkerThread2D::calc_residuals()
    connect( solvesim, SIGNAL(  work_progress( int ) ),
             this,     SLOT( forward_progress( int ) ) );
 
+   solvesim->set_cache( simcache );
+
    sim_vals.solutes    = solutes_i;
 
    sim_vals.noisflag   = noisflag;
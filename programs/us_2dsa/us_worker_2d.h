@@ -1,6 +1,6 @@
 //! \file us_worker_2d.h
-#ifndef US_THREAD_WORKER_H
-#define US_THREAD_WORKER_H
+#ifndef US_WORKER_2D_H
+#define US_WORKER_2D_H
 
 #include <QtCore>
 
@@ -40,6 +40,7 @@ typedef struct work_packet_2d_s
 
    QList< US_SolveSim::DataSet* > dsets; //!< list of data set object pointers
    US_SolveSim::Simulation  sim_vals;  //!< simulation values
+   US_SolveSim::SimCache*   simcache;  //!< solute simulation cache (or null)
 
 
 } WorkPacket2D;
@@ -115,6 +116,7 @@ class WorkerThread2D : public QThread
       QList< US_SolveSim::DataSet* > dsets;     // list of data set obj. ptrs.
       US_SolveSim::Simulation        sim_vals;  // simulation values
       US_SolveSim*                   solvesim;  // object for calc_residuals()
+      US_SolveSim::SimCache*         simcache;  // solute simulation cache
       US_SolveSim::DataSet           dset_wk;   // local copy of data set
 
       QVector< US_Solute >    solutes_i;   // solutes input
@@ -0,0 +1,1329 @@
+//! \file us_batch_analysis.cpp
+
+#include <QApplication>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "us_batch_analysis.h"
+#include "us_settings.h"
+#include "us_util.h"
+#include "us_math2.h"
+#include "us_constants.h"
+#include "us_astfem_math.h"
+
+//! \brief Main program for us_batch_analysis. Parses the command line,
+//         then runs the batch of triple analyses to completion.
+
+int main( int argc, char* argv[] )
+{
+#if QT_VERSION < 0x050000
+   QApplication application( argc, argv, false );
+#else
+   if ( qgetenv( "DISPLAY" ).isEmpty() )
+      qputenv( "QT_QPA_PLATFORM", "offscreen" );
+
+   QApplication application( argc, argv );
+#endif
+
+   QStringList cmdargs = application.arguments();
+
+   US_BatchAnalysis batch( cmdargs );
+
+   if ( ! batch.is_ready() )
+      return 1;
+
+   QTimer::singleShot( 0, &batch, SLOT( start_jobs() ) );
+
+   return application.exec();
+}
+
+// Batch driver constructor:  parse arguments, read parameters and triples
+US_BatchAnalysis::US_BatchAnalysis( QStringList& cmdargs ) : QObject()
+{
+   dbg_level  = US_Settings::us_debug();
+   maxthrs    = 0;
+   maxjobs    = 0;
+   nrunning   = 0;
+   nthrused   = 0;
+   ndone      = 0;
+   nfailed    = 0;
+   ready      = false;
+
+   QStringList files;
+
+   for ( int jj = 1; jj < cmdargs.size(); jj++ )
+   {
+      QString arg  = cmdargs[ jj ];
+
+      if ( ( arg == "-threads"  ||  arg == "-jobs" )  &&
+           ( jj + 1 ) < cmdargs.size() )
+      {
+         int ival     = cmdargs[ ++jj ].toInt();
+
+         if ( arg == "-threads" )
+            maxthrs      = ival;
+         else
+            maxjobs      = ival;
+      }
+
+      else if ( arg.startsWith( "-" ) )
+      {
+         usage();
+         return;
+      }
+
+      else
+         files << arg;
+   }
+
+   if ( files.size() != 2 )
+   {
+      usage();
+      return;
+   }
+
+   if ( ! read_params( files[ 0 ] )  ||  ! read_triples( files[ 1 ] ) )
+      return;
+
+   // Command line counts override any in the parameters file
+   if ( maxthrs < 1 )
+      maxthrs    = params.contains( "thread_count" )
+                   ? params[ "thread_count" ].toInt()
+                   : QThread::idealThreadCount();
+
+   if ( maxjobs < 1 )
+      maxjobs    = params.contains( "job_count" )
+                   ? params[ "job_count" ].toInt()
+                   : maxthrs / 4;
+
+   maxthrs    = qMax( maxthrs, 1 );
+   maxjobs    = qMax( qMin( maxjobs, jobs.size() ), 1 );
+   maxjobs    = qMin( maxjobs, maxthrs );
+
+   printf( "us_batch_analysis: %s of %d triples; %d threads, %d jobs at once\n",
+           qPrintable( params[ "method" ] ), jobs.size(), maxthrs, maxjobs );
+   fflush( stdout );
+
+   ready      = true;
+}
+
+// Print the command usage
+void US_BatchAnalysis::usage()
+{
+   printf( "Usage:  us_batch_analysis [-threads N] [-jobs N]"
+           " parameters-file triples-file\n\n"
+           "  parameters-file  lines of \"key = value\" analysis parameters\n"
+           "  triples-file     lines of \"edit-file [noise-file ...]\"\n" );
+   fflush( stdout );
+}
+
+// Read the analysis parameters file
+bool US_BatchAnalysis::read_params( const QString& fname )
+{
+   QFile pfile( fname );
+
+   if ( ! pfile.open( QIODevice::ReadOnly | QIODevice::Text ) )
+   {
+      printf( "*ERROR* Unable to open parameters file %s\n",
+              qPrintable( fname ) );
+      return false;
+   }
+
+   QTextStream ts( &pfile );
+
+   while ( ! ts.atEnd() )
+   {
+      QString line = ts.readLine().section( "#", 0, 0 ).trimmed();
+
+      if ( line.isEmpty()  ||  ! line.contains( "=" ) )
+         continue;
+
+      QString key  = line.section( "=", 0, 0 ).trimmed();
+      QString val  = line.section( "=", 1, -1 ).trimmed();
+      params[ key ] = val;
+DbgLv(1) << "BA:rdpar: key" << key << "val" << val;
+   }
+
+   pfile.close();
+
+   QString method = params[ "method" ].toUpper();
+   params[ "method" ] = method.isEmpty() ? QString( "2DSA" ) : method;
+   method         = params[ "method" ];
+
+   if ( method == "GA"  ||  method == "DMGA" )
+   {
+      printf( "*ERROR* Method %s requires a 2DSA model and is only available"
+              " through us_mpi_analysis\n", qPrintable( method ) );
+      return false;
+   }
+
+   if ( method != "2DSA"  &&  method != "PCSA" )
+   {
+      printf( "*ERROR* Unknown analysis method \"%s\"\n",
+              qPrintable( method ) );
+      return false;
+   }
+
+   if ( params[ "meniscus_points" ].toInt() > 1  &&
+        params[ "mc_iterations"   ].toInt() > 1 )
+   {
+      printf( "*ERROR* Meniscus fit and Monte Carlo may not both be given\n" );
+      return false;
+   }
+
+   if ( params[ "mwl_global" ].toInt() > 0  &&
+        ( method != "2DSA"  ||
+          params[ "meniscus_points" ].toInt() > 1  ||
+          params[ "mc_iterations"   ].toInt() > 1  ||
+          params[ "max_iterations"  ].toDouble() > 1.0  ||
+          params[ "ff0_constant"    ].toDouble() != 0.0 ) )
+   {
+      printf( "*ERROR* A multi-wavelength global fit is only available for"
+              " a 2DSA of constant vbar, without meniscus fit,"
+              " Monte Carlo or refinement iterations\n" );
+      return false;
+   }
+
+   return true;
+}
+
+// Read the list of triples, each an edit file and any noise files
+bool US_BatchAnalysis::read_triples( const QString& fname )
+{
+   QFile tfile( fname );
+
+   if ( ! tfile.open( QIODevice::ReadOnly | QIODevice::Text ) )
+   {
+      printf( "*ERROR* Unable to open triples file %s\n",
+              qPrintable( fname ) );
+      return false;
+   }
+
+   QTextStream ts( &tfile );
+   QDir        tdir = QFileInfo( fname ).absoluteDir();
+   bool        mwlgf = ( params[ "mwl_global" ].toInt() > 0 );
+   QMap< QString, int > mwlleads;   // Leading job of each cell
+
+   while ( ! ts.atEnd() )
+   {
+      QString line = ts.readLine().section( "#", 0, 0 ).simplified();
+
+      if ( line.isEmpty() )
+         continue;
+
+      // Paths are relative to the triples file directory
+      QStringList paths = line.split( " " );
+
+      for ( int jj = 0; jj < paths.size(); jj++ )
+         paths[ jj ]   = QDir::cleanPath(
+                            tdir.absoluteFilePath( paths[ jj ] ) );
+
+      QString epath = paths.takeFirst();
+      int     jobx  = jobs.size();
+
+      US_BatchJob* job = new US_BatchJob( jobx, epath, paths, params, this );
+
+      connect( job,  SIGNAL( job_complete( int, bool ) ),
+               this, SLOT(   job_complete( int, bool ) ) );
+
+      jobs  << job;
+
+      if ( mwlgf )
+      {  // For a multi-wavelength fit, the first job of a cell leads the
+         //  jobs of its other wavelengths ("runID.editID.type.cell.channel")
+         QString cellkey = QFileInfo( epath ).absolutePath() + "/"
+                           + QFileInfo( epath ).fileName()
+                             .section( ".", 0, -3 );
+
+         if ( mwlleads.contains( cellkey ) )
+         {
+            jobs[ mwlleads[ cellkey ] ]->add_member( job );
+            continue;
+         }
+
+         mwlleads[ cellkey ] = jobx;
+      }
+
+      queue << jobx;
+   }
+
+   tfile.close();
+
+   if ( jobs.size() == 0 )
+   {
+      printf( "*ERROR* No triples are listed in %s\n", qPrintable( fname ) );
+      return false;
+   }
+
+   return true;
+}
+
+// Start queued jobs while there are free job slots and threads
+void US_BatchAnalysis::start_jobs()
+{
+   if ( ! ready )
+      return;
+
+   if ( ndone == 0  &&  nrunning == 0 )
+      timer.start();
+
+   while ( nrunning < maxjobs  &&  nthrused < maxthrs  &&  ! queue.isEmpty() )
+   {
+      int jobx       = queue.takeFirst();
+      US_BatchJob* job = jobs[ jobx ];
+
+      // Divide the free threads among the jobs that can still be started,
+      //  so that the last jobs of a batch get any threads freed up
+      int nfree      = maxthrs - nthrused;
+      int nslot      = qMin( maxjobs - nrunning, queue.size() + 1 );
+      int nthr       = qMax( nfree / qMax( nslot, 1 ), 1 );
+      QString emsg;
+
+      if ( ! job->load_data( emsg ) )
+      {
+         ndone         += job->member_count() + 1;
+         nfailed       += job->member_count() + 1;
+         printf( "[%d/%d] %s  FAILED: %s\n", ndone, jobs.size(),
+                 qPrintable( job->triple() ), qPrintable( emsg ) );
+         fflush( stdout );
+         continue;
+      }
+
+      nrunning++;
+      nthrused      += nthr;
+DbgLv(1) << "BA:stj: jobx" << jobx << "nthr" << nthr << "nrun" << nrunning
+ << "nthrused" << nthrused << "queued" << queue.size();
+
+      job->start( nthr );
+   }
+
+   if ( ndone == jobs.size() )
+   {  // All done:  report and exit
+      printf( "us_batch_analysis: %d triples analyzed, %d failed,"
+              " in %d seconds\n", ndone - nfailed, nfailed,
+              qRound( timer.elapsed() / 1000.0 ) );
+      fflush( stdout );
+      ready         = false;
+      qApp->exit( ( nfailed > 0 ) ? 1 : 0 );
+   }
+}
+
+// Slot to handle a completed job:  report and start any next ones
+void US_BatchAnalysis::job_complete( int jobx, bool ok )
+{
+   US_BatchJob* job = jobs[ jobx ];
+   ndone        += job->member_count() + 1;
+   nrunning--;
+   nthrused     -= job->threads();
+
+   if ( ! ok )
+      nfailed      += job->member_count() + 1;
+
+   printf( "[%d/%d] %s\n", ndone, jobs.size(), qPrintable( job->summary() ) );
+   fflush( stdout );
+
+   // Start next jobs once control returns to the event loop
+   QTimer::singleShot( 0, this, SLOT( start_jobs() ) );
+}
+
+// Batch job constructor
+US_BatchJob::US_BatchJob( const int a_jobx, const QString& a_epath,
+      const QStringList& a_npaths, const QMap< QString, QString >& a_params,
+      QObject* parent ) : QObject( parent )
+{
+   jobx         = a_jobx;
+   edit_path    = a_epath;
+   noise_paths  = a_npaths;
+   params       = a_params;
+   method       = params[ "method" ];
+   dbg_level    = US_Settings::us_debug();
+   proc2d       = 0;
+   procpc       = 0;
+   mwlfit       = 0;
+   edata        = &dset.run_data;
+   nthreads     = 0;
+   mmtype       = 0;
+   pctype       = 0;
+   is_member    = false;
+}
+
+// Add the job of another wavelength of this job's cell
+void US_BatchJob::add_member( US_BatchJob* job )
+{
+   job->is_member = true;
+   members << job;
+}
+
+// Return the job's triple description
+QString US_BatchJob::triple() const
+{
+   if ( edata->runID.isEmpty() )
+      return QFileInfo( edit_path ).fileName();
+
+   return edata->runID + "." + edata->cell + edata->channel
+          + edata->wavelength;
+}
+
+// Return a numeric parameter value, or a default if not given
+double US_BatchJob::param( const QString& key, const double defval ) const
+{
+   return params.contains( key ) ? params[ key ].toDouble() : defval;
+}
+
+// Load the edited data and any noises, then build the data set
+bool US_BatchJob::load_data( QString& emsg )
+{
+   QFileInfo finfo( edit_path );
+   int result    = US_DataIO::OK;
+
+   try
+   {
+      result        = US_DataIO::loadData( finfo.absolutePath(),
+                                           finfo.fileName(), dset.run_data );
+   }
+   catch ( US_DataIO::ioError error )
+   {
+      result        = error;
+   }
+
+   if ( result != US_DataIO::OK )
+   {
+      emsg          = tr( "Bad edit file %1 : %2" )
+                      .arg( edit_path ).arg( US_DataIO::errorString( result ) );
+      return false;
+   }
+
+   ti_noise_in.count = 0;
+   ri_noise_in.count = 0;
+
+   for ( int jj = 0; jj < noise_paths.size(); jj++ )
+   {  // Apply any input noise, saving it to sum into the output noise
+      US_Noise noise;
+
+      if ( noise.load( noise_paths[ jj ] ) != 0  ||
+           noise.apply_to_data( dset.run_data ) != 0 )
+      {
+         emsg          = tr( "Bad noise file %1" ).arg( noise_paths[ jj ] );
+         return false;
+      }
+
+      if ( noise.type == US_Noise::TI )
+         ti_noise_in   = noise;
+      else
+         ri_noise_in   = noise;
+   }
+
+   // Solution values come from the parameters, defaulting to water
+   double avTemp = edata->average_temperature();
+   double vbar20 = param( "vbar20",    TYPICAL_VBAR );
+   double vbartb = US_Math2::adjust_vbar20( vbar20, avTemp );
+
+   US_Math2::SolutionData sd;
+   sd.density    = param( "density",   DENS_20W );
+   sd.viscosity  = param( "viscosity", VISC_20W );
+   sd.vbar20     = vbar20;
+   sd.vbar       = vbartb;
+   sd.manual     = ( param( "manual", 0.0 ) != 0.0 );
+   US_Math2::data_correction( avTemp, sd );
+
+   if ( ( 1.0 - vbar20 * DENS_20W ) <= 0.0 )
+   {
+      emsg          = tr( "The vbar20 value (%1) implies a non-positive"
+                          " buoyancy" ).arg( vbar20 );
+      return false;
+   }
+
+   dset.viscosity        = sd.viscosity;
+   dset.density          = sd.density;
+   dset.compress         = 0.0;
+   dset.temperature      = avTemp;
+   dset.vbar20           = vbar20;
+   dset.vbartb           = vbartb;
+   dset.s20w_correction  = sd.s20w_correction;
+   dset.D20w_correction  = sd.D20w_correction;
+   dset.manual           = sd.manual;
+   dset.edit_file        = edit_path;
+   dset.noise_files      = noise_paths;
+   dset.solute_type      = 0;
+   dset.zcoeffs[ 0 ]     = 0.0;
+   dset.zcoeffs[ 1 ]     = 0.0;
+   dset.zcoeffs[ 2 ]     = 0.0;
+   dset.zcoeffs[ 3 ]     = 0.0;
+   dset.rotor_stretch[ 0 ] = 0.0;
+   dset.rotor_stretch[ 1 ] = 0.0;
+DbgLv(1) << "BJ:ld: triple" << triple() << "avTemp" << avTemp
+ << "s_corr D_corr" << sd.s20w_correction << sd.D20w_correction;
+
+   if ( ! build_simparms( emsg ) )
+      return false;
+
+   dsets.clear();
+   dsets << &dset;
+
+   for ( int jj = 0; jj < members.size(); jj++ )
+   {  // Load the other wavelengths of a multi-wavelength fit
+      if ( ! members[ jj ]->load_data( emsg ) )
+      {
+         emsg          = members[ jj ]->triple() + " : " + emsg;
+         return false;
+      }
+   }
+
+   return true;
+}
+
+// Build the data set's simulation parameters, as in the GUI analyses
+bool US_BatchJob::build_simparms( QString& emsg )
+{
+   QString ddir      = QFileInfo( edit_path ).absolutePath();
+   QString runID     = edata->runID;
+   QVector< SP_SPEEDPROFILE > speed_steps;
+
+   // Read the run experiment file and parse out any speed steps
+   QFile xfi( ddir + "/" + runID + "." + edata->dataType + ".xml" );
+
+   if ( xfi.open( QIODevice::ReadOnly ) )
+   {
+      QXmlStreamReader xmli( &xfi );
+
+      while ( ! xmli.atEnd() )
+      {
+         xmli.readNext();
+
+         if ( xmli.isStartElement()  &&  xmli.name() == "speedstep" )
+         {
+            SP_SPEEDPROFILE  sp;
+            US_SimulationParameters::speedstepFromXml( xmli, sp );
+            speed_steps << sp;
+         }
+      }
+
+      xfi.close();
+   }
+
+   bool exp_steps    = ( speed_steps.count() > 0 );
+   dset.simparams.initFromData( NULL, dset.run_data, !exp_steps );
+
+   if ( exp_steps )
+      dset.simparams.speed_step  = speed_steps;
+
+   dset.simparams.sim = ( edata->channel == "S" );
+
+   // Use a TimeState beside the data or in results, or else build one
+   QString tmst_fpath = ddir + "/" + runID + ".time_state.tmst";
+
+   if ( ! QFileInfo( tmst_fpath ).isFile() )
+      tmst_fpath        = US_Settings::resultDir() + "/" + runID + "/"
+                          + runID + ".time_state.tmst";
+
+   US_AstfemMath::initSimData( sdata, dset.run_data, 0.0 );
+
+   if ( ! QFileInfo( tmst_fpath ).isFile()  ||
+        ! US_AstfemMath::timestate_onesec( tmst_fpath, sdata ) )
+   {
+      tmst_fpath        = US_Settings::tmpDir() + "/b"
+                          + QString::number( getpid() ) + "j"
+                          + QString::number( jobx ) + ".time_state.tmst";
+      US_AstfemMath::writetimestate( tmst_fpath, dset.simparams, sdata );
+   }
+
+   if ( dset.simparams.simSpeedsFromTimeState( tmst_fpath ) < 1 )
+   {
+      emsg              = tr( "Unable to build a TimeState from %1" )
+                          .arg( tmst_fpath );
+      return false;
+   }
+
+   dset.tmst_file     = tmst_fpath;
+   dset.simparams.speedstepsFromSSprof();
+
+   // Do a quick test of the speed step implied by TimeState
+   int tf_scan   = dset.simparams.speed_step[ 0 ].time_first;
+   int accel1    = dset.simparams.speed_step[ 0 ].acceleration;
+   int rspeed    = dset.simparams.speed_step[ 0 ].rotorspeed;
+   int tf_aend   = ( rspeed + accel1 - 1 ) / qMax( accel1, 1 );
+
+   if ( accel1 < 250  ||  tf_aend > ( tf_scan - 6 ) )
+   {
+      printf( "*WARNING* %s The TimeState used is likely bad: acceleration"
+              " %d zone end %d first scan time %d\n", qPrintable( triple() ),
+              accel1, tf_aend, tf_scan );
+      fflush( stdout );
+   }
+
+   return true;
+}
+
+// Start the analysis of the triple using a given number of threads
+void US_BatchJob::start( const int nthr )
+{
+   nthreads      = nthr;
+   timer.start();
+   models   .clear();
+   ti_noises.clear();
+   ri_noises.clear();
+
+   if ( method == "PCSA" )
+      start_pcsa();
+   else if ( members.size() > 0 )
+      start_mwl();
+   else
+      start_2dsa();
+}
+
+// Stop an analysis in progress
+void US_BatchJob::stop()
+{
+   if ( proc2d != 0 )
+   {
+      proc2d->disconnect();
+      proc2d->stop_fit();
+   }
+
+   if ( procpc != 0 )
+   {
+      procpc->disconnect();
+      procpc->stop_fit();
+   }
+}
+
+// Start a 2DSA analysis, as the 2DSA fit control does
+void US_BatchJob::start_2dsa()
+{
+   double slo    = param( "s_min",            1.0 );
+   double sup    = param( "s_max",           10.0 );
+   int    nss    = (int)param( "s_grid_points",   64.0 );
+   double klo    = param( "ff0_min",          1.0 );
+   double kup    = param( "ff0_max",          4.0 );
+   int    nks    = (int)param( "ff0_grid_points", 64.0 );
+   int    noif   = ( param( "tinoise_option", 0.0 ) > 0.0 ? 1 : 0 ) +
+                   ( param( "rinoise_option", 0.0 ) > 0.0 ? 2 : 0 );
+   int    mxiter = qMax( (int)param( "max_iterations",  1.0 ), 1 );
+   int    mniter = (int)param( "meniscus_points", 0.0 );
+   int    mciter = (int)param( "mc_iterations",   0.0 );
+   double menrng = param( "meniscus_range",   0.03 );
+   double cff0   = param( "ff0_constant",     0.0 );
+   double vtoler = 1.0e-12;
+   mniter        = ( mniter > 1 ) ? mniter : 0;
+   mciter        = ( mciter > 1 ) ? mciter : 0;
+   mmtype        = ( mniter > 0 ) ? 1 : ( ( mciter > 0 ) ? 2 : 0 );
+
+   if ( ( sup - slo ) < 0.0  ||  ( kup - klo ) < 0.0  ||
+        nss < 2  ||  nks < 2 )
+   {
+      finish( false, tr( "The s or f/f0 ranges are inconsistent" ) );
+      return;
+   }
+
+   if ( mniter > 0  &&
+        ( edata->meniscus + menrng * 0.5 ) >= edata->xvalues[ 0 ] )
+   {
+      finish( false, tr( "The meniscus range overlaps the data range" ) );
+      return;
+   }
+
+   QString smsg;
+
+   if ( US_SolveSim::checkGridSize( dsets, sup * 1.0e-13, smsg ) )
+   {
+      printf( "*WARNING* %s %s\n", qPrintable( triple() ),
+              qPrintable( smsg ) );
+      fflush( stdout );
+   }
+
+   double sdelt  = ( sup - slo ) / (double)( nss - 1 );
+   double kdelt  = ( kup - klo ) / (double)( nks - 1 );
+   int    ngrr   = US_Math2::best_grid_reps( nss, nks );
+
+   // Adjust upper limits if need be so deltas work out
+   sup           = slo + ( sdelt * (double)( nss - 1 ) );
+   kup           = klo + ( kdelt * (double)( nks - 1 ) );
+DbgLv(1) << "BJ:2d: slo sup nss" << slo << sup << nss << "klo kup nks"
+ << klo << kup << nks << "ngrr" << ngrr << "nthr" << nthreads;
+
+   ti_noise.values.clear();
+   ri_noise.values.clear();
+   ti_noise.count = 0;
+   ri_noise.count = 0;
+
+   proc2d        = new US_2dsaProcess( dsets, this );
+
+   connect( proc2d, SIGNAL( message_update(   QString, bool ) ),
+            this,   SLOT(   progress_message( QString, bool ) ) );
+   connect( proc2d, SIGNAL( process_complete( int  ) ),
+            this,   SLOT(   completed_2dsa(   int  ) ) );
+
+   proc2d->set_iters( mxiter, mciter, mniter, vtoler, menrng, cff0, ngrr );
+
+   proc2d->start_fit( slo, sup, nss, klo, kup, nks, ngrr, nthreads, noif );
+}
+
+// Start a multi-wavelength 2DSA of this job's and its members' triples
+void US_BatchJob::start_mwl()
+{
+   double slo    = param( "s_min",            1.0 );
+   double sup    = param( "s_max",           10.0 );
+   int    nss    = (int)param( "s_grid_points",   64.0 );
+   double klo    = param( "ff0_min",          1.0 );
+   double kup    = param( "ff0_max",          4.0 );
+   int    nks    = (int)param( "ff0_grid_points", 64.0 );
+   int    noif   = ( param( "tinoise_option", 0.0 ) > 0.0 ? 1 : 0 ) +
+                   ( param( "rinoise_option", 0.0 ) > 0.0 ? 2 : 0 );
+   mmtype        = 0;
+
+   if ( ( sup - slo ) < 0.0  ||  ( kup - klo ) < 0.0  ||
+        nss < 2  ||  nks < 2 )
+   {
+      finish( false, tr( "The s or f/f0 ranges are inconsistent" ) );
+      return;
+   }
+
+   QList< US_SolveSim::DataSet* > mwlsets = dsets;
+   QString smsg;
+
+   for ( int jj = 0; jj < members.size(); jj++ )
+   {
+      members[ jj ]->timer.start();
+      members[ jj ]->models   .clear();
+      members[ jj ]->ti_noises.clear();
+      members[ jj ]->ri_noises.clear();
+      mwlsets << &members[ jj ]->dset;
+   }
+
+   if ( US_SolveSim::checkGridSize( mwlsets, sup * 1.0e-13, smsg ) )
+   {
+      printf( "*WARNING* %s %s\n", qPrintable( triple() ),
+              qPrintable( smsg ) );
+      fflush( stdout );
+   }
+
+   int    ngrr   = US_Math2::best_grid_reps( nss, nks );
+   QList< QVector< US_Solute > > subgrids;
+
+   US_Solute::init_solutes( slo * 1.0e-13, sup * 1.0e-13, nss,
+                            klo, kup, nks, ngrr, 0.0, subgrids );
+
+   for ( int ii = 0; ii < subgrids.count(); ii++ )
+      for ( int jj = 0; jj < subgrids[ ii ].count(); jj++ )
+         subgrids[ ii ][ jj ].v  = dset.vbar20;
+DbgLv(1) << "BJ:mwl: slo sup nss" << slo << sup << nss << "klo kup nks"
+ << klo << kup << nks << "ngrr" << ngrr << "nwavl" << mwlsets.size()
+ << "nthr" << nthreads;
+
+   lastmsg       = tr( "Fitting %1 wavelengths" ).arg( mwlsets.size() );
+   mwlfit        = new US_BatchMwlFit( mwlsets, subgrids, noif, nthreads,
+                                       this );
+
+   connect( mwlfit, SIGNAL( finished()      ),
+            this,   SLOT(   completed_mwl() ) );
+
+   mwlfit->start();
+}
+
+// Start a PCSA analysis, as the PCSA fit control does
+void US_BatchJob::start_pcsa()
+{
+   double xlo    = param( "x_min",            1.0 );
+   double xup    = param( "x_max",           10.0 );
+   double ylo    = param( "y_min",            1.0 );
+   double yup    = param( "y_max",            5.0 );
+   double zval   = param( "z_value",          0.0 );
+   int    nvar   = (int)param( "vars_count",       6.0 );
+   int    res    = (int)param( "curves_points",  100.0 );
+   int    gfits  = (int)param( "gfit_iterations",  3.0 );
+   double gfthr  = param( "thr_deltr_ratio",  1.0e-4 );
+   int    lmmxc  = (int)param( "lm_mxcall",        0.0 );
+   int    noif   = ( param( "tinoise_option", 0.0 ) > 0.0 ? 1 : 0 ) +
+                   ( param( "rinoise_option", 0.0 ) > 0.0 ? 2 : 0 );
+   double alpha  = ( param( "tikreg_option", 0.0 ) > 0.0 )
+                   ? param( "tikreg_alpha", 0.0 ) : 0.0;
+   QString s_styp = params.contains( "solute_type" )
+                    ? params[ "solute_type" ] : QString( "013" );
+   pctype        = US_ModelRecord::ctype_flag( params.contains( "curve_type" )
+                   ? params[ "curve_type" ] : QString( "IS" ) );
+   mmtype        = 0;
+
+   if ( ( xup - xlo ) < 0.0  ||  ( yup - ylo ) < 0.0 )
+   {
+      finish( false, tr( "The x or y ranges are inconsistent" ) );
+      return;
+   }
+
+   int    nthr   = nthreads;
+
+   if ( nvar == 1 )
+   {
+      nthr          = 1;
+      gfits         = 1;
+   }
+
+   dset.solute_type  = US_ModelRecord::stype_flag( s_styp );
+   dset.zcoeffs[ 0 ] = ( zval == 0.0 ) ? dset.vbar20 : zval;
+   dset.zcoeffs[ 1 ] = 0.0;
+   dset.zcoeffs[ 2 ] = 0.0;
+   dset.zcoeffs[ 3 ] = 0.0;
+
+   QString smsg;
+
+   if ( ( ( dset.solute_type >> 6 ) & 7 ) == ATTR_S  &&
+        US_SolveSim::checkGridSize( dsets, xup * 1.0e-13, smsg ) )
+   {
+      finish( false, smsg );
+      return;
+   }
+DbgLv(1) << "BJ:pc: x" << xlo << xup << "y" << ylo << yup << "nvar res"
+ << nvar << res << "ctype stype" << pctype << dset.solute_type
+ << "alpha" << alpha << "nthr" << nthr;
+
+   ti_noise.values.clear();
+   ri_noise.values.clear();
+   ti_noise.count = 0;
+   ri_noise.count = 0;
+
+   procpc        = new US_pcsaProcess( dsets, this );
+
+   connect( procpc, SIGNAL( message_update(   QString, bool ) ),
+            this,   SLOT(   progress_message( QString, bool ) ) );
+   connect( procpc, SIGNAL( process_complete( int  ) ),
+            this,   SLOT(   completed_pcsa(   int  ) ) );
+
+   procpc->start_fit( xlo, xup, ylo, yup, nvar, res, pctype,
+                      nthr, noif, lmmxc, gfits, gfthr, alpha );
+}
+
+// Slot to keep the latest progress message
+void US_BatchJob::progress_message( QString pmsg, bool /*append*/ )
+{
+   lastmsg       = pmsg.section( "\n", -1, -1 );
+DbgLv(2) << "BJ:pmsg:" << triple() << lastmsg;
+}
+
+// Slot to handle a completed 2DSA iteration or analysis
+void US_BatchJob::completed_2dsa( int stage )
+{
+   bool alldone  = ( stage == 9 );
+DbgLv(1) << "BJ:c2d: stage alldone" << stage << alldone << triple();
+
+   if ( stage == 6 )
+   {  // Stopped because of memory usage
+      stop();
+      finish( false, tr( "Stopped for high memory usage" ) );
+      return;
+   }
+
+   proc2d->get_results( &sdata, &rdata, &model, &ti_noise, &ri_noise );
+
+   US_DataIO::Scan* rscan0 = &rdata.scanData[ 0 ];
+   int    mmitnum  = (int)rscan0->seconds;
+   double varinew  = rscan0->delta_r;
+   double meniscus = rscan0->plateau;
+
+   if ( mmitnum == 0 )
+   {  // Simple refinement iteration (no MC/Meniscus)
+      model.description = QString( "MMITER=%1 VARI=%2 " )
+                          .arg( mmitnum ).arg( varinew );
+   }
+
+   else if ( mmtype == 1 )
+   {  // Meniscus
+      model.global      = US_Model::MENISCUS;
+      model.description = QString( "MMITER=%1 VARI=%2 MENISCUS=%3" )
+                          .arg( mmitnum ).arg( varinew ).arg( meniscus );
+   }
+
+   else
+   {  // Monte Carlo
+      model.monteCarlo  = true;
+      model.description = QString( "MMITER=%1 VARI=%2 " )
+                          .arg( mmitnum ).arg( varinew );
+   }
+
+   if ( param( "max_iterations", 1.0 ) > 1.0 )
+      model.description = model.description + QString( " REFITERS" );
+
+   if ( alldone  ||  ( mmitnum > 0  &&  stage > 0 ) )
+   {  // Update lists of models,noises
+      models << model;
+
+      if ( ti_noise.count > 0 )
+         ti_noises << ti_noise;
+
+      if ( ri_noise.count > 0 )
+         ri_noises << ri_noise;
+   }
+
+   if ( ! alldone )
+      return;
+
+   QString analysisType = QString( "2DSA" )
+      + QString( ( param( "max_iterations", 1.0 ) > 1.0 ) ? "-IT" : "" )
+      + QString( ( mmtype == 1 ) ? "-FM" : "" )
+      + QString( ( mmtype == 2 ) ? "-MC" : "" );
+
+   bool saved    = save_models( analysisType, US_Model::TWODSA );
+
+   finish( saved, saved ? QString( "RMSD %1" ).arg( sqrt( varinew ) )
+                        : tr( "Unable to write models" ) );
+}
+
+// Slot to handle a completed PCSA analysis
+void US_BatchJob::completed_pcsa( int stage )
+{
+DbgLv(1) << "BJ:cpc: stage" << stage << triple();
+   if ( stage == 7  ||  stage == 8 )
+      return;              // Alpha-scan ready or L-M start:  keep going
+
+   if ( stage == 6 )
+   {  // Stopped because of memory usage
+      stop();
+      finish( false, tr( "Stopped for high memory usage" ) );
+      return;
+   }
+
+   QStringList modelstats;
+   int         bmndx    = -1;
+   mrecs.clear();
+
+   procpc->get_results( &sdata, &rdata, &model, &ti_noise, &ri_noise, bmndx,
+                        modelstats, mrecs );
+
+   if ( model.components.size() == 0  ||  mrecs.size() == 0 )
+   {
+      finish( false, tr( "The best model has no components" ) );
+      return;
+   }
+
+   double variance   = mrecs[ 0 ].variance;
+   model.description = QString( "MMITER=0 VARI=%1 " ).arg( variance );
+   models << model;
+
+   if ( ti_noise.count > 0 )
+      ti_noises << ti_noise;
+
+   if ( ri_noise.count > 0 )
+      ri_noises << ri_noise;
+
+   QString analysisType = "PCSA-" + US_ModelRecord::ctype_text( pctype )
+      + QString( ( model.alphaRP != 0.0 ) ? "-TR" : "" );
+
+   bool saved    = save_models( analysisType, US_Model::PCSA );
+
+   finish( saved, saved ? QString( "RMSD %1" ).arg( mrecs[ 0 ].rmsd )
+                        : tr( "Unable to write models" ) );
+}
+
+// Slot to handle a completed multi-wavelength fit:  save each wavelength
+void US_BatchJob::completed_mwl()
+{
+   QList< US_SolveSim::Simulation > results = mwlfit->results;
+   int nwavl     = members.size() + 1;
+   mwlfit->deleteLater();
+   mwlfit        = 0;
+DbgLv(1) << "BJ:cmw: results" << results.size() << "nwavl" << nwavl
+ << triple();
+
+   if ( results.size() != nwavl )
+   {
+      finish( false, tr( "No solutes were found at any wavelength" ) );
+      return;
+   }
+
+   bool saved    = true;
+
+   for ( int jj = 0; jj < members.size(); jj++ )
+   {  // Save and finish each member wavelength
+      US_BatchJob* mjob = members[ jj ];
+      mjob->mwl_results( results[ jj + 1 ] );
+      bool msaved   = mjob->save_models( "2DSA", US_Model::TWODSA );
+      saved         = saved && msaved;
+
+      mjob->finish( msaved,
+                    msaved ? QString( "RMSD %1" )
+                             .arg( sqrt( results[ jj + 1 ].variance ) )
+                           : tr( "Unable to write models" ) );
+   }
+
+   mwl_results( results[ 0 ] );
+   bool msaved   = save_models( "2DSA", US_Model::TWODSA );
+   saved         = saved && msaved;
+
+   finish( saved, msaved ? QString( "RMSD %1" )
+                           .arg( sqrt( results[ 0 ].variance ) )
+                         : tr( "Unable to write models" ) );
+}
+
+// Build this job's model and noises from its wavelength's MWL fit results
+void US_BatchJob::mwl_results( US_SolveSim::Simulation& sim_vals )
+{
+   int    nscans  = edata->scanCount();
+   int    npoints = edata->pointCount();
+   model.components.clear();
+
+   for ( int cc = 0; cc < sim_vals.solutes.size(); cc++ )
+   {  // Build the model from solutes with a positive concentration
+      if ( sim_vals.solutes[ cc ].c <= 0.0 )
+         continue;
+
+      US_Model::SimulationComponent mcomp;
+      mcomp.vbar20 = dset.vbar20;
+      mcomp.s      = sim_vals.solutes[ cc ].s;
+      mcomp.D      = 0.0;
+      mcomp.mw     = 0.0;
+      mcomp.f      = 0.0;
+      mcomp.f_f0   = sim_vals.solutes[ cc ].k;
+      mcomp.signal_concentration
+                   = sim_vals.solutes[ cc ].c;
+
+      // Complete other coefficients in standard-space
+      model.calc_coefficients( mcomp );
+      model.components << mcomp;
+   }
+
+   model.description = QString( "MMITER=0 VARI=%1 " ).arg( sim_vals.variance );
+   models.clear();
+   ti_noises.clear();
+   ri_noises.clear();
+   models << model;
+
+   if ( sim_vals.ti_noise.size() == npoints )
+   {  // Copy TI noise
+      ti_noise.minradius = edata->radius( 0 );
+      ti_noise.maxradius = edata->radius( npoints - 1 );
+      ti_noise.minradius = (double)qRound( ti_noise.minradius * 1e+5 ) * 1e-5;
+      ti_noise.maxradius = (double)qRound( ti_noise.maxradius * 1e+5 ) * 1e-5;
+      ti_noise.values    = sim_vals.ti_noise;
+      ti_noise.count     = npoints;
+      ti_noises << ti_noise;
+   }
+
+   if ( sim_vals.ri_noise.size() == nscans )
+   {  // Copy RI noise
+      ri_noise.values    = sim_vals.ri_noise;
+      ri_noise.count     = nscans;
+      ri_noises << ri_noise;
+   }
+}
+
+// Write the models and noises to local disk, named as the GUI saves them
+bool US_BatchJob::save_models( const QString& analysisType,
+                               const US_Model::AnalysisType atype )
+{
+   QString analysisDate = QDateTime::currentDateTime().toUTC()
+                          .toString( "yyMMddhhmm" );
+   QString reqGUID      = US_Util::new_guid();
+   QString runID        = edata->runID;
+   QString editID       = edata->editID.startsWith( "20" ) ?
+                          edata->editID.mid( 2 ) :
+                          edata->editID;
+   QString dates        = "e" + editID + "_a" + analysisDate;
+   bool    fitMeni      = ( mmtype == 1 );
+   bool    montCar      = ( mmtype == 2 );
+   QString requestID    = "local";
+   QString tripleID     = edata->cell + edata->channel + edata->wavelength;
+   QString analysisID   = dates + "_" + analysisType + "_" + requestID + "_";
+   QString dext2        = ".e" + editID + "-" + tripleID;
+   QString descbase     = runID + "." + tripleID + "." + analysisID;
+
+   QString respath  = US_Settings::resultDir() + "/" + runID;
+   QString tmppath  = US_Settings::tmpDir() + "/";
+   QString mdlpath;
+   QString noipath;
+   int     nmodels  = models.size();
+   bool    have_ti  = ( ti_noises.size() > 0 );
+   bool    have_ri  = ( ri_noises.size() > 0 );
+   int     knois    = ( have_ti ? 1 : 0 ) + ( have_ri ? 1 : 0 );
+   int     nnoises  = nmodels * knois;
+   double  meniscus = edata->meniscus;
+   double  dwavelen = edata->wavelength.toDouble();
+
+   if ( nmodels < 1 )
+      return false;
+
+   if ( ! US_Model::model_path( mdlpath ) )
+      return false;
+
+   if ( knois > 0  &&  ! US_Noise::noise_path( noipath ) )
+      return false;
+
+   QDir        dirm( mdlpath );
+   QDir        dirn( noipath );
+   mdlpath             += "/";
+   noipath             += "/";
+   QStringList mfilt( "M*.xml" );
+   QStringList nfilt( "N*.xml" );
+   QStringList mdnams   =  dirm.entryList( mfilt, QDir::Files, QDir::Name );
+   QStringList ndnams   =  dirn.entryList( nfilt, QDir::Files, QDir::Name );
+   QStringList mnames;
+   QStringList nnames;
+   QStringList tnames;
+   QString     mname    = "M0000000.xml";
+   QString     nname    = "N0000000.xml";
+   int         indx     = 1;
+   int         kmodels  = 0;
+   int         knoises  = 0;
+
+   while( indx > 0 )
+   {  // build a list of available model file names
+      mname = "M" + QString().sprintf( "%07i", indx++ ) + ".xml";
+      if ( ! mdnams.contains( mname ) )
+      {  // no name with this index exists, so add it new-name list
+         mnames << mname;
+         if ( ++kmodels >= nmodels )
+            break;
+      }
+   }
+
+   indx   = 1;
+
+   while( indx > 0  &&  nnoises > 0 )
+   {  // build a list of available noise file names
+      nname = "N" + QString().sprintf( "%07i", indx++ ) + ".xml";
+      if ( ! ndnams.contains( nname ) )
+      {  // add to the list of new-name noises
+         nnames << nname;
+         if ( ++knoises >= nnoises )
+            break;
+      }
+   }
+
+   for ( int jj = 0; jj < nmodels; jj++ )
+   {  // loop to output models and noises
+      model             = models[ jj ];
+      QString mdesc     = model.description;
+      double  variance  = mdesc.mid( mdesc.indexOf( "VARI=" ) + 5 )
+                          .section( ' ', 0, 0 ).toDouble();
+      QString iterID    = "i01";
+      int     iterNum   = jj + 1;
+
+      if ( montCar )
+         iterID.sprintf( "mc%04d", iterNum );
+
+      else if ( fitMeni )
+      {
+         meniscus          = mdesc.mid( mdesc.indexOf( "MENISCUS=" ) + 9 )
+                             .section( ' ', 0, 0 ).toDouble();
+         iterID.sprintf( "i%02d-m%05d", iterNum, qRound( meniscus * 10000 ) );
+      }
+
+      // fill in actual model parameters needed for output
+      model.description = descbase + iterID + ".model";
+      mname             = QString( model.description );
+      mname             = montCar ?
+                          tmppath + mname.replace( ".model", ".mdl.tmp" ) :
+                          mdlpath + mnames[ jj ];
+      model.modelGUID   = US_Util::new_guid();
+      model.editGUID    = edata->editGUID;
+      model.requestGUID = reqGUID;
+      model.analysis    = atype;
+      model.variance    = variance;
+      model.meniscus    = meniscus;
+      model.wavelength  = dwavelen;
+      model.dataDescrip = edata->description;
+
+      for ( int cc = 0; cc < model.components.size(); cc++ )
+         model.components[ cc ].name = QString().sprintf( "SC%04d", cc + 1 );
+
+      if ( model.write( mname ) != US_DB2::OK )
+         return false;
+
+      tnames << mname;
+
+      int kk  = jj * knois;
+
+      if ( have_ti )
+      {  // output a TI noise, with any input noise summed in
+         ti_noise             = ti_noises[ jj ];
+         ti_noise.description = descbase + iterID + ".ti_noise";
+         ti_noise.type        = US_Noise::TI;
+         ti_noise.modelGUID   = model.modelGUID;
+         ti_noise.noiseGUID   = US_Util::new_guid();
+         nname                = noipath + nnames[ kk++ ];
+
+         if ( ti_noise_in.count > 0 )
+            ti_noise.sum_noise( ti_noise_in, true );
+
+         ti_noise.write( nname );
+      }
+
+      if ( have_ri )
+      {  // output an RI noise, with any input noise summed in
+         ri_noise             = ri_noises[ jj ];
+         ri_noise.description = descbase + iterID + ".ri_noise";
+         ri_noise.type        = US_Noise::RI;
+         ri_noise.modelGUID   = model.modelGUID;
+         ri_noise.noiseGUID   = US_Util::new_guid();
+         nname                = noipath + nnames[ kk++ ];
+
+         if ( ri_noise_in.count > 0 )
+            ri_noise.sum_noise( ri_noise_in, true );
+
+         ri_noise.write( nname );
+      }
+   }
+
+   if ( montCar )
+   {  // For Monte Carlo, create a composite of MC iteration files
+      QString tname  = US_Model::composite_mc_file( tnames, true );
+      QFile( tname ).rename( mdlpath + mnames[ 0 ] );
+   }
+
+   if ( fitMeni  &&  nmodels > 1 )
+   {  // For fit-meniscus, write the meniscus,rmsd file in results
+      QString fresFile = respath + "/" + analysisType.section( "-", 0, 0 )
+                         .toLower() + "-fm" + dext2 + ".fitmen.dat";
+      QFile   res_f( fresFile );
+      QDir().mkpath( respath );
+
+      if ( res_f.open( QIODevice::WriteOnly | QIODevice::Text ) )
+      {
+         QTextStream ts( &res_f );
+
+         for ( int jj = 0; jj < nmodels; jj++ )
+         {
+            QString mdesc = models[ jj ].description;
+            double  rmsd  = sqrt( mdesc.mid( mdesc.indexOf( "VARI=" ) + 5 )
+                                  .section( " ", 0, 0 ).toDouble() );
+            ts << mdesc.mid( mdesc.indexOf( "MENISCUS=" ) + 9 )
+                       .section( " ", 0, 0 )
+               << " " << QString().sprintf( "%10.8f", rmsd ) << "\n";
+         }
+
+         res_f.close();
+      }
+   }
+
+DbgLv(1) << "BJ:sv:" << triple() << "models" << nmodels << "noises" << nnoises
+ << "first model" << mdlpath + mnames[ 0 ];
+   return true;
+}
+
+// Finish the job:  free processing memory and signal completion
+void US_BatchJob::finish( const bool ok, const QString& msg )
+{
+   sumtext       = triple() + QString( ok ? "  done" : "  FAILED" )
+                   + QString( " (%1 s): " )
+                     .arg( qRound( timer.elapsed() / 1000.0 ) ) + msg;
+
+   if ( ! ok  &&  ! lastmsg.isEmpty() )
+      sumtext      += "  [" + lastmsg + "]";
+
+   for ( int jj = 0; jj < members.size(); jj++ )
+   {  // Finish any member wavelengths not yet finished; add their summaries
+      if ( members[ jj ]->summary().isEmpty() )
+         members[ jj ]->finish( ok, msg );
+
+      sumtext      += "\n" + members[ jj ]->summary();
+   }
+
+   if ( proc2d != 0 )
+   {
+      proc2d->disconnect();
+      proc2d->deleteLater();
+      proc2d        = 0;
+   }
+
+   if ( procpc != 0 )
+   {
+      procpc->disconnect();
+      procpc->deleteLater();
+      procpc        = 0;
+   }
+
+   // Only the summary is needed from here on
+   models   .clear();
+   ti_noises.clear();
+   ri_noises.clear();
+   mrecs    .clear();
+   sdata.scanData.clear();
+   rdata.scanData.clear();
+   dset.run_data.scanData.clear();
+
+   if ( ! is_member )
+      emit job_complete( jobx, ok );
+}
+
+// Multi-wavelength fit thread constructor
+US_BatchMwlFit::US_BatchMwlFit( QList< US_SolveSim::DataSet* >& a_dsets,
+      QList< QVector< US_Solute > >& a_subgrids, const int a_noisflag,
+      const int a_nthreads, QObject* parent ) : QThread( parent )
+{
+   dbg_level       = US_Settings::us_debug();
+   nthreads        = a_nthreads;
+   task.dsets      = a_dsets;
+   task.subgrids   = a_subgrids;
+   task.noisflag   = a_noisflag;
+   task.dbg_level  = dbg_level;
+   task.csolutes.resize( a_subgrids.size() );
+}
+
+// Fit the subgrids, then all solutes found, for all wavelengths
+void US_BatchMwlFit::run()
+{
+   int nsubg     = task.subgrids.size();
+   int nwavl     = task.dsets.size();
+
+   US_Parallel::run( &task, nsubg, nthreads );
+
+   // The final fit is of the solutes found at any wavelength of any subgrid
+   US_SolveSim::Simulation sim_vals;
+   sim_vals.noisflag  = task.noisflag;
+   sim_vals.dbg_level = dbg_level;
+
+   for ( int ii = 0; ii < nsubg; ii++ )
+      sim_vals.solutes << task.csolutes[ ii ];
+
+   qSort( sim_vals.solutes );
+   int kk        = 0;
+
+   for ( int cc = 0; cc < sim_vals.solutes.size(); cc++ )
+   {  // Remove duplicates
+      if ( kk == 0  ||  sim_vals.solutes[ cc ] != sim_vals.solutes[ kk - 1 ] )
+         sim_vals.solutes[ kk++ ] = sim_vals.solutes[ cc ];
+   }
+
+   sim_vals.solutes.resize( kk );
+DbgLv(1) << "BMF:run: nsubg" << nsubg << "nwavl" << nwavl
+ << "final solutes" << kk;
+   results.clear();
+
+   if ( kk == 0 )
+      return;
+
+   results << sim_vals;
+   US_SolveSim solvesim( task.dsets, 1, false );
+   solvesim.calc_residuals_mwl( 0, nwavl, results );
+}
+
+// Fit a range of subgrids for all wavelengths, keeping the solutes found
+void US_BatchMwlTask::run_range( int begin, int end, int thrx )
+{
+   US_SolveSim solvesim( dsets, thrx + 1, false );
+
+   for ( int ii = begin; ii < end; ii++ )
+   {
+      QList< US_SolveSim::Simulation > sim_vals;
+      US_SolveSim::Simulation          isim_vals;
+      isim_vals.solutes   = subgrids[ ii ];
+      isim_vals.noisflag  = noisflag;
+      isim_vals.dbg_level = dbg_level;
+      sim_vals << isim_vals;
+
+      solvesim.calc_residuals_mwl( 0, dsets.size(), sim_vals );
+
+      for ( int jw = 0; jw < sim_vals.size(); jw++ )
+      {  // Keep solutes with a positive concentration at any wavelength
+         for ( int cc = 0; cc < sim_vals[ jw ].solutes.size(); cc++ )
+         {
+            US_Solute solute = sim_vals[ jw ].solutes[ cc ];
+
+            if ( solute.c <= 0.0 )
+               continue;
+
+            solute.c      = 0.0;
+
+            if ( ! csolutes[ ii ].contains( solute ) )
+               csolutes[ ii ] << solute;
+         }
+      }
+   }
+}
@@ -0,0 +1,242 @@
+//! \file us_batch_analysis.h
+#ifndef US_BATCH_ANALYSIS_H
+#define US_BATCH_ANALYSIS_H
+
+#include <QtCore>
+
+#include "us_extern.h"
+#include "us_dataIO.h"
+#include "us_simparms.h"
+#include "us_solve_sim.h"
+#include "us_model.h"
+#include "us_noise.h"
+#include "us_parallel.h"
+#include "us_pcsa_modelrec.h"
+#include "us_2dsa_process.h"
+#include "us_pcsa_process.h"
+
+#ifndef DbgLv
+#define DbgLv(a) if(dbg_level>=a)qDebug()
+#endif
+
+#ifndef SP_SPEEDPROFILE
+#define SP_SPEEDPROFILE US_SimulationParameters::SpeedProfile
+#endif
+
+//! \brief Subgrid fits of a multi-wavelength 2DSA, run over a thread range
+class US_BatchMwlTask : public US_RangeTask
+{
+   public:
+      QList< US_SolveSim::DataSet* >     dsets;     //!< Wavelength data sets
+      QList< QVector< US_Solute > >      subgrids;  //!< Subgrid solutes
+      QVector< QVector< US_Solute > >    csolutes;  //!< Subgrid results
+      int                                noisflag;  //!< Noise flag: 0-3
+      int                                dbg_level; //!< Debug level
+
+      void run_range( int, int, int );
+};
+
+//! \brief Multi-wavelength 2DSA of the wavelengths of one cell
+
+/*! \class US_BatchMwlFit
+ *
+    This thread fits all wavelength triples of a cell together. The s,f/f0
+    subgrids are fit in parallel, each by a US_SolveSim::calc_residuals_mwl()
+    that simulates a solute once for all wavelengths. The solutes found at
+    any wavelength are then fit in a final pass, which gives each wavelength
+    its own concentrations and noise from the shared simulations.
+*/
+class US_BatchMwlFit : public QThread
+{
+   public:
+      //! \brief Create the fit thread
+      //! \param dsets     Wavelength data sets of a cell
+      //! \param subgrids  Subgrid solutes of the s,f/f0 grid
+      //! \param noisflag  Noise flag: 0-3 for none|ti|ri|both
+      //! \param nthreads  Threads for the subgrid fits
+      //! \param parent    Parent object
+      US_BatchMwlFit( QList< US_SolveSim::DataSet* >&,
+                      QList< QVector< US_Solute > >&, const int,
+                      const int, QObject* = 0 );
+
+      //! \brief Run the subgrid fits and the final fit
+      void run( void );
+
+      //! \brief Final simulation values of each wavelength
+      QList< US_SolveSim::Simulation > results;
+
+   private:
+      US_BatchMwlTask  task;          // Subgrid fits task
+      int              nthreads;      // Threads for subgrid fits
+      int              dbg_level;     // Debug level
+};
+
+//! \brief The analysis of a single edited triple in a batch
+
+/*! \class US_BatchJob
+ *
+    This class loads an edited triple, builds its data set and simulation
+    parameters, runs a 2DSA or PCSA processor on a given number of threads
+    and writes the resulting models and noises to the local disk, just as
+    the corresponding GUI programs save them. For a multi-wavelength global
+    fit, the first job of a cell leads the jobs of the cell's other
+    wavelengths (its members), fitting and saving all of their triples.
+*/
+class US_BatchJob : public QObject
+{
+   Q_OBJECT
+
+   public:
+      //! \brief Create a batch job for a triple
+      //! \param jobx    Index of the job in the batch
+      //! \param epath   Full path to the triple's edit file
+      //! \param npaths  Full paths to any noise files to apply to the data
+      //! \param params  Analysis parameters map
+      //! \param parent  Parent object
+      US_BatchJob( const int, const QString&, const QStringList&,
+                   const QMap< QString, QString >&, QObject* = 0 );
+
+      //! \brief Load the triple data and build its data set
+      //! \param emsg    Returned error message if loading fails
+      //! \returns       Success flag:  true if data set is ready
+      bool load_data   ( QString& );
+
+      //! \brief Start the analysis of the triple
+      //! \param nthr    Number of threads for the analysis
+      void start       ( const int );
+
+      //! \brief Stop an analysis that is in progress
+      void stop        ( void );
+
+      //! \brief Return the number of threads in use by the analysis
+      int  threads     ( void ) const { return nthreads; }
+
+      //! \brief Return the triple description (runID.triple)
+      QString triple   ( void ) const;
+
+      //! \brief Return a summary of the job's outcome, one line per triple
+      QString summary  ( void ) const { return sumtext; }
+
+      //! \brief Add the job of another wavelength of this job's cell
+      //! \param job     Member job, analyzed along with this one
+      void add_member  ( US_BatchJob* );
+
+      //! \brief Return the number of member jobs
+      int  member_count( void ) const { return members.size(); }
+
+   signals:
+      //! \brief Signal that the job is complete
+      //! \param jobx    Index of the job
+      //! \param ok      Flag of whether the job succeeded
+      void job_complete( int, bool );
+
+   private slots:
+      void progress_message ( QString, bool );
+      void completed_2dsa   ( int );
+      void completed_pcsa   ( int );
+      void completed_mwl    ( void );
+
+   private:
+      QMap< QString, QString >   params;    // Analysis parameters
+
+      QList< US_SolveSim::DataSet* >  dsets;// Data sets list (one)
+      US_SolveSim::DataSet       dset;      // Data set of the triple
+
+      US_2dsaProcess*            proc2d;    // 2DSA processor
+      US_pcsaProcess*            procpc;    // PCSA processor
+      US_BatchMwlFit*            mwlfit;    // Multi-wavelength fit thread
+
+      QList< US_BatchJob* >      members;   // Jobs of other wavelengths
+
+      US_DataIO::EditedData*     edata;     // Edited data of the triple
+      US_DataIO::RawData         sdata;     // Simulation data
+      US_DataIO::RawData         rdata;     // Residuals data
+      US_Model                   model;     // Latest model
+      US_Noise                   ti_noise;  // Latest TI noise
+      US_Noise                   ri_noise;  // Latest RI noise
+      US_Noise                   ti_noise_in; // Input TI noise
+      US_Noise                   ri_noise_in; // Input RI noise
+
+      QList< US_Model >          models;    // Models to output
+      QList< US_Noise >          ti_noises; // TI noises to output
+      QList< US_Noise >          ri_noises; // RI noises to output
+      QVector< US_ModelRecord >  mrecs;     // PCSA model records
+
+      QString    edit_path;     // Edit file path
+      QStringList noise_paths;  // Input noise file paths
+      QString    method;        // Analysis method (2DSA, PCSA)
+      QString    sumtext;       // Outcome summary
+      QString    lastmsg;       // Last progress message
+
+      QTime      timer;         // Job timer
+
+      int        jobx;          // Job index
+      int        nthreads;      // Threads in use
+      int        mmtype;        // 2DSA multi-model type: 0,1(menisc),2(MC)
+      int        pctype;        // PCSA curve type
+      int        dbg_level;     // Debug level
+      bool       is_member;     // Flag job is led by another's MWL fit
+
+      void   start_2dsa    ( void );
+      void   start_pcsa    ( void );
+      void   start_mwl     ( void );
+      void   mwl_results   ( US_SolveSim::Simulation& );
+      bool   build_simparms( QString& );
+      bool   save_models   ( const QString&, const US_Model::AnalysisType );
+      double param         ( const QString&, const double ) const;
+      void   finish        ( const bool, const QString& );
+};
+
+//! \brief Headless batch analysis driver
+
+/*! \class US_BatchAnalysis
+ *
+    This class reads an analysis-parameters file and a list of edited
+    triples, then analyzes the triples on the local machine. Several triples
+    are analyzed at once and the total thread count is divided among them;
+    as the queue of triples empties, freed threads go to the jobs started
+    last, so the final triples of a batch run on more threads. With the
+    "mwl_global" parameter set, the wavelength triples of each cell are
+    analyzed together by one job.
+*/
+class US_BatchAnalysis : public QObject
+{
+   Q_OBJECT
+
+   public:
+      //! \brief Create the batch driver from command line arguments
+      //! \param cmdargs  Command line arguments
+      US_BatchAnalysis( QStringList& );
+
+      //! \brief Return a flag of whether the batch is ready to run
+      bool is_ready( void ) const { return ready; }
+
+   public slots:
+      //! \brief Start as many queued jobs as slots and threads allow
+      void start_jobs  ( void );
+
+   private slots:
+      void job_complete( int, bool );
+
+   private:
+      QMap< QString, QString >   params;    // Analysis parameters
+      QList< US_BatchJob* >      jobs;      // All jobs of the batch
+      QList< int >               queue;     // Indexes of queued jobs
+
+      QTime      timer;         // Batch timer
+
+      int        maxthrs;       // Total threads available
+      int        maxjobs;       // Maximum concurrent jobs
+      int        nrunning;      // Jobs now running
+      int        nthrused;      // Threads now in use
+      int        ndone;         // Jobs completed
+      int        nfailed;       // Jobs failed
+      int        dbg_level;     // Debug level
+      bool       ready;         // Flag batch ready to run
+
+      bool   read_params  ( const QString& );
+      bool   read_triples ( const QString& );
+      void   usage        ( void );
+};
+#endif
+
@@ -0,0 +1,27 @@
+include( ../../gui.pri )
+
+QT           += xml svg
+
+TARGET        = us_batch_analysis
+
+win32 {
+LIBS         += -lpsapi
+CONFIG       += console
+}
+mac {
+CONFIG       += console
+}
+
+INCLUDEPATH  += ../us_2dsa ../us_pcsa
+
+HEADERS       = us_batch_analysis.h          \
+                ../us_2dsa/us_2dsa_process.h \
+                ../us_2dsa/us_worker_2d.h    \
+                ../us_pcsa/us_pcsa_process.h \
+                ../us_pcsa/us_worker_pc.h
+
+SOURCES       = us_batch_analysis.cpp          \
+                ../us_2dsa/us_2dsa_process.cpp \
+                ../us_2dsa/us_worker_2d.cpp    \
+                ../us_pcsa/us_pcsa_process.cpp \
+                ../us_pcsa/us_worker_pc.cpp
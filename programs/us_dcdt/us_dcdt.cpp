@@ -92,6 +92,10 @@ US_Dcdt::US_Dcdt() : US_AnalysisBase2()
 			        SLOT   ( boundary_pos ( double ) ) );
    connect( this,               SIGNAL ( dataAreLoaded( void   ) ),
             this, 		SLOT   ( smooth10     ( void   ) ) );
+
+   // Transforms of all triples come from the shared, cached pipeline
+   trans_flags  = TR_DCDT;
+   trans_points = arrayLength;
    qApp->processEvents();
 }
 
@@ -167,8 +171,6 @@ void US_Dcdt::data_plot( void )
 
    int     scanCount   = d->scanData.size();
    int     skipped     = 0;
-   double  positionPct = ct_boundaryPos    ->value() / 100.0;
-   double  baseline    = calc_baseline();
 
    le_skipped->setText( QString::number( skipped ) );
 
@@ -181,84 +183,32 @@ void US_Dcdt::data_plot( void )
       return;
    }
 
-   int points = d->pointCount();
-
-   // Create the new arrays
-   dcdt   .clear();
-   sValues.clear();
-   avgDcdt.fill( 0.0, arrayLength );
-   avgS   .fill( 0.0, arrayLength );
+   // Get the (cached) dC/dt transforms and correct their s-values
+   const TransformData& trd = triple_transform( index );
+   double  scorr    = solution.s20w_correction;
+   int     count    = trd.dcValues.size();
+   double  s_max    = trd.sMax * scorr;
 
    previousScanCount = scanCount;
+   radii   = trd.dcRadii;
+   dcdt    = trd.dcValues;
+   avgDcdt = trd.avgDcdt;
+   sValues.clear();
+   avgS   .resize( arrayLength );
 
-   for ( int i = 0; i < scanCount; i++ )
-   {
-      dcdt    << QVector< double >( points );
-      sValues << QVector< double >( points ); 
-   }
-
-   arraySizes.fill( 0, scanCount );
-   arrayStart.fill( 0, scanCount );
-
-   // Calculate dcdt and sValues
-   while ( excludedScans.contains( skipped ) ) skipped++;
-
-   int    previous = skipped;
-   int    count    = 0;
-   double s_max    = 0.0;
-
-   for ( int i = skipped + 1; i < scanCount; i++ )
+   for ( int i = 0; i < count; i++ )
    {
-      if ( excludedScans.contains( i ) ) continue;
-
-      US_DataIO::Scan* thisScan = &d->scanData[ i ];
-      US_DataIO::Scan* prevScan = &d->scanData[ previous ];
-
-      // These limits are for thisScan only:
-      double range       = thisScan->plateau - baseline;
-      double lower_limit = baseline + range * positionPct;
-      double dt          = thisScan->seconds - prevScan->seconds;
-      double plateau     = thisScan->plateau;
-      double prevPlateau = prevScan->plateau;
-
-      double meniscus    = d->meniscus;
-      double omega       = thisScan->rpm * M_PI / 30.0;
+      QVector< double > svals = trd.dcSeds[ i ];
 
-      int    size        = 0;
-      bool   started     = false;
+      for ( int j = 0; j < svals.size(); j++ )
+         svals[ j ]  *= scorr;
 
-      for ( int j = 0; j < points; j++ )
-      {
-         double currentV  = thisScan->rvalues[ j ];
-         double previousV = prevScan->rvalues[ j ];
-
-         if ( currentV < lower_limit ) continue;
-
-         if ( ! started )
-         {
-            started = true;
-            arrayStart[ count ] = j;
-         }
-
-         double dC             = previousV / prevPlateau - currentV / plateau;
-         dcdt[ count ][ size ] = dC / dt;
-         double radius         = d->radius( j );
-
-         sValues[ count ][ size ] = 
-            solution.s20w_correction * 1.0e13 * log( radius / meniscus ) /
-            ( sq( omega ) * ( prevScan->seconds + dt / 2.0 ) );
-
-         s_max = max( s_max, sValues[ count ][ size ] );
-
-         size++;
-      }
-
-      arraySizes[ count ] = size;
-
-      count++;
-      previous = i;
+      sValues << svals;
    }
 
+   for ( int i = 0; i < arrayLength; i++ )
+      avgS[ i ]    = trd.avgSeds[ i ] * scorr;
+
    ct_sValue->setMaximum ( ceil( s_max ) );
 
    if ( s_max < sMax )
@@ -276,55 +226,6 @@ void US_Dcdt::data_plot( void )
       sMax = s_max;
    }
 
-   double s_min = 9.9e10;
-
-   for ( int i = 0; i < count; i++ )
-   {
-      for ( int j = 0; j < arraySizes[ i ]; j++ )
-      {
-         s_min = min( s_min, sValues[ i ][ j ] );
-      }
-   }
-
-   // Figure the total points to plot
-   double increment = ( s_max - s_min ) / arrayLength;
-
-   // Assign new equally spaced s-values for the x-axis
-   for ( int i = 0; i < arrayLength; i++ ) 
-      avgS[ i ] = s_min + i * increment;
-
-   // For each new s value, find the corresponding g*(s) through
-   // linear interpolation and add up, then average by the number of
-   // total scans included.
-   
-   for ( int j = 0; j < arrayLength; j++ ) 
-   {
-      avgDcdt[ j ] = 0.0;
-
-      for ( int i = 0; i < count; i++ )
-      {
-         int k = 1;
-
-         // Find index where svalue for the scan first exceeds 
-         // the point on the x-axis
-         while ( sValues[ i ][ k ] < avgS[ j ] ) 
-         {
-            k++;
-            if ( k >= arraySizes[ i ] ) goto next; // Skip rest of scans
-         }
-
-         // Interpolate and apply y = mx + b
-         double m = ( dcdt   [ i ][ k ] - dcdt   [ i ][ k - 1 ] ) /
-                    ( sValues[ i ][ k ] - sValues[ i ][ k - 1 ] );
-         
-         double b = dcdt[ i ][ k ] - m * sValues[ i ][ k ];
-         
-         avgDcdt[ j ] += m * avgS[ j ] + b;
-      }
-
-next: avgDcdt[ j ] /= ( count - 1 ); 
-   }
-
    // Draw plot
    dataPlotClear( data_plot1 );
    us_grid( data_plot1 );
@@ -335,7 +236,6 @@ next: avgDcdt[ j ] /= ( count - 1 );
 
    data_plot1->setAxisTitle( QwtPlot::yLeft  , tr( "g<sup>*</sup>(s)" ) );
 
-   QVector< double > x( points );
    QwtPlotCurve*     curve;
    QwtText           title = QwtText( tr( "<b>Sedimentation Coefficient x "
                                           "10<sup>13</sup> sec</b>" ) );
@@ -350,16 +250,11 @@ next: avgDcdt[ j ] /= ( count - 1 );
 
          for ( int i = 0; i < count; i++ )
          {
-            int size = 0;
-            int end  = arraySizes[ i ] + arrayStart[ i ];
-
-            for ( int j = arrayStart[ i ]; j < end; j++ ) 
-               x[ size++ ] = d->xvalues[ j ];
-
             curve = us_curve( data_plot1, 
                   tr( "Scan " ) + QString::number( i + 1 ) );
 
-            curve->setSamples( x.data(), dcdt[ i ].data(), arraySizes[ i ] );
+            curve->setSamples( radii[ i ].data(), dcdt[ i ].data(),
+                               dcdt[ i ].size() );
          }
 
          data_plot1->setAxisAutoScale( QwtPlot::xBottom );
@@ -372,7 +267,7 @@ next: avgDcdt[ j ] /= ( count - 1 );
                   tr( "Scan " ) + QString::number( i + 1 ) );
 
             curve->setSamples( sValues[ i ].data(), dcdt[ i ].data(), 
-                               arraySizes[ i ] );
+                               dcdt[ i ].size() );
          }
          
          data_plot1->setAxisScale( QwtPlot::xBottom, 0.0, ct_sValue->value() );
@@ -17,8 +17,6 @@ class US_Dcdt : public US_AnalysisBase2
       int               previousScanCount; // total # of scans before skipping and exclusion
       double            sMax;
 
-      QVector< int >    arraySizes; 
-      QVector< int >    arrayStart;
       QVector< double > avgDcdt;         // holds the average of all dcdt scans
       QVector< double > avgS;            // holds the transformation to s of avgDcdt
 
@@ -32,6 +30,7 @@ class US_Dcdt : public US_AnalysisBase2
 
       QwtCounter*       ct_sValue;
 
+      QList< QVector< double > > radii;   // holds radii of the dcdt scans
       QList< QVector< double > > dcdt;    // holds all the dcdt scans
       QList< QVector< double > > sValues; // holds s-value transformations from the dcdt scans
 
@@ -2232,6 +2232,7 @@ void US_Edit::plot_all( void )
    double minR =  1.0e99;
    double maxV = -1.0e99;
    double minV =  1.0e99;
+   QList< US_PlotLodCurve* > lcurves;
 
    for ( int i = 0; i < data.scanData.size(); i++ )
    {
@@ -2254,11 +2255,14 @@ void US_Edit::plot_all( void )
          + QString::number( s->seconds ) + tr( " seconds" )
          + " #" + QString::number( i );
 
-      QwtPlotCurve* c = us_curve( data_plot, title );
+      US_PlotLodCurve* c = new US_PlotLodCurve( data_plot, title );
       c->setPaintAttribute( QwtPlotCurve::ClipPolygons, true );
-      c->setSamples( r, v, size );
+      c->setLodData( r, v, size );
+      lcurves << c;
    }
 
+   US_PlotLodCurve::build_levels( lcurves );
+
    // Reset the scan curves within the new limits
    double padR = ( maxR - minR ) / 30.0;
    double padV = ( maxV - minV ) / 30.0;
@@ -2290,6 +2294,7 @@ void US_Edit::plot_range( void )
    double maxV = -1.0e99;
    double minV =  1.0e99;
    int indext  = cb_triple->currentIndex();
+   QList< US_PlotLodCurve* > lcurves;
 
    if ( isMwl )
    {
@@ -2379,10 +2384,13 @@ DbgLv(1) << "plot_range(): ccx wvx indext" << ccx << wvx << indext;
          + QString::number( s->seconds ) + tr( " seconds" )
          + " #" + QString::number( i );
 
-      QwtPlotCurve* c = us_curve( data_plot, title );
-      c->setSamples( r, v, count );
+      US_PlotLodCurve* c = new US_PlotLodCurve( data_plot, title );
+      c->setLodData( r, v, count );
+      lcurves << c;
    }
 
+   US_PlotLodCurve::build_levels( lcurves );
+
    // Reset the scan curves within the new limits
    double padR = ( maxR - minR ) / 30.0;
    double padV = ( maxV - minV ) / 30.0;
@@ -2607,6 +2615,7 @@ DbgLv(1) << "PlMwl:   xa_rad" << xaxis_radius << "nsc npt" << nscan << npoint;
    double  maxOD  = odlimit * 2.0;
    double  valueV;
    int     kodlim = 0;
+   QList< US_PlotLodCurve* > lcurves;
 
    if ( xaxis_radius )
    {  // Build normal AUC data plot
@@ -2643,9 +2652,10 @@ DbgLv(1) << "PlMwl:     ii" << ii << "NOT INCLUDED";
             + QString::number( scn->seconds ) + tr( " seconds" )
             + " #" + QString::number( ii );
 
-         QwtPlotCurve* cc = us_curve( data_plot, ctitle );
+         US_PlotLodCurve* cc = new US_PlotLodCurve( data_plot, ctitle );
          cc->setPaintAttribute( QwtPlotCurve::ClipPolygons, true );
-         cc->setSamples( rr, vv, npoint );
+         cc->setLodData( rr, vv, npoint );
+         lcurves << cc;
       }
       pick     ->disconnect();
       connect( pick, SIGNAL( cMouseUp( const QwtDoublePoint& ) ),
@@ -2684,13 +2694,16 @@ DbgLv(1) << "PlMwl:    START xa_WAV";
             + QString::number( scn->seconds ) + tr( " seconds" )
             + " #" + QString::number( ii );
 
-         QwtPlotCurve* cc = us_curve( data_plot, ctitle );
+         US_PlotLodCurve* cc = new US_PlotLodCurve( data_plot, ctitle );
          cc->setPaintAttribute( QwtPlotCurve::ClipPolygons, true );
-         cc->setSamples( rr, vv, npoint );
+         cc->setLodData( rr, vv, npoint );
+         lcurves << cc;
       }
 DbgLv(1) << "PlMwl:      END xa_WAV  kodlim odlimit" << kodlim << odlimit;
    }
 
+   US_PlotLodCurve::build_levels( lcurves );
+
    // Reset the scan curves within the new limits
    double padR = ( maxR - minR ) / 30.0;
    double padV = ( maxV - minV ) / 30.0;
@@ -4820,10 +4833,16 @@ DbgLv(1) << "EDT:WrMwl:  dax celchn" << odax << celchn;
                     + "." + scell + "." + schan + ".";
    QApplication::setOverrideCursor( QCursor( Qt::WaitCursor ) );
 
-   // Loop to output a file/db-record for each wavelength of the cell/channel
+   // Gather the file name, GUIDs and XML of each wavelength's edit. The
+   //  XML is composed here, so the writer never reads live editor state.
+   US_EditWriter  writer;
+   QVector< int > idaxs;
+   int            ntrip    = expc_wvlns.size();
+   writer.workDir          = workingDir;
+   write_ops();
 
-DbgLv(1) << "EDT:WrMwl: files,wvlns.size" << files.size() << expc_wvlns.size();
-   for ( wvx = 0; wvx < expc_wvlns.size(); wvx++ )
+DbgLv(1) << "EDT:WrMwl: files,wvlns.size" << files.size() << ntrip;
+   for ( wvx = 0; wvx < ntrip; wvx++ )
    {
       QString swavl    = expc_wvlns[ wvx ];
       QString triple   = tripbase + swavl;
@@ -4832,7 +4851,6 @@ DbgLv(1) << "EDT:WrMwl: files,wvlns.size" << files.size() << expc_wvlns.size();
       odax             = index_data( wvx );
 DbgLv(1) << "EDT:WrMwl:  wvx triple" << wvx << triple << "filename" << filename;
 
-DbgLv(1) << "EDT:WrMwl:   idax,editGUIDs.size" << idax << editGUIDs.size();
       QString editGUID = editGUIDs[ idax ];
 
       if ( editGUID.isEmpty() )
@@ -4840,48 +4858,113 @@ DbgLv(1) << "EDT:WrMwl:   idax,editGUIDs.size" << idax << editGUIDs.size();
          editGUID      = US_Util::new_guid();
          editGUIDs.replace( idax, editGUID );
       }
-DbgLv(1) << "EDT:WrMwl:    editGUID" << editGUID;
 
-DbgLv(1) << "EDT:WrMwl:   odax,outData.size" << odax << outData.size();
       QString rawGUID  = US_Util::uuid_unparse(
             (unsigned char*)outData[ odax ]->rawGUID );
-DbgLv(1) << "EDT:WrMwl:    rawGUID" << rawGUID;
+DbgLv(1) << "EDT:WrMwl:    idax odax editGUID rawGUID" << idax << odax
+ << editGUID << rawGUID;
 
-      // Output the edit XML file
-      le_info->setText( tr( "Writing " ) + filename + " ..." );
-      qApp->processEvents();
-      int wrstat       = write_xml_file( filename, triple, editGUID, rawGUID );
-DbgLv(1) << "EDT:WrMwl:     write_xml_file stat" << wrstat;
+      idaxs            << idax;
+      writer.fnames    << filename;
+      writer.editGUIDs << editGUID;
+      writer.rawGUIDs  << rawGUID;
+      writer.xmls      << edit_xml( triple, editGUID, rawGUID );
+   }
 
-      if ( wrstat != 0 )
-         return;
-      else
-         editFnames[ idax ] = filename;
+   // Write the edit XML files in a worker thread, while the database
+   //  edit records (if any) are created here
+   writer.start();
 
-      if ( disk_controls->db() )
+   if ( disk_controls->db() )
+   {
+      if ( dbP == NULL )
       {
-         if ( dbP == NULL )
+         US_Passwd pw;
+         dbP          = new US_DB2( pw.getPasswd() );
+         if ( dbP == NULL  ||  dbP->lastErrno() != US_DB2::OK )
          {
-            US_Passwd pw;
-            dbP          = new US_DB2( pw.getPasswd() );
-            if ( dbP == NULL  ||  dbP->lastErrno() != US_DB2::OK )
-            {
-               QMessageBox::warning( this, tr( "Connection Problem" ),
-                 tr( "Could not connect to database \n" ) + dbP->lastError() );
-               return;
-            }
+            writer.wait();
+            QApplication::restoreOverrideCursor();
+            QMessageBox::warning( this, tr( "Connection Problem" ),
+              tr( "Could not connect to database \n" ) + dbP->lastError() );
+            return;
          }
+      }
 
+      for ( wvx = 0; wvx < ntrip; wvx++ )
+      {
+         idax             = idaxs[ wvx ];
          QString editID   = editIDs[ idax ];
+         QString emsg;
+
+         le_info->setText( tr( "Saving database edit record %1 of %2 ..." )
+                           .arg( wvx + 1 ).arg( ntrip ) );
+         qApp->processEvents();
 
-         // Output the edit database record
-         wrstat = write_edit_db( dbP, filename, editGUID, editID, rawGUID );
-DbgLv(1) << "EDT:WrMwl:  dax fname" << idax << filename << "wrstat" << wrstat;
+         int wrstat       = edit_db_record( dbP, writer.fnames[ wvx ],
+                                            writer.editGUIDs[ wvx ], editID,
+                                            writer.rawGUIDs[ wvx ], emsg );
+DbgLv(1) << "EDT:WrMwl:  dax editID" << idax << editID << "wrstat" << wrstat;
 
          if ( wrstat != 0 )
+         {
+            writer.wait();
+            QApplication::restoreOverrideCursor();
+            QMessageBox::warning( this, tr( "Database Problem" ), emsg );
             return;
-      }  // END:  DB output
-   }  // END:  wavelength-in-cellchannel loop
+         }
+
+         US_DB2::BlobTransfer xfer;
+         xfer.filename    = workingDir + writer.fnames[ wvx ];
+         xfer.procedure   = "upload_editData";
+         xfer.tableID     = editID.toInt();
+         xfer.upload      = true;
+         writer.xfers << xfer;
+      }
+   }
+
+   // Show progress until all the edit files are written
+   while ( ! writer.wait( 100 ) )
+   {
+      le_info->setText( tr( "Writing edit files:  %1 of %2 ..." )
+                        .arg( (int)writer.ndone ).arg( ntrip ) );
+      qApp->processEvents();
+   }
+DbgLv(1) << "EDT:WrMwl:   write status" << writer.status;
+
+   if ( writer.status != 0 )
+   {
+      QApplication::restoreOverrideCursor();
+      QMessageBox::information( this, tr( "File write error" ),
+                                writer.error );
+      return;
+   }
+
+   for ( wvx = 0; wvx < ntrip; wvx++ )
+      editFnames[ idaxs[ wvx ] ] = writer.fnames[ wvx ];
+
+   if ( ! writer.xfers.isEmpty() )
+   {  // Upload the edit files to the database records, several at a time
+      US_Passwd pw;
+      writer.masterPW  = pw.getPasswd();
+      writer.start();
+
+      le_info->setText( tr( "Uploading %1 edit files to the database ..." )
+                        .arg( ntrip ) );
+
+      while ( ! writer.wait( 100 ) )
+         qApp->processEvents();
+DbgLv(1) << "EDT:WrMwl:   upload status" << writer.status;
+
+      if ( writer.status != US_DB2::OK )
+      {
+         QApplication::restoreOverrideCursor();
+         QMessageBox::warning( this, tr( "Database Problem" ),
+            tr( "Could not insert edit xml data into database \n" ) + 
+            writer.error );
+         return;
+      }
+   }
 
    QApplication::restoreOverrideCursor();
    changes_made = false;
@@ -4910,7 +4993,27 @@ int US_Edit::write_xml_file( QString& fname, QString& triple,
 
 DbgLv(1) << "EDT:WrXml: IN: fname,triple,editGUID,rawGUID"
  << fname << triple << editGUID << rawGUID;
-   QXmlStreamWriter xml( &efo );
+   write_ops();
+   efo.write( edit_xml( triple, editGUID, rawGUID ) );
+   efo.close();
+   return 0;
+}
+
+// Save the state of edit operations that is held in GUI elements
+void US_Edit::write_ops( void )
+{
+   wr_rinoise   = ! pb_residuals->icon().isNull();
+   wr_spikes    = ! pb_spikes   ->icon().isNull();
+   wr_gaptol    = ct_gaps->value();
+}
+
+// Compose the edit XML for a triple, using the operations state saved by
+//  write_ops()
+QByteArray US_Edit::edit_xml( const QString& triple, const QString& editGUID,
+      const QString& rawGUID ) const
+{
+   QByteArray       xmlout;
+   QXmlStreamWriter xml( &xmlout );
 
    xml.setAutoFormatting( true );
    xml.writeStartDocument();
@@ -4938,14 +5041,11 @@ DbgLv(1) << "EDT:WrXml: IN: fname,triple,editGUID,rawGUID"
    QStringList parts   = triple.contains( " / " ) ?
                          triple.split( " / " ) :
                          triple.split( "." );
-DbgLv(1) << "EDT:WrXml:  parts.size" << parts.size();
 
    QString     cell    = parts[ 0 ];
    QString     channel = parts[ 1 ];
    QString     waveln  = parts[ 2 ];
 
-DbgLv(1) << "EDT:WrXml:  waveln" << waveln;
-
    xml.writeStartElement( "run" );
    xml.writeAttribute   ( "cell",       cell    );
    xml.writeAttribute   ( "channel",    channel );
@@ -4976,7 +5076,7 @@ DbgLv(1) << "EDT:WrXml:  waveln" << waveln;
 
       for ( int ii = 0; ii < changed_points.size(); ii++ )
       {
-         Edits* e = &changed_points[ ii ];
+         const Edits* e = &changed_points[ ii ];
 
          for ( int jj = 0; jj < e->changes.size(); jj++ )
          {
@@ -5011,7 +5111,7 @@ DbgLv(1) << "EDT:WrXml:  waveln" << waveln;
          xml.writeAttribute   ( "right",
             QString::number( airGap_right,     'f', 8 ) );
          xml.writeAttribute   ( "tolerance",
-            QString::number( ct_gaps->value(), 'f', 8 ) );
+            QString::number( wr_gaptol,        'f', 8 ) );
          xml.writeEndElement  ();
       }
 
@@ -5048,7 +5148,7 @@ DbgLv(1) << "EDT:WrXml:  waveln" << waveln;
          xml.writeAttribute   ( "right",
             QString::number( airGap_right,     'f', 8 ) );
          xml.writeAttribute   ( "tolerance",
-            QString::number( ct_gaps->value(), 'f', 8 ) );
+            QString::number( wr_gaptol,        'f', 8 ) );
          xml.writeEndElement  ();
       }
 
@@ -5084,15 +5184,15 @@ DbgLv(1) << "EDT:WrXml:  waveln" << waveln;
  
    xml.writeEndElement  ();  // parameters
 
-   if ( ! pb_residuals->icon().isNull()  ||
-        ! pb_spikes->icon().isNull()     ||
+   if ( wr_rinoise                       ||
+        wr_spikes                        ||
         invert == -1.0                   ||
         floatingData )
    {
       xml.writeStartElement( "operations" );
  
       // Write RI Noise
-      if ( ! pb_residuals->icon().isNull() )
+      if ( wr_rinoise )
       {
          xml.writeStartElement( "subtract_ri_noise" );
          xml.writeAttribute   ( "order", QString::number( noise_order ) );
@@ -5100,7 +5200,7 @@ DbgLv(1) << "EDT:WrXml:  waveln" << waveln;
       }
 
       // Write Remove Spikes
-      if ( ! pb_spikes->icon().isNull() )
+      if ( wr_spikes )
       {
          xml.writeStartElement( "remove_spikes" );
          xml.writeEndElement  ();
@@ -5127,33 +5227,62 @@ DbgLv(1) << "EDT:WrXml:  waveln" << waveln;
    xml.writeEndElement  ();  // experiment
    xml.writeEndDocument ();
 
-   efo.close();
-   return 0;
+   return xmlout;
 }
 
 // Write edit database record
 int US_Edit::write_edit_db( US_DB2* dbP, QString& fname, QString& editGUID,
       QString& editID, QString& rawGUID )
 {
-   int idEdit;
-
    if ( dbP == NULL )
    {
       QMessageBox::warning( this, tr( "Connection Problem" ),
-         tr( "Could not connect to database \n" ) + dbP->lastError() );
+         tr( "Could not connect to database \n" ) );
       return 1;
    }
 
+   QString emsg;
+   int     wrstat   = edit_db_record( dbP, fname, editGUID, editID, rawGUID,
+                                      emsg );
+
+   if ( wrstat != 0 )
+   {
+      QMessageBox::warning( this,
+         ( wrstat == 2 ? tr( "AUC Data is not in DB" )
+                       : tr( "Database Problem" ) ),
+         emsg );
+      return wrstat;
+   }
+
+   dbP->writeBlobToDB( workingDir + fname, "upload_editData", editID.toInt() );
+
+   if ( dbP->lastErrno() != US_DB2::OK )
+   {
+      QMessageBox::warning( this, tr( "Database Problem" ),
+         tr( "Could not insert edit xml data into database \n" ) + 
+         dbP->lastError() );
+      return 5;
+   }
+
+   return 0;
+}
+
+// Create or update the database record for an edit, but not its xml blob.
+//  A new record's ID is returned in editID; on an error, emsg explains it.
+int US_Edit::edit_db_record( US_DB2* dbP, const QString& fname,
+      const QString& editGUID, QString& editID, const QString& rawGUID,
+      QString& emsg )
+{
+   int idEdit;
+
    QStringList query( "get_rawDataID_from_GUID" );
    query << rawGUID;
    dbP->query( query );
 
    if ( dbP->lastErrno() != US_DB2::OK )
    {
-      QMessageBox::warning( this, 
-         tr( "AUC Data is not in DB" ),
-         tr( "Cannot save edit data to the database.\n"
-             "The associated AUC data is not present." ) );
+      emsg     = tr( "Cannot save edit data to the database.\n"
+                     "The associated AUC data is not present." );
       return 2;
    }
 
@@ -5173,10 +5302,8 @@ int US_Edit::write_edit_db( US_DB2* dbP, QString& fname, QString& editGUID,
 
       if ( dbP->lastErrno() != US_DB2::OK )
       {
-         QMessageBox::warning( this, tr( "Database Problem" ),
-            tr( "Could not insert metadata into the database\n" ) + 
-                dbP->lastError() );
-
+         emsg     = tr( "Could not insert metadata into the database\n" ) + 
+                    dbP->lastError();
          return 3;
       }
 
@@ -5194,24 +5321,10 @@ int US_Edit::write_edit_db( US_DB2* dbP, QString& fname, QString& editGUID,
 
       if ( dbP->lastErrno() != US_DB2::OK )
       {
-         QMessageBox::warning( this, tr( "Database Problem" ),
-            tr( "Could not update metadata in the database \n" ) + 
-            dbP->lastError() );
-
+         emsg     = tr( "Could not update metadata in the database \n" ) + 
+                    dbP->lastError();
          return 4;
       }
-
-      idEdit   = editID.toInt();
-   }
-
-   dbP->writeBlobToDB( workingDir + fname, "upload_editData", idEdit );
-
-   if ( dbP->lastErrno() != US_DB2::OK )
-   {
-      QMessageBox::warning( this, tr( "Database Problem" ),
-         tr( "Could not insert edit xml data into database \n" ) + 
-         dbP->lastError() );
-      return 5;
    }
 
    return 0;
@@ -5312,16 +5425,25 @@ DbgLv(1) << "LiEdFi:  nlocals nledits" << nlocals << nledits;
          if ( nlocals == 0 )
             QDir().mkpath( workingDir );
 
-         dbfiles.sort();
+         QList< US_DB2::BlobTransfer > xfers;
 
          for ( int ii = 0; ii < dbfiles.count(); ii++ )
          {  // Download each DB record to a local file
-            QString fname     = workingDir + dbfiles[ ii ];
-            int     dataID    = dbEdIds[ ii ].toInt();
-
-            dbP->readBlobFromDB( fname, "download_editData", dataID );
+            US_DB2::BlobTransfer xfer;
+            xfer.filename     = workingDir + dbfiles[ ii ];
+            xfer.procedure    = "download_editData";
+            xfer.tableID      = dbEdIds[ ii ].toInt();
+            xfer.upload       = false;
+            xfers << xfer;
          }
 
+         // Run the downloads concurrently, several connections at a time
+         US_Passwd pw;
+         QApplication::setOverrideCursor( QCursor( Qt::WaitCursor ) );
+         US_DB2::transferBlobs( pw.getPasswd(), xfers );
+         QApplication::restoreOverrideCursor();
+
+         dbfiles.sort();
          ldfiles           = dbfiles;
       }
    }
@@ -5859,3 +5981,60 @@ void US_Edit::close_edit( void )
 
    close();
 }
+
+// Create the thread that writes a channel's edit profiles
+US_EditWriter::US_EditWriter( QObject* parent )
+   : QThread( parent )
+{
+   ndone       = 0;
+   status      = 0;
+}
+
+// Write the edit files in parallel, or upload them if transfers are given
+void US_EditWriter::run( void )
+{
+   status      = 0;
+   error.clear();
+
+   if ( xfers.isEmpty() )
+   {
+      ndone       = 0;
+      US_Parallel::run( this, fnames.size() );
+   }
+
+   else
+   {
+      status      = US_DB2::transferBlobs( masterPW, xfers );
+
+      for ( int ii = 0; ii < xfers.size()  &&  error.isEmpty(); ii++ )
+         error       = xfers[ ii ].error;
+   }
+}
+
+// Write the edit XML files of a block of wavelengths
+void US_EditWriter::run_range( int begin, int end, int )
+{
+   for ( int ii = begin; ii < end; ii++ )
+   {
+      QString fpath  = workDir + fnames.at( ii );
+      QFile   efo( fpath );
+
+      if ( ! efo.open( QFile::WriteOnly | QFile::Text )  ||
+           efo.write( xmls.at( ii ) ) < 0 )
+      {
+         QMutexLocker lock( &mutex );
+
+         if ( status == 0 )
+         {
+            status         = 1;
+            error          = QObject::tr( "Could not write the file\n" )
+                             + fpath
+                             + QObject::tr( "\nCheck your permissions." );
+         }
+         continue;
+      }
+
+      efo.close();
+      ndone.fetchAndAddOrdered( 1 );
+   }
+}
@@ -8,8 +8,44 @@
 #include "us_dataIO.h"
 #include "us_db2.h"
 #include "us_mwl_data.h"
+#include "us_parallel.h"
 #include "qwt_plot_marker.h"
 
+//! \brief Thread that writes the edit profiles of a channel's wavelengths
+//!
+//! With no blob transfers given, the thread writes the edit XML file of
+//! each wavelength, running the wavelengths in parallel. The XML is
+//! composed beforehand on the GUI thread, so the thread only works on
+//! its own copies. Otherwise it uploads the given edit files to the
+//! database over a small pool of connections.
+class US_EditWriter : public QThread, public US_RangeTask
+{
+   public:
+      //! \brief Create the writer thread
+      //! \param parent  Parent object
+      US_EditWriter( QObject* = 0 );
+
+      //! \brief Write the edit files, or upload them
+      void run( void );
+
+      //! \brief Write the edit files of a block of wavelengths
+      void run_range( int, int, int );
+
+      QString     workDir;    //!< Directory of the edit files
+      QStringList fnames;     //!< Edit file name of each wavelength
+      QStringList editGUIDs;  //!< Edit GUID of each wavelength
+      QStringList rawGUIDs;   //!< Raw data GUID of each wavelength
+      QList< QByteArray > xmls;  //!< Edit XML of each wavelength
+      QString     masterPW;   //!< Master password for DB uploads
+      QList< US_DB2::BlobTransfer > xfers;  //!< Edit file uploads
+      QAtomicInt  ndone;      //!< Count of edit files written
+      int         status;     //!< Status of the run: 0 if all went well
+      QString     error;      //!< Message of the first error
+
+   private:
+      QMutex      mutex;      // Guard for the first error
+};
+
 class US_Edit : public US_Widgets
 {
 	Q_OBJECT
@@ -18,7 +54,6 @@ class US_Edit : public US_Widgets
 		US_Edit();
 
 	private:
-
       enum { MENISCUS, AIRGAP, RANGE, PLATEAU, BASELINE, FINISHED } step;
 
       class Edits
@@ -46,6 +81,8 @@ class US_Edit : public US_Widgets
       bool               expIsOther;
       bool               all_edits;
       bool               men_1click;
+      bool               wr_rinoise;     // RI noise subtraction is written
+      bool               wr_spikes;      // Spike removal is written
 
       int                noise_order;
       int                triple_index;
@@ -209,6 +246,7 @@ class US_Edit : public US_Widgets
       int                ntriple;
 
       double             odlimit;
+      double             wr_gaptol;      // Fringe tolerance written
 
       US_DB2*            dbP;
 
@@ -303,6 +341,11 @@ class US_Edit : public US_Widgets
       int  write_xml_file    ( QString&, QString&, QString&, QString& );
       int  write_edit_db     ( US_DB2*,
                                QString&, QString&, QString&, QString& );
+      int  edit_db_record    ( US_DB2*, const QString&, const QString&,
+                               QString&, const QString&, QString& );
+      void write_ops         ( void );
+      QByteArray edit_xml    ( const QString&, const QString&,
+                               const QString& ) const;
       int  index_data        ( int = -1 );
       int  like_edit_files   ( QString, QStringList&, US_DB2* );
       int  apply_edits       ( US_DataIO::EditValues parameters );
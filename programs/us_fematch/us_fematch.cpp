@@ -2211,6 +2211,13 @@ DbgLv(1)<<"SimMdl: ssck: rspeed accel1 tf_aend tf_scan"
    nthread    = US_Settings::threads();
    int ntc    = ( ncomp + nthread - 1 ) / nthread;
    nthread    = ( ntc > MIN_NTC ) ? nthread : 1;
+   // The finite element solver threads its own component blocks
+   int nthr_fe  = US_Settings::threads();
+   bool use_fe  = ( model.components[ 0 ].sigma == 0.0  &&
+                    model.components[ 0 ].delta == 0.0  &&
+                    model.coSedSolute           <  0.0  &&
+                    compress                    == 0.0 );
+   nthread    = use_fe ? 1 : nthread;
 
 DbgLv(1) << "SimMdl: nthread" << nthread << "ncomp" << ncomp
  << "ntc" << ntc << "meshtype" << simparams.meshType;
@@ -2218,10 +2225,7 @@ DbgLv(1) << "SimMdl: nthread" << nthread << "ncomp" << ncomp
    // Do simulation by several possible ways: 1-/Multi-thread, ASTFEM/ASTFVM
    if ( nthread < 2 )
    {
-      if ( model.components[ 0 ].sigma == 0.0  &&
-           model.components[ 0 ].delta == 0.0  &&
-           model.coSedSolute           <  0.0  &&
-           compress                    == 0.0 )
+      if ( use_fe )
       {
 DbgLv(1) << "SimMdl: (fematch:)Finite Element Solver is called";
 //*DEBUG*
@@ -2241,6 +2245,7 @@ simparams.debug();
          connect( astfem_rsa, SIGNAL( current_component( int ) ),
                   this,       SLOT  ( update_progress  ( int ) ) );
          astfem_rsa->set_debug_flag( dbg_level );
+         astfem_rsa->set_thread_count( nthr_fe );
          solution_rec.buffer.compressibility = compress;
          solution_rec.buffer.manual          = manual;
          //astfem_rsa->set_buffer( solution_rec.buffer );
@@ -746,6 +746,9 @@ qDebug() << "FIT_COMPLETED";
    {
       plot_residuals();
    }
+
+   if ( ! fitpars.aborted )
+      emit fit_available( fitpars );    // Allow Monte Carlo on the fit
 }
 
 // Prepare data for plots:  get y_delta and data indecies,counts
@@ -26,6 +26,7 @@ class US_EqFitControl : public US_WidgetsDialog
 
    signals:
       void update_scan( int );
+      void fit_available( const FitCtrlPar& );
 
 	private:
       QVector< EqScanFit >&   scanfits;  // Scan Fit vector
@@ -21,16 +21,11 @@ US_EqHistogram::US_EqHistogram( double od_limit,
                                 Qt::WindowFlags f )
  :US_WidgetsDialog( parent, f ),
    od_limit ( od_limit ),
-   scanfits ( scanfits )
+   scanfits ( &scanfits )
 {
    setAttribute  ( Qt::WA_DeleteOnClose );
    setPalette    ( US_GuiSettings::frameColor() );
 
-   // Main layout
-   QVBoxLayout* main = new QVBoxLayout( this );
-   main->setContentsMargins( 2, 2, 2, 2 );
-   main->setSpacing        ( 2 );
-
    // Analyze data to determine type of histogram
    double min_extinc = 1.0e28;
    double max_extinc = -1.0;
@@ -183,25 +178,125 @@ qDebug() << "UH: wtitle" << wtitle;
    setWindowTitle( wtitle );
 
    // Create the plot
+   setup_plot( htitle, hxaxis, hyaxis );
+   hist_plot->setAxisScale( QwtPlot::xBottom, 0.0,   1.0 );
+
+qDebug() << "UH: x0 x1 xm xn" << xplot[0] << xplot[1] << xplot[48] << xplot[49];
+qDebug() << "UH: y0 y1 ym yn" << yplot[0] << yplot[1] << yplot[48] << yplot[49];
+   hcurve->setSamples( xplot, yplot, points );
+   pcurve->setSamples( xplot, yplot, points );
+
+   // Display the plot
+   hist_plot->replot();
+
+   adjustSize();
+}
+
+// Constructor for a histogram of fitted parameter values
+US_EqHistogram::US_EqHistogram( const QString& ptitle,
+                                QWidget* parent,
+                                Qt::WindowFlags f )
+ :US_WidgetsDialog( parent, f ),
+   od_limit ( 0.0 ),
+   scanfits ( 0 )
+{
+   setAttribute  ( Qt::WA_DeleteOnClose );
+   setPalette    ( US_GuiSettings::frameColor() );
+   setWindowTitle( tr( "GlobalEquil Monte Carlo Histogram" ) );
+
+   setup_plot( ptitle + tr( " Histogram" ), ptitle, tr( "Frequency" ) );
+   hist_plot->setAxisAutoScale( QwtPlot::xBottom );
+
+   adjustSize();
+}
+
+// Plot (or re-plot) the histogram of a set of parameter values
+void US_EqHistogram::plot_values( const QString& ptitle,
+                                  const QVector< double >& pvals )
+{
+   int    nvals      = pvals.size();
+
+   if ( nvals == 0 )
+      return;
+
+   double xplot[ ARRAY_SIZE ];
+   double yplot[ ARRAY_SIZE ];
+   double pmin       = pvals[ 0 ];
+   double pmax       = pvals[ 0 ];
+   double psum       = 0.0;
+
+   for ( int ii = 0; ii < nvals; ii++ )
+   {
+      pmin       = qMin( pmin, pvals[ ii ] );
+      pmax       = qMax( pmax, pvals[ ii ] );
+      psum      += pvals[ ii ];
+   }
+
+   double pmean      = psum / (double)nvals;
+   double pvari      = 0.0;
+
+   for ( int ii = 0; ii < nvals; ii++ )
+      pvari     += sq( pvals[ ii ] - pmean );
+
+   double pstdd      = ( nvals > 1 ) ? sqrt( pvari / (double)( nvals - 1 ) )
+                                     : 0.0;
+
+   // Build bins spanning the values range (a unit range if all are equal)
+   double prange     = pmax - pmin;
+   prange            = ( prange > 0.0 ) ? prange
+                                        : qMax( qAbs( pmean ), 1.0 ) * 1.0e-3;
+   double x_incr     = prange / (double)ARRAY_SIZE;
+   double x_valu     = pmin + x_incr * 0.5;
+
+   for ( int jj = 0; jj < ARRAY_SIZE; jj++ )
+   {
+      xplot[ jj ]  = x_valu;
+      x_valu      += x_incr;
+      yplot[ jj ]  = 0.0;
+   }
+
+   for ( int ii = 0; ii < nvals; ii++ )
+   {
+      int jj       = (int)( ( pvals[ ii ] - pmin ) / x_incr );
+      jj           = qMax( 0, qMin( ( ARRAY_SIZE - 1 ), jj ) );
+      yplot[ jj ] += 1.0;
+   }
+
+   hist_plot->setTitle( tr( "%1 Histogram\n"
+                            "(%2 fits;  mean %3;  std.dev. %4)" )
+                        .arg( ptitle ).arg( nvals )
+                        .arg( pmean ).arg( pstdd ) );
+   hist_plot->setAxisTitle( QwtPlot::xBottom, ptitle );
+   hcurve->setSamples( xplot, yplot, ARRAY_SIZE );
+   pcurve->setSamples( xplot, yplot, ARRAY_SIZE );
+
+   hist_plot->replot();
+}
+
+// Create the histogram plot with its bars and max-points curves
+void US_EqHistogram::setup_plot( const QString& htitle, const QString& hxaxis,
+                                 const QString& hyaxis )
+{
+   // Main layout
+   QVBoxLayout* main = new QVBoxLayout( this );
+   main->setContentsMargins( 2, 2, 2, 2 );
+   main->setSpacing        ( 2 );
+
    hplot = new US_Plot( hist_plot, htitle, hxaxis, hyaxis );
    QwtPlotGrid* grid = us_grid( hist_plot );
    grid->enableYMin( true );
    grid->enableY   ( true );
 
    hist_plot->setMinimumSize( 600, 400 );
-   hist_plot->setAxisScale( QwtPlot::xBottom, 0.0,   1.0 );
    hist_plot->setAxisAutoScale( QwtPlot::yLeft );
 
    // Build a "curve" consisting of bars
-   QwtPlotCurve* hcurve = us_curve( hist_plot, "Histogram Bar" );
+   hcurve = us_curve( hist_plot, "Histogram Bar" );
    hcurve->setPen( QPen( QBrush( Qt::red ), 6.0 ) );
    hcurve->setStyle( QwtPlotCurve::Sticks );
-qDebug() << "UH: x0 x1 xm xn" << xplot[0] << xplot[1] << xplot[48] << xplot[49];
-qDebug() << "UH: y0 y1 ym yn" << yplot[0] << yplot[1] << yplot[48] << yplot[49];
-   hcurve->setSamples( xplot, yplot, points );
 
    // Add a "curve" of circles at the max point of each bar
-   QwtPlotCurve* pcurve = us_curve( hist_plot, "Histogram MaxPoints" );
+   pcurve = us_curve( hist_plot, "Histogram MaxPoints" );
    pcurve->setStyle( QwtPlotCurve::NoCurve );
    QwtSymbol* sym = new QwtSymbol;
    sym->setStyle( QwtSymbol::Ellipse );
@@ -209,13 +304,6 @@ qDebug() << "UH: y0 y1 ym yn" << yplot[0] << yplot[1] << yplot[48] << yplot[49];
    sym->setBrush( QBrush( Qt::yellow ) );
    sym->setSize ( 12 );
    pcurve->setSymbol ( sym );
-   pcurve->setSamples( xplot, yplot, points );
-
-   // Display the plot
-   hist_plot->replot();
 
    main->addLayout( hplot );
-
-   adjustSize();
 }
-
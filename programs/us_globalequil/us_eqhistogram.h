@@ -16,14 +16,27 @@ class US_EqHistogram : public US_WidgetsDialog
 		US_EqHistogram( double, QVector< EqScanFit >&,
          QWidget* = 0, Qt::WindowFlags = 0 );
 
+      //! \brief Constructor for a histogram of fitted parameter values
+      //! \param ptitle  Title of the parameter
+      US_EqHistogram( const QString&, QWidget* = 0, Qt::WindowFlags = 0 );
+
+      //! \brief Plot (or re-plot) the histogram of parameter values
+      //! \param ptitle  Title of the parameter
+      //! \param pvals   Parameter values accumulated so far
+      void plot_values( const QString&, const QVector< double >& );
+
 	private:
       double                 od_limit;  // OD Limit value
-      QVector< EqScanFit >&  scanfits;  // Scan fits vector
+      QVector< EqScanFit >*  scanfits;  // Scan fits vector
 
       US_Plot*    hplot;      // Histogram plot layout
       QwtPlot*    hist_plot;  // The histogram plot
 
+      QwtPlotCurve* hcurve;   // Histogram bars curve
+      QwtPlotCurve* pcurve;   // Histogram max points curve
+
    private slots:
+      void setup_plot( const QString&, const QString&, const QString& );
 };
 #endif
 
@@ -644,10 +644,10 @@ void US_EqMath::parameter_mapBackward( double* vguess )
       {
          if ( scnf->amp_fits[ jj ] )
             scnf->amp_vals[ jj ] = vguess[ jpx++ ];
-
-         if ( scnf->baseln_fit )
-            scnf->baseline       = vguess[ jpx++ ];
       }
+
+      if ( scnf->baseln_fit )
+         scnf->baseline       = vguess[ jpx++ ];
    }
 
    for ( int jj = 0; jj < runfit.nbr_assocs; jj++ )
@@ -0,0 +1,664 @@
+//! \file us_eqmontecarlo.cpp
+
+#include "us_eqmontecarlo.h"
+#include "us_settings.h"
+#include "us_gui_settings.h"
+#include "us_math2.h"
+
+// Random number stream for one Monte Carlo iteration (SplitMix64).
+//  Streams are independent of any global generator state, so they may be
+//  used concurrently, and each iteration's stream depends only on the
+//  run seed and the iteration index.
+class US_EqMCRandom
+{
+   public:
+      US_EqMCRandom( const uint seed, const int iter )
+      {
+         state       = (quint64)seed;
+         state       = next() ^ ( (quint64)( iter + 1 )
+                                  * Q_UINT64_C( 0xD1B54A32D192ED03 ) );
+         have_gauss  = false;
+         gauss2      = 0.0;
+      }
+
+      // Next 64-bit random value
+      quint64 next( void )
+      {
+         state      += Q_UINT64_C( 0x9E3779B97F4A7C15 );
+         quint64 zz  = state;
+         zz          = ( zz ^ ( zz >> 30 ) ) * Q_UINT64_C( 0xBF58476D1CE4E5B9 );
+         zz          = ( zz ^ ( zz >> 27 ) ) * Q_UINT64_C( 0x94D049BB133111EB );
+         return ( zz ^ ( zz >> 31 ) );
+      }
+
+      // Uniform value in [0,1)
+      double uniform( void )
+      {
+         return ( (double)( next() >> 11 ) * ( 1.0 / 9007199254740992.0 ) );
+      }
+
+      // Uniform index in [0,count)
+      int index( const int count )
+      {
+         return qMin( (int)( uniform() * (double)count ), count - 1 );
+      }
+
+      // Standard normal value (polar Box-Muller)
+      double gauss( void )
+      {
+         if ( have_gauss )
+         {
+            have_gauss  = false;
+            return gauss2;
+         }
+
+         double x1;
+         double x2;
+         double ww;
+
+         do
+         {
+            x1          = 2.0 * uniform() - 1.0;
+            x2          = 2.0 * uniform() - 1.0;
+            ww          = sq( x1 ) + sq( x2 );
+         } while ( ww >= 1.0  ||  ww == 0.0 );
+
+         ww          = sqrt( ( -2.0 * log( ww ) ) / ww );
+         gauss2      = x2 * ww;
+         have_gauss  = true;
+         return ( x1 * ww );
+      }
+
+   private:
+      quint64 state;
+      double  gauss2;
+      bool    have_gauss;
+};
+
+// Construct a Monte Carlo iteration thread with its own copies of fit data
+US_EqMCThread::US_EqMCThread(
+      QVector< US_DataIO::EditedData >& a_dataList,
+      QVector< ScanEdit >&              a_scedits,
+      QVector< EqScanFit >&             a_scanfits,
+      EqRunFit&                         a_runfit,
+      const EqMCDefs*                   a_mcdefs,
+      QAtomicInt*                       a_next_iter,
+      double*                           a_mcpars,
+      double*                           a_mcvaris,
+      QObject*                          parent )
+ : QThread( parent ),
+   wdataList  ( a_dataList ),
+   wscedits   ( a_scedits ),
+   bscanfits  ( a_scanfits ),
+   wscanfits  ( a_scanfits ),
+   brunfit    ( a_runfit ),
+   wrunfit    ( a_runfit ),
+   mcdefs     ( a_mcdefs ),
+   next_iter  ( a_next_iter ),
+   mcpars     ( a_mcpars ),
+   mcvaris    ( a_mcvaris )
+{
+   dbg_level   = US_Settings::us_debug();
+   abort_flag  = false;
+}
+
+// Flag that the thread should stop after its current refit
+void US_EqMCThread::abort()
+{
+   abort_flag  = true;
+}
+
+// Run refits of synthetic data sets until all iterations are taken
+void US_EqMCThread::run()
+{
+   int        niters  = mcdefs->niters;
+   int        nfpars  = mcdefs->nfpars;
+   US_EqMath  emath( wdataList, wscedits, wscanfits, wrunfit );
+   FitCtrlPar fitpars;
+
+   emath.init_fit( mcdefs->modelx, mcdefs->nlsmeth, fitpars );
+   set_controls( fitpars );
+
+   US_FitWorker fworker( &emath, fitpars, 0 );
+
+   while ( ! abort_flag )
+   {
+      int iter    = next_iter->fetchAndAddOrdered( 1 );
+
+      if ( iter >= niters )
+         break;
+
+      // Start each refit from the best fit parameters
+      wscanfits   = bscanfits;
+      wrunfit     = brunfit;
+      synth_data( iter );
+
+      emath.init_fit( mcdefs->modelx, mcdefs->nlsmeth, fitpars );
+      set_controls( fitpars );
+      fworker.redefine_work();
+
+      int stat    = fworker.fit_iterations();
+      bool good   = ( stat == 0  &&  ! fitpars.aborted  &&
+                      fitpars.nfpars == nfpars  &&  fitpars.variance >= 0.0 );
+      double* pars = mcpars + iter * nfpars;
+
+      for ( int kk = 0; kk < nfpars; kk++ )
+         pars[ kk ]     = good ? fitpars.guess[ kk ] : 0.0;
+
+      mcvaris[ iter ] = good ? fitpars.variance : -1.0;
+DbgLv(1) << "MCT: iter" << iter << "stat" << stat << "k_iter" << fitpars.k_iter
+ << "variance" << fitpars.variance;
+
+      emit iteration_done( iter );
+   }
+}
+
+// Replace the fitted scans' data with best fit values plus noise
+void US_EqMCThread::synth_data( int iter )
+{
+   US_EqMCRandom rng( mcdefs->seed, iter );
+   bool gaussn   = ( mcdefs->noistype == 0 );
+   int  ptx      = 0;
+   int  dsx      = 0;
+
+   for ( int ii = 0; ii < wscanfits.size(); ii++ )
+   {
+      if ( ! wscanfits[ ii ].scanFit )  continue;
+
+      EqScanFit* scnf  = &wscanfits[ ii ];
+      int    nspts     = mcdefs->setpts[ dsx ];
+      double sigma     = mcdefs->sigmas[ dsx++ ];
+      int    ptb       = ptx;
+      int    jy        = scnf->start_ndx;
+
+      for ( int jj = 0; jj < nspts; jj++ )
+      {
+         double noise     = gaussn ? ( sigma * rng.gauss() )
+                                   : mcdefs->y_res[ ptb + rng.index( nspts ) ];
+         scnf->yvs[ jy++ ] = mcdefs->y_fit[ ptx++ ] + noise;
+      }
+   }
+}
+
+// Set the fit control parameters of a refit
+void US_EqMCThread::set_controls( FitCtrlPar& fitpars )
+{
+   fitpars.nlsmeth   = mcdefs->nlsmeth;
+   fitpars.modelx    = mcdefs->modelx;
+   fitpars.mxiters   = mcdefs->mxiters;
+   fitpars.mxsteps   = mcdefs->mxiters;
+   fitpars.lam_start = mcdefs->lam_start;
+   fitpars.lam_step  = mcdefs->lam_step;
+   fitpars.fittoler  = mcdefs->fittoler;
+   fitpars.lincnstr  = mcdefs->lincnstr;
+   fitpars.autocnvg  = mcdefs->autocnvg;
+}
+
+// Main constructor with copies of the best fit data and fit controls
+US_EqMonteCarlo::US_EqMonteCarlo(
+      QVector< US_DataIO::EditedData >& a_dataList,
+      QVector< ScanEdit >&              a_scedits,
+      QVector< EqScanFit >&             a_scanfits,
+      EqRunFit&                         a_runfit,
+      const FitCtrlPar&                 a_fitpars,
+      const QVector< double >&          a_bguess )
+ : US_WidgetsDialog( 0, 0 ),
+   dataList   ( a_dataList ),
+   scedits    ( a_scedits ),
+   scanfits   ( a_scanfits ),
+   runfit     ( a_runfit ),
+   fitpars    ( a_fitpars ),
+   bguess     ( a_bguess )
+{
+   setAttribute  ( Qt::WA_DeleteOnClose );
+   setWindowTitle( tr( "Equilibrium Monte Carlo Analysis" ) );
+   setPalette    ( US_GuiSettings::frameColor() );
+   setMinimumSize( 200, 100 );
+   dbg_level    = US_Settings::us_debug();
+   nthreads     = 0;
+   nfailed      = 0;
+   nfinish      = 0;
+
+   // Main layout
+   QGridLayout* main = new QGridLayout( this );
+   main->setContentsMargins( 2, 2, 2, 2 );
+   main->setSpacing        ( 2 );
+
+   QLabel*  lb_mbanner  = us_banner( tr( "Monte Carlo Analysis of the"
+                                         " Global Equilibrium Fit" ) );
+   QLabel*  lb_iters    = us_label( tr( "Monte Carlo Iterations:" ) );
+            le_iters    = us_lineedit( "1000" );
+   QLabel*  lb_threads  = us_label( tr( "Threads:" ) );
+            ct_threads  = us_counter( 2, 1, 64, US_Settings::threads() );
+   QLabel*  lb_seed     = us_label( tr( "Random Seed (0=time):" ) );
+            le_seed     = us_lineedit( "0" );
+   QLabel*  lb_noise    = us_label( tr( "Synthetic Noise:" ) );
+   QGridLayout*  lo_gauss   = us_radiobutton( tr( "Gaussian" ),
+                                              rb_gauss, true );
+   QGridLayout*  lo_boots   = us_radiobutton( tr( "Bootstrap Residuals" ),
+                                              rb_boots, false );
+   QHBoxLayout*  lo_noibox  = new QHBoxLayout;
+   QButtonGroup* noisgrp    = new QButtonGroup( this );
+   lo_noibox->setSpacing        (  0 );
+   lo_noibox->setContentsMargins( 0, 0, 0, 0 );
+   lo_noibox->addLayout( lo_gauss );
+   lo_noibox->addLayout( lo_boots );
+   noisgrp->addButton( rb_gauss );
+   noisgrp->addButton( rb_boots );
+   noisgrp->setExclusive( true );
+   QLabel*  lb_param    = us_label( tr( "Histogram Parameter:" ) );
+            cb_param    = us_comboBox();
+   QLabel*  lb_progress = us_label( tr( "Progress:" ) );
+            progress    = us_progressBar( 0, 100, 0 );
+            le_status   = us_lineedit();
+            te_results  = us_textedit();
+            pb_start    = us_pushbutton( tr( "Start" ) );
+            pb_histo    = us_pushbutton( tr( "Histogram" ) );
+            pb_close    = us_pushbutton( tr( "Close" ) );
+
+   ct_threads->setSingleStep( 1 );
+   le_status ->setReadOnly( true );
+   te_results->setReadOnly( true );
+   te_results->setFont( QFont( "monospace", US_GuiSettings::fontSize() - 1 ) );
+   te_results->setMinimumWidth( 500 );
+
+   int row = 0;
+   main->addWidget( lb_mbanner,  row++, 0, 1, 6 );
+   main->addWidget( lb_iters,    row,   0, 1, 3 );
+   main->addWidget( le_iters,    row++, 3, 1, 3 );
+   main->addWidget( lb_threads,  row,   0, 1, 3 );
+   main->addWidget( ct_threads,  row++, 3, 1, 3 );
+   main->addWidget( lb_seed,     row,   0, 1, 3 );
+   main->addWidget( le_seed,     row++, 3, 1, 3 );
+   main->addWidget( lb_noise,    row,   0, 1, 2 );
+   main->addLayout( lo_noibox,   row++, 2, 1, 4 );
+   main->addWidget( lb_param,    row,   0, 1, 2 );
+   main->addWidget( cb_param,    row++, 2, 1, 4 );
+   main->addWidget( lb_progress, row,   0, 1, 2 );
+   main->addWidget( progress,    row++, 2, 1, 4 );
+   main->addWidget( le_status,   row++, 0, 1, 6 );
+   main->addWidget( te_results,  row,   0, 8, 6 );
+   row    += 8;
+   main->addWidget( pb_start,    row,   0, 1, 2 );
+   main->addWidget( pb_histo,    row,   2, 1, 2 );
+   main->addWidget( pb_close,    row++, 4, 1, 2 );
+
+   connect( pb_start, SIGNAL( clicked()            ),
+            this,     SLOT(   start_run()          ) );
+   connect( pb_histo, SIGNAL( clicked()            ),
+            this,     SLOT(   show_histogram()     ) );
+   connect( pb_close, SIGNAL( clicked()            ),
+            this,     SLOT(   closed()             ) );
+   connect( cb_param, SIGNAL( activated( int )     ),
+            this,     SLOT(   new_param( int )     ) );
+
+   // Compute the best fit and its residuals with a private math object
+   US_EqMath  bmath( dataList, scedits, scanfits, runfit );
+   FitCtrlPar bfpars;
+   bmath.init_fit( fitpars.modelx, fitpars.nlsmeth, bfpars );
+   int nfpars   = bfpars.nfpars;
+   int ntpts    = bfpars.ntpts;
+   int ndsets   = bfpars.ndsets;
+
+   if ( bguess.size() == nfpars )
+   {
+      for ( int kk = 0; kk < nfpars; kk++ )
+         bfpars.guess[ kk ] = bguess[ kk ];
+   }
+   else
+   {
+      bguess.clear();
+
+      for ( int kk = 0; kk < nfpars; kk++ )
+         bguess << bfpars.guess[ kk ];
+   }
+
+   bmath.calc_model( bfpars.guess );
+   double variance = bmath.calc_residuals();
+
+   mcdefs.modelx    = fitpars.modelx;
+   mcdefs.nlsmeth   = fitpars.nlsmeth;
+   mcdefs.mxiters   = fitpars.mxiters;
+   mcdefs.niters    = 0;
+   mcdefs.noistype  = 0;
+   mcdefs.nfpars    = nfpars;
+   mcdefs.ntpts     = ntpts;
+   mcdefs.seed      = 0;
+   mcdefs.fittoler  = fitpars.fittoler;
+   mcdefs.lam_start = fitpars.lam_start;
+   mcdefs.lam_step  = fitpars.lam_step;
+   mcdefs.lincnstr  = fitpars.lincnstr;
+   mcdefs.autocnvg  = fitpars.autocnvg;
+   mcdefs.setpts .clear();
+   mcdefs.sigmas .clear();
+   mcdefs.y_fit  .clear();
+   mcdefs.y_res  .clear();
+
+   for ( int ii = 0; ii < ntpts; ii++ )
+   {
+      mcdefs.y_fit << bfpars.y_guess[ ii ];
+      mcdefs.y_res << bfpars.y_delta[ ii ];
+   }
+
+   int ptx      = 0;
+
+   for ( int jj = 0; jj < ndsets; jj++ )
+   {  // Get the residuals standard deviation of each scan
+      int    nspts  = bfpars.setpts[ jj ];
+      double rsum   = 0.0;
+
+      for ( int kk = 0; kk < nspts; kk++ )
+         rsum         += sq( mcdefs.y_res[ ptx++ ] );
+
+      mcdefs.setpts << nspts;
+      mcdefs.sigmas << ( ( nspts > 0 ) ? sqrt( rsum / (double)nspts ) : 0.0 );
+   }
+
+   // Build parameter names, in the order of US_EqMath::guess_mapForward
+   for ( int jj = 0; jj < runfit.nbr_comps; jj++ )
+   {
+      if ( runfit.mw_fits[ jj ] )
+         pnames << tr( "Molecular Weight %1" ).arg( jj + 1 );
+
+      if ( runfit.vbar_fits[ jj ] )
+         pnames << tr( "Vbar %1" ).arg( jj + 1 );
+
+      if ( runfit.viri_fits[ jj ] )
+         pnames << tr( "Virial Coefficient %1" ).arg( jj + 1 );
+   }
+
+   for ( int ii = 0; ii < scanfits.size(); ii++ )
+   {
+      if ( ! scanfits[ ii ].scanFit )  continue;
+
+      for ( int jj = 0; jj < runfit.nbr_comps; jj++ )
+         if ( scanfits[ ii ].amp_fits[ jj ] )
+            pnames << tr( "Amplitude %1, Scan %2" ).arg( jj + 1 ).arg( ii + 1 );
+
+      if ( scanfits[ ii ].baseln_fit )
+         pnames << tr( "Baseline, Scan %1" ).arg( ii + 1 );
+   }
+
+   for ( int jj = 0; jj < runfit.nbr_assocs; jj++ )
+      if ( runfit.eq_fits[ jj ] )
+         pnames << tr( "Equilibrium Constant %1" ).arg( jj + 1 );
+
+   while ( pnames.size() < nfpars )
+      pnames << tr( "Parameter %1" ).arg( pnames.size() + 1 );
+
+   cb_param->addItems( pnames.mid( 0, nfpars ) );
+   pb_histo->setEnabled( false );
+
+   le_status->setText( tr( "%1 parameters, %2 scans, %3 points;"
+                           "  best fit std.dev. %4" )
+                       .arg( nfpars ).arg( ndsets ).arg( ntpts )
+                       .arg( sqrt( qMax( variance, 0.0 ) ) ) );
+DbgLv(1) << "EMC: nfpars ntpts ndsets" << nfpars << ntpts << ndsets
+ << "variance" << variance;
+
+   if ( nfpars == 0  ||  ntpts == 0 )
+      pb_start->setEnabled( false );
+
+   adjustSize();
+}
+
+// Destructor:  stop and delete any running threads
+US_EqMonteCarlo::~US_EqMonteCarlo()
+{
+   for ( int ii = 0; ii < threads.size(); ii++ )
+      threads[ ii ]->abort();
+
+   for ( int ii = 0; ii < threads.size(); ii++ )
+      threads[ ii ]->wait();
+
+   qDeleteAll( threads );
+   threads.clear();
+}
+
+// Start (or stop) a Monte Carlo run
+void US_EqMonteCarlo::start_run()
+{
+   if ( threads.size() > 0 )
+   {
+      stop_run();
+      return;
+   }
+
+   int niters      = le_iters->text().toInt();
+   int nfpars      = mcdefs.nfpars;
+
+   if ( niters < 1 )
+   {
+      le_status->setText( tr( "The number of iterations must be positive." ) );
+      return;
+   }
+
+   uint seed       = le_seed->text().toUInt();
+   seed            = ( seed == 0 ) ? US_Math2::randomize() : seed;
+   le_seed->setText( QString::number( seed ) );
+
+   nthreads        = qMax( 1, qMin( (int)ct_threads->value(), niters ) );
+   nfailed         = 0;
+   nfinish         = 0;
+   mcdefs.niters   = niters;
+   mcdefs.seed     = seed;
+   mcdefs.noistype = rb_gauss->isChecked() ? 0 : 1;
+   mcpars .fill(  0.0, niters * nfpars );
+   mcvaris.fill( -1.0, niters );
+   done_its.clear();
+   next_iter.fetchAndStoreOrdered( 0 );
+
+   progress  ->setRange( 0, niters );
+   progress  ->reset();
+   te_results->clear();
+   pb_start  ->setText( tr( "Stop" ) );
+   pb_histo  ->setEnabled( true );
+   le_status ->setText( tr( "Monte Carlo refits begun with %1 threads ..." )
+                        .arg( nthreads ) );
+DbgLv(1) << "EMC: start_run niters nthreads seed" << niters << nthreads << seed;
+
+   timer .start();
+   ptimer.start();
+
+   for ( int ii = 0; ii < nthreads; ii++ )
+   {
+      US_EqMCThread* mcthr = new US_EqMCThread( dataList, scedits, scanfits,
+            runfit, &mcdefs, &next_iter, mcpars.data(), mcvaris.data() );
+
+      connect( mcthr, SIGNAL( iteration_done( int ) ),
+               this,  SLOT(   iteration_done( int ) ) );
+      connect( mcthr, SIGNAL( finished()            ),
+               this,  SLOT(   thread_done()         ) );
+
+      threads << mcthr;
+   }
+
+   for ( int ii = 0; ii < nthreads; ii++ )
+      threads[ ii ]->start();
+}
+
+// Stop a run:  threads finish their current refit
+void US_EqMonteCarlo::stop_run()
+{
+   for ( int ii = 0; ii < threads.size(); ii++ )
+      threads[ ii ]->abort();
+
+   pb_start ->setEnabled( false );
+   le_status->setText( tr( "Stopping after the current refits ..." ) );
+}
+
+// Record a completed refit and update progress and the histogram
+void US_EqMonteCarlo::iteration_done( int iter )
+{
+   done_its << iter;
+   int ndone   = done_its.size();
+
+   if ( mcvaris.at( iter ) < 0.0 )
+      nfailed++;
+
+   progress ->setValue( ndone );
+   le_status->setText( tr( "%1 of %2 refits completed (%3 failed)." )
+                       .arg( ndone ).arg( mcdefs.niters ).arg( nfailed ) );
+
+   // Stream the histogram at a rate the display can keep up with
+   if ( ehisto  &&  ptimer.elapsed() > 500 )
+   {
+      plot_param();
+      ptimer.restart();
+   }
+}
+
+// React to a thread finishing; complete the run when all are done
+void US_EqMonteCarlo::thread_done()
+{
+   if ( ++nfinish < threads.size() )
+      return;
+
+   run_complete();
+}
+
+// Clean up after a run and report its results
+void US_EqMonteCarlo::run_complete()
+{
+   for ( int ii = 0; ii < threads.size(); ii++ )
+      threads[ ii ]->wait();
+
+   qDeleteAll( threads );
+   threads.clear();
+
+   int ktimms  = timer.elapsed();
+DbgLv(1) << "EMC: run_complete ndone nfailed" << done_its.size() << nfailed
+ << "time(ms)" << ktimms;
+   pb_start ->setText( tr( "Start" ) );
+   pb_start ->setEnabled( true );
+   le_status->setText( tr( "%1 of %2 refits completed (%3 failed)"
+                           " in %4 seconds." )
+                       .arg( done_its.size() ).arg( mcdefs.niters )
+                       .arg( nfailed ).arg( ktimms / 1000.0 ) );
+
+   show_results();
+   plot_param();
+}
+
+// Open (or raise) the parameter histogram dialog
+void US_EqMonteCarlo::show_histogram()
+{
+   if ( ehisto )
+   {
+      ehisto->raise();
+   }
+
+   else
+   {
+      ehisto = new US_EqHistogram( cb_param->currentText(), this,
+                                   Qt::Window );
+      ehisto->show();
+   }
+
+   plot_param();
+}
+
+// React to a new histogram parameter selection
+void US_EqMonteCarlo::new_param( int )
+{
+   plot_param();
+}
+
+// Plot the histogram of the selected parameter
+void US_EqMonteCarlo::plot_param()
+{
+   if ( ! ehisto )
+      return;
+
+   int px      = cb_param->currentIndex();
+
+   ehisto->plot_values( cb_param->currentText(), param_values( px ) );
+}
+
+// Return the values of a parameter from all successful refits
+QVector< double > US_EqMonteCarlo::param_values( int px )
+{
+   QVector< double > pvals;
+   int nfpars  = mcdefs.nfpars;
+
+   if ( px < 0  ||  px >= nfpars )
+      return pvals;
+
+   for ( int ii = 0; ii < done_its.size(); ii++ )
+   {
+      int iter    = done_its[ ii ];
+
+      if ( mcvaris.at( iter ) >= 0.0 )
+         pvals << mcpars.at( iter * nfpars + px );
+   }
+
+   return pvals;
+}
+
+// Summarize the parameter distributions of the run
+void US_EqMonteCarlo::show_results()
+{
+   int nfpars  = mcdefs.nfpars;
+   int ngood   = done_its.size() - nfailed;
+   QString mtext = tr( "Monte Carlo Analysis:  %1 refits (%2 failed);"
+                       "  %3 noise;  seed %4\n\n" )
+                   .arg( done_its.size() ).arg( nfailed )
+                   .arg( mcdefs.noistype == 0 ? tr( "Gaussian" )
+                                              : tr( "bootstrap" ) )
+                   .arg( mcdefs.seed );
+
+   if ( ngood < 2 )
+   {
+      te_results->setPlainText( mtext + tr( "Too few successful refits"
+                                            " for statistics." ) );
+      return;
+   }
+
+   mtext      += QString( "%1 %2 %3 %4 %5 %6\n" )
+                 .arg( tr( "Parameter" ), -28 )
+                 .arg( tr( "Best Fit" ),  12 )
+                 .arg( tr( "Mean" ),      12 )
+                 .arg( tr( "Std.Dev." ),  12 )
+                 .arg( tr( "95% Low" ),   12 )
+                 .arg( tr( "95% High" ),  12 );
+
+   for ( int px = 0; px < nfpars; px++ )
+   {
+      QVector< double > pvals = param_values( px );
+      int    nvals   = pvals.size();
+      double psum    = 0.0;
+      double pvari   = 0.0;
+
+      for ( int ii = 0; ii < nvals; ii++ )
+         psum          += pvals[ ii ];
+
+      double pmean   = psum / (double)nvals;
+
+      for ( int ii = 0; ii < nvals; ii++ )
+         pvari         += sq( pvals[ ii ] - pmean );
+
+      double pstdd   = sqrt( pvari / (double)( nvals - 1 ) );
+
+      // Confidence limits from the 2.5 and 97.5 percentiles
+      qSort( pvals );
+      int    jlo     = qMax( 0, (int)( 0.025 * (double)nvals ) );
+      int    jhi     = qMin( nvals - 1, (int)( 0.975 * (double)nvals ) );
+
+      mtext         += QString( "%1 %2 %3 %4 %5 %6\n" )
+                       .arg( pnames[ px ], -28 )
+                       .arg( bguess[ px ], 12, 'g', 6 )
+                       .arg( pmean,        12, 'g', 6 )
+                       .arg( pstdd,        12, 'g', 6 )
+                       .arg( pvals[ jlo ], 12, 'g', 6 )
+                       .arg( pvals[ jhi ], 12, 'g', 6 );
+   }
+
+   te_results->setPlainText( mtext );
+}
+
+// Close:  stop any run first
+void US_EqMonteCarlo::closed()
+{
+   close();
+}
+
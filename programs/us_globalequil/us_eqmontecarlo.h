@@ -0,0 +1,152 @@
+#ifndef US_EQMONTECARLO_H
+#define US_EQMONTECARLO_H
+
+#include "us_extern.h"
+#include "us_widgets_dialog.h"
+#include "us_globeq_data.h"
+#include "us_eqmath.h"
+#include "us_eqhistogram.h"
+#include "us_fit_worker.h"
+#include "us_dataIO.h"
+
+#ifndef DbgLv
+#define DbgLv(a) if(dbg_level>=a)qDebug()
+#endif
+
+// Monte Carlo definitions shared (read-only) by all iteration threads
+typedef struct EqMCDefs_s
+{
+   int                 modelx;        // Model type index
+   int                 nlsmeth;       // NLS method index
+   int                 mxiters;       // Maximum fit iterations per refit
+   int                 niters;        // Number of Monte Carlo iterations
+   int                 noistype;      // Noise type: 0(Gaussian), 1(bootstrap)
+   int                 nfpars;        // Number of fit parameters
+   int                 ntpts;         // Number of total fit points
+   uint                seed;          // Random seed of the run
+   double              fittoler;      // Fit tolerance
+   double              lam_start;     // Lambda start
+   double              lam_step;      // Lambda step size
+   bool                lincnstr;      // Linear constraints flag
+   bool                autocnvg;      // Autoconverge flag
+   QVector< int >      setpts;        // Points in each fitted scan
+   QVector< double >   sigmas;        // Residuals std.dev. of each scan
+   QVector< double >   y_fit;         // Best-fit Y values
+   QVector< double >   y_res;         // Best-fit residuals
+} EqMCDefs;
+
+//! \brief Thread that refits synthetic data sets for Monte Carlo
+//!
+//! Each thread holds its own copies of the fit data and its own US_EqMath
+//! and US_FitWorker, so no fit state is shared. Iterations are handed out
+//! dynamically from a shared counter; each one's synthetic data comes from
+//! a random stream seeded by the iteration index, so the results do not
+//! depend on the number of threads.
+class US_EqMCThread : public QThread
+{
+   Q_OBJECT
+
+   public:
+      US_EqMCThread( QVector< US_DataIO::EditedData >&, QVector< ScanEdit >&,
+                     QVector< EqScanFit >&, EqRunFit&, const EqMCDefs*,
+                     QAtomicInt*, double*, double*, QObject* = 0 );
+
+      void abort( void );             // Flag that the thread should stop
+
+   signals:
+      void iteration_done( int );     // Signal an iteration's refit is done
+
+   protected:
+      virtual void run();
+
+   private:
+      QVector< US_DataIO::EditedData >  wdataList; // Data sets
+      QVector< ScanEdit >   wscedits;   // Scan edits
+      QVector< EqScanFit >  bscanfits;  // Best-fit scan fits
+      QVector< EqScanFit >  wscanfits;  // Work scan fits
+      EqRunFit              brunfit;    // Best-fit run fit
+      EqRunFit              wrunfit;    // Work run fit
+      const EqMCDefs*       mcdefs;     // Shared Monte Carlo definitions
+      QAtomicInt*           next_iter;  // Shared next-iteration counter
+      double*               mcpars;     // Shared parameters (iter x nfpars)
+      double*               mcvaris;    // Shared variances (-1 for failed)
+
+      int                   dbg_level;
+      volatile bool         abort_flag; // Flag to stop early
+
+      void synth_data  ( int );
+      void set_controls( FitCtrlPar& );
+};
+
+//! \brief Dialog to run a Monte Carlo analysis of a global equilibrium fit
+//!
+//! Synthetic data sets are made from the best fit plus noise based on the
+//! fit residuals, either Gaussian with each scan's residuals standard
+//! deviation or bootstrapped from each scan's residuals. Each is refit by
+//! a thread of a pool, and a histogram of a selected parameter is updated
+//! as the fits complete.
+class US_EqMonteCarlo : public US_WidgetsDialog
+{
+	Q_OBJECT
+
+	public:
+		US_EqMonteCarlo( QVector< US_DataIO::EditedData >&,
+         QVector< ScanEdit >&, QVector< EqScanFit >&, EqRunFit&,
+         const FitCtrlPar&, const QVector< double >& );
+
+      ~US_EqMonteCarlo();
+
+	private:
+      QVector< US_DataIO::EditedData >  dataList;  // Data sets
+      QVector< ScanEdit >   scedits;   // Scan edits
+      QVector< EqScanFit >  scanfits;  // Scan fits (at best fit)
+      EqRunFit              runfit;    // Run fit (at best fit)
+      FitCtrlPar            fitpars;   // Fit control parameters
+      QVector< double >     bguess;    // Best-fit parameter values
+      EqMCDefs              mcdefs;    // Monte Carlo definitions
+
+      QList< US_EqMCThread* >  threads;  // Running threads
+      QAtomicInt               next_iter;// Next iteration to refit
+      QVector< double >        mcpars;   // Refit parameters (iter x nfpars)
+      QVector< double >        mcvaris;  // Refit variances
+      QList< int >             done_its; // Iterations done, in order done
+      QPointer< US_EqHistogram > ehisto; // Parameter histogram dialog
+      QStringList              pnames;   // Parameter names
+
+      QLineEdit*         le_iters;
+      QLineEdit*         le_seed;
+      QLineEdit*         le_status;
+      QwtCounter*        ct_threads;
+      QRadioButton*      rb_gauss;
+      QRadioButton*      rb_boots;
+      QComboBox*         cb_param;
+      QProgressBar*      progress;
+      QTextEdit*         te_results;
+
+      QPushButton*       pb_start;
+      QPushButton*       pb_histo;
+      QPushButton*       pb_close;
+
+      QTime              timer;      // Run timer
+      QTime              ptimer;     // Histogram replot timer
+
+      int                dbg_level;
+      int                nthreads;   // Threads in the current run
+      int                nfailed;    // Refits that failed
+      int                nfinish;    // Threads finished
+
+   private slots:
+      void start_run     ( void );
+      void stop_run      ( void );
+      void iteration_done( int );
+      void thread_done   ( void );
+      void run_complete  ( void );
+      void show_histogram( void );
+      void new_param     ( int );
+      void plot_param    ( void );
+      void show_results  ( void );
+      void closed        ( void );
+      QVector< double > param_values( int );
+};
+#endif
+
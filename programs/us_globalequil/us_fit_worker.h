@@ -26,6 +26,7 @@ class US_FitWorker : public QThread
       void run          ( void );     // Run the thread
       void flag_paused  ( bool );     // Set pause flag true/false
       void flag_abort   ( void );     // Set abort flag true
+      int  fit_iterations( void );    // Main work method for fit iterations
 
    signals:
       void work_progress( int  );     // Signal work progress step
@@ -56,7 +57,6 @@ class US_FitWorker : public QThread
       bool        completed;          // Flag fitting completed
 
    private slots:
-      int    fit_iterations( void );    // Main work method for fit iterations
       int    fit_iter_LM  ( void );     // Fit iteration - Levenberg-Marquardt
       int    fit_iter_MGN ( void );     // Fit iteration - Modified Gauss-Newton
       int    fit_iter_HM  ( void );     // Fit iteration - Hybrid Method
@@ -719,6 +719,8 @@ DbgLv(1) << "FITTING_CONTROL()";
       efitctrl     = new US_EqFitControl( scanfits, runfit, edata, emath,
                                           ereporter, modelx, models,
                                           fit_widget, sscann );
+      connect( efitctrl, SIGNAL( fit_available( const FitCtrlPar& ) ),
+               this,     SLOT(   fit_available( const FitCtrlPar& ) ) );
 
       efitctrl->show();
    }
@@ -726,8 +728,45 @@ DbgLv(1) << "FITTING_CONTROL()";
 
 void US_GlobalEquil::load_fit( void )
 { DbgLv(1) << "LOAD_FIT()"; }
+
+// Open (or raise) a Monte Carlo dialog for the last completed fit
 void US_GlobalEquil::monte_carlo( void )
-{ DbgLv(1) << "MONTE_CARLO()"; }
+{
+DbgLv(1) << "MONTE_CARLO()";
+   if ( emcarlo )
+   {
+      emcarlo->raise();
+   }
+
+   else
+   {
+      emcarlo      = new US_EqMonteCarlo( dataList, scedits, scanfits, runfit,
+                                          mcfitpars, mcguess );
+      emcarlo->show();
+   }
+}
+
+// Save controls and parameters of a completed fit, for Monte Carlo
+void US_GlobalEquil::fit_available( const FitCtrlPar& fitpars )
+{
+DbgLv(1) << "FIT_AVAILABLE() nfpars" << fitpars.nfpars;
+   mcfitpars    = fitpars;
+   mcguess.clear();
+
+   for ( int ii = 0; ii < fitpars.nfpars; ii++ )
+      mcguess << fitpars.guess[ ii ];
+
+   if ( emcarlo )
+   {  // An open Monte Carlo dialog holds the previous fit (stopping any
+      //  run on close):  replace it with one for the new fit
+      emcarlo->close();
+      emcarlo      = new US_EqMonteCarlo( dataList, scedits, scanfits, runfit,
+                                          mcfitpars, mcguess );
+      emcarlo->show();
+   }
+
+   pb_monCarlo->setEnabled( true );
+}
 
 void US_GlobalEquil::float_params( void )
 {
@@ -873,6 +912,7 @@ void US_GlobalEquil::close_all( void )
 //DbgLv(1) << "CLOSE_ALL()";
    if ( model_widget )    emodctrl->close();
    if ( fit_widget )      efitctrl->close();
+   if ( emcarlo )         emcarlo->close();
    if ( emath != 0 )      delete emath;
    if ( ereporter != 0 )  delete ereporter;
 
@@ -13,6 +13,7 @@
 #include "us_eqreporter.h"
 #include "us_eqmath.h"
 #include "us_eqhistogram.h"
+#include "us_eqmontecarlo.h"
 
 #ifndef DbgLv
 #define DbgLv(a) if(dbg_level>=a)qDebug()
@@ -47,6 +48,10 @@ class US_GlobalEquil : public US_Widgets
       US_EqReporter*           ereporter;
       US_EqMath*               emath;
       US_EqHistogram*          ehisto;
+      QPointer< US_EqMonteCarlo > emcarlo;
+
+      FitCtrlPar               mcfitpars;  // Controls of the last fit
+      QVector< double >        mcguess;    // Parameters of the last fit
 
       QList< double >          speed_steps;
       QList< double >          aud_params;
@@ -141,6 +146,7 @@ class US_GlobalEquil : public US_Widgets
       void fitting_control   ( void );
       void load_fit          ( void );
       void monte_carlo       ( void );
+      void fit_available     ( const FitCtrlPar& );
       void float_params      ( void );
       void init_params       ( void );
       void close_all         ( void );
@@ -12,6 +12,7 @@ HEADERS       = us_globalequil.h      \
                 us_eqhistogram.h      \
                 us_eqfit_control.h    \
                 us_fit_worker.h       \
+                us_eqmontecarlo.h     \
                 us_long_messagebox.h
 
 SOURCES       = us_globalequil.cpp      \
@@ -23,5 +24,6 @@ SOURCES       = us_globalequil.cpp      \
                 us_eqhistogram.cpp      \
                 us_eqfit_control.cpp    \
                 us_fit_worker.cpp       \
+                us_eqmontecarlo.cpp     \
                 us_long_messagebox.cpp
 
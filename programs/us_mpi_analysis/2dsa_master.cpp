@@ -227,6 +227,7 @@ DbgLv(1) << " master loop-BOT:      wkst1 wkstn" << worker_status[1]
       int        sizes[ 4 ];
       MPI_Status status;
 
+      US_PROF_BEGIN( wait, "mpi.master_wait" );
       MPI_Recv( sizes,
                 4,
                 MPI_INT,
@@ -234,6 +235,7 @@ DbgLv(1) << " master loop-BOT:      wkst1 wkstn" << worker_status[1]
                 MPI_ANY_TAG,
                 my_communicator,
                 &status);
+      US_PROF_END( wait );
 
       worker = status.MPI_SOURCE;
 
@@ -311,6 +313,12 @@ DbgLv(0) << "InSol: nss nks" << s_pts << ff0_pts << nsstep << nkstep << "grid_re
       US_Solute::init_solutes( s_min,   s_max,   nsstep,
                                ff0_min, ff0_max, nkstep,
                                grid_reps, cnstff0, orig_solutes );
+
+      if ( adaptive_refine )
+      {  // Define the index of the grid for adaptive refinement
+         sol_grid.define( s_min,   s_max,   nsstep,
+                          ff0_min, ff0_max, nkstep, 0.0 );
+      }
 DbgLv(0) << "InSol:  s range" << s_min*1.e+13 << s_max*1.e+13 << "k range"
  << ff0_min << ff0_max;
 int j0=orig_solutes.count()-1;
@@ -826,10 +834,20 @@ void US_MPI_Analysis::iterate( void )
    max_experiment_size        = min_experiment_size;
 
    QVector< US_Solute > prev_solutes = simulation_values.solutes;
+   QList< QVector< US_Solute > > task_solutes;
 
-   for ( int i = 0; i < orig_solutes.size(); i++ )
+   if ( adaptive_refine  &&  data_sets[ 0 ]->model_file.isEmpty() )
+   {  // Adaptive refinement:  jobs of new grid points around the solutes
+      adaptive_tasks( prev_solutes, task_solutes );
+   }
+   else
+   {  // Otherwise, jobs of the original subgrids
+      task_solutes = orig_solutes;
+   }
+
+   for ( int i = 0; i < task_solutes.size(); i++ )
    {
-      job.solutes = orig_solutes[ i ];
+      job.solutes = task_solutes[ i ];
 
       // Add back all non-zero Solutes to each job
       // Ensure there are no duplicates
@@ -857,6 +875,37 @@ void US_MPI_Analysis::iterate( void )
    return;
 }
 
+// Build adaptive refinement jobs' solutes:  new grid points around solutes
+void US_MPI_Analysis::adaptive_tasks( QVector< US_Solute >& prev_solutes,
+                                      QList< QVector< US_Solute > >& task_sols )
+{
+   int level    = iterations - 1;   // Refinement level (1 at 2nd iteration)
+
+   if ( level == 1 )
+   {  // At the first refinement, the index holds just the original grid
+      sol_grid.clear();
+      sol_grid.add_solutes( orig_solutes );
+   }
+
+   // Get the grid points not yet simulated around the previous solutes
+   QVector< US_Solute > new_solutes = sol_grid.refine( prev_solutes, level );
+   int nnsol    = new_solutes.size();
+   int ktsize   = qMax( min_experiment_size, orig_solutes[ 0 ].size() );
+   int ntask    = qMax( 1, ( nnsol + ktsize - 1 ) / ktsize );
+   ktsize       = ( nnsol + ntask - 1 ) / ntask;
+
+   // Divide the new solutes evenly among jobs; the previous solutes are
+   //  added to each, and workers mostly have their simulations cached.
+   task_sols.clear();
+
+   for ( int ii = 0; ii < ntask; ii++ )
+      task_sols << new_solutes.mid( ii * ktsize, ktsize );
+
+   qDebug() << "++ Adaptive refinement level" << level << ":" << nnsol
+            << "new grid points around" << prev_solutes.size()
+            << "solutes, in" << ntask << "jobs";
+}
+
 // Submit a queued job
 void US_MPI_Analysis::submit( Sa_Job& job, int worker )
 {
@@ -26,6 +26,7 @@ void US_MPI_Analysis::_2dsa_worker( void )
 DbgLv(1) << "w:" << my_rank << ": ready sent";
 
       // Blocking -- Wait for instructions
+      US_PROF_BEGIN( wait, "mpi.worker_wait" );
       MPI_Recv( &job, // get masters' response
                 sizeof( job ),
                 MPI_BYTE,
@@ -33,6 +34,7 @@ DbgLv(1) << "w:" << my_rank << ": ready sent";
                 MPI_Job::TAG0,
                 my_communicator,
                 &status );        // status not used
+      US_PROF_END( wait );
 //if(my_rank==1)
 DbgLv(1) << "w:" << my_rank << ": job_recvd  length" << job.length
  << "command" << job.command;
@@ -46,6 +48,12 @@ DbgLv(1) << "w:" << my_rank << ": offs cnt" << offset << dataset_count;
       data_sets[ offset ]->run_data.meniscus  = meniscus_value;
       data_sets[ offset ]->simparams.meniscus = meniscus_value;
 
+      if ( adaptive_refine  &&  meniscus_value != cache_menisc )
+      {  // Cached simulations are only valid for a single meniscus
+         sim_cache.clear();
+         cache_menisc       = meniscus_value;
+      }
+
       switch( job.command )
       {
 
@@ -92,6 +100,7 @@ DbgLv(1) << "w:" << my_rank << ": sols size" << job.length;
 //*DEBUG*
 
                calc_residuals( offset, dataset_count, simulation_values );
+               US_PROF_MEMORY( "mpi.worker_rss_kb" );
 
                // Tell master we are sending back results
                int size[ 4 ] = { simulation_values.solutes.size(),
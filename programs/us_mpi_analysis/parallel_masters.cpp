@@ -52,6 +52,10 @@ DbgLv(1) << "COMM_SPLIT (g r m)" << my_group << group_rank << my_rank
    }
 
 DbgLv(1) << "Final-my_rank" << my_rank << " msecs=" << startTime.msecsTo(QDateTime::currentDateTime());
+   // The supervisor joined the profile gather before building the archive
+   if ( my_rank != 0 )
+      profile_output();
+
    MPI_Finalize();
    exit( 0 );
 }
@@ -326,6 +330,9 @@ DbgLv(1) << "SUPER:  Send next iter" << iter_wk << "gr ma tg" << jgroup << maste
    // In the parallel-masters case, the supervisor handles end-of-job
    //  messages and file creation.
 
+   // Collect profiling from all ranks, so it joins the job outputs
+   profile_output();
+
    // Get job end time (after waiting, so it has the greatest time stamp)
    US_Sleep::msleep( 900 );
    QDateTime endTime = QDateTime::currentDateTime();
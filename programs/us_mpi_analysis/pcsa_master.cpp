@@ -5,6 +5,7 @@
 #include "us_astfem_rsa.h"
 #include "us_simparms.h"
 #include "us_constants.h"
+#include "us_pcsa_lm.h"
 
 #define DbgTime() qDebug() << "TM:" << (startTime.msecsTo(QDateTime::currentDateTime())/1000.0)
 void US_MPI_Analysis::pcsa_master( void )
@@ -170,6 +171,10 @@ DbgLv(1) << "pcsa_mast: loop-BOT: ds" << current_dataset+1 << "data l m h"
          // Clean up mrecs of any empty-calculated-solutes records
          clean_mrecs( mrecs );
 
+         // Levenberg-Marquardt refinement of the best curves
+         lmrefine_pcsa();
+DbgLv(1) << "pcsa_mast: loop-BOT:   lmrefine_pcsa() complete";
+
          // Manage multiple data sets in a global fit
          if ( is_global_fit )
          {
@@ -222,6 +227,7 @@ if (jql>=0) {
       int        sizes[ 4 ];
 
 DbgLv(1) << "PM:Recv: 1:sizes" << 4;
+      US_PROF_BEGIN( wait, "mpi.master_wait" );
       MPI_Recv( sizes, 
                 4, 
                 MPI_INT,
@@ -229,6 +235,7 @@ DbgLv(1) << "PM:Recv: 1:sizes" << 4;
                 MPI_ANY_TAG,
                 my_communicator,
                 &status );
+      US_PROF_END( wait );
 DbgLv(1) << "PM:Recv:   sizes" << sizes[0] << sizes[1] << sizes[2] << sizes[3]
  << "statTAG" << status.MPI_TAG;
 
@@ -744,6 +751,98 @@ DbgLv(1) << "iter_p: plims_ds"
    iterations++;
 }
 
+// Refine the best model(s) with a Levenberg-Marquardt fit
+void US_MPI_Analysis::lmrefine_pcsa()
+{
+   int lmmxcall   = parameters.contains( "lm_mxcall" )
+                    ? parameters[ "lm_mxcall" ].toInt() : 0;
+DbgLv(1) << "lmrf: lmmxcall" << lmmxcall << "mrecs size" << mrecs.count();
+
+   if ( lmmxcall < 1  ||  mrecs.size() < 2 )
+      return;
+
+   int    ctype   = mrecs[ 0 ].ctype;
+   int    stype   = US_ModelRecord::stype_flag( parameters[ "solute_type" ] );
+   int    nlpts   = parameters[ "curves_points" ].toInt();
+   int    mxrefs  = parameters.contains( "lm_refines" )
+                    ? qMax( 1, parameters[ "lm_refines" ].toInt() ) : 1;
+   double x_min   = parameters[ "x_min"   ].toDouble();
+   double x_max   = parameters[ "x_max"   ].toDouble();
+   double y_min   = parameters[ "y_min"   ].toDouble();
+   double y_max   = parameters[ "y_max"   ].toDouble();
+   double zval    = parameters[ "z_value" ].toDouble();
+   bool   LnType  = ( ctype == CTYPE_SL  ||  ctype == CTYPE_HL );
+
+   if ( ( ctype & ( CTYPE_SL | CTYPE_IS | CTYPE_DS | CTYPE_HL ) ) == 0 )
+      return;                   // Only simple curve types are refined
+
+   double minyv   = y_max;
+   double maxyv   = y_min;
+   double minp1   = LnType ? minyv : 0.5;
+   double maxp1   = LnType ? maxyv : 0.001;
+   double minp2   = LnType ? minyv : 1.0;
+   double maxp2   = LnType ? maxyv : 0.0;
+   double minp3   =  9.99e+22;
+   double maxp3   = -9.99e+22;
+   US_ModelRecord::elite_limits( mrecs, ctype, minyv, maxyv,
+                                 minp1, maxp1, minp2, maxp2, minp3, maxp3 );
+
+   // Gather the top records of the best model's curve type
+   QVector< US_ModelRecord >   lmrecs;
+   QVector< US_LM::LM_Status > lmstats;
+
+   for ( int ii = 0; ii < mrecs.size()  &&  lmrecs.size() < mxrefs; ii++ )
+   {
+      if ( mrecs[ ii ].ctype == ctype )
+         lmrecs << mrecs[ ii ];
+   }
+
+   US_PcsaLM pcsa_lm( data_sets, current_dataset, datasets_to_process,
+                      ctype, stype, nlpts );
+   int    npar    = pcsa_lm.npars();
+   US_LM::LM_Control control( 1.e-5, 1.e-5, 1.e-5, 1.e-5,
+                              100., lmmxcall / ( npar + 1 ), 0, 0 );
+
+   if ( ctype == CTYPE_IS )
+      control.epsilon = mrecs[ 0 ].rmsd * 8.0e-5;
+   else if ( ctype == CTYPE_DS )
+   {
+      control.ftol    = 1.e-16;
+      control.xtol    = 1.e-16;
+      control.gtol    = 1.e-16;
+      control.epsilon = 1.e-4;
+   }
+
+   pcsa_lm.set_extents( x_min, x_max, y_min, y_max );
+   pcsa_lm.set_limits ( minyv, maxyv, minp1, maxp1, minp2, maxp2 );
+   pcsa_lm.set_options( simulation_values.noisflag, 0.0, zval );
+
+   pcsa_lm.refine_all( lmrecs, control, lmstats );
+
+   // Put the best refined record at the top of the list
+   int    bestx   = 0;
+
+   for ( int ii = 1; ii < lmrecs.size(); ii++ )
+   {
+      if ( lmrecs[ ii ].rmsd < lmrecs[ bestx ].rmsd )
+         bestx          = ii;
+   }
+
+   if ( lmrecs[ bestx ].csolutes.size() == 0  ||
+        lmrecs[ bestx ].rmsd >= mrecs[ 0 ].rmsd )
+   {
+      qDebug() << "Levenberg-Marquardt refinement: no improvement on RMSD"
+               << mrecs[ 0 ].rmsd;
+      return;
+   }
+
+   mrecs.insert( 0, lmrecs[ bestx ] );
+
+   qDebug() << "Levenberg-Marquardt refinement RMSD" << mrecs[ 0 ].rmsd
+            << "par1 par2" << mrecs[ 0 ].par1 << mrecs[ 0 ].par2
+            << "nfev" << lmstats[ bestx ].nfev;
+}
+
 // Engineer Tikhonov Regularization for PCSA
 void US_MPI_Analysis::tikreg_pcsa()
 {
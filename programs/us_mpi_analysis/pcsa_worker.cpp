@@ -28,6 +28,7 @@ DbgLv(1) << "w:" << my_rank << ": pcsa_worker IN";
       // Blocking -- Wait for instructions
 //if(my_rank==1)
 DbgLv(1) << "w:" << my_rank << ":PM:Recv: 1:job" << sizeof(job);
+      US_PROF_BEGIN( wait, "mpi.worker_wait" );
       MPI_Recv( &job, // get masters' response
                 sizeof( job ),
                 MPI_BYTE,
@@ -35,6 +36,7 @@ DbgLv(1) << "w:" << my_rank << ":PM:Recv: 1:job" << sizeof(job);
                 MPI_Job::TAG0,
                 my_communicator,
                 &status );        // status not used
+      US_PROF_END( wait );
 //if(my_rank==1)
 DbgLv(1) << "w:" << my_rank << ": job_recvd  length" << job.length
  << "command" << job.command;
@@ -98,6 +100,7 @@ DbgLv(1) << "w:" << my_rank << ":PM:Recv: 2:zsol" << job_length*zsolut_doubles;
 //*DEBUG*
 
                calc_residuals( offset, dataset_count, simulation_values );
+               US_PROF_MEMORY( "mpi.worker_rss_kb" );
 
 //*DEBUG*
 //if(my_rank==1)
@@ -44,6 +44,8 @@ US_MPI_Analysis::US_MPI_Analysis( int nargs, QStringList& cmdargs ) : QObject()
 
    dbg_level    = 0;
    dbg_timing   = false;
+   adaptive_refine = false;
+   cache_menisc = 0.0;
    maxrss       = 0L;
    minimize_opt = 2;
    in_gsm       = false;
@@ -939,6 +941,9 @@ void US_MPI_Analysis::start( void )
           pcsa_worker();
    }
 
+   // Collect profiling from all ranks, so it joins the job outputs
+   profile_output();
+
    int exit_status = 0;
 
    // Pack results
@@ -1149,6 +1154,65 @@ void US_MPI_Analysis::stats_output( int walltime, int cputime, int maxrssmb,
    return;
 }
 
+// Gather profiling data of all ranks and write profile output files
+void US_MPI_Analysis::profile_output( void )
+{
+   if ( ! US_Profiler::enabled() )
+      return;
+
+   US_PROF_MEMORY( "mpi.rss_end_kb" );
+
+   // Gather the packed profile texts of all ranks to rank 0
+   QByteArray   pack  = US_Profiler::serialize( my_rank );
+   int          plen  = pack.size();
+   QVector< int > plens ( proc_count, 0 );
+   QVector< int > displs( proc_count, 0 );
+
+   MPI_Gather( &plen, 1, MPI_INT, plens.data(), 1, MPI_INT,
+               0, MPI_COMM_WORLD );
+
+   int ptotal   = 0;
+   for ( int ii = 0; ii < proc_count; ii++ )
+   {
+      displs[ ii ] = ptotal;
+      ptotal      += plens[ ii ];
+   }
+
+   QByteArray   allpk( qMax( ptotal, 1 ), '\0' );
+
+   MPI_Gatherv( pack.data(), plen, MPI_CHAR,
+                allpk.data(), plens.data(), displs.data(), MPI_CHAR,
+                0, MPI_COMM_WORLD );
+
+   if ( my_rank != 0 )
+      return;
+
+   QList< QByteArray > packs;
+   for ( int ii = 0; ii < proc_count; ii++ )
+      packs << allpk.mid( displs[ ii ], plens[ ii ] );
+
+   // Write statistics (and trace) files and list them with the outputs
+   QStringList pfiles;
+   if ( US_Profiler::write_json( "profile_stats.json", packs ) )
+      pfiles << "profile_stats.json";
+
+   if ( US_Profiler::tracing()  &&
+        US_Profiler::write_trace( "profile_trace.json", packs ) )
+      pfiles << "profile_trace.json";
+
+   DbgLv(0) << "Profile:" << proc_count << "ranks\n"
+            << qPrintable( US_Profiler::report( packs ) );
+
+   QFile f( "analysis_files.txt" );
+   if ( f.open( QIODevice::WriteOnly | QIODevice::Text | QIODevice::Append ) )
+   {
+      QTextStream out( &f );
+      for ( int ii = 0; ii < pfiles.size(); ii++ )
+         out << pfiles[ ii ] << "\n";
+      f.close();
+   }
+}
+
 // Insure vertexes of a bucket do not exceed physically possible limits
 void US_MPI_Analysis::limitBucket( Bucket& buk )
 {
@@ -1278,6 +1342,10 @@ if ( do_dbg )
 
    US_SolveSim solvesim( data_sets, my_rank, false );
 
+   if ( adaptive_refine  &&  group_rank > 0  &&
+        analysis_type.startsWith( "2DSA" ) )
+      solvesim.set_cache( &sim_cache );   // 2DSA workers reuse simulations
+
 //*DEBUG*
 int dbglvsv=simu_values.dbg_level;
 simu_values.dbg_level=(dbglvsv>1||my_rank<0)?dbglvsv:0;
@@ -2301,9 +2369,10 @@ DbgLv(0) << my_rank << ":       model2.description" << model2.description;
       fileo.close();
    }
 
-   // Create the archive file containing all outputs
+   // Create or update the archive file containing all outputs,
+   //  appending only the files that are new or changed
    US_Tar tar;
-   tar.create( "analysis-results.tar", files );
+   tar.update( "analysis-results.tar", files );
 for(int jf=0;jf<files.size();jf++)
  DbgLv(0) << my_rank << "   tar file" << jf << ":" << files[jf];
 
@@ -14,6 +14,7 @@
 #include "us_solve_sim.h"
 #include "us_vector.h"
 #include "us_math2.h"
+#include "us_profiler.h"
 
 #define SIMULATION       US_SolveSim::Simulation
 #define DATASET          US_SolveSim::DataSet
@@ -52,6 +53,7 @@ class US_MPI_Analysis : public QObject
     int                 total_points;
     int                 dbg_level;
     bool                dbg_timing;
+    bool                adaptive_refine;
     bool                glob_runid;
     bool                do_astfem;
     bool                is_global_fit;
@@ -178,6 +180,10 @@ class US_MPI_Analysis : public QObject
     QVector< US_Solute >           ljob_solutes;
     QList< QVector< US_ZSolute > > orig_zsolutes;
 
+    US_SoluteGrid                  sol_grid;      // Adaptive grid index
+    US_SolveSim::SimCache          sim_cache;     // Worker simulations cache
+    double                         cache_menisc;  // Meniscus of cached sims
+
     class Sa_Job
     {
        public:
@@ -327,6 +333,8 @@ class US_MPI_Analysis : public QObject
     void     shutdown_all      ( void );
     void     write_noise       ( US_Noise::NoiseType, const QVector< double>& );
     void     iterate           ( void );
+    void     adaptive_tasks    ( QVector< US_Solute >&,
+                                 QList< QVector< US_Solute > >& );
     void     set_meniscus      ( void );
     void     set_monteCarlo    ( void );
     void     write_output      ( void );
@@ -338,6 +346,7 @@ class US_MPI_Analysis : public QObject
     void     write_superg      ( const SIMULATION&, US_Model::AnalysisType );
     void     stats_output      ( int, int, int,
                                  QDateTime, QDateTime, QDateTime );
+    void     profile_output    ( void );
     void     pm_2dsa_master    ( void );
     void     pm_ga_master      ( void );
     void     pm_dmga_master    ( void );
@@ -430,6 +439,7 @@ class US_MPI_Analysis : public QObject
     void    process_pcsa_solutes( Result& );
     void    write_mrecs         ( void );
     void    iterate_pcsa        ( void );
+    void    lmrefine_pcsa       ( void );
     void    tikreg_pcsa         ( void );
     void    montecarlo_pcsa     ( void );
     void    pcsa_best_model     ( void );
@@ -293,6 +293,14 @@ if (my_rank==0) DbgLv(0) << "PF:   DC_model" << parameters[name] << name;
       US_Settings::set_us_debug( dbglv );
       dbg_timing = ( parameters.contains( "debug_timings" )
                  &&  parameters[ "debug_timings" ].toInt() != 0 );
+
+      // Adaptive refinement iterations of a uniform 2DSA grid
+      adaptive_refine = ( parameters.contains( "adaptive_refine" )
+                      &&  parameters[ "adaptive_refine" ].toInt() != 0 );
+
+      // Profiling:  0 (off), 1 (statistics), 2 (statistics and trace)
+      if ( parameters.contains( "profile" ) )
+         US_Profiler::set_mode( parameters[ "profile" ].toInt() );
    }
 }
 
@@ -955,38 +955,54 @@ QDateTime time2=QDateTime::currentDateTime();
 
    int narows     = klambda;
 DbgLv(1) << "sfd: narows kscan inclsize" << narows << kscan << inclscns.size();
-
-   for ( int ii = 0; ii < kscan; ii++ )
-   {  // Loop through non-excluded scans
-      int js         = inclscns[ ii ];
-      int jr         = radxs;
+   // Solve the points of groups of scans in batches sharing the A matrix
+   int nsgrp      = qMax( 1, ( 1 << 22 ) / qMax( 1, kradii * klambda ) );
+   nsgrp          = qMin( nsgrp, kscan );
+   QVector< double > bbatch( nsgrp * kradii * klambda );
+   QVector< double > xbatch( nsgrp * kradii * nspecies );
+   int nfull      = 0;
+
+   for ( int is1 = 0; is1 < kscan; is1 += nsgrp )
+   {  // Loop through groups of non-excluded scans
+      int is2        = qMin( is1 + nsgrp, kscan );
+      double* bb     = bbatch.data();
+
+      for ( int ii = is1; ii < is2; ii++ )
+      {  // Loop through scans of the group
+         int js         = inclscns[ ii ];
+         int jr         = radxs;
 DbgLv(1) << "sfd: sc" << ii << "js jr" << js << jr;
 
-      for ( int jj = krpad; jj < kradp; jj++, jr++ )
-      {  // Loop through radius values
-         int trx        = trpxs + lmbxs;
-         nnls_a         = sv_nnls_a;
-
-         for ( int kk = 0; kk < klambda; kk++, trx++ )
-         {  // Store scan,radius reading for each wavelength in channel
-//            nnls_b[ kk ]   = rawList[ trx ].value( js, jr );
-            nnls_b[ kk ]   = dataList[ trx ].value( js, jr );
+         for ( int jj = krpad; jj < kradp; jj++, jr++ )
+         {  // Loop through radius values
+            int trx        = trpxs + lmbxs;
+
+            for ( int kk = 0; kk < klambda; kk++, trx++ )
+            {  // Store scan,radius reading for each wavelength in channel
+               *(bb++)        = dataList[ trx ].value( js, jr );
+            }
          }
-DbgLv(1) << "sfd: NNLS b:" << nnls_b[0] << nnls_b[klambda-1];
+      }
 
-         // Fit using NNLS to compute X value for each species
-         US_Math2::nnls( nnls_a.data(), narows, narows, nspecies,
-                         nnls_b.data(), nnls_x.data() );
-DbgLv(1) << "sfd:  NNLS  ii jj kl" << ii << jj << klambda
- << " x:" << nnls_x[0] << nnls_x[nspecies-1];
+      // Fit using NNLS to compute X value for each species at each point
+      int nrhs       = ( is2 - is1 ) * kradii;
+      nfull         += US_Math2::nnls_batch( sv_nnls_a.data(), narows,
+                          nspecies, nrhs, bbatch.data(), xbatch.data() );
+      double* xx     = xbatch.data();
 
-         // Set scan,radius value in each species data set
-         kd             = kdstart;
-         for ( int mm = 0; mm < nspecies; mm++, kd++ )
-         {
-            synData[ kd ].setValue( ii, jj, nnls_x[ mm ] );
+      for ( int ii = is1; ii < is2; ii++ )
+      {
+         for ( int jj = krpad; jj < kradp; jj++ )
+         {  // Set scan,radius value in each species data set
+            kd             = kdstart;
+            for ( int mm = 0; mm < nspecies; mm++, kd++ )
+            {
+               synData[ kd ].setValue( ii, jj, *(xx++) );
+            }
          }
       }
+DbgLv(1) << "sfd:  NNLS  scans" << is1 << is2 << "nrhs" << nrhs
+ << "x:" << xbatch[0] << xbatch[nspecies-1] << "nfull" << nfull;
    }
 QDateTime time3=QDateTime::currentDateTime();
 nnls_a=sv_nnls_a;
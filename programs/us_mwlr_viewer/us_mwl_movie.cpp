@@ -0,0 +1,194 @@
+//! \file us_mwl_movie.cpp
+
+#include <QApplication>
+
+#include "us_mwl_movie.h"
+#include "us_mwlr_viewer.h"
+
+// Create the movie frame builder
+US_MwlMovieFrames::US_MwlMovieFrames( US_MwlRawViewer* a_viewer,
+      const QVector< int >& a_fids, const bool a_is3d, QObject* parent )
+   : QThread( parent )
+{
+   viewer      = a_viewer;
+   frame_ids   = a_fids;
+   is3d        = a_is3d;
+   abort       = false;
+   nbuilt      = 0;
+   ntaken      = 0;
+   bfirst      = 0;
+
+   // Buffer two batches of one frame per thread
+   capacity    = qMin( US_Parallel::threads() * 2, frame_ids.size() );
+   capacity    = qMax( capacity, 1 );
+
+   if ( is3d )
+      ring3d.resize( capacity );
+   else
+      ring2d.resize( capacity );
+}
+
+// Stop building and wait for the thread to finish
+US_MwlMovieFrames::~US_MwlMovieFrames()
+{
+   mutex.lock();
+   abort       = true;
+   frame_taken.wakeAll();
+   mutex.unlock();
+
+   wait();
+}
+
+// Build the frames in batches, waiting while the ring is full
+void US_MwlMovieFrames::run( void )
+{
+   int nframe  = frame_ids.size();
+   int nbatch  = qMax( capacity / 2, 1 );
+
+   for ( int fx = 0; fx < nframe; fx += nbatch )
+   {
+      int kframe  = qMin( nbatch, nframe - fx );
+
+      mutex.lock();
+
+      while ( ! abort  &&  ( fx + kframe - ntaken ) > capacity )
+         frame_taken.wait( &mutex );
+
+      bool stop   = abort;
+      mutex.unlock();
+
+      if ( stop )
+         break;
+
+      bfirst      = fx;
+      US_Parallel::run( this, kframe );
+
+      mutex.lock();
+      nbuilt      = fx + kframe;
+      frame_built.wakeAll();
+      mutex.unlock();
+   }
+}
+
+// Build a block of the current batch, each frame into its ring slot
+void US_MwlMovieFrames::run_range( int begin, int end, int )
+{
+   for ( int ii = begin; ii < end; ii++ )
+   {
+      int fx      = bfirst + ii;
+      int slot    = fx % capacity;
+
+      if ( is3d )
+         viewer->build_xyz_frame( frame_ids[ fx ], ring3d[ slot ] );
+      else
+         viewer->build_avg_frame( frame_ids[ fx ], ring2d[ slot ] );
+   }
+}
+
+// Take the next frame, keeping the GUI alive while waiting for it
+bool US_MwlMovieFrames::next_frame( QVector< double >* adata,
+                                    QVector< QVector3D >* xyzd )
+{
+   int nframe  = frame_ids.size();
+   mutex.lock();
+
+   while ( ntaken >= nbuilt  &&  ntaken < nframe )
+   {
+      mutex.unlock();
+      qApp->processEvents();
+      mutex.lock();
+
+      if ( ntaken >= nbuilt )
+         frame_built.wait( &mutex, 50 );
+   }
+
+   if ( ntaken >= nframe )
+   {
+      mutex.unlock();
+      return false;
+   }
+
+   int slot    = ntaken % capacity;
+
+   if ( adata != NULL )
+      *adata      = ring2d[ slot ];
+
+   if ( xyzd != NULL )
+      *xyzd       = ring3d[ slot ];
+
+   ntaken++;
+   frame_taken.wakeAll();
+   mutex.unlock();
+
+   return true;
+}
+
+// Task that saves one frame image
+class US_MwlFrameSave : public QRunnable
+{
+   public:
+      US_MwlFrameSave( const QImage& a_image, const QString& a_fpath,
+                       QSemaphore* a_slots, QAtomicInt* a_nfail )
+         : image( a_image ), fpath( a_fpath ),
+           slots( a_slots ), nfail( a_nfail ) {}
+
+      void run()
+      {
+         if ( ! image.save( fpath ) )
+            nfail->fetchAndAddOrdered( 1 );
+
+         image        = QImage();
+         slots->release();
+      }
+
+   private:
+      QImage       image;
+      QString      fpath;
+      QSemaphore*  slots;
+      QAtomicInt*  nfail;
+};
+
+// Create the frame writer with its own pool of encoder threads
+US_MwlFrameWriter::US_MwlFrameWriter( int nthreads )
+{
+   nthreads    = US_Parallel::threads( nthreads );
+   nfail       = 0;
+
+   pool .setMaxThreadCount( nthreads );
+   slots.release( nthreads * 2 );
+}
+
+// Wait for any images still being saved
+US_MwlFrameWriter::~US_MwlFrameWriter()
+{
+   pool.waitForDone();
+}
+
+// Queue an image to be saved, waiting (with GUI events) for a free slot
+void US_MwlFrameWriter::save( const QImage& image, const QString& fpath )
+{
+   while ( ! slots.tryAcquire( 1, 50 ) )
+      qApp->processEvents();
+
+   pool.start( new US_MwlFrameSave( image, fpath, &slots, &nfail ) );
+}
+
+// Wait until all queued images are saved and return the failure count
+int US_MwlFrameWriter::finish( void )
+{
+   while ( ! pool.waitForDone( 50 ) )
+      qApp->processEvents();
+
+   return (int)nfail;
+}
+
+// Render a widget into an image, as US_GuiUtil::save_png() does
+QImage US_MwlFrameWriter::grab( QWidget* widget )
+{
+#if QT_VERSION > 0x050000
+   return widget->grab().toImage();
+#else
+   return QPixmap::grabWidget( widget, 0, 0,
+                               widget->width(), widget->height() ).toImage();
+#endif
+}
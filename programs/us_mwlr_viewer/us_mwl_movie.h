@@ -0,0 +1,111 @@
+//! \file us_mwl_movie.h
+#ifndef US_MWL_MOVIE_H
+#define US_MWL_MOVIE_H
+
+#include <QtCore>
+#include <QtGui>
+#include <QVector3D>
+
+#include "us_parallel.h"
+
+class US_MwlRawViewer;
+
+//! \brief Builder of MWL movie frame data ahead of playback
+
+/*! \class US_MwlMovieFrames
+ *
+    This thread builds the data of movie frames, in order, into a bounded
+    ring buffer. Each batch of frames is built in parallel over the thread
+    pool, and the thread waits whenever the buffer is full, so memory use
+    is bounded however long the movie. A 2-D frame is the averaged data of
+    a plot record; a 3-D frame is the XYZ data of a scan. The consumer
+    (the GUI thread) takes frames with next_frame(), which processes GUI
+    events while it waits for a frame to be built.
+
+    Frames are built from the viewer's live data, ranges and excludes, not
+    from a snapshot; so the viewer disables its data and range controls
+    (US_MwlRawViewer::hold_controls) for the length of a movie.
+*/
+class US_MwlMovieFrames : public QThread, public US_RangeTask
+{
+   public:
+      //! \brief Create the frame builder
+      //! \param viewer   Viewer whose current ranges define the frames
+      //! \param fids     Record (2-D) or scan (3-D) index of each frame
+      //! \param is3d     Flag:  build 3-D frames
+      //! \param parent   Parent object
+      US_MwlMovieFrames( US_MwlRawViewer*, const QVector< int >&,
+                         const bool, QObject* = 0 );
+
+      //! \brief Stop building and wait for the thread to finish
+      ~US_MwlMovieFrames();
+
+      //! \brief Build all frames, batch by batch, as buffer space allows
+      void run( void );
+
+      //! \brief Build a block of frames of the current batch
+      void run_range( int, int, int );
+
+      //! \brief Take the next frame, waiting for it if need be
+      //! \param adata  Returned 2-D frame data (or NULL for 3-D)
+      //! \param xyzd   Returned 3-D frame data (or NULL for 2-D)
+      //! \returns      Flag:  false if all frames have been taken
+      bool next_frame( QVector< double >*, QVector< QVector3D >* );
+
+   private:
+      US_MwlRawViewer*                viewer;     // Viewer building frames
+      QVector< int >                  frame_ids;  // Index of each frame
+      QVector< QVector< double > >    ring2d;     // Ring of 2-D frame data
+      QVector< QVector< QVector3D > > ring3d;     // Ring of 3-D frame data
+
+      QMutex          mutex;        // Guard for the counts below
+      QWaitCondition  frame_built;  // Signals that frames were built
+      QWaitCondition  frame_taken;  // Signals that a slot was freed
+
+      bool            is3d;         // Flag:  3-D frames
+      bool            abort;        // Flag:  stop building
+      int             capacity;     // Number of slots in the ring
+      int             nbuilt;       // Count of frames built
+      int             ntaken;       // Count of frames taken
+      int             bfirst;       // First frame of the current batch
+};
+
+//! \brief Writer of movie frame images on a pool of encoder threads
+
+/*! \class US_MwlFrameWriter
+ *
+    Frame images are grabbed on the GUI thread and handed to this writer,
+    which compresses and saves each one on its own pool of threads. The
+    number of images waiting to be saved is bounded, so that grabbing
+    does not outrun the encoders.
+*/
+class US_MwlFrameWriter
+{
+   public:
+      //! \brief Create the frame writer
+      //! \param nthreads  Number of encoder threads (0 for default)
+      US_MwlFrameWriter( int = 0 );
+
+      //! \brief Wait for any images still being saved
+      ~US_MwlFrameWriter();
+
+      //! \brief Queue an image to be saved to a file
+      //! \param image  Image to save
+      //! \param fpath  Full path to the image file
+      void save  ( const QImage&, const QString& );
+
+      //! \brief Wait until all queued images are saved
+      //! \returns      Count of images that could not be saved
+      int  finish( void );
+
+      //! \brief Grab a widget (such as a 2-D plot) to an image off-screen
+      //! \param widget Widget to render
+      //! \returns      Rendered image
+      static QImage grab( QWidget* );
+
+   private:
+      QThreadPool pool;     // Encoder threads
+      QSemaphore  slots;    // Free slots for queued images
+      QAtomicInt  nfail;    // Count of failed saves
+};
+#endif
@@ -1124,14 +1124,20 @@ void US_MwlRawViewer::plot_titles( void )
 // Draw scan curves for the current plot record
 void US_MwlRawViewer::plot_all( void )
 {
-   dataPlotClear( data_plot );
-   grid           = us_grid( data_plot );
-
    // Make sure ranges are set up, then build an averaged data vector
    compute_ranges();
 
    build_avg_data();
 
+   plot_avg_data();
+}
+
+// Draw scan curves from the current averaged data
+void US_MwlRawViewer::plot_avg_data( void )
+{
+   dataPlotClear( data_plot );
+   grid           = us_grid( data_plot );
+
 DbgLv(1) << "PltA: kpoint" << kpoint << "datsize" << curr_adata.size();
    // Build the X,Y vectors
    QVector< double > rvec( kpoint );
@@ -1144,6 +1150,7 @@ DbgLv(1) << "PltA: kpoint" << kpoint << "datsize" << curr_adata.size();
    int     scan_nbr  = 0;
    QPen    pen_red ( Qt::red );
    QPen    pen_plot( US_GuiSettings::plotCurve() );
+   QList< US_PlotLodCurve* > lcurves;
    int     rdx       = 0;
 
    for ( int ptx = 0; ptx < kpoint; ptx++ )   // One-time build of X vector
@@ -1161,18 +1168,21 @@ DbgLv(1) << "PltA: kpoint" << kpoint << "datsize" << curr_adata.size();
       scan_nbr++;
       QString       title = tr( "Raw Data at scan " )
                             + QString::number( scan_nbr );
-      QwtPlotCurve* curv  = us_curve( data_plot, title );
+      US_PlotLodCurve* curv = new US_PlotLodCurve( data_plot, title );
 
       if ( scan_nbr > scan_to  ||  scan_nbr < scan_from )
          curv->setPen( pen_plot );            // Normal pen
       else
          curv->setPen( pen_red  );            // Scan-focus pen
 
-      curv->setSamples( rr, vv, kpoint );     // Build a scan curve
+      curv->setLodData( rr, vv, kpoint );     // Build a scan curve
+      lcurves << curv;
 //DbgLv(1) << "PltA:   scx" << scx << "rr0 vv0 rrn vvn"
 // << rr[0] << rr[kpoint-1] << vv[0] << vv[kpoint-1];
    }
 
+   US_PlotLodCurve::build_levels( lcurves );
+
 DbgLv(1) << "PltA: last_xmin" << last_xmin;
    if ( last_xmin < 0.0 )
    {  // If first time, use auto scale to set plot ranges
@@ -1697,16 +1707,96 @@ DbgLv(1) << "Show 2D Movie";
    int svrec       = recx;                  // Save currently plotted record
    changeCellCh();                          // Force save of scales
 
+   // Build the averaged data of records ahead of playback
+   QVector< int >    frecs;
+   QVector< double > fdata;
+
+   for ( int prx = 0; prx < krecs; prx++ )
+      frecs << prx;
+
+   hold_controls( true );                   // Hold data fixed for frames
+   US_MwlMovieFrames frames( this, frecs, false );
+   frames.start();
+
    for ( int prx = 0; prx < krecs; prx++ )
    {
-      cb_pltrec->setCurrentIndex( prx );    // Plot each record in the range
+      if ( ! frames.next_frame( &fdata, NULL ) )
+         break;
+
+      curr_adata      = fdata;
+      plot_frame_2d( prx );                 // Plot each record in the range
       qApp->processEvents();
    }
 
+   frames.wait();
+   hold_controls( false );
    cb_pltrec->setCurrentIndex( svrec );     // Restore previous plot record
    qApp->processEvents();
 }
 
+// Plot a 2-D movie frame from averaged data already in place
+void US_MwlRawViewer::plot_frame_2d( const int prx )
+{
+   recx            = prx;
+   cb_pltrec->blockSignals( true );
+   cb_pltrec->setCurrentIndex( prx );
+   cb_pltrec->blockSignals( false );
+
+   plot_titles();
+   plot_avg_data();
+}
+
+// Return the indexes of the included, in-range scans of a 3-D movie
+QVector< int > US_MwlRawViewer::movie_scans( void )
+{
+   QVector< int > scans;
+   int fscnx       = -1;
+   int lscnx       = -1;
+
+   live_scan( &fscnx, &lscnx );
+
+   for ( int scnx = fscnx; scnx <= lscnx  &&  scnx >= 0; scnx++ )
+   {
+      if ( ! excludes.contains( scnx ) )
+         scans << scnx;
+   }
+
+   return scans;
+}
+
+// Disable the data and range controls for the length of a movie, then
+//   restore them.  Frames are built in worker threads from the loaded data,
+//   ranges and excludes, so none of these may change during playback.
+void US_MwlRawViewer::hold_controls( const bool hold )
+{
+   QList< QWidget* > ctrls;
+   ctrls << pb_loadMwl << pb_loadAUC << pb_reset   << pb_details
+         << cb_cellchn << cb_rstart  << cb_rend    << cb_lstart
+         << cb_lend    << ct_recavg  << ck_xwavlen << cb_pltrec
+         << pb_prev    << pb_next    << ct_from    << ct_to
+         << pb_exclude << pb_include << pb_plot2d  << pb_movie2d
+         << pb_plot3d  << pb_movie3d << pb_svplot  << pb_svmovie;
+
+   if ( hold )
+   {  // Save the enable state of each control, then disable it
+      held_enabs.clear();
+
+      for ( int ii = 0; ii < ctrls.size(); ii++ )
+      {
+         held_enabs << ctrls[ ii ]->isEnabled();
+         ctrls[ ii ]->setEnabled( false );
+      }
+   }
+
+   else
+   {  // Restore each control's saved enable state
+      for ( int ii = 0; ii < held_enabs.size(); ii++ )
+         ctrls[ ii ]->setEnabled( held_enabs[ ii ] );
+
+      held_enabs.clear();
+   }
+}
+
 // Slot to open a dialog for 3-D plotting
 void US_MwlRawViewer::plot_3d()
 {
@@ -1796,12 +1886,20 @@ DbgLv(1) << "sh3M:  fscnx lscnx krscan" << fscnx << lscnx << krscan;
    QString ptitle   = tr( "MWL 3-D Plot, Scan 1" );
    QString str_scan;
 
+   // Build the data of scans ahead of playback
+   QVector< int >    fscans = movie_scans();
+   build_xyz_data( xyzdat, fscnx );      // Set 3-D ranges
+   hold_controls( true );                // Hold data fixed for frames
+   US_MwlMovieFrames frames( this, fscans, true );
+   frames.start();
+
    // Loop to show movie frames for each included scan that is in range
-   for ( int scnx = fscnx; scnx <= lscnx; scnx++ )
+   for ( int frx = 0; frx < fscans.size(); frx++ )
    {
-      if ( excludes.contains( scnx ) )  continue;
+      int scnx         = fscans[ frx ];
 
-      build_xyz_data( xyzdat, scnx );    // Build data for this scan
+      if ( ! frames.next_frame( NULL, &xyzdat ) )
+         break;
 
       p3d_pltw->reloadData( &xyzdat );   // Load the data in the plot window
 //      p3d_ctld->do_3dplot();             // Do the plot
@@ -1814,6 +1912,9 @@ DbgLv(1) << "sh3M:    scnx ptitle" << scnx << ptitle;
       le_status->setText( statmsg + str_scan );
       qApp->processEvents();
    }
+
+   frames.wait();
+   hold_controls( false );
 }
 
 // Slot to save the current plot
@@ -1932,10 +2033,27 @@ DbgLv(1) << "Save 2D Movie";
    QString bstat   = tr( "Of %1 records, saving record " ).arg( krecs );
    le_status->setText( bstat );
 
+   // Build record data ahead, and encode frame images in parallel
+   QVector< int >    frecs;
+   QVector< double > fdata;
+
+   for ( int prx = 0; prx < krecs; prx++ )
+      frecs << prx;
+
+   compute_ranges();
+   navgrec         = ct_recavg->value();
+   hold_controls( true );                   // Hold data fixed for frames
+   US_MwlMovieFrames frames( this, frecs, false );
+   US_MwlFrameWriter writer;
+   frames.start();
+
    for ( int prx = 0; prx < krecs; prx++ )
    {
-      cb_pltrec->setCurrentIndex( prx );    // Plot each record in the range
-      qApp->processEvents();
+      if ( ! frames.next_frame( &fdata, NULL ) )
+         break;
+
+      curr_adata      = fdata;
+      plot_frame_2d( prx );                 // Plot each record in the range
 
       QString rec_str = ccr + cb_pltrec->currentText().remove( "." );
       QString frm_str = QString().sprintf( "%05d", ( prx + 1 ) );
@@ -1945,13 +2063,27 @@ DbgLv(1) << "Save 2D Movie";
 
       le_status->setText( bstat + rec_str + ", frame " + frm_str );
 
-      US_GuiUtil::save_png( fpath, data_plot );
+      writer.save( US_MwlFrameWriter::grab( data_plot ), fpath );
       fnames << fname;
    }
 
+   int nfail       = writer.finish();
+DbgLv(1) << "Save 2D Movie: nfail" << nfail;
+   frames.wait();
+   hold_controls( false );
+
    cb_pltrec->setCurrentIndex( svrec );     // Restore previous plot record
    qApp->processEvents();
 
+   if ( nfail > 0 )
+   {  // Report any frames that could not be saved
+      QMessageBox::warning( this, tr( "Frame Files Not Saved" ),
+         tr( "%1 of %2 2-D movie frame files could not be saved in"
+             " the directory\n     %3.\n\nCheck its permissions"
+             " and free space." )
+         .arg( nfail ).arg( fnames.size() ).arg( savedir ) );
+   }
+
    QMessageBox::information( this, tr( "Frame Files Saved" ),
       tr( "In the directory\n     %1,\n\n%2 2-D movie frame files"
           " were saved:\n     %3\n     ...\n     %4 ." )
@@ -1995,7 +2127,6 @@ DbgLv(1) << "Save 3-D Movie";
 
    // Get the save directory and base file name for saved image files
    QStringList ffnames;
-   QString imgtype( "png" );
    QString ptbase   = tr( "MWL 3-D Plot, Scan SSS" );
    QString statmsg  = tr( "Of %1 included in-range scans,"
                           " saving:   Scan " ).arg( krscan );
@@ -2006,12 +2137,21 @@ DbgLv(1) << "Save 3-D Movie";
    QApplication::setOverrideCursor( QCursor( Qt::WaitCursor) );
    int kframe       = 0;
 
+   // Build scan data ahead, and encode frame images in parallel
+   QVector< int >    fscans = movie_scans();
+   build_xyz_data( xyzdat, fscnx );      // Set 3-D ranges
+   hold_controls( true );                // Hold data fixed for frames
+   US_MwlMovieFrames frames( this, fscans, true );
+   US_MwlFrameWriter writer;
+   frames.start();
+
    // Loop to save movie frames for each included scan that is in range
-   for ( int scnx = fscnx; scnx <= lscnx; scnx++ )
+   for ( int frx = 0; frx < fscans.size(); frx++ )
    {
-      if ( excludes.contains( scnx ) )  continue;
+      int scnx         = fscans[ frx ];
 
-      build_xyz_data( xyzdat, scnx );    // Build data for this scan
+      if ( ! frames.next_frame( NULL, &xyzdat ) )
+         break;
 
       p3d_pltw->reloadData( &xyzdat );   // Load the data in the plot window
 
@@ -2032,15 +2172,29 @@ DbgLv(1) << "Save 3-D Movie";
                                           .replace( "XXXX", s_frame );
       QString fpath    = savedir + fname;
 
-      p3d_pltw->save_plot( fpath, imgtype );
+      writer.save( p3d_pltw->plot_image(), fpath );
 
       ffnames << fname;
       qApp->processEvents();
    }
 
+   int nfail        = writer.finish();
+DbgLv(1) << "Save 3D Movie: nfail" << nfail;
+   frames.wait();
+   hold_controls( false );
+
    QApplication::restoreOverrideCursor();
    QApplication::restoreOverrideCursor();
 
+   if ( nfail > 0 )
+   {  // Report any frames that could not be saved
+      QMessageBox::warning( this, tr( "Frame Files Not Saved" ),
+         tr( "%1 of %2 3-D movie frame files could not be saved in"
+             " the directory\n     %3.\n\nCheck its permissions"
+             " and free space." )
+         .arg( nfail ).arg( kframe ).arg( savedir ) );
+   }
+
    // Report the frame files saved
    QMessageBox::information( this,
       tr( "Frame Files Saved" ),
@@ -2141,37 +2295,10 @@ DbgLv(1) << "Bxyz: lambda count" << k3dlamb << "range"
  << lmb3d[0] << lmb3d[k3dlamb-1];
 DbgLv(1) << "Bxyz: radius count" << k3drads << "range"
  << rad3d[0] << rad3d[k3drads-1];
-   int nhavg    = navgrec / 2;                            // Half avg. points
-   int wvx      = lmbxs;                                  // True lambda index
-DbgLv(1) << "Bxyz:  navg" << navgrec << "trpxs wvx" << trpxs << wvx;
-   xyzd.clear();
+DbgLv(1) << "Bxyz:  navg" << navgrec << "trpxs lmbxs" << trpxs << lmbxs;
 
    // Now build the data points
-   for ( int klx = 0; klx < k3dlamb; klx++, wvx++ )
-   {  // Outer loop is lambdas
-      int lambda   = lmb3d[ klx ];                        // Lambda value
-      int wvxs     = qMax( ( wvx  - nhavg   ), 0 );       // Start for avg.
-      int wvxe     = qMin( ( wvxs + navgrec ), nlambda ); // End for avg.
-      int kavgc    = wvxe - wvxs;                         // True avg. count
-      int trxs     = trpxs + wvxs;                        // Triple start
-      int trxe     = trpxs + wvxe;                        // Triple end
-      int rdx      = radxs;                               // True radius index
-      double yval  = (double)lambda;                      // Y is lambda
-
-      for ( int krx = 0; krx < k3drads; krx++, rdx++ )
-      {
-         double xval  = rad3d[ krx ];                     // X is radius
-         double zval  = 0.0;                              // Initial Z sum
-
-         for ( int trx = trxs; trx < trxe; trx++ )        // WvLn range Z sum
-            zval        += allData[ trx ].reading( scnx, rdx );
-
-         zval        /= (double)kavgc;                    // Averaged Z value
-
-         xyzd << QVector3D( xval, yval, zval );           // Store X,Y,Z point
-DbgLv(2) << "Bxyz:    k" << xyzd.count() << "x y z" << xval << yval << zval;
-      }
-   }
+   build_xyz_frame( scnx, xyzd );
 
    k3dtot       = xyzd.count();
 int i=k3drads-1;
@@ -2195,6 +2322,90 @@ DbgLv(1) << "cmpR:  pxS pxE" << pltxvals[0] << pltxvals[pltxvals.count()-1];
    return k3dtot;
 }
 
+// Build the XYZ data of a scan for a 3D plot or movie frame.
+//   Only members set by compute_ranges() are read, and none are changed,
+//   so that frames may be built in worker threads.
+void US_MwlRawViewer::build_xyz_frame( const int scnx,
+                                       QVector< QVector3D >& xyzd ) const
+{
+   int nhavg    = navgrec / 2;                            // Half avg. points
+   xyzd.clear();
+   xyzd.reserve( ( lmbxe - lmbxs ) * ( radxe - radxs ) );
+
+   for ( int wvx = lmbxs; wvx < lmbxe; wvx++ )
+   {  // Outer loop is lambdas
+      int wvxs     = qMax( ( wvx  - nhavg   ), 0 );       // Start for avg.
+      int wvxe     = qMin( ( wvxs + navgrec ), nlambda ); // End for avg.
+      int kavgc    = wvxe - wvxs;                         // True avg. count
+      int trxs     = trpxs + wvxs;                        // Triple start
+      int trxe     = trpxs + wvxe;                        // Triple end
+      double yval  = (double)lambdas[ wvx ];              // Y is lambda
+
+      for ( int rdx = radxs; rdx < radxe; rdx++ )
+      {
+         double xval  = radii[ rdx ];                     // X is radius
+         double zval  = 0.0;                              // Initial Z sum
+
+         for ( int trx = trxs; trx < trxe; trx++ )        // WvLn range Z sum
+            zval        += allData[ trx ].scanData[ scnx ].rvalues[ rdx ];
+
+         zval        /= (double)kavgc;                    // Averaged Z value
+
+         xyzd << QVector3D( xval, yval, zval );           // Store X,Y,Z point
+      }
+   }
+}
+
+// Build the averaged data of a plot record for a 2D movie frame.
+//   The result matches that of build_avg_data(), but is computed without
+//   changing any members, so that frames may be built in worker threads.
+void US_MwlRawViewer::build_avg_frame( const int prx,
+                                       QVector< double >& adata ) const
+{
+   int kavgh     = navgrec / 2;                     // Half averaging count
+   int arxs      = qMax( prx - kavgh, 0 );          // Record start index
+   int arxe      = qMin( prx + kavgh, krecs - 1 ) + 1;
+   arxe          = qMax( arxe, ( arxs + 1 ) );      // Record end index
+   double avgscl = 1.0 / (double)( arxe - arxs );   // Averaging scale factor
+   int wavxs     = trpxs + lmbxs;                   // Start wavelength index
+   int wavxe     = trpxs + lmbxe;                   // End wavelength index
+   adata.clear();
+
+   for ( int scnx = 0; scnx < nscan; scnx++ )
+   {  // Average points of included scans across component records
+      if ( excludes.contains( scnx ) )  continue;
+
+      if ( is_wrecs )
+      {  // Wavelength records with x-axis radius
+         for ( int radx = radxs; radx < radxe; radx++ )
+         {
+            double dsum   = 0.0;
+
+            for ( int krx = arxs; krx < arxe; krx++ )
+               dsum         += allData[ wavxs + krx ].scanData[ scnx ]
+                               .rvalues[ radx ];
+
+            adata << ( dsum * avgscl );
+         }
+      }
+
+      else
+      {  // Radius records with x-axis wavelength
+         for ( int wavx = wavxs; wavx < wavxe; wavx++ )
+         {
+            const QVector< double >* rvals =
+               &allData[ wavx ].scanData[ scnx ].rvalues;
+            double dsum   = 0.0;
+
+            for ( int krx = arxs; krx < arxe; krx++ )
+               dsum         += (*rvals)[ krx ];
+
+            adata << ( dsum * avgscl );
+         }
+      }
+   }
+}
+
 // Slot to handle the close of the 3D plot control dialog
 void US_MwlRawViewer::p3dctrl_closed()
 {
@@ -10,6 +10,7 @@
 #include "us_plot3d_xyz.h"
 #include "us_mwl_pltctrl.h"
 #include "us_dataIO.h"
+#include "us_mwl_movie.h"
 
 class US_MwlRawViewer : public US_Widgets
 {
@@ -21,6 +22,8 @@ class US_MwlRawViewer : public US_Widgets
      US_MwlRawViewer();
 
   private:
+     friend class US_MwlMovieFrames;
+
      QPointer< US_MwlPlotControl >   p3d_ctld;   //!< Pointer to 3D control
      QPointer< US_Plot3Dxyz >        p3d_pltw;   //!< Pointer to 3D plot window
 
@@ -42,6 +45,7 @@ class US_MwlRawViewer : public US_Widgets
      QVector< int >    prev_recxs;  //!< Previous avg. component rec. indexes
 
      QList< int >      excludes;    //!< List of scans to exclude
+     QList< bool >     held_enabs;  //!< Control enable states held in movies
 
      US_MwlData     mwl_data;       //!< Raw MWL (.mwrs) data loaded
 
@@ -139,6 +143,8 @@ class US_MwlRawViewer : public US_Widgets
      void   plot_current   ( void );
      void   plot_titles    ( void );
      void   plot_all       ( void );
+     void   plot_avg_data  ( void );
+     void   plot_frame_2d  ( const int );
      void   build_cmp_data ( void );
      void   build_avg_data ( void );
      void   build_rec_data ( const int, QVector< double >& );
@@ -168,6 +174,10 @@ class US_MwlRawViewer : public US_Widgets
      void   include_scans  ( void );
      int    dvec_index     ( QVector< double >&, const double );
      int    build_xyz_data ( QVector< QVector3D >&, int = -1 );
+     void   build_avg_frame( const int, QVector< double >& ) const;
+     void   build_xyz_frame( const int, QVector< QVector3D >& ) const;
+     QVector< int > movie_scans( void );
+     void   hold_controls  ( const bool );
      void   p3dctrl_closed ( void );
      int    live_scan      ( int* = 0, int* = 0, int* = 0 );
      void   help           ( void )
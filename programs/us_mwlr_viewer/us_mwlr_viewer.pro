@@ -7,9 +7,11 @@ TARGET        = us_mwlr_viewer
 
 HEADERS       = us_mwlr_viewer.h    \
                 us_mwl_pltctrl.h    \
+                us_mwl_movie.h      \
                 us_mwl_run.h
 
 SOURCES       = us_mwlr_viewer.cpp  \
                 us_mwl_pltctrl.cpp  \
+                us_mwl_movie.cpp    \
                 us_mwl_run.cpp
 
@@ -11,6 +11,7 @@
 #include "us_sleep.h"
 #include "us_math2.h"
 #include "us_lm.h"
+#include "us_pcsa_lm.h"
 #include "us_solve_sim.h"
 #include "us_constants.h"
 #include "us_memory.h"
@@ -1132,539 +1133,28 @@ DbgLv(1) << "PC:MS:   RTN";
 
 }
 
-// Do curve-fit evaluate function (return RMSD) for a Straight Line model
-double US_pcsaProcess::fit_function_SL( double t, double* par )
-{
-   static int ffcall=0;          // Fit function call counter
-   static double epar[ 20 ];     // Static array for holding parameters
-   static const int nepar = sizeof( epar ) / sizeof( epar[ 0 ] );
-
-   if ( t > 0.0 )
-   { // If not t[0], return immediately
-      return 0.0;
-   }
-
-   if ( t < 0.0 )
-   { // If t is special flag (-ve.), reset ffcall and return
-      ffcall = 0;
-      return 0.0;
-   }
-
-   QTime ftimer;
-   ftimer.start();
-   QList< US_SolveSim::DataSet* > dsets;
-   void** iparP  = (void**)par;
-   void** parP   = (void**)epar;
-   double par1   = par[ 0 ];
-   double par2   = par[ 1 ];
-   int    px     = ( sizeof( double ) / sizeof( void* ) ) * 2;
-   if ( ffcall == 0 )
-   { // On 1st call, copy par array to internal static one
-      for ( int ii = 0; ii < nepar - 2; ii++ )
-         epar[ ii ]    = par[ ii + 2 ];
-      parP[ 0 ]     = iparP[ px ];
-   }
-
-   ffcall++;                                    // Bump function call counter
-   dsets << (US_SolveSim::DataSet*)parP[ 0 ];
-   int    nlpts  = (int)epar[ 1 ];              // Get limit parameters
-   double xmin   = epar[ 2 ];
-   double xmax   = epar[ 3 ];
-   double ylow   = epar[ 6 ];
-   double yhigh  = epar[ 7 ];
-   double p1lo   = epar[ 8 ];
-   double p1hi   = epar[ 9 ];
-   double p2lo   = epar[ 10 ];
-   double p2hi   = epar[ 11 ];
-   int    noisfl = (int)epar[ 12 ];
-   int    dbg_lv = (int)epar[ 13 ];
-   double alpha  = epar[ 14 ];
-   int    attr_x = (int)epar[ 16 ];
-   int    attr_y = (int)epar[ 17 ];
-   //int    attr_z = (int)epar[ 18 ];
-   //int    zbase  = epar[ 19 ];
-   double ystart = par1;
-   double yend   = ystart + par2 * ( xmax - xmin );
-
-   // After 1st few calls, test if parameters are within limits
-   if ( ffcall > 3 )
-   {
-      // Leave a little wiggle room on limits
-      ylow         -= 0.1;
-      yhigh        += 0.1;
-      p1lo         -= 0.1;
-      p1hi         += 0.1;
-      p2lo         -= 0.01;
-      p2hi         += 0.02;
-
-      // If this record is beyond any limit, return now with it marked as bad
-      if ( par1   < p1lo   ||  par2   < p2lo  ||
-           par1   > p1hi   ||  par2   > p2hi  ||
-           ystart < ylow   ||  yend   < ylow  ||
-           ystart > yhigh  ||  yend   > yhigh )
-      {
-qDebug() << "ffSL: call" << ffcall << "par1 par2" << par1 << par2
- << "ys ye" << ystart << yend << "*OUT-OF-LIMITS*";
-         return 1e+99;
-      }
-   }
-
-   double prange = (double)( nlpts - 1 );
-   double xinc   = ( xmax - xmin ) / prange;
-   double yinc   = ( yend - ystart ) / prange;
-   double vbar20 = dsets[ 0 ]->vbar20;
-   double xcurr  = xmin;
-   double ycurr  = ystart;
-   double zcurr  = dsets[ 0 ]->zcoeffs[ 0 ];
-   zcurr         = ( zcurr == 0.0 ) ? vbar20 : zcurr;
-qDebug() << "ffSL:  zcurr vb" << zcurr << vbar20;
-
-   if ( attr_x == ATTR_S )
-   {  // X is s:  scale by 1e-13
-      xcurr        *= 1e-13;
-      xinc         *= 1e-13;
-   }
-   if ( attr_y == ATTR_S )
-   {  // Y is s:  scale by 1e-13
-      ycurr        *= 1e-13;
-      yinc         *= 1e-13;
-   }
-   US_SolveSim::Simulation sim_vals;
-   sim_vals.noisflag  = noisfl;
-   sim_vals.dbg_level = dbg_lv;
-   sim_vals.alpha     = alpha;
-
-   for ( int ii = 0; ii < nlpts; ii++ )
-   { // Fill the input solutes vector
-      sim_vals.zsolutes << US_ZSolute( xcurr, ycurr, zcurr, 0.0 );
-      xcurr        += xinc;
-      ycurr        += yinc;
-   }
-
-   // Evaluate the model
-   double rmsd   = evaluate_model( dsets, sim_vals );
-
-   epar[ 15 ]    = rmsd;
-   int    ktimms = ftimer.elapsed();
-qDebug() << "ffSL: call" << ffcall << "par1 par2" << par1 << par2
- << "rmsd" << rmsd << "eval time" << ktimms << "ms.";
-if(ffcall<6)
-qDebug() << "ffSL:  epar0 epar1-9" << parP[0] << epar[1] << epar[2] << epar[3]
- << epar[4] << epar[5] << epar[6] << epar[7] << epar[8] << epar[9];
-//qDebug() << "ffSL:  dsets[0]" << dsets[0] << parP[0]
-// << "dsets[0]->vbar20" << dsets[0]->vbar20;
-qDebug() << "ffSL:    ys ye yl yh" << ystart << yend << ylow << yhigh;
-
-   return rmsd;
-}
-
-// Do curve-fit evaluate function (return RMSD) for a Increasing Sigmoid model
-double US_pcsaProcess::fit_function_IS( double t, double* par )
-{
-   static int ffcall=0;          // Fit function call counter
-   static double epar[ 18 ];     // Static array for holding parameters
-   static const int nepar = sizeof( epar ) / sizeof( epar[ 0 ] );
-
-   if ( t > 0.0 )
-   { // If not t[0], return immediately
-      return 0.0;
-   }
-
-   if ( t < 0.0 )
-   { // If t is special flag (-ve.), reset ffcall and return
-      ffcall = 0;
-      return 0.0;
-   }
-
-   QTime ftimer;
-   ftimer.start();
-   QList< US_SolveSim::DataSet* > dsets;
-   void** iparP  = (void**)par;
-   void** parP   = (void**)epar;
-   double par1   = par[ 0 ];
-   double par2   = par[ 1 ];
-   int    px     = ( sizeof( double ) / sizeof( void* ) ) * 2;
-   if ( ffcall == 0 )
-   { // On 1st call, copy par array to internal static one
-      for ( int ii = 0; ii < nepar - 2; ii++ )
-         epar[ ii ]    = par[ ii + 2 ];
-      parP[ 0 ]     = iparP[ px ];
-   }
-
-   ffcall++;                                    // Bump function call counter
-   dsets << (US_SolveSim::DataSet*)parP[ 0 ];
-   int    nlpts  = (int)epar[ 1 ];              // Get limit parameters
-   double xmin   = epar[ 2 ];
-   double xmax   = epar[ 3 ];
-   double ymin   = epar[ 4 ];
-   double ymax   = epar[ 5 ];
-   double ylow   = epar[ 6 ];
-   double yhigh  = epar[ 7 ];
-   double p1lo   = epar[ 8 ];
-   double p1hi   = epar[ 9 ];
-   double p2lo   = epar[ 10 ];
-   double p2hi   = epar[ 11 ];
-   int    noisfl = (int)epar[ 12 ];
-   int    dbg_lv = (int)epar[ 13 ];
-   double alpha  = epar[ 14 ];
-   int    attr_x = (int)epar[ 16 ];
-   int    attr_y = (int)epar[ 17 ];
-   //int    attr_z = (int)epar[ 18 ];
-   //int    zbase  = epar[ 19 ];
-   double ystr   = ymin;
-   double ydif   = ymax - ymin;
-   double xrange = xmax - xmin;
-   double p1fac  = sqrt( 2.0 * qMax( par1, p1lo ) );
-   double ystart = ystr + ydif * ( 0.5 * erf( ( 0.0 - par2 ) / p1fac ) + 0.5 );
-   double yend   = ystr + ydif * ( 0.5 * erf( ( 1.0 - par2 ) / p1fac ) + 0.5 );
-
-   // After 1st few calls, test if parameters are within limits
-   if ( ffcall > 3 )
-   {
-      // Leave a little wiggle room on limits
-      ylow         -= 0.1;
-      yhigh        += 0.1;
-      p1lo         -= 0.00001;
-      p1hi         += 0.00001;
-      p2lo         -= 0.01;
-      p2hi         += 0.01;
-
-      // If this record is beyond any limit, return now with it marked as bad
-      if ( par1   < p1lo   ||  par2   < p2lo  ||
-           par1   > p1hi   ||  par2   > p2hi  ||
-           ystart < ylow   ||  yend   < ylow  ||
-           ystart > yhigh  ||  yend   > yhigh )
-      {
-qDebug() << "ffIS: call" << ffcall << "par1 par2" << par1 << par2
- << "ys ye" << ystart << yend << "*OUT-OF-LIMITS*";
-         return 1e+99;
-      }
-   }
-
-   double prange = (double)( nlpts - 1 );
-   double xinc   = 1.0 / prange;
-   double vbar20 = dsets[ 0 ]->vbar20;
-   double xcurr  = xmin;
-   double ycurr  = ymin;
-   double zcurr  = dsets[ 0 ]->zcoeffs[ 0 ];
-   zcurr         = ( zcurr == 0.0 ) ? vbar20 : zcurr;
-qDebug() << "ffIS:  zcurr vb" << zcurr << vbar20;
-   if ( attr_x == ATTR_S )
-   {  // X is s:  scale by 1e-13
-      xmin         *= 1e-13;
-      xrange       *= 1e-13;
-   }
-   if ( attr_y == ATTR_S )
-   {  // Y is s:  scale by 1e-13
-      ymin         *= 1e-13;
-      ydif         *= 1e-13;
-   }
-   US_SolveSim::Simulation sim_vals;
-   sim_vals.noisflag  = noisfl;
-   sim_vals.dbg_level = dbg_lv;
-   sim_vals.alpha     = alpha;
-
-   double xoff   = 0.0;
-
-   for ( int ii = 0; ii < nlpts; ii++ )
-   { // Fill the input solutes vector
-      double efac   = 0.5 * erf( ( xoff - par2 ) / p1fac ) + 0.5;
-      xcurr         = xmin + xoff * xrange;
-      ycurr         = ymin + ydif * efac;
-      sim_vals.zsolutes << US_ZSolute( xcurr, ycurr, zcurr, 0.0 );
-      xoff         += xinc;
-   }
-
-   // Evaluate the model
-   double rmsd   = evaluate_model( dsets, sim_vals );
-
-   epar[ 15 ]    = rmsd;
-   int    ktimms = ftimer.elapsed();
-qDebug() << "ffIS: call" << ffcall << "par1 par2" << par1 << par2
- << "rmsd" << rmsd << "eval time" << ktimms << "ms.";
-if(ffcall<6)
-qDebug() << "ffIS:  epar0 epar1-9" << parP[0] << epar[1] << epar[2] << epar[3]
- << epar[4] << epar[5] << epar[6] << epar[7] << epar[8] << epar[9];
-
-   return rmsd;
-}
-
-// Do curve-fit evaluate function (return RMSD) for a Decreasing Sigmoid model
-double US_pcsaProcess::fit_function_DS( double t, double* par )
-{
-   static int ffcall=0;          // Fit function call counter
-   static double epar[ 18 ];     // Static array for holding parameters
-   static const int nepar = sizeof( epar ) / sizeof( epar[ 0 ] );
-
-   if ( t > 0.0 )
-   { // If not t[0], return immediately
-      return 0.0;
-   }
-
-   if ( t < 0.0 )
-   { // If t is special flag (-ve.), reset ffcall and return
-      ffcall = 0;
-      return 0.0;
-   }
-   QTime ftimer;
-   ftimer.start();
-   QList< US_SolveSim::DataSet* > dsets;
-   void** iparP  = (void**)par;
-   void** parP   = (void**)epar;
-   double par1   = par[ 0 ];
-   double par2   = par[ 1 ];
-   int    px     = ( sizeof( double ) / sizeof( void* ) ) * 2;
-   if ( ffcall == 0 )
-   { // On 1st call, copy par array to internal static one
-      for ( int ii = 0; ii < nepar - 2; ii++ )
-         epar[ ii ]    = par[ ii + 2 ];
-      parP[ 0 ]     = iparP[ px ];
-   }
-
-   ffcall++;                                    // Bump function call counter
-   dsets << (US_SolveSim::DataSet*)parP[ 0 ];
-   int    nlpts  = (int)epar[ 1 ];              // Get limit parameters
-   double xmin   = epar[ 2 ];
-   double xmax   = epar[ 3 ];
-   double ymin   = epar[ 4 ];
-   double ymax   = epar[ 5 ];
-   double ylow   = epar[ 6 ];
-   double yhigh  = epar[ 7 ];
-   double p1lo   = epar[ 8 ];
-   double p1hi   = epar[ 9 ];
-   double p2lo   = epar[ 10 ];
-   double p2hi   = epar[ 11 ];
-   int    noisfl = (int)epar[ 12 ];
-   int    dbg_lv = (int)epar[ 13 ];
-   double alpha  = epar[ 14 ];
-   int    attr_x = (int)epar[ 16 ];
-   int    attr_y = (int)epar[ 17 ];
-   //int    attr_z = (int)epar[ 18 ];
-   //int    zbase  = epar[ 19 ];
-   double ystr   = ymax;
-   double ydif   = ymin - ymax;
-   double xrange = xmax - xmin;
-   double p1fac  = sqrt( 2.0 * qMax( par1, p1lo ) );
-   double ystart = ystr + ydif * ( 0.5 * erf( ( 0.0 - par2 ) / p1fac ) + 0.5 );
-   double yend   = ystr + ydif * ( 0.5 * erf( ( 1.0 - par2 ) / p1fac ) + 0.5 );
-
-   // After 1st few calls, test if parameters are within limits
-   if ( ffcall > 3 )
-   {
-      // Leave a little wiggle room on limits
-      ylow         -= 0.1;
-      yhigh        += 0.1;
-      p1lo         -= 0.00001;
-      p1hi         += 0.00001;
-      p2lo         -= 0.01;
-      p2hi         += 0.01;
-
-      // If this record is beyond any limit, return now with it marked as bad
-      if ( par1   < p1lo   ||  par2   < p2lo  ||
-           par1   > p1hi   ||  par2   > p2hi  ||
-           ystart < ylow   ||  yend   < ylow  ||
-           ystart > yhigh  ||  yend   > yhigh )
-      {
-qDebug() << "ffDS: call" << ffcall << "par1 par2" << par1 << par2
- << "ys ye" << ystart << yend << "*OUT-OF-LIMITS*";
-         return 1e+99;
-      }
-   }
-
-   double prange = (double)( nlpts - 1 );
-   double xoinc  = 1.0 / prange;
-   double vbar20 = dsets[ 0 ]->vbar20;
-   double xcurr  = xmin;
-   double ycurr  = ymin;
-   double zcurr  = dsets[ 0 ]->zcoeffs[ 0 ];
-   zcurr         = ( zcurr == 0.0 ) ? vbar20 : zcurr;
-qDebug() << "ffDS:  zcurr vb" << zcurr << vbar20;
-   if ( attr_x == ATTR_S )
-   {  // X is s:  scale by 1e-13
-      xmin         *= 1e-13;
-      xrange       *= 1e-13;
-   }
-   if ( attr_y == ATTR_S )
-   {  // Y is s:  scale by 1e-13
-      ymin         *= 1e-13;
-      ydif         *= 1e-13;
-   }
-   US_SolveSim::Simulation sim_vals;
-   sim_vals.noisflag  = noisfl;
-   sim_vals.dbg_level = dbg_lv;
-   sim_vals.alpha     = alpha;
-
-   double xoff   = 0.0;
-
-   for ( int ii = 0; ii < nlpts; ii++ )
-   { // Fill the input solutes vector
-      double efac   = 0.5 * erf( ( xoff - par2 ) / p1fac ) + 0.5;
-      xcurr         = xmin + xoff * xrange;
-      ycurr         = ystr + ydif * efac;
-      sim_vals.zsolutes << US_ZSolute( xcurr * 1e-13, ycurr, vbar20, 0.0 );
-      xoff         += xoinc;
-   }
-
-   // Evaluate the model
-   double rmsd   = evaluate_model( dsets, sim_vals );
-
-   epar[ 15 ]    = rmsd;
-   int    ktimms = ftimer.elapsed();
-qDebug() << "ffDS: call" << ffcall << "par1 par2" << par1 << par2
- << "rmsd" << rmsd << "eval time" << ktimms << "ms.";
-if(ffcall<6)
-qDebug() << "ffDS:  epar0 epar1-9" << parP[0] << epar[1] << epar[2] << epar[3]
- << epar[4] << epar[5] << epar[6] << epar[7] << epar[8] << epar[9];
-
-   return rmsd;
-}
-
-// Do curve-fit evaluate function (return RMSD) for a Horizontal Line model
-double US_pcsaProcess::fit_function_HL( double t, double* par )
-{
-   static int ffcall=0;          // Fit function call counter
-   static double epar[ 18 ];     // Static array for holding parameters
-   static const int nepar = sizeof( epar ) / sizeof( epar[ 0 ] );
-
-   if ( t > 0.0 )
-   { // If not t[0], return immediately
-      return 0.0;
-   }
-
-   if ( t < 0.0 )
-   { // If t is special flag (-ve.), reset ffcall and return
-      ffcall = 0;
-      return 0.0;
-   }
-
-   QTime ftimer;
-   ftimer.start();
-   QList< US_SolveSim::DataSet* > dsets;
-   void** iparP  = (void**)par;
-   void** parP   = (void**)epar;
-   double par1   = par[ 0 ];
-   double par2   = par[ 0 ];
-   int    px     = ( sizeof( double ) / sizeof( void* ) ) * 2;
-   if ( ffcall == 0 )
-   { // On 1st call, copy par array to internal static one
-      for ( int ii = 0; ii < nepar - 2; ii++ )
-         epar[ ii ]    = par[ ii + 2 ];
-      parP[ 0 ]     = iparP[ px ];
-   }
-
-   ffcall++;                                    // Bump function call counter
-   dsets << (US_SolveSim::DataSet*)parP[ 0 ];
-   int    nlpts  = (int)epar[ 1 ];              // Get limit parameters
-   double xmin   = epar[ 2 ];
-   double xmax   = epar[ 3 ];
-   double ylow   = epar[ 6 ];
-   double yhigh  = epar[ 7 ];
-   double p1lo   = epar[ 8 ];
-   double p1hi   = epar[ 9 ];
-   int    noisfl = (int)epar[ 12 ];
-   int    dbg_lv = (int)epar[ 13 ];
-   double alpha  = epar[ 14 ];
-   int    attr_x = (int)epar[ 16 ];
-   int    attr_y = (int)epar[ 17 ];
-   //int    attr_z = (int)epar[ 18 ];
-   //int    zbase  = epar[ 19 ];
-   double yval   = par1;
-
-   // After 1st few calls, test if parameters are within limits
-   if ( ffcall > 3 )
-   {
-      // Leave a little wiggle room on limits
-      ylow         -= 0.1;
-      yhigh        += 0.1;
-      p1lo         -= 0.1;
-      p1hi         += 0.1;
-
-      // If this record is beyond any limit, return now with it marked as bad
-      if ( par1   < p1lo   ||  par1   > p1hi  ||
-           yval   < ylow   ||  yval   > yhigh )
-      {
-qDebug() << "ffHL: call" << ffcall << "par1" << par1 << "yv" << yval 
- << "*OUT-OF-LIMITS*";
-         return 1e+99;
-      }
-   }
-
-   double prange = (double)( nlpts - 1 );
-   double xinc   = ( xmax - xmin ) / prange;
-   double vbar20 = dsets[ 0 ]->vbar20;
-   double xcurr  = xmin;
-   double ycurr  = yval;
-   double zcurr  = dsets[ 0 ]->zcoeffs[ 0 ];
-   zcurr         = ( zcurr == 0.0 ) ? vbar20 : zcurr;
-qDebug() << "ffHL:  zcurr vb" << zcurr << vbar20;
-   if ( attr_x == ATTR_S )
-   {  // X is s:  scale by 1e-13
-      xcurr        *= 1e-13;
-      xinc         *= 1e-13;
-   }
-   if ( attr_y == ATTR_S )
-   {  // Y is s:  scale by 1e-13
-      ycurr        *= 1e-13;
-   }
-   US_SolveSim::Simulation sim_vals;
-   sim_vals.noisflag  = noisfl;
-   sim_vals.dbg_level = dbg_lv;
-   sim_vals.alpha     = alpha;
-
-   for ( int ii = 0; ii < nlpts; ii++ )
-   { // Fill the input solutes vector
-      sim_vals.zsolutes << US_ZSolute( xcurr, ycurr, zcurr, 0.0 );
-      xcurr        += xinc;
-   }
-
-   // Evaluate the model
-   double rmsd   = evaluate_model( dsets, sim_vals );
-
-   epar[ 15 ]    = rmsd;
-   int    ktimms = ftimer.elapsed();
-qDebug() << "ffHL: call" << ffcall << "par1 par2" << par1 << par2
- << "rmsd" << rmsd << "eval time" << ktimms << "ms.";
-if(ffcall<6)
-qDebug() << "ffHL:  epar0 epar1-9" << parP[0] << epar[1] << epar[2] << epar[3]
- << epar[4] << epar[5] << epar[6] << epar[7] << epar[8] << epar[9];
-//qDebug() << "ffHL:  dsets[0]" << dsets[0] << parP[0]
-// << "dsets[0]->vbar20" << dsets[0]->vbar20;
-qDebug() << "ffHL:    yv yl yh" << yval << ylow << yhigh;
-
-   return rmsd;
-}
-
 // Do Levenberg-Marquardt fit
 void US_pcsaProcess::LevMarq_fit( void )
 {
    const int eslnc = 32;   // Estimated straight-line LM eval calls
    const int esigc = 44;   // Estimated sigmoid LM eval calls
-   static US_LM::LM_Control control( 1.e-5, 1.e-5, 1.e-5, 1.e-5,
-                                     100., 100, 0,  3 );
+   const int mxref = 4;    // Maximum elite curves refined at once
+   US_LM::LM_Control control( 1.e-5, 1.e-5, 1.e-5, 1.e-5,
+                              100., 100, 0,  3 );
    if ( lmmxcall < 1 )
       return;
 
-   static US_LM::LM_Status  status;
-   static int    n_par  = 2;
-   static int    m_dat  = 3;
-DbgLv(1) << "LMf: n_par m_dat" << n_par << m_dat;
-   static double tarray[ 3 ] = { 0.0, 1.0, 2.0 };
-   static double yarray[ 3 ] = { 0.0, 0.0, 0.0 };
-   static double parray[ 20 ];
+   US_LM::LM_Status  status;
    bool   LnType = ( curvtype == CTYPE_SL  ||  curvtype == CTYPE_HL );
    double minyv  = yuplim;
    double maxyv  = ylolim;
-#if 0
-   double minsl  = ( yuplim - ylolim ) / ( xuplim - xlolim );
-   double maxsl  = -minsl;
-#endif
    double minp1  = LnType ? minyv : 0.5;
    double maxp1  = LnType ? maxyv : 0.001;
    double minp2  = LnType ? minyv : 1.0;
    double maxp2  = LnType ? maxyv : 0.0;
    double minp3  =  9.99e+22;
    double maxp3  = -9.99e+22;
-   int    npar   = ( curvtype != CTYPE_HL ) ? n_par : 1;
+   int    npar   = ( curvtype != CTYPE_HL ) ? 2 : 1;
    control.maxcall      = lmmxcall / ( npar + 1 );
    lm_done       = false;
    // Start timer for L-M progress bar, based on estimated duration
@@ -1682,169 +1172,82 @@ DbgLv(1) << "LMf: n_par m_dat" << n_par << m_dat;
    emit message_update( tr( "\nNow refining the best model with a "
                             "Levenberg-Marquardt fit ...\n" ), true );
 
-#if 0
-   elite_limits( mrecs, minyv, maxyv, minp1, maxp1, minp2, maxp2 );
-#endif
-#if 1
    US_ModelRecord::elite_limits( mrecs, curvtype, minyv, maxyv,
                                  minp1, maxp1, minp2, maxp2, minp3, maxp3 );
-#endif
-#if 0
-const double par1lo=0.001;
-const double par1up=0.5;
-const double par2lo=0.0;
-const double par2up=1.0;
-minyv=ylolim;
-maxyv=yuplim;
-minp1=(minp1+par1lo)*0.5;
-maxp1=(maxp1+par1up)*0.5;
-minp2=(minp2+par2lo)*0.5;
-maxp2=(maxp2+par2up)*0.5;
-#endif
 
    double ibm_rmsd = mrecs[ 0 ].rmsd;  // Initial Best Model RMSD
-   double *t     = tarray;
-   double *y     = yarray;
-   double *par   = parray;
-   void   **ppar = (void**)par;
-   int    px     = ( sizeof( double ) / sizeof( void* ) ) * 2;
-   double zbase  = dsets[ 0 ]->zcoeffs[ 0 ];
-   par[ 0 ]      = mrecs[ 0 ].par1;
-   par[ 1 ]      = mrecs[ 0 ].par2;
-DbgLv(0) << "LMf:  par1 par2" << par[0] << par[1];
-   par[ 2 ]      = 0.0;
-   ppar[ px ]    = (void*)dsets[ 0 ];
-   par[ 3 ]      = (double)cresolu;
-   par[ 4 ]      = xlolim;
-   par[ 5 ]      = xuplim;
-   par[ 6 ]      = ylolim;
-   par[ 7 ]      = yuplim;
-   par[ 8 ]      = minyv;
-   par[ 9 ]      = maxyv;
-   par[ 10 ]     = minp1;
-   par[ 11 ]     = maxp1;
-   par[ 12 ]     = minp2;
-   par[ 13 ]     = maxp2;
-   par[ 14 ]     = noisflag;
-   par[ 15 ]     = dbg_level;
-//   par[ 15 ]     = 0;
-   par[ 16 ]     = alpha_lm;
-   par[ 17 ]     = attr_x;
-   par[ 18 ]     = attr_y;
-   par[ 19 ]     = attr_z;
-   par[ 20 ]     = zbase;
-DbgLv(1) << "LMf:  ppar2" << ppar[4] << dsets[0] << curvtype << ppar[5];
-DbgLv(1) << "LMf:  alpha" << alpha_lm << par[14];
-   timer.start();              // start a timer to measure run time
+DbgLv(0) << "LMf:  par1 par2" << mrecs[0].par1 << mrecs[0].par2;
+DbgLv(1) << "LMf:  alpha" << alpha_lm << "limits" << minyv << maxyv
+ << minp1 << maxp1 << minp2 << maxp2;
 
-   if ( curvtype == CTYPE_SL )
-   { // Fit with Levenberg-Marquardt for straight-line curves
+   if ( curvtype == CTYPE_SL  ||  curvtype == CTYPE_HL )
+   { // Controls for straight-line and horizontal-line curves
       control.ftol     = 1.e-5;
       control.xtol     = 1.e-5;
       control.gtol     = 1.e-5;
       control.epsilon  = 1.e-5;
-DbgLv(0) << "lmcurve_fit (SL) with par1,par2" << par[0] << par[1]
-   << "ftol,epsl" << control.ftol << control.epsilon;
-      fit_function_SL( -1.0, par );    // Make sure to reset eval. function
-
-      US_LM::lmcurve_fit_rmsd( npar, par, m_dat, t, y,
-            &(US_pcsaProcess::fit_function_SL), &control, &status );
-
-DbgLv(0) << "  lmcurve_fit (SL) return: par1,par2" << par[0] << par[1];
-DbgLv(0) << "   lmcfit status: fnorm nfev info"
-   << status.fnorm << status.nfev << status.info
-   << US_LM::lm_statmsg( &status, false );
-double ys = par[0];
-double ye = ys + par[1] * ( xuplim - xlolim );
-//double rmsd = par[10];
-double rmsd = sqrt( dsets[0]->model.variance );
-int    nsol = dsets[0]->model.components.size();
-DbgLv(0) << "   lmcfit xs,ys xe,ye rmsd" << xlolim << ys << xuplim << ye
- << rmsd << "ncsol" << nsol;
    }
 
    else if ( curvtype == CTYPE_IS )
-   { // Fit with Levenberg-Marquardt for increasing-sigmoid curves
-      //control.ftol     = 30.0 * DBL_EPSILON;
+   { // Controls for increasing-sigmoid curves
       control.ftol     = 1.0e-5;
       control.xtol     = control.ftol;
       control.gtol     = control.ftol;
       control.epsilon  = ibm_rmsd * 8.0e-5;
-      fit_function_IS( -1.0, par );    // Make sure to reset eval. function
-DbgLv(0) << "lmcurve_fit (IS) with par1,par2" << par[0] << par[1]
-   << QString().sprintf( "%14.8e %14.8e", par[0], par[1] )
-   << "ftol,epsl" << control.ftol << control.epsilon;
-
-      US_LM::lmcurve_fit_rmsd( npar, par, m_dat, t, y,
-            &(US_pcsaProcess::fit_function_IS), &control, &status );
-
-DbgLv(0) << "  lmcurve_fit (IS) return: par1,par2" << par[0] << par[1]
-   << QString().sprintf( "%14.8e %14.8e", par[0], par[1] );
-DbgLv(0) << "   lmcfit status: fnorm nfev info"
-   << status.fnorm << status.nfev << status.info
-   << US_LM::lm_statmsg( &status, false );
-double rmsd = sqrt( dsets[0]->model.variance );
-int    nsol = dsets[0]->model.components.size();
-DbgLv(0) << "   lmcfit rmsd" << rmsd << "#solutes" << nsol; 
    }
 
    else if ( curvtype == CTYPE_DS )
-   { // Fit with Levenberg-Marquardt for decreasing-sigmoid curves
+   { // Controls for decreasing-sigmoid curves
       control.ftol     = 1.e-16;
       control.xtol     = 1.e-16;
       control.gtol     = 1.e-16;
       control.epsilon  = 1.e-4;
-      fit_function_DS( -1.0, par );    // Make sure to reset eval. function
-DbgLv(0) << "lmcurve_fit (DS) with par1,par2" << par[0] << par[1]
-   << QString().sprintf( "%14.8e %14.8e", par[0], par[1] )
-   << "ftol,epsl" << control.ftol << control.epsilon;
-
-      US_LM::lmcurve_fit_rmsd( npar, par, m_dat, t, y,
-            &(US_pcsaProcess::fit_function_DS), &control, &status );
+   }
 
-DbgLv(0) << "  lmcurve_fit (DS) return: par1,par2" << par[0] << par[1]
-   << QString().sprintf( "%14.8e %14.8e", par[0], par[1] );
-DbgLv(0) << "   lmcfit status: fnorm nfev info"
-   << status.fnorm << status.nfev << status.info;
-double rmsd = sqrt( dsets[0]->model.variance );
-int    nsol = dsets[0]->model.components.size();
-DbgLv(0) << "   lmcfit rmsd" << rmsd << "#solutes" << nsol; 
+   else
+   {
+      DbgLv( 0 ) << "*ERROR* invalid curvtype" << curvtype;
    }
 
-   else if ( curvtype == CTYPE_HL )
-   { // Fit with Levenberg-Marquardt for horizontal-line curves
-      control.ftol     = 1.e-5;
-      control.xtol     = 1.e-5;
-      control.gtol     = 1.e-5;
-      control.epsilon  = 1.e-5;
-DbgLv(0) << "lmcurve_fit (HL) with par1" << par[0]
+   // Refine as many of the elite curves at once as still leaves each
+   //  refinement a thread for each of its Jacobian columns
+   int    nrefs  = qMin( qMin( nthreads / npar, mxref ), mrecs.size() );
+   nrefs         = qMax( nrefs, 1 );
+   QVector< US_ModelRecord >   lmrecs = mrecs.mid( 0, nrefs );
+   QVector< US_LM::LM_Status > lmstats;
+
+   US_PcsaLM pcsa_lm( dsets, 0, 1, curvtype, st_mask, cresolu );
+   pcsa_lm.set_extents( xlolim, xuplim, ylolim, yuplim );
+   pcsa_lm.set_limits ( minyv, maxyv, minp1, maxp1, minp2, maxp2 );
+   pcsa_lm.set_options( noisflag, alpha_lm );
+DbgLv(0) << "lmcurve_fit ctype" << curvtype << "nrefs" << nrefs
    << "ftol,epsl" << control.ftol << control.epsilon;
-      fit_function_HL( -1.0, par );    // Make sure to reset eval. function
+   timer.start();              // start a timer to measure run time
 
-      US_LM::lmcurve_fit_rmsd( npar, par, m_dat, t, y,
-            &(US_pcsaProcess::fit_function_HL), &control, &status );
+   pcsa_lm.refine_all( lmrecs, control, lmstats, nthreads );
 
-DbgLv(0) << "  lmcurve_fit (HL) return: par1" << par[0];
-DbgLv(0) << "   lmcfit status: fnorm nfev info"
-   << status.fnorm << status.nfev << status.info
-   << US_LM::lm_statmsg( &status, false );
-double yv = par[0];
-double rmsd = sqrt( dsets[0]->model.variance );
-int    nsol = dsets[0]->model.components.size();
-DbgLv(0) << "   lmcfit xs,yv xe,yv rmsd" << xlolim << yv << xuplim << yv
- << rmsd << "ncsol" << nsol;
-   }
+   // Pick the best of the refined records
+   int    bestx  = 0;
 
-   else
+   for ( int jj = 1; jj < nrefs; jj++ )
    {
-      DbgLv( 0 ) << "*ERROR* invalid curvtype" << curvtype;
+      if ( lmrecs[ jj ].rmsd < lmrecs[ bestx ].rmsd )
+         bestx         = jj;
    }
 
+   US_ModelRecord mrec = lmrecs [ bestx ];
+   status        = lmstats[ bestx ];
+DbgLv(0) << "  lmcurve_fit return: best" << bestx << "par1,par2"
+   << mrec.par1 << mrec.par2;
+DbgLv(0) << "   lmcfit status: fnorm nfev info"
+   << status.fnorm << status.nfev << status.info
+   << US_LM::lm_statmsg( &status, false );
+
    lm_done       = true;
    QApplication::restoreOverrideCursor();
    US_SolveSim::DataSet* dset = dsets[ 0 ];
-   double rmsd   = sqrt( dset->model.variance );
-   int    nsol   = dset->model.components.size();
+   double rmsd   = mrec.rmsd;
+   int    nsol   = mrec.csolutes.size();
    int    nfev   = status.nfev;
    time_lm       = timer.elapsed();
    int    ktimes = ( time_lm + 500 ) / 1000;
@@ -1857,7 +1260,8 @@ DbgLv(0) << "     lmcfit  LM time(ms):  estimated" << kctask
  << "actual" << time_lm;
    QString fmsg = tr( "The new best model has par1 %1,  par2 %2,\n"
                       "  RMSD %3,  %4 solutes,  %5 LM iters.  " )
-       .arg( par[ 0 ] ).arg( par[ 1 ] ).arg( rmsd ).arg( nsol ).arg( nfev );
+       .arg( mrec.par1 ).arg( mrec.par2 ).arg( rmsd ).arg( nsol )
+       .arg( nfev );
    if ( ktimeh == 0 )
       fmsg      = fmsg + tr( "(%1 min., %2 sec.)" )
                          .arg( ktimem ).arg( ktimes );
@@ -1867,58 +1271,22 @@ DbgLv(0) << "     lmcfit  LM time(ms):  estimated" << kctask
    if ( alpha_lm != 0.0 )
       fmsg      = fmsg + tr( "\nA Tikhonov regularization parameter of %1"
                              " was used." ).arg( alpha_lm );
+   if ( nrefs > 1 )
+      fmsg      = fmsg + tr( "\n%1 elite curves were refined at once." )
+                         .arg( nrefs );
    emit message_update( fmsg, true );
 
-   // Replace best model in vector and build out model more completely
-   US_ModelRecord mrec = mrecs[ 0 ];
-   US_SimulationParameters* spar = &dset->simparams;
-   int  jsp       = 0;
-
-   if ( curvtype == CTYPE_SL )
-   {
-      mrec.str_y     = par[ 0 ];
-      mrec.end_y     = par[ 0 ] + par[ 1 ] * ( xuplim - xlolim );
-   }
-
-   else if ( curvtype == CTYPE_HL )
-   {
-      mrec.str_y     = par[ 0 ];
-      mrec.end_y     = par[ 0 ];
-      par[ 1 ]       = 0.0;
-   }
-
-   mrec.par1      = par[ 0 ];
-   mrec.par2      = par[ 1 ];
-   mrec.par3      = 0.0;
-   mrec.variance  = dset->model.variance;
-   mrec.rmsd      = rmsd;
+   // Build out the refined best model more completely
    mrec.ctype     = curvtype;
-   mrec.xmin      = xlolim;
-   mrec.xmax      = xuplim;
-   mrec.ymin      = ylolim;
-   mrec.ymax      = yuplim;
-
-   for ( int ii = 0; ii < mrec.isolutes.size(); ii++ )
-   { // Replace x and y in top model input solutes
-      mrec.isolutes[ ii ].x = spar->mesh_radius[ jsp++ ];
-      mrec.isolutes[ ii ].y = spar->mesh_radius[ jsp++ ];
-   }
-
-   mrec.csolutes.clear();
-   model          = dset->model;
+   model          = mrec.model;
    double sfactor = 1.0 / dset->s20w_correction;
    double dfactor = 1.0 / dset->D20w_correction;
+   mrec.csolutes.clear();
 
    for ( int ii = 0; ii < nsol; ii++ )
    {
       // Insert calculated solutes into top model record
       US_ZSolute solute;
-#if 0
-      solute.x   = model.components[ ii ].s;
-      solute.y   = model.components[ ii ].f_f0;
-      solute.z   = model.components[ ii ].vbar20;
-      solute.c   = model.components[ ii ].signal_concentration;
-#endif
       US_ZSolute::set_solute_values( model.components[ ii ], solute, st_mask );
       mrec.csolutes << solute;
 DbgLv(1) << "LMf:  ii" << ii << "x y c" << solute.x << solute.y << solute.c;
@@ -1964,38 +1332,33 @@ DbgLv(1) << "LMf:     s D mw" << model.components[ii].s
 
    mrec.model      = model;
 
-   // Fetch any noise saved in dset
+   // Compose any noise records from those of the refined record
    bool tino       = ( ( noisflag & 1 ) != 0 );
    bool rino       = ( ( noisflag & 2 ) != 0 );
    ti_noise.count  = 0;
    ri_noise.count  = 0;
    ti_noise.values.clear();
    ri_noise.values.clear();
-   mrec.ti_noise.clear();
-   mrec.ri_noise.clear();
 
-   // Compose any noise records
    if ( tino )
    {
-      for ( int ii = 0; ii < npoints; ii++ )
-         ti_noise.values << spar->mesh_radius[ jsp++ ];
-
+      ti_noise.values    = mrec.ti_noise;
       ti_noise.minradius = edata->radius( 0 );
       ti_noise.maxradius = edata->radius( npoints - 1 );
       ti_noise.count     = npoints;
-      mrec.ti_noise      = ti_noise.values;
 DbgLv(1) << "LMf: ti count size" << ti_noise.count << ti_noise.values.size();
    }
+   else
+      mrec.ti_noise.clear();
 
    if ( rino )
    {
-      for ( int ii = 0; ii < nscans; ii++ )
-         ri_noise.values << spar->mesh_radius[ jsp++ ];
-
+      ri_noise.values    = mrec.ri_noise;
       ri_noise.count     = nscans;
-      mrec.ri_noise      = ri_noise.values;
 DbgLv(1) << "LMf: ri count size" << ri_noise.count << ri_noise.values.size();
    }
+   else
+      mrec.ri_noise.clear();
 
    // Insert new refined best model at the top of the list
 DbgLv(0) << "LMf:insert-new: old par1 par2" << mrecs[0].par1 << mrecs[0].par2
@@ -2017,7 +1380,6 @@ DbgLv(1) << "LMf: rdata  nsc npt"
  << rdata.scanCount() << rdata.pointCount();
 DbgLv(1) << "LMf: sdata  nsc npt"
  << sdata.scanCount() << sdata.pointCount();
-   spar->mesh_radius.clear();
    double cvari = 0.0;
    double crmsd = 0.0;
 
@@ -2152,8 +1514,8 @@ double US_pcsaProcess::evaluate_model( QList< US_SolveSim::DataSet* >& dsets,
    }
 
    // Do astfem fit, mostly to get an RMSD
-   US_SolveSim* solvesim = new US_SolveSim( dsets, 0, false );
-   solvesim->calc_residuals( 0, 1, sim_vals );
+   US_SolveSim solvesim( dsets, 0, false );
+   solvesim.calc_residuals( 0, 1, sim_vals );
 
    // Construct a rudimentary model from computed solutes and save it
    dset->model          = US_Model();
@@ -106,12 +106,6 @@ class US_pcsaProcess : public QObject
 
       static const int solute_doubles = sizeof( US_ZSolute ) / sizeof( double );
 
-      // Static routines needed for Levenberg-Marquardt
-      static double fit_function_SL( double, double* );
-      static double fit_function_IS( double, double* );
-      static double fit_function_DS( double, double* );
-      static double fit_function_HL( double, double* );
-
 private:
 
       signals:
@@ -0,0 +1,331 @@
+//! \file us_rppath.cpp
+
+#include "us_rppath.h"
+#include "us_settings.h"
+#include "us_matrix.h"
+#include "us_parallel.h"
+#include "us_math2.h"
+#include <float.h>
+
+// Range task that computes rows of the upper triangle of the Gram matrix
+class US_RpGramTask : public US_RangeTask
+{
+   public:
+      const double* a_ptr;     // A matrix (column major)
+      const double* b_ptr;     // B vector
+      double*       g_ptr;     // Gram matrix
+      double*       c_ptr;     // A'b vector
+      int           ntotal;    // Number of data rows used
+      int           narows;    // Number of A rows
+      int           nisols;    // Number of columns
+
+      void run_range( int begin, int end, int )
+      {
+         for ( int ii = begin; ii < end; ii++ )
+         {
+            const double* acoli = a_ptr + ii * narows;
+
+            for ( int jj = ii; jj < nisols; jj++ )
+            {
+               const double* acolj = a_ptr + jj * narows;
+               double        dsum  = 0.0;
+
+               for ( int kk = 0; kk < ntotal; kk++ )
+                  dsum         += acoli[ kk ] * acolj[ kk ];
+
+               g_ptr[ ii * nisols + jj ] = dsum;
+            }
+
+            double        bsum  = 0.0;
+
+            for ( int kk = 0; kk < ntotal; kk++ )
+               bsum         += acoli[ kk ] * b_ptr[ kk ];
+
+            c_ptr[ ii ]  = bsum;
+         }
+      }
+};
+
+// Regularization path solver constructor
+US_RpPath::US_RpPath( QVector< double >* a_nnls_a,
+      QVector< double >* a_nnls_b, const int a_ntotal, const int a_nisols )
+   : psv_nnls_a( a_nnls_a ), psv_nnls_b( a_nnls_b ), ntotal( a_ntotal ),
+   nisols( a_nisols )
+{
+   narows      = ntotal + nisols;
+   dbg_level   = US_Settings::us_debug();
+   gdmax       = 0.0;
+}
+
+// Build the Gram matrix and A'b vector from the saved A,B
+void US_RpPath::build_gram( const int nthreads )
+{
+   gram.fill( 0.0, nisols * nisols );
+   atb .fill( 0.0, nisols );
+
+   US_RpGramTask gtask;
+   gtask.a_ptr   = psv_nnls_a->data();
+   gtask.b_ptr   = psv_nnls_b->data();
+   gtask.g_ptr   = gram.data();
+   gtask.c_ptr   = atb .data();
+   gtask.ntotal  = ntotal;
+   gtask.narows  = narows;
+   gtask.nisols  = nisols;
+
+   US_Parallel::run( &gtask, nisols, nthreads );
+
+   // Mirror the upper triangle and find the largest diagonal
+   gdmax         = 0.0;
+
+   for ( int ii = 0; ii < nisols; ii++ )
+   {
+      gdmax         = qMax( gdmax, gram[ ii * nisols + ii ] );
+
+      for ( int jj = 0; jj < ii; jj++ )
+         gram[ ii * nisols + jj ] = gram[ jj * nisols + ii ];
+   }
+DbgLv(1) << "RPP: build_gram  ntotal nisols" << ntotal << nisols
+ << "gdmax" << gdmax;
+}
+
+// Solve for an alpha, warm started from the given solution
+void US_RpPath::solve( const double alpha, QVector< double >& xsol,
+      double& variance, double& xnormsq )
+{
+   if ( xsol.size() != nisols )
+      xsol.fill( 0.0, nisols );
+
+   fnnls( alpha, xsol.data() );
+
+   // Construct the implied simulation and xnorm-sq
+   QVector< double > simdat( ntotal, 0.0 );
+   double* a_ptr    = psv_nnls_a->data();
+   double* b_ptr    = psv_nnls_b->data();
+   double* s_ptr    = simdat.data();
+   variance         = 0.0;
+   xnormsq          = 0.0;
+
+   for ( int cc = 0; cc < nisols; cc++ )
+   {
+      double soluval  = xsol[ cc ];     // Computed concentration, this solute
+
+      if ( soluval > 0.0 )
+      {
+         xnormsq        += sq( soluval );
+         double* acol    = a_ptr + cc * narows;
+
+         for ( int kk = 0; kk < ntotal; kk++ )
+            s_ptr[ kk ]    += ( soluval * acol[ kk ] );
+      }
+   }
+
+   // Calculate the sum for the variance computation
+   for ( int kk = 0; kk < ntotal; kk++ )
+      variance       += sq( ( b_ptr[ kk ] - s_ptr[ kk ] ) );
+
+   variance         /= (double)ntotal;
+DbgLv(1) << "RPP: solve: alpha" << alpha << "vari xnsq" << variance << xnormsq;
+}
+
+// Fast NNLS (Bro and de Jong) on the regularized normal equations, with
+//  the initial passive set taken from any positive solution values
+void US_RpPath::fnnls( const double alpha, double* xx )
+{
+   const int    maxiter = nisols * 3;
+   // For alpha of zero, add a tiny ridge so that passive systems factor
+   const double ridge   = ( alpha > 0.0 ) ? sq( alpha ) : ( gdmax * 1.0e-12 );
+   const double toler   = 10.0 * DBL_EPSILON * ( gdmax + ridge ) * nisols;
+   QVector< int >    passive( nisols, 0 );
+   QVector< double > ww     ( nisols, 0.0 );
+   QVector< double > ss     ( nisols, 0.0 );
+   double* gg    = gram.data();
+   double* sv    = ss.data();
+   bool    warm  = false;
+   int     iter  = 0;
+
+   for ( int ii = 0; ii < nisols; ii++ )
+   {  // Start with the positive values of the warm start solution
+      if ( xx[ ii ] > 0.0 )
+      {
+         passive[ ii ] = 1;
+         warm          = true;
+      }
+      else
+         xx[ ii ]      = 0.0;
+   }
+
+   while ( iter < maxiter )
+   {
+      // Gradient w = A'b - ( A'A + alpha^2 I ) x
+      for ( int ii = 0; ii < nisols; ii++ )
+      {
+         double  dsum  = atb[ ii ] - ridge * xx[ ii ];
+         double* grow  = gg + ii * nisols;
+
+         for ( int jj = 0; jj < nisols; jj++ )
+            dsum         -= grow[ jj ] * xx[ jj ];
+
+         ww[ ii ]      = dsum;
+      }
+
+      if ( ! warm )
+      {  // Add the active variable with the largest gradient
+         int    jmax   = -1;
+         double wmax   = toler;
+
+         for ( int ii = 0; ii < nisols; ii++ )
+         {
+            if ( passive[ ii ] == 0  &&  ww[ ii ] > wmax )
+            {
+               wmax          = ww[ ii ];
+               jmax          = ii;
+            }
+         }
+
+         if ( jmax < 0 )
+            break;         // Optimality conditions hold:  done
+
+         passive[ jmax ] = 1;
+      }
+
+      warm          = false;
+
+      if ( ! solve_passive( ridge, passive, sv ) )
+         break;
+
+      // Inner loop:  step back into the feasible region as needed
+      while ( iter++ < maxiter )
+      {
+         double step   = 2.0;
+         int    kmin   = -1;
+
+         for ( int ii = 0; ii < nisols; ii++ )
+         {
+            if ( passive[ ii ] != 0  &&  sv[ ii ] <= 0.0 )
+            {
+               double dx     = xx[ ii ] - sv[ ii ];
+               double ratio  = ( dx > 0.0 ) ? ( xx[ ii ] / dx ) : 0.0;
+
+               if ( ratio < step )
+               {
+                  step          = ratio;
+                  kmin          = ii;
+               }
+            }
+         }
+
+         if ( kmin < 0 )
+            break;         // All passive values are positive
+
+         for ( int ii = 0; ii < nisols; ii++ )
+         {  // Move toward the new solution and drop any that reach zero
+            if ( passive[ ii ] == 0 )
+               continue;
+
+            xx[ ii ]     += step * ( sv[ ii ] - xx[ ii ] );
+
+            if ( ii == kmin  ||  xx[ ii ] <= 0.0 )
+            {
+               xx[ ii ]      = 0.0;
+               passive[ ii ] = 0;
+            }
+         }
+
+         if ( ! solve_passive( ridge, passive, sv ) )
+            break;
+      }
+
+      for ( int ii = 0; ii < nisols; ii++ )
+      {
+         if ( passive[ ii ] != 0  &&  sv[ ii ] > 0.0 )
+            xx[ ii ]      = sv[ ii ];
+         else
+         {
+            xx[ ii ]      = 0.0;
+            passive[ ii ] = 0;
+         }
+      }
+   }
+}
+
+// Solve the regularized normal equations restricted to the passive set
+bool US_RpPath::solve_passive( const double ridge,
+      const QVector< int >& passive, double* sv )
+{
+   QVector< int > pindx;
+
+   for ( int ii = 0; ii < nisols; ii++ )
+   {
+      sv[ ii ]      = 0.0;
+
+      if ( passive[ ii ] != 0 )
+         pindx << ii;
+   }
+
+   int npass     = pindx.size();
+
+   if ( npass == 0 )
+      return true;
+
+   QVector< double >  mvals( npass * npass );
+   QVector< double* > mrows( npass );
+   QVector< double >  rhs  ( npass );
+
+   for ( int ii = 0; ii < npass; ii++ )
+   {
+      int    gi     = pindx[ ii ];
+      mrows[ ii ]   = mvals.data() + ii * npass;
+      rhs  [ ii ]   = atb[ gi ];
+
+      for ( int jj = 0; jj < npass; jj++ )
+         mrows[ ii ][ jj ] = gram[ gi * nisols + pindx[ jj ] ];
+
+      mrows[ ii ][ ii ] += ridge;
+   }
+
+   if ( ! US_Matrix::Cholesky_Decomposition( mrows.data(), npass ) )
+      return false;
+
+   US_Matrix::Cholesky_SolveSystem( mrows.data(), rhs.data(), npass );
+
+   for ( int ii = 0; ii < npass; ii++ )
+      sv[ pindx[ ii ] ] = rhs[ ii ];
+
+   return true;
+}
+
+// Path thread constructor
+US_RpPathThread::US_RpPathThread( US_RpPath* a_path,
+      const QVector< double > a_alphas, const int a_jbeg, const int a_jend,
+      QObject* parent )
+   : QThread( parent ), path( a_path ), alphas( a_alphas ), jbeg( a_jbeg ),
+   jend( a_jend )
+{
+   abort_flag  = false;
+}
+
+// Flag that the thread should stop early
+void US_RpPathThread::abort()
+{
+   abort_flag  = true;
+}
+
+// Solve each alpha of the range, warm starting each from the previous one
+void US_RpPathThread::run()
+{
+   QVector< double > xsol;
+
+   for ( int ja = jbeg; ja < jend; ja++ )
+   {
+      if ( abort_flag )
+         break;
+
+      double variance = 0.0;
+      double xnormsq  = 0.0;
+
+      path->solve( alphas[ ja ], xsol, variance, xnormsq );
+
+      emit alpha_done( ja, variance, xnormsq );
+   }
+}
+
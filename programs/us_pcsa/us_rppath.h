@@ -0,0 +1,102 @@
+//! \file us_rppath.h
+#ifndef US_RP_PATH_H
+#define US_RP_PATH_H
+
+#include <QtCore>
+
+#include "us_extern.h"
+
+#ifndef DbgLv
+#define DbgLv(a) if(dbg_level>=a)qDebug()
+#endif
+
+//! \brief Regularization path solver for a Tikhonov alpha scan
+
+//! \class US_RpPath
+//! The Gram matrix (A'A) and A'b of a saved NNLS system are built once.
+//! Each alpha is then solved as the non-negative least squares problem
+//! with normal matrix (A'A + alpha^2 I), by an active set method that is
+//! warm started from the solution for a neighboring alpha.
+class US_RpPath
+{
+   public:
+      //! \brief Regularization path solver constructor
+      //! \param a_nnls_a  Pointer to saved NNLS A matrix (column major,
+      //!                  with an nisols-square regularization block)
+      //! \param a_nnls_b  Pointer to saved NNLS B vector
+      //! \param a_ntotal  Number of data points (scans times points)
+      //! \param a_nisols  Number of input solutes
+      US_RpPath( QVector< double >*, QVector< double >*, const int,
+                 const int );
+
+      //! \brief Build the Gram matrix and A'b vector
+      //! \param nthreads  Number of threads to use
+      void build_gram( const int );
+
+      //! \brief Solve for a given alpha
+      //! \param alpha     Regularization parameter
+      //! \param xsol      Solution vector; on input, any warm start values
+      //! \param variance  Returned variance of the fit to the data
+      //! \param xnormsq   Returned norm-squared of the solution
+      void solve( const double, QVector< double >&, double&, double& );
+
+   private:
+      QVector< double >*  psv_nnls_a;   // Saved A matrix
+      QVector< double >*  psv_nnls_b;   // Saved B vector
+
+      int                 ntotal;       // Number of data points
+      int                 nisols;       // Number of solutes
+      int                 narows;       // Number of A rows (ntotal+nisols)
+      int                 dbg_level;    // Debug level
+
+      double              gdmax;        // Maximum Gram diagonal value
+
+      QVector< double >   gram;         // Gram matrix A'A (nisols square)
+      QVector< double >   atb;          // A'b vector
+
+      void fnnls        ( const double, double* );
+      bool solve_passive( const double, const QVector< int >&, double* );
+};
+
+//! \brief Thread to solve a contiguous range of path alphas
+
+//! \class US_RpPathThread
+//! Alphas of the range are solved in order, each warm started from the
+//! solution of the previous one. A signal is emitted as each is done.
+class US_RpPathThread : public QThread
+{
+   Q_OBJECT
+
+   public:
+      //! \brief Path thread constructor
+      //! \param a_path    Pointer to the shared path solver
+      //! \param a_alphas  Alphas of the whole scan
+      //! \param a_jbeg    Index of the first alpha of this thread
+      //! \param a_jend    Index past the last alpha of this thread
+      //! \param parent    Parent object
+      US_RpPathThread( US_RpPath*, const QVector< double >, const int,
+                       const int, QObject* = 0 );
+
+      //! \brief Flag that the thread should stop after its current alpha
+      void abort( void );
+
+   signals:
+      //! \brief Signal that an alpha has been evaluated
+      //! \param ja        Index of the alpha in the scan
+      //! \param variance  Fit variance for the alpha
+      //! \param xnormsq   Solution norm-squared for the alpha
+      void alpha_done( int, double, double );
+
+   protected:
+      //! \brief Run the thread, solving each alpha of the range
+      virtual void run();
+
+   private:
+      US_RpPath*         path;          // Shared path solver
+      QVector< double >  alphas;        // Scan alphas
+      int                jbeg;          // First alpha index
+      int                jend;          // Past-last alpha index
+      volatile bool      abort_flag;    // Flag to stop early
+};
+#endif
+
@@ -34,6 +34,7 @@ DbgLv(1) << "TRP:  RpScan IN";
 
    dbg_level       = US_Settings::us_debug();
    v_line          = NULL;
+   scan_aborted    = false;
 
    mainLayout      = new QHBoxLayout( this );
    leftLayout      = new QVBoxLayout();
@@ -196,10 +197,33 @@ DbgLv(1) << "TRP:  mrec.csolutes.size" << mrec.csolutes.size();
 // Cancel button clicked
 void US_RpScan::reject_it()
 {
+   abort_scan();
    reject();
    close();
 }
 
+// Dialog closing:  stop any running scan
+void US_RpScan::closeEvent( QCloseEvent* event )
+{
+   abort_scan();
+   event->accept();
+}
+
+// Stop any path threads of a running scan and wait for them to finish
+void US_RpScan::abort_scan()
+{
+   if ( pthreads.isEmpty() )
+      return;
+
+   scan_aborted  = true;
+
+   for ( int jt = 0; jt < pthreads.size(); jt++ )
+      pthreads[ jt ]->abort();
+
+   for ( int jt = 0; jt < pthreads.size(); jt++ )
+      pthreads[ jt ]->wait();
+}
+
 // Accept button clicked
 void US_RpScan::accept_it()
 {
@@ -242,159 +266,91 @@ void US_RpScan::scan()
 int kalpha=nalpha;
    nalpha        = alphas.size();
 DbgLv(1) << "ASC:  nalpha" << nalpha << kalpha << "nthr" << nthr;
-
-   if ( nthr == 1 )
-   {  // Non-multi-threaded scan
-      QVector< double > csolutes;
-      sv_nnls_a.clear();
-      sv_nnls_b.clear();
-      int    nscans      = dsets[ 0 ]->run_data.scanCount();
-      int    npoints     = dsets[ 0 ]->run_data.pointCount();
-      int    nisols      = mrec.isolutes.size();
-      le_stattext->setText( tr( "Beginning Single-Thread Alpha Scan ..." ) );
-
-      for ( int ja = 0; ja < nalpha; ja++ )
-      {  // Loop to evaluate each alpha in the specified range
-         calpha             = alphas[ ja ];
-
-         if ( ja == 0 )
-         {  // For the first one do a full compute and save the A,B matrices
-            US_SolveSim::Simulation sim_vals;
-            sim_vals.alpha     = calpha;
-            sim_vals.noisflag  = 0;
-            sim_vals.dbg_level = 0;
-            sim_vals.zsolutes  = mrec.isolutes;
-
-            US_SolveSim* solvesim = new US_SolveSim( dsets, 0, false );
-
-            solvesim->calc_residuals( 0, 1, sim_vals, true,
-                  &sv_nnls_a, &sv_nnls_b );
-
-            v_vari             = sim_vals.variance;
-            v_xnsq             = sim_vals.xnormsq;
-         }
-
-         else
-         {  // After 1st, regularize by modifying A matrix diagonal, then NNLS
-            apply_alpha( calpha, &sv_nnls_a, &sv_nnls_b,
-                         nscans, npoints, nisols, v_vari, v_xnsq );
-         }
-
-         varias[ ja ]       = v_vari;
-         xnorms[ ja ]       = v_xnsq;
-         int kalf           = ja + 1;
-
-         b_progress->setValue( kalf );
-
-         varmx              = qMax( varmx, v_vari );
-         xnomx              = qMax( xnomx, v_xnsq );
-         QString astat      = tr( "Of %1 models, computed %2 (Alpha %3)" )
-            .arg( nalpha ).arg( kalf ).arg( calpha );
-         le_stattext->setText( astat );
-DbgLv(1) << "a v x" << calpha << v_vari << v_xnsq;
-         qApp->processEvents();
-      }
-
-      sv_nnls_a.clear();
-      sv_nnls_b.clear();
+   le_stattext->setText( tr( "Beginning %1-Thread Alpha Scan ..." )
+                         .arg( nthr ) );
+   qApp->processEvents();
+   sv_nnls_a.clear();
+   sv_nnls_b.clear();
+   int    nscans      = dsets[ 0 ]->run_data.scanCount();
+   int    npoints     = dsets[ 0 ]->run_data.pointCount();
+   int    nisols      = mrec.isolutes.size();
+
+   // Run a complete model computation to get the A,B matrices
+   US_SolveSim::Simulation sim_vals;
+   sim_vals.alpha     = alphas[ 0 ];
+   sim_vals.noisflag  = 0;
+   sim_vals.dbg_level = 0;
+   sim_vals.zsolutes  = mrec.isolutes;
+
+   US_SolveSim* solvesim = new US_SolveSim( dsets, 0, false );
+
+   solvesim->calc_residuals( 0, 1, sim_vals, true, &sv_nnls_a, &sv_nnls_b );
+
+   delete solvesim;
+
+   // Build the Gram system once, then solve the alphas along the path:
+   //  each thread takes a contiguous range of alphas, warm starting each
+   //  solution from that of the previous alpha
+   US_RpPath rppath( &sv_nnls_a, &sv_nnls_b, nscans * npoints, nisols );
+   rppath.build_gram( nthr );
+
+   int    nthrp       = qMax( 1, qMin( nthr, nalpha ) );
+   nasubm        = 0;
+   nacomp        = 0;
+   adones.fill( false, nalpha );
+   ptimer.start();
+   pthreads.clear();
+   scan_aborted  = false;
+
+   for ( int jt = 0; jt < nthrp; jt++ )
+   {  // Start a path thread for each range of alphas
+      int    jbeg     = ( jt * nalpha ) / nthrp;
+      int    jend     = ( ( jt + 1 ) * nalpha ) / nthrp;
+DbgLv(1) << "ASC:   jt" << jt << "alphas" << jbeg << "to" << jend - 1;
+
+      US_RpPathThread* pthr = new US_RpPathThread( &rppath, alphas,
+                                                   jbeg, jend, this );
+      connect( pthr, SIGNAL( alpha_done( int, double, double ) ),
+               this, SLOT(   path_point( int, double, double ) ) );
+      pthreads << pthr;
+      pthr->start();
+      nasubm       += ( jend - jbeg );
    }
 
-   else
-   {  // Multi-threaded alpha scan
-      le_stattext->setText( tr( "Beginning %1-Thread Alpha Scan ..." )
-                            .arg( nthr ) );
+   // Keep testing to see if all alphas are complete (or the scan aborted)
+   while( nacomp < nalpha  &&  ! scan_aborted )
+   {
+      US_Sleep::msleep( 100 );
       qApp->processEvents();
-      wthreads .clear();
-      sv_nnls_a.clear();
-      sv_nnls_b.clear();
-
-      // Run a complete model computation to get the A,B matrices
-      US_SolveSim::Simulation sim_vals;
-      calpha             = alphas[ 0 ];
-      sim_vals.alpha     = calpha;
-      sim_vals.noisflag  = 0;
-      sim_vals.dbg_level = 0;
-      sim_vals.zsolutes  = mrec.isolutes;
-
-      US_SolveSim* solvesim = new US_SolveSim( dsets, 0, false );
-
-      solvesim->calc_residuals( 0, 1, sim_vals, true, &sv_nnls_a, &sv_nnls_b );
-
-      v_vari        = sim_vals.variance;
-      v_xnsq        = sim_vals.xnormsq;
-qDebug() << "A0: alpha" << calpha << "vari xnsq" << v_vari << v_xnsq
- << "ncsols" << sim_vals.zsolutes.size();;
-      varias[ 0 ]   = v_vari;
-      xnorms[ 0 ]   = v_xnsq;
-      nasubm        = 1;
-      nacomp        = 1;
-
-      QString astat =
-         tr( "Of %1 models, %2 done (Alpha %3, thread %4)" )
-         .arg( nalpha ).arg( nacomp ).arg( alphas[ 0 ] ).arg( 0 );
-      le_stattext->setText( astat );
-      b_progress->setValue( 1 );
-
-      for ( int jt = 0; jt < nthr; jt++ )
-      {  // Submit the first tasks using available threads
-         WorkPacketPc wtask;
-         calpha               = alphas[ jt + 1 ];
-         US_SolveSim::Simulation sim_vals;
-         sim_vals.alpha       = calpha;
-         sim_vals.noisflag    = 0;
-         sim_vals.dbg_level   = qMax( 0, ( dbg_level - 1 ) );
-         sim_vals.zsolutes    = mrec.isolutes;
-         wtask.thrn           = jt + 1;
-         wtask.taskx          = nasubm;
-         wtask.str_y          = mrec.str_y;
-         wtask.end_y          = mrec.end_y;
-         wtask.par1           = mrec.par1;
-         wtask.par2           = mrec.par2;
-         wtask.sim_vals       = sim_vals;
-         wtask.isolutes       = sim_vals.zsolutes;
-         wtask.dsets          = dsets;
-         wtask.depth          = 1;
-         wtask.state          = 0;
-         wtask.noisf          = sim_vals.noisflag;
-         wtask.psv_nnls_a     = &sv_nnls_a;
-         wtask.psv_nnls_b     = &sv_nnls_b;
-         wtask.csolutes.clear();
-DbgLv(1) << "ASC:   jt" << jt << "alpha" << calpha;
-
-         WorkerThreadPc* wthr   = new WorkerThreadPc( this );
-
-         wthr->define_work( wtask );
-         wthreads << wthr;
-         connect( wthr, SIGNAL( work_complete( WorkerThreadPc* ) ),
-                  this, SLOT(   process_job(   WorkerThreadPc* ) ) );
-         wthr->start();
-         nasubm++;
-DbgLv(1) << "ASC:      defined: nasubm" << nasubm;
-         qApp->processEvents();
-      }
-
-      // Keep testing to see if all tasks are complete
-      while( nacomp < nalpha )
-      {
-         US_Sleep::msleep( 500 );
-         qApp->processEvents();
-      }
+   }
 
-      // Once all threads are done, determine max variance,norm
-      for ( int ja = 0; ja < nalpha; ja++ )
-      {
-         varmx              = qMax( varmx, varias[ ja ] );
-         xnomx              = qMax( xnomx, xnorms[ ja ] );
-      }
+   // Once all threads are done, determine max variance,norm
+   for ( int jt = 0; jt < pthreads.size(); jt++ )
+   {
+      pthreads[ jt ]->wait();
+      delete pthreads[ jt ];
+   }
 
-      // Delete worker threads and free saved A,B matrices
-      for ( int jt = 0; jt < nthr; jt++ )
-         delete wthreads[ jt ];
+   pthreads .clear();
 
+   if ( scan_aborted )
+   {  // Cancelled or closed mid-scan:  abandon it
       sv_nnls_a.clear();
       sv_nnls_b.clear();
+      QApplication::restoreOverrideCursor();
+      le_stattext->setText( tr( "Alpha Scan aborted." ) );
+      return;
    }
 
+   for ( int ja = 0; ja < nalpha; ja++ )
+   {
+      varmx              = qMax( varmx, varias[ ja ] );
+      xnomx              = qMax( xnomx, xnorms[ ja ] );
+   }
+
+   sv_nnls_a.clear();
+   sv_nnls_b.clear();
+
    lgv           = 0  -(int)qFloor( log10( varmx ) );
    lgx           = -1 -(int)qFloor( log10( xnomx ) );
    vscl          = qPow( 10.0, lgv );
@@ -648,130 +604,84 @@ void US_RpScan::mouse( const QwtDoublePoint& p )
    data_plot1->replot();
 }
 
-void US_RpScan::process_job( WorkerThreadPc* wthrd )
+// Record an alpha scan point as computed by a path thread
+void US_RpScan::path_point( int ja, double variance, double xnormsq )
 {
-DbgLv(1) << "SCPJ: IN";
-   WorkPacketPc wresult;
    nacomp++;                            // Bump alphas-complete count
    b_progress->setValue( nacomp );
-   wthrd->get_result( wresult );        // Get results of thread task
-   int    thrn     = wresult.thrn;      // Thread number of task
-   int    taskx    = wresult.taskx;     // Task index of task
-DbgLv(1) << "SCPJ:  thrn" << thrn << "taskx" << taskx;
-   double variance = wresult.sim_vals.variance;
-   double xnormsq  = wresult.sim_vals.xnormsq;
-DbgLv(1) << "SCPJ:   a v x" << alphas[taskx] << variance << xnormsq;
-   varias[ taskx ] = variance;
-   xnorms[ taskx ] = xnormsq;
-//   delete wthrd;
+   varias[ ja ]    = variance;
+   xnorms[ ja ]    = xnormsq;
+   adones[ ja ]    = true;
+DbgLv(1) << "SCPP:   a v x" << alphas[ja] << variance << xnormsq;
    QString astat      =
-      tr( "Of %1 models, %2 done (Alpha %3, thread %4)" )
-      .arg( nalpha ).arg( nacomp ).arg( alphas[ taskx ] ).arg( thrn );
+      tr( "Of %1 models, %2 done (Alpha %3)" )
+      .arg( nalpha ).arg( nacomp ).arg( alphas[ ja ] );
    le_stattext->setText( astat );
-DbgLv(1) << "SCPJ:    astat" << astat;
 
-   if ( nacomp == nalpha )
-   {  // We are done with all tasks
-      qApp->processEvents();
-DbgLv(1) << "SCPJ:    ALL-DONE";
-      return;
-   }
-
-   if ( nasubm < nalpha )
-   {  // We need to set up to submit another task
-      WorkPacketPc wtask   = wresult;
-      wtask.taskx          = nasubm;
-      wtask.sim_vals.alpha = alphas[ nasubm ];
-      wtask.dsets          = dsets;
-      wtask.depth          = 1;
-      wtask.state          = 0;
-      wtask.psv_nnls_a     = &sv_nnls_a;
-      wtask.psv_nnls_b     = &sv_nnls_b;
-DbgLv(1) << "SCPJ:     new subm nnls_a nnls_b" << wtask.psv_nnls_a
- << wtask.psv_nnls_b << "b size" << sv_nnls_b.size();
-      wtask.csolutes.clear();
-DbgLv(1) << "SCPJ:     new subm taskx alpha" << nasubm << wtask.sim_vals.alpha;
-
-//      WorkerThreadPc* wthr   = new WorkerThreadPc( this );
-      wthrd->disconnect();
-      WorkerThreadPc* wthr = wthrd;
-
-      wthr->define_work( wtask );
-DbgLv(1) << "SCPJ:     new subm   work defined  sv_nnls_a" << wtask.psv_nnls_b;
-//      wthr->disconnect();
-      connect( wthr, SIGNAL( work_complete( WorkerThreadPc* ) ),
-               this, SLOT(   process_job(   WorkerThreadPc* ) ) );
-      wthr->start();
-      nasubm++;
-DbgLv(1) << "SCPJ:     new subm   tsk started" << nasubm;
+   // Show the growing L-curve at intervals
+   if ( ptimer.elapsed() > 500  &&  nacomp < nalpha )
+   {
+      plot_partial();
+      ptimer.restart();
    }
-   qApp->processEvents();
 }
 
-void US_RpScan::apply_alpha( const double alpha, QVector< double >* psv_nnls_a,
-      QVector< double >* psv_nnls_b, const int nscans, const int npoints,
-      const int nisols, double& variance, double& xnormsq )
+// Plot the scan points computed so far
+void US_RpScan::plot_partial()
 {
-   int    ntotal   = nscans * npoints;
-   int    narows   = ntotal + nisols;
-   int    ncsols   = 0;
-          variance = 0.0;
-          xnormsq  = 0.0;
-   QVector< double > nnls_a = *psv_nnls_a;
-   QVector< double > nnls_b = *psv_nnls_b;
-   QVector< double > nnls_x;
-   QVector< double > simdat;
-   nnls_x.fill( 0.0, nisols );
-   simdat.fill( 0.0, ntotal );
-qDebug() << "AA: ns np ni na" << nscans << npoints << nisols << narows;
-
-   // Replace alpha in the diagonal of the lower square of A
-   int    dx       = ntotal;
-   int    dinc     = ntotal + nisols + 1;
-//qDebug() << "AA:  alf alfd" << alpha << alphad << "dx dinc" << dx << dinc;
-qDebug() << "AA:  alf" << alpha << "dx dinc" << dx << dinc;
-
-   for ( int cc = 0; cc < nisols; cc++ )
+   QVector< double > xvec;
+   QVector< double > yvec;
+   double varmx  = 0.0;
+   double xnomx  = 0.0;
+
+   for ( int ja = 0; ja < nalpha; ja++ )
    {
-      nnls_a[ dx ]    = alpha;
-      dx             += dinc;
+      if ( ! adones[ ja ] )  continue;
+
+      xvec << varias[ ja ];
+      yvec << xnorms[ ja ];
+      varmx         = qMax( varmx, varias[ ja ] );
+      xnomx         = qMax( xnomx, xnorms[ ja ] );
    }
 
-   // Compute the X vector using NNLS
-   US_Math2::nnls( nnls_a.data(), narows, narows, nisols,
-                   nnls_b.data(), nnls_x.data() );
+   int    npts   = xvec.size();
 
-   // Construct the output solutes and the implied simulation and xnorm-sq
-   for ( int cc = 0; cc < nisols; cc++ )
-   {
-      double soluval  = nnls_x[ cc ];   // Computed concentration, this solute
+   if ( npts < 2  ||  varmx <= 0.0  ||  xnomx <= 0.0 )
+      return;
 
-      if ( soluval > 0.0 )
-      {
-         xnormsq        += sq( soluval );
-         ncsols++;
-         int    aa       = cc * narows;
-
-         for ( int kk = 0; kk < ntotal; kk++ )
-         {
-            simdat[ kk ]   += ( soluval * (*psv_nnls_a)[ aa++ ] );
-         }
-      }
-   }
+   int    lgvp   = 0  -(int)qFloor( log10( varmx ) );
+   int    lgxp   = -1 -(int)qFloor( log10( xnomx ) );
+   double vsclp  = qPow( 10.0, lgvp );
+   double xsclp  = qPow( 10.0, lgxp );
 
-   // Calculate the sum for the variance computation
-   for ( int kk = 0; kk < ntotal; kk++ )
+   for ( int jj = 0; jj < npts; jj++ )
    {
-      variance       += sq( ( (*psv_nnls_b)[ kk ] - simdat[ kk ] ) );
+      xvec[ jj ]   *= vsclp;
+      yvec[ jj ]   *= xsclp;
    }
-qDebug() << "AA:    ntotal" << ntotal << "varisum" << variance;
-
-   // Return computed variance and xnorm-sq
-   variance         /= (double)ntotal;
-qDebug() << "AA: alpha" << alpha << "vari xnsq" << variance << xnormsq
- << "ncsols" << ncsols;
-int mm = npoints / 2;
-qDebug() << "AA: mm=" << mm << "a[m] b[m] s[m]" << (*psv_nnls_a)[mm]
-   << (*psv_nnls_b)[mm] << simdat[mm];
+
+   dataPlotClear( data_plot1 );
+   data_plot1->setTitle( tr( "Alpha Scan Points\n(%1 of %2 computed)" )
+                         .arg( npts ).arg( nalpha ) );
+   data_plot1->setAxisTitle( QwtPlot::xBottom,
+         tr( "Variance (x 1e%1)" ).arg( lgvp ) );
+   data_plot1->setAxisTitle( QwtPlot::yLeft,
+         ( lgxp == 0 ) ?
+         tr( "Norm of X (solute concentrations)" ) :
+         tr( "Norm of X (solute concentrations x 1e%1)" ).arg( lgxp ) );
+
+   grid          = us_grid( data_plot1 );
+
+   QwtPlotCurve* curvpt = us_curve( data_plot1, tr( "Alpha Points" ) );
+   QwtSymbol* sym = new QwtSymbol;
+   sym->setStyle( QwtSymbol::Ellipse );
+   sym->setPen  ( QPen( Qt::blue ) );
+   sym->setBrush( QBrush( Qt::white ) );
+   sym->setSize ( 8 );
+   curvpt->setStyle  ( QwtPlotCurve::NoCurve );
+   curvpt->setSymbol ( sym );
+   curvpt->setSamples( xvec.data(), yvec.data(), npts );
+
+   data_plot1->replot();
 }
 
@@ -10,7 +10,7 @@
 #include "us_solve_sim.h"
 #include "us_plot.h"
 #include "us_pcsa_modelrec.h"
-#include "us_worker_pc.h"
+#include "us_rppath.h"
 #include "us_help.h"
 
 #include "qwt_plot_marker.h"
@@ -32,7 +32,7 @@ class US_RpScan : public US_WidgetsDialog
       int&                             nthr;
       double&                          alpha;
 
-      QList< WorkerThreadPc* >         wthreads;
+      QList< US_RpPathThread* >        pthreads;
 
       US_Plot*           plotLayout1;
 
@@ -75,21 +75,28 @@ class US_RpScan : public US_WidgetsDialog
       QVector< double >  xnorms;
       QVector< double >  sv_nnls_a;
       QVector< double >  sv_nnls_b;
+      QVector< bool >    adones;
+
+      QTime              ptimer;
+
+      bool               scan_aborted;
 
    protected:
       US_Help       showHelp;
       QProgressBar* b_progress;
 
+      //! Stop any running scan before the dialog closes
+      void closeEvent ( QCloseEvent* );
+
    private slots:
       void reject_it  ( void   );
       void accept_it  ( void   );
       void scan       ( void   );
       void plot_data  ( void   );
       void mouse      ( const QwtDoublePoint& );
-      void process_job( WorkerThreadPc* );
-      void apply_alpha( const double,
-                        QVector< double >*, QVector< double >*,
-                        const int, const int, const int, double&, double& );
+      void path_point ( int, double, double );
+      void plot_partial( void  );
+      void abort_scan ( void   );
 
       void help       ( void )
       { showHelp.show_help( "pcsa_rpscan.html" ); };
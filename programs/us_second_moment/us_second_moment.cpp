@@ -40,6 +40,9 @@ US_SecondMoment::US_SecondMoment() : US_AnalysisBase2()
    connect( pb_help,  SIGNAL( clicked() ), SLOT( help() ) );
    connect( pb_view,  SIGNAL( clicked() ), SLOT( view() ) );
    connect( pb_save,  SIGNAL( clicked() ), SLOT( save() ) );
+
+   // Transforms of all triples come from the shared, cached pipeline
+   trans_flags = TR_MOMENT;
 }
 
 void US_SecondMoment::data_plot( void )
@@ -52,19 +55,10 @@ void US_SecondMoment::data_plot( void )
    US_DataIO::EditedData* d      = &dataList[ index ];
 
    int     scanCount   = d->scanCount();
-   int     points      = d->pointCount();
-   int     exclude     = 0;
-   double  boundaryPct = ct_boundaryPercent->value() / 100.0;
-   double  positionPct = ct_boundaryPos    ->value() / 100.0;
-   double  baseline    = calc_baseline();
 
-   for ( int i = 0; i < scanCount; i++ )
-   {
-      double range  = d->scanData[ i ].plateau - baseline;
-      double test_y = baseline + range * positionPct;
-      
-      if ( d->scanData[ i ].rvalues[ 0 ] > test_y ) exclude++;
-   }
+   // Get the (cached) second moment transforms of the triple
+   const TransformData& trd = triple_transform( index );
+   int     exclude     = trd.smSkipped;
 
    le_skipped->setText( QString::number( exclude ) );
 
@@ -85,48 +79,11 @@ void US_SecondMoment::data_plot( void )
    smPoints  = new double[ scanCount ];
    smSeconds = new double[ scanCount ];
 
-   // Calculate the 2nd moment
+   // Correct the 2nd moment sedimentation coefficients
    for ( int i = 0; i < scanCount; i++ )
    {
-      double sum1  = 0.0;
-      double sum2  = 0.0;
-      int    count = 0;
-
-      // The span is the boundary portion that is going to be analyzed (in
-      // percent)
-
-      double range  = ( d->scanData[ i ].plateau - baseline ) * boundaryPct;
-      double test_y = range * positionPct;
-
-      while ( d->scanData[ i ].rvalues[ count ] - baseline < test_y ) 
-         count++;
-
-
-      if ( count == 0 ) count = 1;
-
-      while ( count < points )
-      {   
-         double value  = d->scanData[ i ].rvalues[ count ] - baseline;
-         double radius = d->xvalues[ count ];
-
-         if ( value >= test_y + range ) break;
-      
-         double v0 = d->scanData[ i ].rvalues[ count - 1 ] - baseline;
-         double dC = value - v0;
-
-         sum1 += dC * sq( radius );
-         sum2 += dC;
-         count++;
-      }
-
-      smPoints [ i ] = sqrt( sum1 / sum2 ); // second moment points in cm
-
-      double omega = d->scanData[ i ].rpm * M_PI / 30.0;
-
-      // second moment s
-      smSeconds[ i ] = 
-         1.0e13 * solution.s20w_correction * log( smPoints[ i ] / d->meniscus ) /
-         ( sq( omega ) * ( d->scanData[ i ].seconds - time_correction ) );
+      smPoints [ i ] = trd.smRadii[ i ];    // second moment points in cm
+      smSeconds[ i ] = trd.smSeds [ i ] * solution.s20w_correction;
    }
 
    QVector< double > x( scanCount );
@@ -13,6 +13,7 @@
 #include "us_passwd.h"
 #include "us_constants.h"
 #include "us_astfem_rsa.h"
+#include "us_parallel.h"
 #if QT_VERSION < 0x050000
 #define setSamples(a,b,c)  setData(a,b,c)
 #define setSymbol(a)       setSymbol(*a)
@@ -21,6 +22,66 @@
 
 #define SEDC_NOVAL   -9999.0
 
+// Range task for the per-scan and per-division stages of a vHW pass
+class US_vHW_Task : public US_RangeTask
+{
+   public:
+      enum { TABLES, BDIFF, DIVS, PARTS, POINTS };
+
+      US_vHW_Enhanced*   vhw;       // Analysis whose stage is computed
+      int                stage;     // Stage to compute
+      QVector< double >* rows;      // Row vectors (tables or partials)
+      double*            xx;        // Reciprocal sqrt(time) by live scan
+      double*            xr;        // Back-diffusion radius by live scan
+      double*            yr;        // Back-diffusion conc. by live scan
+      double*            fits;      // Division intercept,slope,sigma,corr.
+      int*               npnts;     // Division fitted points counts
+      double*            sdiffs;    // Scan partials span-sum differences
+      double*            ptx;       // Extrapolation plot X by live scan
+      double*            pty;       // Extrapolation plot Y by scan,division
+      double             bottom;    // Bottom radius of the data
+
+      US_vHW_Task( US_vHW_Enhanced* a_vhw, const int a_stage )
+         : vhw( a_vhw ), stage( a_stage ), rows( 0 ), xx( 0 ), xr( 0 ),
+           yr( 0 ), fits( 0 ), npnts( 0 ), sdiffs( 0 ), ptx( 0 ), pty( 0 ),
+           bottom( 0.0 ) {}
+
+      void run_range( int begin, int end, int )
+      {
+         QVector< double > xtvec;
+         QVector< double > ytvec;
+
+         if ( stage == DIVS )
+         {  // Work buffers for the scan points of a division
+            xtvec.resize( vhw->lscnCount );
+            ytvec.resize( vhw->lscnCount );
+         }
+
+         for ( int ii = begin; ii < end; ii++ )
+         {
+            switch ( stage )
+            {
+               case TABLES:
+                  vhw->scan_table( ii, rows[ ii ] );
+                  break;
+               case BDIFF:
+                  vhw->scan_bdiff( ii, bottom, xx, xr, yr );
+                  break;
+               case DIVS:
+                  npnts[ ii ]  = vhw->div_fit( ii, xx, xr, xtvec.data(),
+                                               ytvec.data(), fits + ii * 4 );
+                  break;
+               case PARTS:
+                  sdiffs[ ii ] = vhw->scan_partials( ii, rows[ ii ] );
+                  break;
+               case POINTS:
+                  vhw->scan_points( ii, ptx, pty );
+                  break;
+            }
+         }
+      }
+};
+
 // main program
 int main( int argc, char* argv[] )
 {
@@ -136,6 +197,10 @@ US_vHW_Enhanced::US_vHW_Enhanced() : US_AnalysisBase2()
    haveZone   = false;
    forcePlot  = false;
    skipPlot   = false;
+   vhw_redo   = VS_PLATS;
+   lscnCount  = 0;
+   bnd_edata  = NULL;
+   vhw_edata  = NULL;
 
    rightLayout->setStretchFactor( plotLayout1, 3 );
    rightLayout->setStretchFactor( plotLayout2, 2 );
@@ -152,6 +217,8 @@ void US_vHW_Enhanced::load( void )
    skipPlot   = true;
    US_AnalysisBase2::load();
    skipPlot   = false;
+   vhw_edata  = NULL;         // Prior pass and tables are of old data
+   bnd_edata  = NULL;
 
    if ( ! dataLoaded )
       return;
@@ -278,6 +345,8 @@ void US_vHW_Enhanced::data_plot( void )
    double  ymax        = 0.0;
    int     count       = 0;
    int     totalCount;
+   int     stage       = vhw_redo;   // First stage to redo in this pass
+   vhw_redo            = VS_PLATS;   // Next pass is full unless told
 
 DbgLv(1) << " data_plot: dataLoaded" << dataLoaded << "vbar" << vbar;
    if ( !dataLoaded  ||  vbar <= 0.0  ||  skipPlot )
@@ -302,9 +371,15 @@ DbgLv(1) << " data_plot: dataLoaded" << dataLoaded << "vbar" << vbar;
       edata      = ck_use_fed->isChecked() ? &dsimList[ row ] : edata;
    }
 
-   dataPlotClear( data_plot2 );
-   data_plot2->setAxisAutoScale( QwtPlot::yLeft );
-   data_plot2->setAxisAutoScale( QwtPlot::xBottom );
+   if ( forcePlot  ||  edata != vhw_edata  ||  lscnCount < 1 )
+      stage      = VS_PLATS;     // No prior pass on this data to build on
+
+   if ( stage == VS_PLATS )
+   {  // A full pass redraws the lower plot
+      dataPlotClear( data_plot2 );
+      data_plot2->setAxisAutoScale( QwtPlot::yLeft );
+      data_plot2->setAxisAutoScale( QwtPlot::xBottom );
+   }
    boundPct   = ct_boundaryPercent->value() / 100.0;
    positPct   = ct_boundaryPos    ->value() / 100.0;
    baseline   = calc_baseline();
@@ -323,35 +398,59 @@ kcalls[0]+=1;QDateTime sttime=QDateTime::currentDateTime();
 //*TIMING
 
 
-   // Get live scans and original plateaus
-   live_scans();
+DbgLv(1) << "  stage" << stage;
+   if ( stage == VS_PLATS )
+   {  // Data or scan selection may have changed:  rebuild from plateaus
+      vhw_edata   = edata;
+      bnd_edata   = NULL;
+
+      // Get live scans and original plateaus
+      live_scans();
 DbgLv(1) << " valueCount totalCount" << valueCount << totalCount;
 DbgLv(1) << "  scanCount divsCount" << scanCount << divsCount;
 DbgLv(1) << "  lscnCount" << lscnCount;
 
-   mo_plats    = ck_modelpl->isChecked() && have_model();
-   vhw_enh     = ck_vhw_enh->isChecked();
+      mo_plats    = ck_modelpl->isChecked() && have_model();
+      vhw_enh     = ck_vhw_enh->isChecked();
 
-   if (  mo_plats )
-   {  // Calculate plateaus from a model
-      model_plateaus();
+      if (  mo_plats )
+      {  // Calculate plateaus from a model
+         model_plateaus();
+      }
+
+      else
+      {  // Calculate plateaus from fitting to specified values
+         fitted_plateaus();
+      }
+
+      // Do the lower plot
+      plot_data2();
    }
 
    else
-   {  // Calculate plateaus from fitting to specified values
-      fitted_plateaus();
-   }
+   {  // Plateaus and lower plot stand:  remove its back-diffusion line
+      QwtPlotItemList list = data_plot2->itemList();
 
-   // Do the lower plot
-   plot_data2();
+      for ( int ii = 0; ii < list.size(); ii++ )
+      {
+         if ( list[ ii ]->title().text() == tr( "Fitted Line BD" ) )
+         {
+            list[ ii ]->detach();
+            delete list[ ii ];
+         }
+      }
+   }
 
    // Then set up to handle the upper (vHW Extrapolation) plot.
    // Calculate the division-1 sedimentation coefficient intercept and,
-   //  from that, the back diffusion coefficient
+   //  from that, the back diffusion coefficient (unchanged by tolerance)
 
-   bdiff_sedc = sedcoeff_intercept();
+   if ( stage <= VS_INTCP )
+   {
+      bdiff_sedc  = sedcoeff_intercept();
 
-   bdiff_coef = back_diff_coeff( bdiff_sedc );
+      bdiff_coef  = back_diff_coeff( bdiff_sedc );
+   }
 
    init_partials();
 
@@ -828,42 +927,34 @@ void US_vHW_Enhanced::update_vbar(      double  dval )
 }
 
 
+// update back-diffusion tolerance:  only divisions need redoing
 void US_vHW_Enhanced::update_bdtoler(    double dval )
 {
    bdtoler   = dval;
+   vhw_redo  = VS_DIVS;
 
    data_plot();
 }
 
+// update divisions:  plateaus and lower plot are unchanged
 void US_vHW_Enhanced::update_divis(      double dval )
 { 
    divsCount = qRound( dval );
+   vhw_redo  = VS_INTCP;
 
    data_plot();
 }
 
-// Index to first readings value greater than or equal to given concentration
+// Index to first readings value greater than or equal to given concentration,
+//  found by binary search of the scan's running-maximum readings table
 int US_vHW_Enhanced::first_gteq( double concenv,
-      QVector< double >& rvalues, int valueCount, int defndx )
+      const QVector< double >& rmaxes, int valueCount, int defndx ) const
 {
-   int index = defndx;                           // Set return index to default
+   const double* rbeg = rmaxes.constData();
+   const double* rend = rbeg + qMin( valueCount, rmaxes.size() );
+   const double* rpos = qLowerBound( rbeg, rend, concenv );
 
-   for ( int jj = 0; jj < valueCount; jj++ )
-   {  // Find index where readings value equals or exceeds given concentration
-      if ( rvalues[ jj ] >= concenv )
-      {
-         index     = jj;                         // Set index to found point
-         break;                                  // And return with it
-      }
-   }
-   return index;
-}
-
-// Index to first greater-or-equal value (with default of -1)
-int US_vHW_Enhanced::first_gteq( double concenv,
-      QVector< double >& rvalues, int valueCount )
-{
-   return first_gteq( concenv, rvalues, valueCount, -1 );
+   return ( rpos != rend ) ? (int)( rpos - rbeg ) : defndx;
 }
 
 // Get average scan plateau value for 41 points around user-specified value
@@ -888,14 +979,13 @@ kmsecs[7]+=sttime.msecsTo(QDateTime::currentDateTime());
    return plato;
 }
 
-// Get sedimentation coefficient for a given concentration
-double US_vHW_Enhanced::sed_coeff( double cconc, double oterm,
-      double* radP, int* ndxP )
+// Get sedimentation coefficient for a given concentration in a scan
+double US_vHW_Enhanced::sed_coeff( int js, double cconc, double oterm,
+      double* radP, int* ndxP ) const
 {
-//*TIMING
-kcalls[16]+=1;QDateTime sttime=QDateTime::currentDateTime();
-//*TIMING
-   int    j2   = first_gteq( cconc, dscan->rvalues, valueCount );
+   const US_DataIO::Scan*  scan  = &edata->scanData.at( js );
+   const QVector< double >& xvs  = edata->xvalues;
+   int    j2   = first_gteq( cconc, bndmaxs.at( js ), valueCount );
    double rv0  = -1.0;          // Mark radius excluded
    double sedc = SEDC_NOVAL;
 
@@ -905,10 +995,10 @@ kcalls[16]+=1;QDateTime sttime=QDateTime::currentDateTime();
 
       if ( j2 > 0 )
       {  // Interpolate radius value
-         double av1  = dscan->rvalues[ j1 ];
-         double av2  = dscan->rvalues[ j2 ];
-         double rv1  = edata->xvalues[ j1 ];
-         double rv2  = edata->xvalues[ j2 ];
+         double av1  = scan->rvalues[ j1 ];
+         double av2  = scan->rvalues[ j2 ];
+         double rv1  = xvs[ j1 ];
+         double rv2  = xvs[ j2 ];
          double rra  = av2 - av1;
          rra         = ( rra == 0.0 ) ? 0.0 : ( ( rv2 - rv1 ) / rra );
          rv0         = rv1 + ( cconc - av1 ) * rra;
@@ -925,17 +1015,49 @@ kcalls[16]+=1;QDateTime sttime=QDateTime::currentDateTime();
    if ( rv0 > 0.0 )
    {  // Use radius and other terms to get corrected sedimentation coeff. value
       sedc        = correc * log( rv0 / edata->meniscus ) / oterm;
-//DbgLv(2) << "sed_coeff:   rv0" << rv0 << " sedc" << sedc << " oterm" << oterm;
    }
 
    if ( radP != NULL )    *radP = rv0;
    if ( ndxP != NULL )    *ndxP = j2;
-//*TIMING
-kmsecs[16]+=sttime.msecsTo(QDateTime::currentDateTime());
-//*TIMING
    return sedc;
 }
 
+// Build (if need be) the running-maximum readings tables of current data
+void US_vHW_Enhanced::bound_tables()
+{
+   int nscan   = edata->scanCount();
+
+   if ( bnd_edata == edata  &&  bndmaxs.size() == nscan )
+      return;
+
+   bndmaxs.resize( nscan );
+
+   US_vHW_Task task( this, US_vHW_Task::TABLES );
+   task.rows   = bndmaxs.data();
+
+   US_Parallel::run( &task, nscan );
+
+   bnd_edata   = edata;
+}
+
+// Build a scan's running-maximum readings table, whose first value at or
+//  above a concentration is where the readings first reach it
+void US_vHW_Enhanced::scan_table( int js, QVector< double >& rmaxes ) const
+{
+   const QVector< double >& rvals = edata->scanData.at( js ).rvalues;
+   int    nvals   = rvals.size();
+   double rmax    = ( nvals > 0 ) ? rvals[ 0 ] : 0.0;
+
+   rmaxes.resize( nvals );
+   double* rmaxp  = rmaxes.data();
+
+   for ( int jj = 0; jj < nvals; jj++ )
+   {
+      rmax        = qMax( rmax, rvals[ jj ] );
+      rmaxp[ jj ] = rmax;
+   }
+}
+
 // Calculate division sedimentation coefficient values (fitted line intercepts)
 void US_vHW_Enhanced::div_seds( )
 {
@@ -943,82 +1065,31 @@ void US_vHW_Enhanced::div_seds( )
 kcalls[1]+=1;QDateTime sttime=QDateTime::currentDateTime();
 //*TIMING
    QVector< double > xxv( lscnCount );
-   QVector< double > yyv( lscnCount );
    QVector< double > xrv( lscnCount );
    QVector< double > yrv( lscnCount );
-   double* xx       = xxv.data();
-   double* yy       = yyv.data();
-   double* xr       = xrv.data();
-   double* yr       = yrv.data();
-   int     nscnu    = 0;  // Number used (non-excluded) scans
-   int     kscnu    = 0;  // Count of scans of div not affected by diffusion
-   double  bdifcsqr = sqrt( bdiff_coef );  // Sqrt( diff_coeff ) used below
-   double  pconc;
-   double  mconc;
+   QVector< double > fitv( divsCount * 4 );
+   QVector< int >    npnv( divsCount );
+   int     nscnu    = lscnCount;  // Number used (non-excluded) scans
    bdtoler          = ct_tolerance->value();
    valueCount       = edata->pointCount();
-   double  bottom   = edata->radius( valueCount - 1 );
+   bound_tables();
 
-   // Do division-1 determination of base
+   // Do division-1 determination of base:  back-diffusion limits by scan
 
 //*TIMING
 kcalls[11]+=1;QDateTime sttim1=QDateTime::currentDateTime();
 //*TIMING
-   for ( int ii = 0; ii < lscnCount; ii++ )
-   {
-      double  timecor;   // Time (corrected)
-      double  timesqr;   // Square root of corrected time
-      double  bdleft;    // Back-diffusion left value
-      double  xbdleft;   // Find-root of bdleft
-      double  radD;      // Radius of back-diffusion point
-      double  omegasq;   // Omega squared
-
-      int js      = liveScans[ ii ];
-DbgLv(1) << "  ii nscnu" << ii << nscnu << " js lscnCount" << js << lscnCount;
-      dscan       = &edata->scanData[ js ];
-      omega       = dscan->rpm * M_PI / 30.0;
-      omegasq     = omega * omega;
-      timecor     = dscan->seconds - time_correction;
-      timesqr     = sqrt( timecor );
-      pconc       = baseline + ( scPlats[ ii ] - baseline ) * positPct;
-
-      xx[ ii ]    = 1.0 / timesqr;    // Save X (reciprocal sqrt(time))
-
-      // Accumulate limits based on back diffusion
-
-//left=tolerance*pow(diff,0.5)/(2*intercept[0]*omega_s*
-//  (bottom+run_inf.meniscus[selected_cell])/2
-//  *pow(run_inf.time[selected_cell][selected_lambda][i],0.5);
-//radD=bottom-(2*US_Math2::find_root(left)
-//  *pow((diff*run_inf.time[selected_cell][selected_lambda][i]),0.5));
-
-      // left = tolerance * sqrt( diff )
-      //        / ( 2 * intercept[0] * omega^2
-      //            * ( bottom + meniscus ) / 2 * sqrt( time ) )
-
-      bdleft      = bdtoler * bdifcsqr
-         / ( bdiff_sedc * omegasq * ( bottom + edata->meniscus ) * timesqr );
-      xbdleft     = US_Math2::find_root( bdleft );
-
-      // radD = bottom - ( 2 * US_Math2::find_root(left) * sqrt( diff * time ) )
-
-      radD        = bottom - ( 2.0 * xbdleft * bdifcsqr * timesqr );
-      radD        = qMax( edata->xvalues[ 0 ], qMin( bottom, radD ) );
-
-      int mm      = edata->xindex( radD );   // Radius's index
+   US_vHW_Task task( this, US_vHW_Task::BDIFF );
+   task.xx          = xxv.data();
+   task.xr          = xrv.data();
+   task.yr          = yrv.data();
+   task.fits        = fitv.data();
+   task.npnts       = npnv.data();
+   task.bottom      = edata->radius( valueCount - 1 );
 
-      // Accumulate for this scan of this division
-      //  the back diffusion limit radius and corresponding concentration
-      xr[ nscnu ] = radD;                    // BD Radius
-      yr[ nscnu ] = dscan->rvalues[ mm ];    // BD Concentration
-DbgLv(1) << "  bottom meniscus bdleft" << bottom << edata->meniscus << bdleft;
-DbgLv(1) << "  bdifsedc find_root toler" << bdiff_sedc << xbdleft << bdtoler;
-DbgLv(1) << "BD x,y " << nscnu+1 << radD << yr[nscnu] << "  mm" << mm;
-DbgLv(1) << "  ii nscnu" << ii << nscnu+1 << " bdsed radD yr"
- << bdiff_sedc << radD << yr[nscnu];
-
-      nscnu++;                               // Bump scans-used count
-   }
+   US_Parallel::run( &task, nscnu );
+DbgLv(1) << "  bottom meniscus" << task.bottom << edata->meniscus
+ << " bdifsedc toler" << bdiff_sedc << bdtoler;
 
    dseds.clear();
    dslos.clear();
@@ -1032,163 +1103,156 @@ kmsecs[11]+=sttim1.msecsTo(QDateTime::currentDateTime());
 kcalls[12]+=1;QDateTime sttim2=QDateTime::currentDateTime();
 //*TIMING
 
-   for ( int jj = 0; jj < divsCount; jj++ )
-   {  // Loop to fit points across scans in a division
-//*TIMING
-kcalls[13]+=1;QDateTime sttim3=QDateTime::currentDateTime();
-//*TIMING
-      double  dsed;
-      double  slope;
-      double  sigma;
-      double  corre;
-      int     ii;
-      double  oterm;
-      double  radC;
-      double  radD;
-      double  range;
-      double  rngFact  = boundPct * divfac;
-      double  rngjFact = rngFact  * jj;
-      double  conjFact = positPct + rngjFact;
-//DbgLv(1) << "div_sed div " << jj+1;
-
-      kscnu      = nscnu;
-//DbgLv(1) << "DVS jj" << jj << "nscnu" << nscnu;
-
-      // Accumulate y values for this division, across used scans
-
-      for ( int kk = 0; kk < nscnu; kk++ )
-      { // Accumulate concentration, sed.coeff. for all scans, this div
-         ii         = liveScans[ kk ];            // Scan index
-         dscan      = &edata->scanData[ ii ];     // Scan pointer
-//DbgLv(1) << "DVS  kk ii" << kk << ii;
-
-         if ( vhw_enh )
-         {
-//DbgLv(1) << "DVS   CPijs sz" << CPijs.size();
-//DbgLv(1) << "DVS   CPijs[0] sz" << CPijs[0].size();
-//DbgLv(1) << "DVS   mconcs sz" << mconcs.size();
-//DbgLv(1) << "DVS   mconcs[0] sz" << mconcs[0].size();
-            cpij       = CPijs [ kk ][ jj ];    // Partial concen (increment)
-            mconc      = mconcs[ kk ][ jj ];    // Mid-div concentration
-         }
-         else
-         {
-            range      = scPlats[ kk ] - baseline;    // Scan's range
-            pconc      = baseline + range * conjFact; // Base conc. of Div
-            cpij       = range * rngFact;       // Partial concentration
-            mconc      = pconc + cpij * 0.5;    // Mid-div concentration
-         }
+   // Fit points across scans in each division
 
-//DbgLv(1) << "DVS    kk jj" << kk << jj << "mconc cpij" << mconc << cpij;
-         omega      = dscan->rpm * M_PI / 30.0;   // Omega
-         oterm      = ( dscan->seconds - time_correction ) * omega * omega;
+   task.stage       = US_vHW_Task::DIVS;
 
-         yy[ kk ]   = sed_coeff( mconc, oterm, &radC, NULL );  // Sed.coeff.
-         radD       = xr[ kk ];
+   US_Parallel::run( &task, divsCount );
 
-         if ( radC > radD )
-         {  // Gone beyond back-diffusion cutoff: exit loop with truncated list
-            kscnu      = kk;
-            yy[ kk ]   = SEDC_NOVAL;
-//DbgLv(1) << " div kscnu" << jj+1 << kscnu
-//   << " radC radD" << radC << radD << " mconc sedcc" << mconc << yy[kk];
-            break;
-         }
-      }
-//*TIMING
-kmsecs[13]+=sttim3.msecsTo(QDateTime::currentDateTime());
-//*TIMING
-//*TIMING
-kcalls[14]+=1;QDateTime sttim4=QDateTime::currentDateTime();
-//*TIMING
+   for ( int jj = 0; jj < divsCount; jj++ )
+   {  // Save the fits of divisions with more than one point
+      int     kscnu    = npnv[ jj ];
+      double* fit      = fitv.data() + jj * 4;
 
-      int kscsv = kscnu;
-      QVector< double > xtvec;
-      QVector< double > ytvec;
-      ii         = 0;
-
-      for ( int kk = 0; kk < kscnu; kk++ )
-      {  // Remove any leading points below meniscus
-         if ( yy[ kk ] != SEDC_NOVAL )
-         { // Sed coeff value not from below meniscus
-            xtvec << xx[ kk ];
-            ytvec << yy[ kk ];
-            ii++;
-         }
-         else
-            DbgLv(1) << "KS +++ SED<=0.0 divjj" << jj << "scnkk ii" << kk << ii;
+      if ( kscnu < 2 )
+      {
+DbgLv(1) << "    jj kscnu" << jj << kscnu;
+         continue;
       }
-      kscnu      = ii;
-      double* xt = xtvec.data();
-      double* yt = ytvec.data();
-DbgLv(1) << " KS" << kscnu << kscsv << "size xtv ytv" << xtvec.size()
-   << ytvec.size();
+
+      dseds << fit[ 0 ];   // Save fitted line intercept (Sed.Coeff.)
+      dslos << fit[ 1 ];   // Save slope and other fitting values
+      dsigs << fit[ 2 ];
+      dcors << fit[ 3 ];
+      dpnts << kscnu;
+DbgLv(2) << "JJ" << jj << "DSED" << fit[0] << "dseds size" << dseds.size();
+   }
+   int kdivs = dseds.size();
+int k1=qMax(0,kdivs-1);
+if(kdivs>0)
+DbgLv(1) << " dsed[0]  " << dseds[0] << "kdivs" << kdivs << " dsed[L]  "
+ << dseds[k1];
+DbgLv(1) << " D_S: xr0 yr0 " << xrv[0] << yrv[0];
+DbgLv(1) << " D_S: xrN yrN " << xrv[nscnu-1] << yrv[nscnu-1] << nscnu;
+
+   // Save the Radius,Concentration points for back-diffusion cutoff curve
+   bdrads     = xrv;
+   bdcons     = yrv;
+
 //*TIMING
-kmsecs[14]+=sttim4.msecsTo(QDateTime::currentDateTime());
+kmsecs[12]+=sttim2.msecsTo(QDateTime::currentDateTime());
 //*TIMING
 //*TIMING
-kcalls[15]+=1;QDateTime sttim5=QDateTime::currentDateTime();
+kmsecs[1]+=sttime.msecsTo(QDateTime::currentDateTime());
 //*TIMING
+   return;
+}
 
-      if ( kscnu > 1 )
-      {
-         // Calculate and save the division sedcoeff and fitted line slope
+// Calculate the back-diffusion limit radius and concentration of a live scan
+void US_vHW_Enhanced::scan_bdiff( int ii, double bottom,
+      double* xx, double* xr, double* yr ) const
+{
+   int    js       = liveScans[ ii ];
+   const US_DataIO::Scan* scan = &edata->scanData.at( js );
+   double bdifcsqr = sqrt( bdiff_coef );       // Sqrt( diff_coeff )
+   double omega    = scan->rpm * M_PI / 30.0;
+   double omegasq  = omega * omega;
+   double timecor  = scan->seconds - time_correction;   // Time (corrected)
+   double timesqr  = sqrt( timecor );
 
-         US_Math2::linefit( &xt, &yt, &slope, &dsed, &sigma, &corre, kscnu );
-DbgLv(1) << " KS" << kscnu << kscsv << "jj" << jj << "xx0 xxn yy0 yyn" << xt[0]
- << xt[kscnu-1] << yt[0] << yt[kscnu-1] << "slo sed" << slope << dsed;
-      }
+   xx[ ii ]        = 1.0 / timesqr;    // Save X (reciprocal sqrt(time))
+
+   // Accumulate limits based on back diffusion
+
+//left=tolerance*pow(diff,0.5)/(2*intercept[0]*omega_s*
+//  (bottom+run_inf.meniscus[selected_cell])/2
+//  *pow(run_inf.time[selected_cell][selected_lambda][i],0.5);
+//radD=bottom-(2*US_Math2::find_root(left)
+//  *pow((diff*run_inf.time[selected_cell][selected_lambda][i]),0.5));
+
+   // left = tolerance * sqrt( diff )
+   //        / ( 2 * intercept[0] * omega^2
+   //            * ( bottom + meniscus ) / 2 * sqrt( time ) )
+
+   double bdleft   = bdtoler * bdifcsqr
+      / ( bdiff_sedc * omegasq * ( bottom + edata->meniscus ) * timesqr );
+   double xbdleft  = US_Math2::find_root( bdleft );
 
+   // radD = bottom - ( 2 * US_Math2::find_root(left) * sqrt( diff * time ) )
+
+   double radD     = bottom - ( 2.0 * xbdleft * bdifcsqr * timesqr );
+   radD            = qMax( edata->xvalues.at( 0 ), qMin( bottom, radD ) );
+
+   int mm          = edata->xindex( radD );   // Radius's index
+
+   // Save for this scan the back diffusion limit radius
+   //  and corresponding concentration
+   xr[ ii ]        = radD;                    // BD Radius
+   yr[ ii ]        = scan->rvalues[ mm ];     // BD Concentration
+}
+
+// Fit a line to the sedimentation coefficients of a division across scans,
+//  returning the number of points fitted and intercept,slope,sigma,correl.
+int US_vHW_Enhanced::div_fit( int jj, const double* xx, const double* xr,
+      double* xt, double* yt, double* fit ) const
+{
+   double  rngFact  = boundPct * divfac;
+   double  conjFact = positPct + rngFact * jj;
+   int     kscnu    = lscnCount;
+   double  radC;
+
+   // Accumulate y values for this division, across used scans
+
+   for ( int kk = 0; kk < lscnCount; kk++ )
+   { // Accumulate concentration, sed.coeff. for all scans, this div
+      int     js       = liveScans[ kk ];           // Scan index
+      const US_DataIO::Scan* scan = &edata->scanData.at( js );
+      double  mconc;
+
+      if ( vhw_enh )
+      {
+         mconc      = mconcs[ kk ][ jj ];           // Mid-div concentration
+      }
       else
       {
-         dsed       = yyv[ 0 ];
-         slope      = 0.0;
-         sigma      = 0.0;
-         corre      = 0.0;
-         slope      = 0.0;
-ii=(kscnu<1)?1:kscnu;
-DbgLv(1) << "    kscnu" << kscnu << "yy0 yyn " << yy[0] << yy[ii-1];
-         continue;
+         double range = scPlats[ kk ] - baseline;   // Scan's range
+         double pconc = baseline + range * conjFact; // Base conc. of Div
+         double cpij  = range * rngFact;            // Partial concentration
+         mconc      = pconc + cpij * 0.5;           // Mid-div concentration
       }
 
-      dseds << dsed;    // Save fitted line intercept (Sed.Coeff.)
-      dslos << slope;   // Save slope and other fitting values
-      dsigs << sigma;
-      dcors << corre;
-      dpnts << kscnu;
-DbgLv(1) << "JJ" << jj << "DSED" << dsed << "dseds size" << dseds.size();
-//*TIMING
-kmsecs[15]+=sttim5.msecsTo(QDateTime::currentDateTime());
-//*TIMING
+      double omega  = scan->rpm * M_PI / 30.0;      // Omega
+      double oterm  = ( scan->seconds - time_correction ) * omega * omega;
 
+      yt[ kk ]      = sed_coeff( js, mconc, oterm, &radC );  // Sed.coeff.
+
+      if ( radC > xr[ kk ] )
+      {  // Gone beyond back-diffusion cutoff: exit loop with truncated list
+         kscnu      = kk;
+         break;
+      }
    }
-   int kdivs = dseds.size();
-int k3=qMax(0,kdivs-3);
-int k2=qMax(0,kdivs-2);
-int k1=qMax(0,kdivs-1);
-DbgLv(1) << " dsed[0]  " << dseds[0] << "kdivs" << kdivs;
-DbgLv(1) << " dsed[k3] " << dseds[k3];
-DbgLv(1) << " dsed[k2] " << dseds[k2];
-DbgLv(1) << " dsed[L]  " << dseds[k1];
-DbgLv(1) << " D_S: xr0 yr0 " << xr[0] << yr[0];
-DbgLv(1) << " D_S: xrN yrN " << xr[nscnu-1] << yr[nscnu-1] << nscnu;
 
-   bdrads.clear();
-   bdcons.clear();
+   int npts   = 0;
 
-   for ( int kk = 0; kk < nscnu; kk++ )
-   {  // Save the Radius,Concentration points for back-diffusion cutoff curve
-      bdrads << xr[ kk ];
-      bdcons << yr[ kk ];
+   for ( int kk = 0; kk < kscnu; kk++ )
+   {  // Remove any leading points below meniscus
+      if ( yt[ kk ] != SEDC_NOVAL )
+      { // Sed coeff value not from below meniscus
+         xt[ npts ] = xx[ kk ];
+         yt[ npts ] = yt[ kk ];
+         npts++;
+      }
    }
 
-//*TIMING
-kmsecs[12]+=sttim2.msecsTo(QDateTime::currentDateTime());
-//*TIMING
-//*TIMING
-kmsecs[1]+=sttime.msecsTo(QDateTime::currentDateTime());
-//*TIMING
-   return;
+   if ( npts > 1 )
+   {  // Calculate the division sedcoeff and fitted line slope
+      fit[ 2 ]   = 0.0;
+
+      US_Math2::linefit( &xt, &yt, fit + 1, fit, fit + 2, fit + 3, npts );
+   }
+
+   return npts;
 }
 
 // Calculate back diffusion coefficient
@@ -1664,6 +1728,7 @@ kcalls[2]+=1;QDateTime sttime=QDateTime::currentDateTime();
    double* yr      = yrvec.data();
    double  sedc    = 0.0;
    int     nscnu   = 0;
+   bound_tables();
 
    for ( int ii = 0; ii < lscnCount; ii++ )
    {  // Accumulate x,y values:  1/sqrt(time), sed_coeff
@@ -1680,7 +1745,7 @@ kcalls[2]+=1;QDateTime sttime=QDateTime::currentDateTime();
       double oterm    = timecor * omega * omega;
 
       // Get sedimentation coefficient for concentration
-      sedc            = sed_coeff( mconc, oterm );
+      sedc            = sed_coeff( js, mconc, oterm );
 
       if ( sedc > 0.0 )
       {
@@ -2044,12 +2109,6 @@ void US_vHW_Enhanced::vhw_calcs_standard( double* ptx, double* pty )
 kcalls[5]+=1;QDateTime sttime=QDateTime::currentDateTime();
 //*TIMING
    int     totalCount;
-   double  cconc;
-   double  pconc;
-   double  mconc;
-   double  cinc;
-   double  cinch;
-   double  oterm;
    divsCount  = qRound( ct_division->value() );
    totalCount = scanCount * divsCount;
    divfac     = 1.0 / (double)divsCount;
@@ -2063,55 +2122,15 @@ kcalls[5]+=1;QDateTime sttime=QDateTime::currentDateTime();
    for ( int ii = 0; ii < totalCount; ii++ )
       pty[ ii ]   = SEDC_NOVAL;
 
-   int     kk     = 0;                    // Index to sed. coeff. values
-   int     kl     = 0;                    // Index/count of live scans
    valueCount     = edata->pointCount();
 
    // Calculate the corrected sedimentation coefficients
 
-   for ( int ii = 0; ii < lscnCount; ii++ )
-   {
-      range          = scPlats[ ii ] - baseline;
-      cinc           = range * boundPct * divfac;
-      int js         = liveScans[ ii ];
-      dscan          = &edata->scanData[ js ];
-      double  timev  = dscan->seconds - time_correction;
-      double  timex  = 1.0 / sqrt( timev );
-      double  bdrad  = bdrads.at( kl );   // Back-diffus cutoff radius for scan
-      double  bdcon  = bdcons.at( kl++ ); // Back-diffus cutoff concentration
-      double  divrad = 0.0;               // Division radius value
-DbgLv(1) << "scn liv" << ii+1 << kl
-   << " radius concen time" << bdrad << bdcon << timev;
-
-      ptx[ ii ]  = timex;                 // Save corrected time and accum max
-
-      range      = scPlats[ ii ] - baseline;
-      cconc      = baseline + range * positPct; // Initial conc for span
-      cinc       = range * boundPct * divfac;
-      cinch      = cinc * 0.5;
-      omega      = dscan->rpm * M_PI / 30.0;
-      oterm      = ( timev > 0.0 ) ? ( timev * omega * omega ) : -1.0;
-
-      for ( int jj = 0; jj < divsCount; jj++ )
-      {  // walk through division points; get sed. coeff. by place in readings
-         pconc       = cconc;               // Div base
-         cconc       = pconc + cinc;        // Absolute concentration
-         mconc       = pconc + cinch;       // Mid div concentration
-
-         sedc        = sed_coeff( mconc, oterm, &divrad, NULL );
+   US_vHW_Task task( this, US_vHW_Task::POINTS );
+   task.ptx       = ptx;
+   task.pty       = pty;
 
-         if ( divrad > bdrad )
-         {  // Mark a point to be excluded by back-diffusion
-            sedc        = SEDC_NOVAL;
-DbgLv(1) << "CPm: *excl* div" << jj+1 << " drad dcon " << divrad << mconc;
-         }
-DbgLv(1) << "CPm: ii jj" << ii << jj << "kk iSedc" << kk << sedc
-   << "mconc divrad bdrad" << mconc << divrad << bdrad;
-
-         // Y value of point is sedcoeff; accumulate y max
-         pty[ kk++ ] = sedc;
-      }
-   }
+   US_Parallel::run( &task, lscnCount );
 //*TIMING
 kmsecs[5]+=sttime.msecsTo(QDateTime::currentDateTime());
 //*TIMING
@@ -2125,9 +2144,6 @@ kcalls[6]+=1;QDateTime sttime=QDateTime::currentDateTime();
 //*TIMING
    int     count       = 0;
    int     totalCount;
-   double  mconc;
-   double  eterm;
-   double  oterm;
 
    edata      = ( ck_use_fed->isChecked()  &&  have_model() )
                 ? &dsimList[ row ] : &dataList[ row ];
@@ -2146,6 +2162,11 @@ kcalls[6]+=1;QDateTime sttime=QDateTime::currentDateTime();
 
    // Iterate to adjust plateaus until none needed or max iters reached
 
+   QVector< double > sdvec( lscnCount );
+   double* sdiffs    = sdvec.data();  // Span-sum differences by scan
+   US_vHW_Task task( this, US_vHW_Task::PARTS );
+   task.sdiffs       = sdiffs;
+
    int     iter      = 1;
    int     mxiter    = 3;          // maximum iterations
    double  avdthr    = 2.0e-5;     // threshold cp-absavg-diff
@@ -2160,47 +2181,19 @@ DbgLv(1) << "iter mxiter " << iter << mxiter;
 
       div_seds();
 
-      int divsUsed   = dseds.size();
+      // Reset division plateaus of each scan
+
+      task.stage     = US_vHW_Task::PARTS;
+      task.rows      = CPijs.data();
 
-      // Reset division plateaus
+      US_Parallel::run( &task, lscnCount );
 
       for ( int ii = 0; ii < lscnCount; ii++ )
       {
-         int js   = liveScans[ ii ];
-         dscan    = &edata->scanData[ js ];
-         omega    = dscan->rpm * M_PI / 30.0;
-         oterm    = ( dscan->seconds - time_correction ) * omega * omega;
-         eterm    = -2.0 * oterm / correc;
-         c0term   = ( C0 - baseline ) * boundPct * divfac;
-         span     = ( scPlats[ ii ] - baseline ) * boundPct;
-         sumcpij  = 0.0;
-
-         // Split the difference between divisions
-
-         for ( int jj = 0; jj < divsCount; jj++ )
-         {  // Recalculate partial concentrations based on sedcoeff intercepts
-            sedc     = ( jj < divsUsed ) ? dseds[ jj ] : SEDC_NOVAL;
-            cpij     = ( sedc != SEDC_NOVAL ) ?
-                       ( c0term * exp( sedc * eterm ) ) :
-                       CPijs[ ii ][ jj ];
-            CPijs[ ii ][ jj ] = cpij;
-            sumcpij += cpij;
-//DbgLv(1) << "    div " << jj+1 << "  tcdps cpij " << tcpds.at(jj) << cpij;
-         }
-
-         // Set to split span-sum difference over each division
-         sdiff    = ( span - sumcpij ) * divfac;
-
-         for ( int jj = 0; jj < divsCount; jj++ )
-         {  // Spread the difference to each partial plateau concentration
-            CPijs[ ii ][ jj ] += sdiff;
-         }
-
-         avgdif  += qAbs( sdiff );  // Sum of difference magnitudes
+         avgdif  += qAbs( sdiffs[ ii ] );  // Sum of difference magnitudes
          count++;
-DbgLv(1) << "   iter scn " << iter << ii+1 << " sumcpij span "
-   << sumcpij << span << "  sdiff sumabsdif" << sdiff << avgdif;
       }
+DbgLv(1) << "   iter" << iter << " sumabsdif" << avgdif;
 
       // Insure we have mid-division concentrations for newest partials
       update_mid_concs();
@@ -2220,50 +2213,102 @@ DbgLv(1) << "   +++ avgdif < avdthr (" << avgdif << avdthr << ") +++";
    for ( int ii = 0; ii < totalCount; ii++ )
       pty[ ii ]   = SEDC_NOVAL;
 
-   int     kk     = 0;                    // Index to sed. coeff. values
-   int     kl     = 0;                    // Index/count of live scans
    valueCount     = edata->pointCount();
 
    // Calculate the corrected sedimentation coefficients
 
-   for ( int ii = 0; ii < lscnCount; ii++ )
-   {
-      int js         = liveScans[ ii ];
-      dscan          = &edata->scanData[ js ];
+   task.stage     = US_vHW_Task::POINTS;
+   task.ptx       = ptx;
+   task.pty       = pty;
 
-      double  timev  = dscan->seconds - time_correction;
-      double  timex  = 1.0 / sqrt( timev );
-      double  bdrad  = bdrads.at( kl );   // Back-diffus cutoff radius for scan
-      double  bdcon  = bdcons.at( kl++ ); // Back-diffus cutoff concentration
-      double  divrad = 0.0;               // Division radius value
-DbgLv(1) << "scn liv" << ii+1 << kl
-   << " radius concen time" << bdrad << bdcon << timev;
+   US_Parallel::run( &task, lscnCount );
+//*TIMING
+kmsecs[6]+=sttime.msecsTo(QDateTime::currentDateTime());
+//*TIMING
 
-      ptx[ ii ]  = timex;                 // Save corrected time and accum max
+}
 
-      omega      = dscan->rpm * M_PI / 30.0;
-      oterm      = ( timev > 0.0 ) ? ( timev * omega * omega ) : -1.0;
+// Reset a live scan's partial concentrations from division intercepts,
+//  returning the span-sum difference spread over its divisions
+double US_vHW_Enhanced::scan_partials( int ii, QVector< double >& cpijs ) const
+{
+   int    js       = liveScans[ ii ];
+   const US_DataIO::Scan* scan = &edata->scanData.at( js );
+   double omega    = scan->rpm * M_PI / 30.0;
+   double oterm    = ( scan->seconds - time_correction ) * omega * omega;
+   double eterm    = -2.0 * oterm / correc;
+   double c0term   = ( C0 - baseline ) * boundPct * divfac;
+   double span     = ( scPlats[ ii ] - baseline ) * boundPct;
+   double sumcpij  = 0.0;
+   int    divsUsed = dseds.size();
+   double* cpijp   = cpijs.data();
+
+   // Split the difference between divisions
 
-      for ( int jj = 0; jj < divsCount; jj++ )
-      {  // walk through division points; get sed. coeff. by place in readings
-         mconc        = mconcs[ ii ][ jj ];  // Mid div concentration
+   for ( int jj = 0; jj < divsCount; jj++ )
+   {  // Recalculate partial concentrations based on sedcoeff intercepts
+      double sedc  = ( jj < divsUsed ) ? dseds[ jj ] : SEDC_NOVAL;
 
-         sedc         = sed_coeff( mconc, oterm, &divrad, NULL );
+      if ( sedc != SEDC_NOVAL )
+         cpijp[ jj ]  = c0term * exp( sedc * eterm );
 
-         if ( divrad > bdrad )
-         {  // Mark a point to be excluded by back-diffusion
-            sedc        = SEDC_NOVAL;
-DbgLv(1) << " *excl* div" << jj+1 << " drad dcon " << divrad << mconc;
-         }
+      sumcpij     += cpijp[ jj ];
+   }
 
-         // Y value of point is sedcoeff
-         pty[ kk++ ] = sedc;
-      }
+   // Set to split span-sum difference over each division
+   double sdiff    = ( span - sumcpij ) * divfac;
+
+   for ( int jj = 0; jj < divsCount; jj++ )
+   {  // Spread the difference to each partial plateau concentration
+      cpijp[ jj ] += sdiff;
    }
-//*TIMING
-kmsecs[6]+=sttime.msecsTo(QDateTime::currentDateTime());
-//*TIMING
 
+   return sdiff;
+}
+
+// Calculate the extrapolation plot points of all divisions of a live scan
+void US_vHW_Enhanced::scan_points( int ii, double* ptx, double* pty ) const
+{
+   int     js     = liveScans[ ii ];
+   const US_DataIO::Scan* scan = &edata->scanData.at( js );
+   double  timev  = scan->seconds - time_correction;
+   double  bdrad  = bdrads[ ii ];      // Back-diffus cutoff radius for scan
+   double  omega  = scan->rpm * M_PI / 30.0;
+   double  oterm  = ( timev > 0.0 ) ? ( timev * omega * omega ) : -1.0;
+   double  range  = scPlats[ ii ] - baseline;
+   double  cconc  = baseline + range * positPct; // Initial conc for span
+   double  cinc   = range * boundPct * divfac;
+   double  cinch  = cinc * 0.5;
+   double  divrad = 0.0;               // Division radius value
+   double* scnty  = pty + ii * divsCount;
+
+   ptx[ ii ]      = 1.0 / sqrt( timev );  // Save corrected time
+
+   for ( int jj = 0; jj < divsCount; jj++ )
+   {  // walk through division points; get sed. coeff. by place in readings
+      double mconc;
+
+      if ( vhw_enh )
+      {
+         mconc       = mconcs[ ii ][ jj ];  // Mid div concentration
+      }
+      else
+      {
+         double pconc = cconc;              // Div base
+         cconc       = pconc + cinc;        // Absolute concentration
+         mconc       = pconc + cinch;       // Mid div concentration
+      }
+
+      double sedc = sed_coeff( js, mconc, oterm, &divrad );
+
+      if ( divrad > bdrad )
+      {  // Mark a point to be excluded by back-diffusion
+         sedc        = SEDC_NOVAL;
+      }
+
+      // Y value of point is sedcoeff
+      scnty[ jj ] = sedc;
+   }
 }
 
 // Flag whether we have a model to use for finite-element plateau determination
@@ -30,10 +30,14 @@ typedef struct groupinfo_s
    QList< int >  idivs;       // list of divisions (0 to n-1) included
 } GrpInfo;
 
+class US_vHW_Task;
+
 class US_vHW_Enhanced : public US_AnalysisBase2
 {
    Q_OBJECT
 
+   friend class US_vHW_Task;
+
    public:
       US_vHW_Enhanced();
 
@@ -41,6 +45,9 @@ class US_vHW_Enhanced : public US_AnalysisBase2
 
       enum { NONE, START, END } groupstep;
 
+      // First stage of a vHW pass to redo (plateaus, intercept, divisions)
+      enum { VS_PLATS, VS_INTCP, VS_DIVS };
+
       QLabel*       lb_tolerance;
       QLabel*       lb_division;
 
@@ -96,6 +103,7 @@ class US_vHW_Enhanced : public US_AnalysisBase2
       int           valueCount;
       int           dbg_level;
       int           lscnCount;
+      int           vhw_redo;
 
       bool          haveZone;
       bool          groupSel;
@@ -129,6 +137,7 @@ class US_vHW_Enhanced : public US_AnalysisBase2
       QVector< QVector< double > > mconcs;     // Mid-div concs, divs in scans
       QVector< double >            bdrads;     // Back-diffusion radii
       QVector< double >            bdcons;     // Back-diffusion concentrations
+      QVector< QVector< double > > bndmaxs;    // Running-max readings of scans
 
       QList< double >              groupxy;    // Group select pick coordinates
       QList< GrpInfo >             groupdat;   // Selected group info structures
@@ -139,6 +148,8 @@ class US_vHW_Enhanced : public US_AnalysisBase2
       US_DataIO::Scan*             dscan;      // Current data scsan
       US_DataIO::Scan*             expsc;      // Current data scsan (exp.)
       US_DataIO::Scan*             simsc;      // Current data scsan (sim.)
+      US_DataIO::EditedData*       bnd_edata;  // Data of running-max tables
+      US_DataIO::EditedData*       vhw_edata;  // Data of last full vHW pass
 
       US_Model                     model;      // Current loaded model
 
@@ -158,9 +169,9 @@ class US_vHW_Enhanced : public US_AnalysisBase2
       void update_vbar(      double );
       void update_bdtoler(   double );
       void update_divis(     double );
-      int  first_gteq( double, QVector< double >&, int, int );
-      int  first_gteq( double, QVector< double >&, int );
-      double sed_coeff( double, double, double* = NULL, int* = NULL );
+      int  first_gteq( double, const QVector< double >&, int, int = -1 ) const;
+      double sed_coeff( int, double, double, double* = NULL,
+                        int* = NULL ) const;
       double avg_plateau(  void );
       double sedcoeff_intercept( void );
       double back_diff_coeff( double );
@@ -191,6 +202,13 @@ class US_vHW_Enhanced : public US_AnalysisBase2
       void create_simulation   ( void );
       void plot_data2          ( void );
       void get_model           ( void );
+      void bound_tables        ( void );
+      void scan_table          ( int, QVector< double >& ) const;
+      void scan_bdiff          ( int, double, double*, double*, double* ) const;
+      int  div_fit             ( int, const double*, const double*,
+                                 double*, double*, double* ) const;
+      double scan_partials     ( int, QVector< double >& ) const;
+      void scan_points         ( int, double*, double* ) const;
 
       void help     ( void )
       { showHelp.show_help( "vhw_enhanced.html" ); };
@@ -1725,6 +1725,7 @@ DbgLv(1) << "PltA: kpoint" << kpoint << "trpxs" << trpxs
    int     scan_nbr  = 0;
    QPen    pen_red ( Qt::red );
    QPen    pen_plot( US_GuiSettings::plotCurve() );
+   QList< US_PlotLodCurve* > lcurves;
    int     rdx       = radxs;
    int     colx      = -1;
    US_DataIO::RawData* rdata = &allData[ trpxs ];
@@ -1758,18 +1759,21 @@ DbgLv(1) << "PltA:   vv[n]" << vv[kpoint-1] << "scnx" << scnx
  << "scan_nbr" << scan_nbr << "colx" << colx;
       QString       title = tr( "Raw Data at scan " )
                             + QString::number( scan_nbr );
-      QwtPlotCurve* curv  = us_curve( data_plot, title );
+      US_PlotLodCurve* curv = new US_PlotLodCurve( data_plot, title );
 
       if ( scan_nbr > scan_to  ||  scan_nbr < scan_from )
          curv->setPen( pen_plot );            // Normal pen
       else
          curv->setPen( pen_red  );            // Scan-focus pen
 
-      curv->setSamples( rr, vv, kpoint );     // Build a scan curve
+      curv->setLodData( rr, vv, kpoint );     // Build a scan curve
+      lcurves << curv;
 //DbgLv(1) << "PltA:   scx" << scx << "rr0 vv0 rrn vvn"
 // << rr[0] << rr[kpoint-1] << vv[0] << vv[kpoint-1];
    }
 
+   US_PlotLodCurve::build_levels( lcurves );
+
 DbgLv(1) << "PltA: last_xmin" << last_xmin;
    if ( last_xmin < 0.0 )
    {  // If first time, use auto scale to set plot ranges
@@ -0,0 +1,998 @@
+//! \file us_benchmark.cpp
+
+#include <QApplication>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "us_benchmark.h"
+#include "us_settings.h"
+#include "us_util.h"
+#include "us_math2.h"
+#include "us_constants.h"
+#include "us_defines.h"
+#include "us_astfem_math.h"
+#include "us_astfem_rsa.h"
+#include "us_lamm_astfvm.h"
+
+// Kernel indexes and names
+enum bench_kernels { K_ASTFEM, K_ASTFVM, K_RESIDS, K_NNLS,
+                     K_READRAW, K_LOADDATA, K_RASTER, K_COUNT };
+
+static const char* kernel_names[] =
+{
+   "astfem_rsa", "lamm_astfvm", "calc_residuals", "nnls",
+   "read_raw", "load_data", "spectro_raster"
+};
+
+// Canned data sets:  name, scans, points, speeds, components,
+//                    grid points per axis, spectrogram points
+static const BenchSize bench_sizes[] =
+{
+   { "small",       30,  250, 1,  1,  6,  200 },
+   { "medium",      60,  600, 1,  4,  8, 1000 },
+   { "multispeed",  60,  600, 3,  4,  8, 1000 },
+   { "large",      120, 1200, 1, 12, 10, 5000 }
+};
+
+static const int n_sizes = sizeof( bench_sizes ) / sizeof( bench_sizes[ 0 ] );
+
+//! \brief Main program for us_benchmark. Parses the command line,
+//         then runs the selected kernel benchmarks.
+
+int main( int argc, char* argv[] )
+{
+#if QT_VERSION < 0x050000
+   QApplication application( argc, argv, false );
+#else
+   if ( qgetenv( "DISPLAY" ).isEmpty() )
+      qputenv( "QT_QPA_PLATFORM", "offscreen" );
+
+   QApplication application( argc, argv );
+#endif
+
+   QStringList cmdargs = application.arguments();
+
+   US_Benchmark bench( cmdargs );
+
+   if ( ! bench.is_ready() )
+      return 1;
+
+   return bench.run();
+}
+
+// Benchmark constructor:  parse arguments
+US_Benchmark::US_Benchmark( QStringList& cmdargs )
+{
+   dbg_level  = US_Settings::us_debug();
+   tolerance  = 0.10;
+   seed       = 12345;
+   nreps      = 0;
+   ready      = false;
+   bool quick = false;
+   QString slist;
+   QString klist;
+   QString tlist;
+
+   for ( int jj = 1; jj < cmdargs.size(); jj++ )
+   {
+      QString arg  = cmdargs[ jj ];
+
+      if ( arg == "-quick" )
+         quick        = true;
+
+      else if ( arg.startsWith( "-" )  &&  ( jj + 1 ) < cmdargs.size() )
+      {
+         QString val  = cmdargs[ ++jj ];
+
+         if      ( arg == "-reps" )      nreps     = val.toInt();
+         else if ( arg == "-threads" )   tlist     = val;
+         else if ( arg == "-sizes" )     slist     = val;
+         else if ( arg == "-kernels" )   klist     = val;
+         else if ( arg == "-out" )       outfile   = val;
+         else if ( arg == "-baseline" )  basefile  = val;
+         else if ( arg == "-tolerance" ) tolerance = val.toDouble();
+         else if ( arg == "-seed" )      seed      = val.toUInt();
+         else
+         {
+            usage();
+            return;
+         }
+      }
+
+      else
+      {
+         usage();
+         return;
+      }
+   }
+
+   // Data sets:  all, or the two smallest for a quick run
+   QStringList allsizes;
+   for ( int jj = 0; jj < n_sizes; jj++ )
+      allsizes << bench_sizes[ jj ].name;
+
+   sizes      = slist.isEmpty() ? allsizes : slist.split( "," );
+
+   if ( quick  &&  slist.isEmpty() )
+      sizes      = allsizes.mid( 0, 2 );
+
+   // Kernels:  all, or those given
+   QStringList allkerns;
+   for ( int jj = 0; jj < K_COUNT; jj++ )
+      allkerns << kernel_names[ jj ];
+
+   kernels    = klist.isEmpty() ? allkerns : klist.split( "," );
+
+   for ( int jj = 0; jj < sizes.size(); jj++ )
+   {
+      if ( ! allsizes.contains( sizes[ jj ] ) )
+      {
+         printf( "*ERROR* Unknown data set \"%s\"\n",
+                 qPrintable( sizes[ jj ] ) );
+         return;
+      }
+   }
+
+   for ( int jj = 0; jj < kernels.size(); jj++ )
+   {
+      if ( ! allkerns.contains( kernels[ jj ] ) )
+      {
+         printf( "*ERROR* Unknown kernel \"%s\"\n",
+                 qPrintable( kernels[ jj ] ) );
+         return;
+      }
+   }
+
+   // Thread counts:  powers of 2 up to the ideal count, plus that count;
+   //  one thread is always timed, since it is the speedup base
+   int maxthr = QThread::idealThreadCount();
+   thrcounts << 1;
+
+   if ( tlist.isEmpty() )
+   {
+      for ( int nthr = 2; nthr < maxthr; nthr *= 2 )
+         thrcounts << nthr;
+
+      thrcounts << maxthr;
+   }
+
+   else
+   {
+      QStringList tvals = tlist.split( "," );
+
+      for ( int jj = 0; jj < tvals.size(); jj++ )
+         thrcounts << qBound( 1, tvals[ jj ].toInt(), maxthr );
+   }
+
+   qSort( thrcounts );
+   for ( int jj = thrcounts.size() - 1; jj > 0; jj-- )
+   {
+      if ( thrcounts[ jj ] == thrcounts[ jj - 1 ] )
+         thrcounts.removeAt( jj );
+   }
+
+   if ( nreps < 1 )
+      nreps      = quick ? 3 : 5;
+
+   workdir    = US_Settings::tmpDir() + "/bench" + QString::number( getpid() );
+   ready      = true;
+}
+
+void US_Benchmark::usage()
+{
+   printf( "Usage:  us_benchmark [-quick] [-reps N] [-threads N,N,...]\n"
+           "          [-sizes name,...] [-kernels name,...] [-seed N]\n"
+           "          [-out file] [-baseline file] [-tolerance fraction]\n\n"
+           "  -quick      time only the small and medium data sets\n"
+           "  -reps       timed repetitions of each configuration\n"
+           "  -threads    thread counts (default powers of 2 to all cores)\n"
+           "  -out        JSON results file (default standard output)\n"
+           "  -baseline   JSON results of an earlier run to compare to\n"
+           "  -tolerance  median slowdown fraction that is a regression\n\n"
+           "  data sets:  small medium multispeed large\n"
+           "  kernels:    astfem_rsa lamm_astfvm calc_residuals nnls\n"
+           "              read_raw load_data spectro_raster\n\n"
+           "  The exit status is 2 if any regression is found.\n" );
+   fflush( stdout );
+}
+
+// Run all selected benchmarks and write the results
+int US_Benchmark::run()
+{
+   QTime timer;
+   timer.start();
+   QDir().mkpath( workdir );
+
+   for ( int ii = 0; ii < n_sizes; ii++ )
+   {
+      if ( ! sizes.contains( bench_sizes[ ii ].name ) )
+         continue;
+
+      US_BenchSet bset( bench_sizes[ ii ], workdir, seed );
+      QString emsg;
+
+      fprintf( stderr, "us_benchmark: building data set %s\n",
+               bench_sizes[ ii ].name );
+
+      if ( ! bset.build( emsg ) )
+      {
+         fprintf( stderr, "*ERROR* Data set %s:  %s\n",
+                  bench_sizes[ ii ].name, qPrintable( emsg ) );
+         bset.remove_files();
+         QDir().rmdir( workdir );
+         return 1;
+      }
+
+      for ( int kx = 0; kx < K_COUNT; kx++ )
+      {
+         if ( kernels.contains( kernel_names[ kx ] ) )
+            time_kernel( kx, &bset );
+      }
+
+      bset.remove_files();
+   }
+
+   QDir().rmdir( workdir );
+
+   // Compare to any baseline
+   QStringList regress;
+   int nregress  = compare_base( regress );
+
+   if ( nregress < 0 )
+      return 1;
+
+   // Write the results, one object per line
+   QFile fout( outfile );
+   QIODevice::OpenMode omode = QIODevice::WriteOnly | QIODevice::Text;
+   bool  ok      = outfile.isEmpty() ? fout.open( stdout, omode )
+                                     : fout.open( omode );
+
+   if ( ! ok )
+   {
+      fprintf( stderr, "*ERROR* Unable to open output file %s\n",
+               qPrintable( outfile ) );
+      return 1;
+   }
+
+   QTextStream ts( &fout );
+   ts << "{\n";
+   ts << "  \"program\": \"us_benchmark\",\n";
+   ts << "  \"us_version\": \"" << US_Version << "\",\n";
+   ts << "  \"qt_version\": \"" << qVersion() << "\",\n";
+   ts << "  \"date\": \""
+      << QDateTime::currentDateTime().toUTC().toString( Qt::ISODate )
+      << "\",\n";
+   ts << "  \"ideal_threads\": " << QThread::idealThreadCount() << ",\n";
+   ts << "  \"seed\": " << seed << ",\n";
+   ts << "  \"tolerance\": " << tolerance << ",\n";
+   ts << "  \"results\": [\n";
+
+   for ( int ii = 0; ii < results.size(); ii++ )
+   {
+      ts << "    " << json_result( results[ ii ] )
+         << ( ( ii + 1 ) < results.size() ? ",\n" : "\n" );
+   }
+
+   ts << "  ],\n";
+   ts << "  \"regressions\": [\n";
+
+   for ( int ii = 0; ii < regress.size(); ii++ )
+   {
+      ts << "    " << regress[ ii ]
+         << ( ( ii + 1 ) < regress.size() ? ",\n" : "\n" );
+   }
+
+   ts << "  ]\n";
+   ts << "}\n";
+   ts.flush();
+   fout.close();
+
+   fprintf( stderr, "us_benchmark: %d results in %.1f seconds;"
+            " %d regressions\n",
+            results.size(), (double)timer.elapsed() / 1000.0, nregress );
+
+   return ( nregress > 0 ) ? 2 : 0;
+}
+
+// Time a kernel on a data set at all thread counts
+void US_Benchmark::time_kernel( const int kernx, US_BenchSet* bset )
+{
+   // Loading uses the event loop, so it is only timed on the main thread
+   QStringList modes;
+   modes << ( ( kernx == K_LOADDATA ) ? "serial" : "throughput" );
+
+   if ( kernx == K_ASTFEM  &&  bset->size.ncomps > 1 )
+      modes << "intrinsic";
+
+   for ( int mm = 0; mm < modes.size(); mm++ )
+   {
+      QString mode    = modes[ mm ];
+      double  base_ms = 0.0;
+
+      for ( int tt = 0; tt < thrcounts.size(); tt++ )
+      {
+         int nthr        = thrcounts[ tt ];
+
+         if ( mode == "serial"  &&  nthr > 1 )
+            break;
+
+         BenchResult bres = time_config( kernx, bset, mode, nthr );
+
+         if ( nthr == 1 )
+            base_ms         = bres.median_ms;
+
+         bres.speedup     = ( bres.median_ms > 0.0 )
+                            ? ( base_ms / bres.median_ms ) : 0.0;
+
+         if ( mode == "throughput" )
+            bres.speedup    *= (double)nthr;
+
+         results << bres;
+
+         fprintf( stderr, "  %-15s %-10s %-10s %3d thr  median %10.3f ms"
+                  "  speedup %6.2f\n",
+                  kernel_names[ kernx ], bset->size.name, qPrintable( mode ),
+                  nthr, bres.median_ms, bres.speedup );
+      }
+   }
+}
+
+// Time one kernel configuration, after one untimed warm-up pass
+BenchResult US_Benchmark::time_config( const int kernx, US_BenchSet* bset,
+      const QString& mode, const int nthr )
+{
+   US_BenchTask task;
+   task.kernx      = kernx;
+   task.bset       = bset;
+
+   QVector< double > times;
+   QElapsedTimer     etimer;
+
+   for ( int jr = -1; jr < nreps; jr++ )
+   {
+      etimer.start();
+
+      if ( mode == "throughput" )
+         US_Parallel::run( &task, nthr, nthr );
+      else
+         run_kernel( kernx, bset, nthr );
+
+      double msecs    = (double)etimer.nsecsElapsed() * 1.0e-6;
+
+      if ( jr >= 0 )
+         times << msecs;
+   }
+
+   qSort( times );
+   int    ntime    = times.size();
+   double tsum     = 0.0;
+
+   for ( int jr = 0; jr < ntime; jr++ )
+      tsum           += times[ jr ];
+
+   BenchResult bres;
+   bres.kernel     = kernel_names[ kernx ];
+   bres.dataset    = bset->size.name;
+   bres.mode       = mode;
+   bres.threads    = nthr;
+   bres.reps       = ntime;
+   bres.min_ms     = times[ 0 ];
+   int    kmid     = ntime / 2;
+   bres.median_ms  = ( ( ntime & 1 ) != 0 )
+                     ? times[ kmid ]
+                     : ( ( times[ kmid - 1 ] + times[ kmid ] ) * 0.5 );
+   bres.mean_ms    = tsum / (double)ntime;
+   bres.speedup    = 1.0;
+   return bres;
+}
+
+// Run one invocation of a kernel. Each invocation makes its own copies of
+//  any inputs that the kernel modifies, just as the analysis callers do.
+void US_Benchmark::run_kernel( const int kernx, US_BenchSet* bset,
+                               const int nthr )
+{
+   switch ( kernx )
+   {
+      case K_ASTFEM:
+      {
+         US_Model                model   = bset->model;
+         US_SimulationParameters sparams = bset->simparams;
+         US_DataIO::RawData      sdata   = bset->zdata;
+         US_Astfem_RSA astfem( model, sparams );
+         astfem.set_thread_count( nthr );
+         astfem.calculate( sdata );
+         break;
+      }
+
+      case K_ASTFVM:
+      {
+         US_Model                model   = bset->model;
+         US_SimulationParameters sparams = bset->simparams;
+         US_DataIO::RawData      sdata   = bset->zdata;
+         US_LammAstfvm astfvm( model, sparams );
+         astfvm.calculate( sdata );
+         break;
+      }
+
+      case K_RESIDS:
+      {
+         US_SolveSim::Simulation sim_vals;
+         sim_vals.solutes   = bset->solutes;
+         sim_vals.noisflag  = 0;
+         sim_vals.dbg_level = 0;
+         US_SolveSim solvesim( bset->dsets, 1, false );
+         solvesim.calc_residuals( 0, 1, sim_vals );
+         break;
+      }
+
+      case K_NNLS:
+      {
+         QVector< double > amat  = bset->amat;
+         QVector< double > bvec  = bset->bvec;
+         QVector< double > xvec( bset->acols, 0.0 );
+         double            rnorm = 0.0;
+         US_Math2::nnls( amat.data(), bset->arows, bset->arows, bset->acols,
+                         bvec.data(), xvec.data(), &rnorm );
+         break;
+      }
+
+      case K_READRAW:
+      {
+         US_DataIO::RawData rdata;
+         US_DataIO::readRawData( bset->dir + "/" + bset->aucfile, rdata );
+         break;
+      }
+
+      case K_LOADDATA:
+      {
+         US_DataIO::EditedData edata;
+         try
+         {
+            US_DataIO::loadData( bset->dir, bset->editfile, edata );
+         }
+         catch ( US_DataIO::ioError err )
+         {
+            qDebug() << "*ERROR* load_data:" << US_DataIO::errorString( err );
+         }
+         break;
+      }
+
+      case K_RASTER:
+      {
+         QList< S_Solute > spoints = bset->spoints;
+         US_SpectrogramData spec_dat;
+         spec_dat.setRastRanges( 400.0, 300.0, 90.0, 100.0,
+                                 QRectF( 0.0, 0.0, 0.0, 0.0 ) );
+         spec_dat.setRaster( &spoints );
+         break;
+      }
+
+      default:
+         break;
+   }
+}
+
+// Format one result as a single-line JSON object
+QString US_Benchmark::json_result( const BenchResult& bres )
+{
+   QString name  = bres.kernel + "/" + bres.dataset + "/" + bres.mode
+                   + "/t" + QString::number( bres.threads );
+
+   return QString( "{ \"name\": \"%1\", \"kernel\": \"%2\","
+                   " \"dataset\": \"%3\", \"mode\": \"%4\","
+                   " \"threads\": %5, \"reps\": %6, \"min_ms\": %7,"
+                   " \"median_ms\": %8, \"mean_ms\": %9, \"speedup\": %10 }" )
+          .arg( name ).arg( bres.kernel ).arg( bres.dataset ).arg( bres.mode )
+          .arg( bres.threads ).arg( bres.reps )
+          .arg( bres.min_ms,    0, 'f', 3 )
+          .arg( bres.median_ms, 0, 'f', 3 )
+          .arg( bres.mean_ms,   0, 'f', 3 )
+          .arg( bres.speedup,   0, 'f', 3 );
+}
+
+// Compare result medians to those of a baseline file. Returns the count of
+//  regressions, with a JSON object for each, or -1 if the file is unreadable.
+int US_Benchmark::compare_base( QStringList& regress )
+{
+   regress.clear();
+
+   if ( basefile.isEmpty() )
+      return 0;
+
+   QFile bfile( basefile );
+
+   if ( ! bfile.open( QIODevice::ReadOnly | QIODevice::Text ) )
+   {
+      fprintf( stderr, "*ERROR* Unable to open baseline file %s\n",
+               qPrintable( basefile ) );
+      return -1;
+   }
+
+   // Each result is on one line, so a simple pattern finds name and median
+   QMap< QString, double > base_ms;
+   QRegExp rx( "\"name\": \"([^\"]+)\".*\"median_ms\": ([-+0-9.eE]+)" );
+   QTextStream ts( &bfile );
+
+   while ( ! ts.atEnd() )
+   {
+      QString line = ts.readLine();
+
+      if ( rx.indexIn( line ) >= 0 )
+         base_ms[ rx.cap( 1 ) ] = rx.cap( 2 ).toDouble();
+   }
+
+   bfile.close();
+
+   int nmatch    = 0;
+
+   for ( int ii = 0; ii < results.size(); ii++ )
+   {
+      QString name  = results[ ii ].kernel + "/" + results[ ii ].dataset
+                      + "/" + results[ ii ].mode + "/t"
+                      + QString::number( results[ ii ].threads );
+
+      if ( ! base_ms.contains( name ) )
+         continue;
+
+      nmatch++;
+      double bmed   = base_ms[ name ];
+      double cmed   = results[ ii ].median_ms;
+
+      if ( bmed > 0.0  &&  cmed > ( bmed * ( 1.0 + tolerance ) ) )
+      {
+         regress << QString( "{ \"name\": \"%1\", \"baseline_ms\": %2,"
+                             " \"median_ms\": %3, \"ratio\": %4 }" )
+                    .arg( name )
+                    .arg( bmed, 0, 'f', 3 )
+                    .arg( cmed, 0, 'f', 3 )
+                    .arg( cmed / bmed, 0, 'f', 3 );
+
+         fprintf( stderr, "*REGRESSION* %s  %.3f ms -> %.3f ms\n",
+                  qPrintable( name ), bmed, cmed );
+      }
+   }
+
+   fprintf( stderr, "us_benchmark: %d of %d results matched the baseline\n",
+            nmatch, results.size() );
+
+   return regress.size();
+}
+
+// Data set constructor
+US_BenchSet::US_BenchSet( const BenchSize& a_size, const QString& a_dir,
+                          const uint a_seed )
+{
+   size       = a_size;
+   dir        = a_dir;
+   seed       = a_seed;
+   arows      = 0;
+   acols      = 0;
+   dbg_level  = US_Settings::us_debug();
+
+   QString runID = QString( "bench" ) + size.name;
+   aucfile    = runID + ".RA.1.A.260.auc";
+   editfile   = runID + ".e01.RA.1.A.260.xml";
+   tmstpath   = dir + "/" + runID + ".time_state.tmst";
+}
+
+// Build the data set files and all kernel inputs
+bool US_BenchSet::build( QString& emsg )
+{
+   // The same seed gives the same noise and distributions in every run
+   US_Math2::randomize( seed );
+
+   build_simparms();
+
+   if ( simparams.simSpeedsFromTimeState( tmstpath ) < 1 )
+   {
+      emsg       = QString( "Unable to build TimeState %1" ).arg( tmstpath );
+      return false;
+   }
+
+   build_model();
+
+   // Simulate the raw data and add Gaussian noise
+   US_DataIO::RawData       rdata   = zdata;
+   US_SimulationParameters  sparams = simparams;
+   US_Model                 smodel  = model;
+   US_Astfem_RSA astfem( smodel, sparams );
+   astfem.set_thread_count( 1 );
+   astfem.calculate( rdata );
+
+   int nipts     = ( rdata.xvalues.size() + 7 ) / 8;
+
+   for ( int js = 0; js < rdata.scanData.size(); js++ )
+   {
+      US_DataIO::Scan* scan = &rdata.scanData[ js ];
+
+      for ( int jr = 0; jr < scan->rvalues.size(); jr++ )
+         scan->rvalues[ jr ] += US_Math2::box_muller( 0.0, 0.005 );
+
+      scan->interpolated.fill( (char)0, nipts );
+      scan->stddevs  .clear();
+      scan->nz_stddev = false;
+   }
+
+   rdata.channel     = 'A';
+   rdata.description = QString( "Benchmark data set " ) + size.name;
+
+   if ( US_DataIO::writeRawData( dir + "/" + aucfile, rdata )
+        != US_DataIO::OK )
+   {
+      emsg       = QString( "Unable to write %1" ).arg( aucfile );
+      return false;
+   }
+
+   if ( ! write_edit( US_Util::uuid_unparse( (uchar*)rdata.rawGUID ) ) )
+   {
+      emsg       = QString( "Unable to write %1" ).arg( editfile );
+      return false;
+   }
+
+   // Load the edited data as the analyses do
+   try
+   {
+      US_DataIO::loadData( dir, editfile, edata );
+   }
+   catch ( US_DataIO::ioError err )
+   {
+      emsg       = US_DataIO::errorString( err );
+      return false;
+   }
+
+   // Build the fitting data set:  water at 20 degrees
+   double avTemp = edata.average_temperature();
+   double vbar20 = TYPICAL_VBAR;
+   double vbartb = US_Math2::adjust_vbar20( vbar20, avTemp );
+
+   US_Math2::SolutionData sd;
+   sd.density    = DENS_20W;
+   sd.viscosity  = VISC_20W;
+   sd.vbar20     = vbar20;
+   sd.vbar       = vbartb;
+   sd.manual     = false;
+   US_Math2::data_correction( avTemp, sd );
+
+   dset.run_data         = edata;
+   dset.viscosity        = sd.viscosity;
+   dset.density          = sd.density;
+   dset.compress         = 0.0;
+   dset.temperature      = avTemp;
+   dset.vbar20           = vbar20;
+   dset.vbartb           = vbartb;
+   dset.s20w_correction  = sd.s20w_correction;
+   dset.D20w_correction  = sd.D20w_correction;
+   dset.manual           = sd.manual;
+   dset.edit_file        = editfile;
+   dset.solute_type      = 0;
+   dset.zcoeffs[ 0 ]     = 0.0;
+   dset.zcoeffs[ 1 ]     = 0.0;
+   dset.zcoeffs[ 2 ]     = 0.0;
+   dset.zcoeffs[ 3 ]     = 0.0;
+   dset.rotor_stretch[ 0 ] = 0.0;
+   dset.rotor_stretch[ 1 ] = 0.0;
+   dset.centerpiece_bottom = simparams.bottom_position;
+
+   dset.simparams.initFromData( NULL, dset.run_data, false );
+   dset.simparams.speed_step = simparams.speed_step;
+
+   if ( dset.simparams.simSpeedsFromTimeState( tmstpath ) < 1 )
+   {
+      emsg       = QString( "Unable to read TimeState %1" ).arg( tmstpath );
+      return false;
+   }
+
+   dset.tmst_file        = tmstpath;
+   dset.simparams.speedstepsFromSSprof();
+   dsets.clear();
+   dsets << &dset;
+
+   build_solutes();
+   build_nnls();
+   build_spectrum();
+
+DbgLv(1) << "BS:build:" << size.name << "scans points" << edata.scanCount()
+ << edata.pointCount() << "solutes" << solutes.size()
+ << "nnls rows cols" << arows << acols;
+   return true;
+}
+
+// Remove the files written by build()
+void US_BenchSet::remove_files()
+{
+   QFile( dir + "/" + aucfile  ).remove();
+   QFile( dir + "/" + editfile ).remove();
+   QFile( tmstpath ).remove();
+   QFile( QString( tmstpath ).replace( ".tmst", ".xml" ) ).remove();
+}
+
+// Build simulation parameters, the zeroed data template and a TimeState,
+//  as US_Astfem_Sim does for its simulations
+void US_BenchSet::build_simparms()
+{
+   simparams.meniscus          = 5.8;
+   simparams.bottom            = 7.2;
+   simparams.bottom_position   = 7.2;
+   simparams.temperature       = NORMAL_TEMP;
+   simparams.radial_resolution = ( simparams.bottom - simparams.meniscus )
+                                 / (double)( size.npoints - 1 );
+   simparams.speed_step.clear();
+
+   // Speed steps of equal length that share the scans
+   int    nstep   = size.nspeeds;
+   int    nscstep = size.nscans / nstep;
+   double dur_hrs = ( nstep == 1 ) ? 4.0 : 2.0;
+
+   for ( int jd = 0; jd < nstep; jd++ )
+   {
+      SP_SPEEDPROFILE sp;
+      sp.duration_hours    = (int)dur_hrs;
+      sp.duration_minutes  = 0.0;
+      sp.delay_hours       = 0;
+      sp.delay_minutes     = ( jd == 0 ) ? 20.0 : 5.0;
+      sp.scans             = nscstep;
+      sp.rotorspeed        = ( nstep == 1 ) ? 45000 : ( 25000 + jd * 10000 );
+      sp.set_speed         = sp.rotorspeed;
+      sp.avg_speed         = sp.rotorspeed;
+      sp.acceleration      = 400;
+      simparams.speed_step << sp;
+   }
+
+   zdata.xvalues .clear();
+   zdata.scanData.clear();
+   zdata.type[ 0 ]   = 'R';
+   zdata.type[ 1 ]   = 'A';
+   US_Util::uuid_parse( US_Util::new_guid(), (uchar*)zdata.rawGUID );
+   zdata.cell        = 1;
+   zdata.channel     = 'S';
+   zdata.description = "Simulation";
+
+   int points    = size.npoints;
+   zdata.xvalues.resize( points );
+
+   for ( int jp = 0; jp < points; jp++ )
+      zdata.xvalues[ jp ] = simparams.meniscus
+                            + jp * simparams.radial_resolution;
+
+   zdata.xvalues[ points - 1 ] = simparams.bottom;
+
+   // Fill in speed steps with scan times and omega^2t; build the template
+   double time0   = 0.0;
+   double time2   = 0.0;
+   double w2tsum  = 0.0;
+   double s_speed = 0.0;
+
+   for ( int jd = 0; jd < nstep; jd++ )
+   {
+      SP_SPEEDPROFILE* sp = &simparams.speed_step[ jd ];
+      time0          = time2;
+      double c_speed = s_speed;
+      s_speed        = sp->set_speed;
+      double accel   = sp->acceleration;
+      double dlay    = sp->delay_hours    * 3600.0 + sp->delay_minutes    * 60.0;
+      double durat   = sp->duration_hours * 3600.0 + sp->duration_minutes * 60.0;
+      double time1   = qRound( time0 + dlay  );
+      time2          = qRound( time0 + durat );
+      double c_time  = time0;
+      double timeinc = ( time2 - time1 ) / (double)( sp->scans - 1 );
+
+      while ( c_speed < s_speed )
+      {  // Walk through acceleration zone building omega2t sum
+         c_speed       += accel;
+         w2tsum        += sq( c_speed * M_PI / 30.0 );
+         c_time        += 1.0;
+      }
+
+      c_speed        = s_speed;
+      double w2tinc  = sq( c_speed * M_PI / 30.0 );
+
+      while ( c_time < time1 )
+      {  // Walk up to the first scan time, accumulating omega2t sum
+         c_time        += 1.0;
+         w2tsum        += w2tinc;
+      }
+
+      sp->time_first = time1;
+      sp->w2t_first  = w2tsum;
+      w2tinc         = timeinc * sq( c_speed * M_PI / 30.0 );
+      c_time         = time1 - timeinc;
+      w2tsum         = w2tsum - w2tinc;
+
+      US_DataIO::Scan scandata;
+      scandata.temperature = simparams.temperature;
+      scandata.rpm         = c_speed;
+      scandata.omega2t     = w2tsum;
+      scandata.wavelength  = 260.0;
+      scandata.plateau     = 0.0;
+      scandata.delta_r     = simparams.radial_resolution;
+      scandata.nz_stddev   = false;
+      scandata.rvalues     .fill( 0.0, points );
+
+      for ( int js = 0; js < sp->scans; js++ )
+      {  // Save scan times and omega2ts
+         c_time           += timeinc;
+         w2tsum           += w2tinc;
+         scandata.seconds  = (double)qRound( c_time );
+         scandata.omega2t  = w2tsum;
+         zdata.scanData << scandata;
+      }
+
+      sp->time_last  = time2;
+      sp->w2t_last   = w2tsum;
+   }
+
+   US_AstfemMath::writetimestate( tmstpath, simparams, zdata );
+}
+
+// Build the generating model:  components spread over 3 to 12 S
+void US_BenchSet::build_model()
+{
+   int ncomp     = size.ncomps;
+   model.components.clear();
+
+   for ( int cc = 0; cc < ncomp; cc++ )
+   {
+      double frac   = ( ncomp > 1 ) ? ( (double)cc / (double)( ncomp - 1 ) )
+                                    : 0.5;
+      US_Model::SimulationComponent comp;
+      comp.name     = QString( "Comp %1" ).arg( cc + 1 );
+      comp.s        = ( 3.0 + 9.0 * frac ) * 1.0e-13;
+      comp.f_f0     = 1.25 + 0.25 * (double)( cc % 3 );
+      comp.vbar20   = TYPICAL_VBAR;
+      comp.signal_concentration = 1.0 / (double)ncomp;
+      comp.D        = 0.0;
+      comp.mw       = 0.0;
+      comp.f        = 0.0;
+      US_Model::calc_coefficients( comp );
+      model.components << comp;
+   }
+}
+
+// Write a minimal edit file for the raw data
+bool US_BenchSet::write_edit( const QString& rawGUID )
+{
+   QFile efile( dir + "/" + editfile );
+
+   if ( ! efile.open( QIODevice::WriteOnly | QIODevice::Text ) )
+      return false;
+
+   double xleft  = simparams.meniscus + 0.02;
+   double xright = simparams.bottom   - 0.10;
+
+   QXmlStreamWriter xml( &efile );
+   xml.setAutoFormatting( true );
+   xml.writeStartDocument();
+   xml.writeDTD         ( "<!DOCTYPE UltraScanEdits>" );
+   xml.writeStartElement( "experiment" );
+   xml.writeAttribute   ( "type", "Velocity" );
+
+   xml.writeStartElement( "identification" );
+   xml.writeStartElement( "runid" );
+   xml.writeAttribute   ( "value", QString( "bench" ) + size.name );
+   xml.writeEndElement  ();
+   xml.writeStartElement( "editGUID" );
+   xml.writeAttribute   ( "value", US_Util::new_guid() );
+   xml.writeEndElement  ();
+   xml.writeStartElement( "rawDataGUID" );
+   xml.writeAttribute   ( "value", rawGUID );
+   xml.writeEndElement  ();
+   xml.writeEndElement  ();  // identification
+
+   xml.writeStartElement( "run" );
+   xml.writeAttribute   ( "cell",       "1"   );
+   xml.writeAttribute   ( "channel",    "A"   );
+   xml.writeAttribute   ( "wavelength", "260" );
+   xml.writeStartElement( "parameters" );
+   xml.writeStartElement( "meniscus" );
+   xml.writeAttribute   ( "radius", QString::number( simparams.meniscus ) );
+   xml.writeEndElement  ();
+   xml.writeStartElement( "plateau" );
+   xml.writeAttribute   ( "radius", QString::number( xright - 0.05 ) );
+   xml.writeEndElement  ();
+   xml.writeStartElement( "baseline" );
+   xml.writeAttribute   ( "radius", QString::number( xright + 0.05 ) );
+   xml.writeEndElement  ();
+   xml.writeStartElement( "data_range" );
+   xml.writeAttribute   ( "left",  QString::number( xleft  ) );
+   xml.writeAttribute   ( "right", QString::number( xright ) );
+   xml.writeEndElement  ();
+   xml.writeStartElement( "od_limit" );
+   xml.writeAttribute   ( "value", "1.8" );
+   xml.writeEndElement  ();
+   xml.writeEndElement  ();  // parameters
+   xml.writeEndElement  ();  // run
+
+   xml.writeEndElement  ();  // experiment
+   xml.writeEndDocument ();
+   efile.close();
+   return true;
+}
+
+// Build a 2DSA-style grid of s,f/f0 solutes over 1 to 15 S and 1 to 4
+void US_BenchSet::build_solutes()
+{
+   int ngrid     = size.ngrid;
+   double sinc   = 14.0 / (double)( ngrid - 1 );
+   double kinc   =  3.0 / (double)( ngrid - 1 );
+   solutes.clear();
+
+   for ( int jk = 0; jk < ngrid; jk++ )
+   {
+      for ( int js = 0; js < ngrid; js++ )
+      {
+         solutes << US_Solute( ( 1.0 + js * sinc ) * 1.0e-13,
+                               1.0 + jk * kinc, 0.0 );
+      }
+   }
+}
+
+// Build an NNLS problem of the same shape as the 2DSA one:  columns are
+//  smoothed boundaries across all scans, and B is a noisy sum of a few
+void US_BenchSet::build_nnls()
+{
+   int nscans    = edata.scanCount();
+   int npoints   = edata.pointCount();
+   arows         = nscans * npoints;
+   acols         = solutes.size();
+   amat.fill( 0.0, arows * acols );
+   bvec.fill( 0.0, arows );
+
+   double xleft  = edata.radius( 0 );
+   double xrange = edata.radius( npoints - 1 ) - xleft;
+
+   for ( int cc = 0; cc < acols; cc++ )
+   {
+      double speed  = 0.2 + 0.8 * (double)( cc % size.ngrid )
+                                / (double)size.ngrid;
+      double width  = 0.01 + 0.04 * (double)( cc / size.ngrid )
+                                  / (double)size.ngrid;
+      double* acol  = amat.data() + cc * arows;
+
+      for ( int ss = 0; ss < nscans; ss++ )
+      {
+         double sfrac  = (double)( ss + 1 ) / (double)nscans;
+         double rbound = xleft + xrange * sfrac * speed;
+
+         for ( int rr = 0; rr < npoints; rr++ )
+         {
+            double rad    = edata.radius( rr );
+            *acol++       = 1.0 / ( 1.0 + exp( ( rbound - rad ) / width ) );
+         }
+      }
+   }
+
+   int col1      = acols / 5;
+   int col2      = acols / 2;
+   int col3      = ( acols * 4 ) / 5;
+
+   for ( int rr = 0; rr < arows; rr++ )
+   {
+      bvec[ rr ]    = 0.3 * amat[ col1 * arows + rr ]
+                    + 0.5 * amat[ col2 * arows + rr ]
+                    + 0.2 * amat[ col3 * arows + rr ]
+                    + US_Math2::box_muller( 0.0, 0.005 );
+   }
+}
+
+// Build a spectrogram distribution of points scattered about a few peaks
+void US_BenchSet::build_spectrum()
+{
+   spoints.clear();
+
+   for ( int jj = 0; jj < size.nspect; jj++ )
+   {
+      S_Solute sol;
+      int    peak   = jj % 4;
+      sol.s         = 2.0 + 3.0 * peak + US_Math2::box_muller( 0.0, 0.4 );
+      sol.k         = 1.2 + 0.6 * peak + US_Math2::box_muller( 0.0, 0.1 );
+      sol.c         = qAbs( US_Math2::box_muller( 0.01, 0.005 ) );
+      sol.w         = 0.0;
+      sol.v         = TYPICAL_VBAR;
+      sol.d         = 0.0;
+      sol.f         = 0.0;
+      sol.si        = sol.s;
+      sol.ki        = sol.k;
+      spoints << sol;
+   }
+}
+
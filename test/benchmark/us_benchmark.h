@@ -0,0 +1,166 @@
+//! \file us_benchmark.h
+#ifndef US_BENCHMARK_H
+#define US_BENCHMARK_H
+
+#include <QtCore>
+
+#include "us_extern.h"
+#include "us_dataIO.h"
+#include "us_simparms.h"
+#include "us_solve_sim.h"
+#include "us_model.h"
+#include "us_parallel.h"
+#include "us_spectrodata.h"
+
+#ifndef DbgLv
+#define DbgLv(a) if(dbg_level>=a)qDebug()
+#endif
+
+#ifndef SP_SPEEDPROFILE
+#define SP_SPEEDPROFILE US_SimulationParameters::SpeedProfile
+#endif
+
+//! \brief Dimensions of one canned synthetic benchmark data set
+typedef struct bench_size_s
+{
+   const char* name;      //!< Data set name
+   int         nscans;    //!< Scans in the raw data
+   int         npoints;   //!< Radial points in the raw data
+   int         nspeeds;   //!< Speed steps of the run
+   int         ncomps;    //!< Components of the generating model
+   int         ngrid;     //!< Grid points per axis of the s,f/f0 solutes
+   int         nspect;    //!< Points of the spectrogram distribution
+} BenchSize;
+
+//! \brief One canned synthetic data set with the inputs to all kernels
+//!
+//! The raw data is simulated from a fixed model, given deterministic
+//! Gaussian noise and written to disk with an edit file, so that the
+//! edited data used by the fitting kernels comes from the same loadData()
+//! path that the analysis programs use. All members are read-only once
+//! built, so kernel invocations on several threads may share a set.
+class US_BenchSet
+{
+   public:
+      US_BenchSet( const BenchSize&, const QString&, const uint );
+
+      //! \brief Build the data set files and kernel inputs
+      //! \param emsg  Returned error message if building fails
+      //! \returns     Success flag
+      bool build( QString& );
+
+      //! \brief Remove the files written by build()
+      void remove_files( void );
+
+      BenchSize                    size;      //!< Data set dimensions
+      QString                      dir;       //!< Directory of the files
+      QString                      aucfile;   //!< Raw data file name
+      QString                      editfile;  //!< Edit file name
+      QString                      tmstpath;  //!< TimeState file path
+
+      US_Model                     model;     //!< Generating model
+      US_SimulationParameters      simparams; //!< Simulation parameters
+      US_DataIO::RawData           zdata;     //!< Zeroed simulation template
+      US_DataIO::EditedData        edata;     //!< Edited synthetic data
+      US_SolveSim::DataSet         dset;      //!< Fitting data set
+      QList< US_SolveSim::DataSet* > dsets;   //!< Data sets list (one)
+      QVector< US_Solute >         solutes;   //!< 2DSA-style grid solutes
+      QVector< double >            amat;      //!< NNLS A matrix
+      QVector< double >            bvec;      //!< NNLS B vector
+      QList< S_Solute >            spoints;   //!< Spectrogram distribution
+      int                          arows;     //!< NNLS rows
+      int                          acols;     //!< NNLS columns
+
+   private:
+      uint       seed;          // Random seed of the data set
+      int        dbg_level;     // Debug level
+
+      void   build_simparms ( void );
+      void   build_model    ( void );
+      bool   write_edit     ( const QString& );
+      void   build_solutes  ( void );
+      void   build_nnls     ( void );
+      void   build_spectrum ( void );
+};
+
+//! \brief Timing summary of one kernel configuration
+typedef struct bench_result_s
+{
+   QString     kernel;        //!< Kernel name
+   QString     dataset;       //!< Data set name
+   QString     mode;          //!< Scaling mode: throughput|intrinsic|serial
+   int         threads;       //!< Threads used
+   int         reps;          //!< Timed repetitions
+   double      min_ms;        //!< Minimum time (ms)
+   double      median_ms;     //!< Median time (ms)
+   double      mean_ms;       //!< Mean time (ms)
+   double      speedup;       //!< Speedup relative to one thread
+} BenchResult;
+
+//! \brief Reproducible benchmark of the simulation and fitting kernels
+//!
+//! Each kernel is timed on each canned data set, first on one thread and
+//! then at increasing thread counts. In "throughput" mode T independent
+//! invocations run on T threads through US_Parallel, so the speedup is T
+//! times the single-invocation time over the batch time. In "intrinsic"
+//! mode a single US_Astfem_RSA calculation is given T threads for its
+//! components. Results are written as JSON, one result object per line,
+//! and may be compared to a baseline file of an earlier run.
+class US_Benchmark
+{
+   public:
+      //! \brief Create the benchmark from command line arguments
+      //! \param cmdargs  Command line arguments
+      US_Benchmark( QStringList& );
+
+      //! \brief Return a flag of whether the benchmark is ready to run
+      bool is_ready( void ) const { return ready; }
+
+      //! \brief Run all selected benchmarks and write the results
+      //! \returns  Exit status: 0 (ok), 1 (error), 2 (regression found)
+      int  run     ( void );
+
+      //! \brief Run one invocation of a kernel on a data set
+      //! \param kernx  Kernel index
+      //! \param bset   Data set
+      //! \param nthr   Threads for a kernel's own parallel work
+      static void run_kernel( const int, US_BenchSet*, const int );
+
+   private:
+      QList< BenchResult >       results;   // Timing results
+      QStringList                kernels;   // Kernel names selected
+      QStringList                sizes;     // Data set names selected
+      QList< int >               thrcounts; // Thread counts to time
+      QString                    outfile;   // JSON output file (or stdout)
+      QString                    basefile;  // Baseline JSON file
+      QString                    workdir;   // Data set files directory
+
+      double     tolerance;     // Regression tolerance fraction
+      uint       seed;          // Random seed
+      int        nreps;         // Timed repetitions
+      int        dbg_level;     // Debug level
+      bool       ready;         // Flag benchmark ready to run
+
+      void   time_kernel   ( const int, US_BenchSet* );
+      BenchResult time_config( const int, US_BenchSet*, const QString&,
+                               const int );
+      int    compare_base  ( QStringList& );
+      QString json_result  ( const BenchResult& );
+      void   usage         ( void );
+};
+
+//! \brief Range task that runs independent kernel invocations
+class US_BenchTask : public US_RangeTask
+{
+   public:
+      int              kernx;     //!< Kernel index
+      US_BenchSet*     bset;      //!< Data set
+
+      void run_range( int begin, int end, int )
+      {
+         for ( int ii = begin; ii < end; ii++ )
+            US_Benchmark::run_kernel( kernx, bset, 1 );
+      }
+};
+#endif
+
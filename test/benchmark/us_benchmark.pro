@@ -0,0 +1,16 @@
+include( ../../gui.pri )
+
+CONFIG       += qt
+TARGET        = us_benchmark
+QT           += core xml
+
+win32 {
+CONFIG       += console
+}
+mac {
+CONFIG       += console
+}
+
+HEADERS       = us_benchmark.h
+
+SOURCES       = us_benchmark.cpp
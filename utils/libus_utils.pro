@@ -47,8 +47,12 @@ HEADERS      = us_analyte.h       \
                us_matrix.h        \
                us_memory.h        \
                us_model.h         \
+               us_model_mc.h      \
                us_noise.h         \
+               us_parallel.h      \
+               us_pcsa_lm.h       \
                us_pcsa_modelrec.h \
+               us_profiler.h      \
                us_project.h       \
                us_protocol_util.h \
                us_report.h        \
@@ -63,6 +67,7 @@ HEADERS      = us_analyte.h       \
                us_tar.h           \
                us_time_state.h    \
                us_timer.h         \
+               us_transform.h     \
                us_util.h          \
                us_vector.h        \
                us_xpn_data.h      \
@@ -92,8 +97,12 @@ SOURCES      = us_analyte.cpp       \
                us_matrix.cpp        \
                us_memory.cpp        \
                us_model.cpp         \
+               us_model_mc.cpp      \
                us_noise.cpp         \
+               us_parallel.cpp      \
+               us_pcsa_lm.cpp       \
                us_pcsa_modelrec.cpp \
+               us_profiler.cpp      \
                us_project.cpp       \
                us_protocol_util.cpp \
                us_report.cpp        \
@@ -108,6 +117,7 @@ SOURCES      = us_analyte.cpp       \
                us_tar.cpp           \
                us_time_state.cpp    \
                us_timer.cpp         \
+               us_transform.cpp     \
                us_util.cpp          \
                us_vector.cpp        \
                us_xpn_data.cpp      \
@@ -474,23 +474,19 @@ void US_AstfemMath::tridiag( double* a, double* b, double* c,
                              double* r, double* u, int N )
 {
    double bet = b[ 0 ];
-#ifdef NO_DB
-   // If used within mpi_analysis, avoid reallocating gamvec at each
-   //  call. Just reallocate if N has grown larger.
-   static QVector< double > gamvec;
-   static int Nsave = 0;
+   // Avoid reallocating gamvec at each call. Each thread keeps its own
+   //  work vector, reallocated only if N has grown larger.
+   static QThreadStorage< QVector< double >* > gamstore;
 
-   if ( N > Nsave )
-   {
-      Nsave = ( N * 3 ) / 2;
-      gamvec.resize( Nsave );
-   }
-#else
-   // If used by a desktop application, simply reallocate gamvec
-   //  at each call.
-   QVector< double > gamvec( N );
-#endif
-   double* gam = gamvec.data();
+   if ( ! gamstore.hasLocalData() )
+      gamstore.setLocalData( new QVector< double > );
+
+   QVector< double >* gamvec = gamstore.localData();
+
+   if ( N > gamvec->size() )
+      gamvec->resize( ( N * 3 ) / 2 );
+
+   double* gam = gamvec->data();
 
    if ( bet == 0.0 )  { qDebug() << "Error 1 in tridiag"; return; }
 
@@ -5,6 +5,8 @@
 #include "us_hardware.h"
 #include "us_math2.h"
 #include "us_memory.h"
+#include "us_parallel.h"
+#include "us_profiler.h"
 #include "us_stiffbase.h"
 #include "us_settings.h"
 #include "us_sleep.h"
@@ -26,6 +28,155 @@
 #define TIMING_NI 1
 #endif
 
+#define PAR_MIN_COMPS  4      // Minimum components for parallel calculate
+#define RA2_PAR_POINTS 16384  // Minimum Mcomp*Nx for parallel ra2 solves
+
+// Range task that simulates blocks of non-interacting components, summing
+//  their concentrations into per-thread arrays. The model, parameters and
+//  zeroed data template are shared read-only. Each thread slot makes its
+//  own model, parameters and simulation engine once, on its first block.
+//  Each block simulates into an implicitly shared copy of the template, so
+//  the only data allocated per block are the concentration vectors that
+//  calculate() writes.
+class US_AstfemCompTask : public US_RangeTask
+{
+   public:
+      const US_Model*                 model;      // Full model
+      const US_SimulationParameters*  simparams;  // Loaded parameters
+      const US_DataIO::RawData*       zdata;      // Zeroed data template
+      QVector< US_Model >             tmodel;     // Per-thread block models
+      QVector< US_SimulationParameters > tparams; // Per-thread parameters
+      QVector< US_Astfem_RSA* >       tastfem;    // Per-thread engines
+      QVector< US_DataIO::RawData >   wdata;      // Per-thread block data
+      QVector< QVector< double > >    tconcs;     // Per-thread conc. sums
+      QVector< US_SimulationParameters::SpeedProfile > speed_step;
+      bool                            use_time;
+      bool                            time_correction;
+      bool*                           stopFlag;
+      int                             dbg_level;
+
+      void run_range( int begin, int end, int thrx )
+      {
+         if ( *stopFlag )
+            return;
+
+         if ( tastfem[ thrx ] == NULL )
+         {  // First block of this thread:  make its model, parameters
+            //  and engine, and size its concentration sums
+            tmodel [ thrx ] = *model;
+            tparams[ thrx ] = *simparams;
+            tconcs [ thrx ].fill( 0.0,
+                                  zdata->scanCount() * zdata->pointCount() );
+
+            US_Astfem_RSA* astfem = new US_Astfem_RSA( tmodel [ thrx ],
+                                                       tparams[ thrx ] );
+            astfem->setTimeInterpolation( use_time );
+            astfem->setTimeCorrection   ( time_correction );
+            astfem->set_debug_flag      ( dbg_level );
+            astfem->set_thread_count    ( 1 );
+            tastfem[ thrx ] = astfem;
+         }
+
+         US_Model& bmodel = tmodel[ thrx ];
+         bmodel.components.clear();
+
+         for ( int cc = begin; cc < end; cc++ )
+            bmodel.components << model->components[ cc ];
+
+         // Simulate the block onto the zeroed experimental grid
+         US_DataIO::RawData* bdata = &wdata[ thrx ];
+         *bdata       = *zdata;
+         tastfem[ thrx ]->calculate( *bdata );
+
+         if ( begin == 0 )
+            speed_step   = tparams[ thrx ].speed_step;
+
+         // Add the block's concentrations into the thread's sums
+         double* tconc = tconcs[ thrx ].data();
+         int     npts  = zdata->pointCount();
+         int     nscan = qMin( bdata->scanCount(), zdata->scanCount() );
+
+         for ( int ss = 0; ss < nscan; ss++ )
+         {
+            const double* bconc = bdata->scanData[ ss ].rvalues.constData();
+            double*       sconc = tconc + ss * npts;
+            int     kpts  = qMin( bdata->scanData[ ss ].rvalues.size(), npts );
+
+            for ( int rr = 0; rr < kpts; rr++ )
+               sconc[ rr ] += bconc[ rr ];
+         }
+      }
+};
+
+// Range task that solves the sedimentation step of each component system
+//  of calculate_ra2() over its own right hand side vector
+class US_Ra2Solver : public US_RangeTask
+{
+   public:
+      double***  CA;      // Left hand side stiffness matrices
+      double***  CB;      // Right hand side stiffness matrices
+      double**   C0;      // Current concentrations
+      double**   C1;      // Next concentrations
+      double**   rhs;     // Right hand side vectors
+      int        Nx;      // Number of radial points
+      bool       fixed;   // Flag fixed grid (else moving grid)
+
+      void run_range( int begin, int end, int )
+      {
+         for ( int i = begin; i < end; i++ )
+         {
+            double* right_hand_side = rhs[ i ];
+
+            if ( fixed )
+            {  // For fixed grid
+               right_hand_side[ 0 ] = - CB[ i ][ 1 ][ 0 ] * C0[ i ][ 0 ]
+                                      - CB[ i ][ 2 ][ 0 ] * C0[ i ][ 1 ];
+
+               for ( int j = 1; j < Nx - 1; j++ )
+               {
+                  right_hand_side[ j ] = - CB[ i ][ 0 ][ j ] * C0[ i ][ j - 1 ]
+                                         - CB[ i ][ 1 ][ j ] * C0[ i ][ j     ]
+                                         - CB[ i ][ 2 ][ j ] * C0[ i ][ j + 1 ];
+               }
+
+               int j = Nx - 1;
+               right_hand_side[ j ] = - CB[ i ][ 0 ][ j ] * C0[ i ][ j - 1 ]
+                                      - CB[ i ][ 1 ][ j ] * C0[ i ][ j     ];
+
+               US_AstfemMath::tridiag( CA[ i ][ 0 ], CA[ i ][ 1 ], CA[ i ][ 2 ],
+                                       right_hand_side, C1[ i ], Nx );
+            }
+
+            else
+            {  // For moving grid
+               right_hand_side[ 0 ] = - CB[ i ][ 2 ][ 0 ] * C0[ i ][ 0 ]
+                                      - CB[ i ][ 3 ][ 0 ] * C0[ i ][ 1 ];
+
+               right_hand_side[ 1 ] = - CB[ i ][ 1 ][ 1 ] * C0[ i ][ 0 ]
+                                      - CB[ i ][ 2 ][ 1 ] * C0[ i ][ 1 ]
+                                      - CB[ i ][ 3 ][ 1 ] * C0[ i ][ 2 ];
+
+               for ( int j = 2; j < Nx - 1; j++ )
+               {
+                  right_hand_side[ j ] = - CB[ i ][ 0 ][ j ] * C0[ i ][ j - 2 ]
+                                         - CB[ i ][ 1 ][ j ] * C0[ i ][ j - 1 ]
+                                         - CB[ i ][ 2 ][ j ] * C0[ i ][ j     ]
+                                         - CB[ i ][ 3 ][ j ] * C0[ i ][ j + 1 ];
+               }
+
+               int j = Nx - 1;
+               right_hand_side[ j ] = - CB[ i ][ 0 ][ j ] * C0[ i ][ j - 2 ]
+                                      - CB[ i ][ 1 ][ j ] * C0[ i ][ j - 1 ]
+                                      - CB[ i ][ 2 ][ j ] * C0[ i ][ j     ];
+
+               US_AstfemMath::QuadSolver( CA[ i ][ 0 ], CA[ i ][ 1 ],
+                                          CA[ i ][ 2 ], CA[ i ][ 3 ],
+                                          right_hand_side, C1[ i ], Nx );
+            }
+         }
+      }
+};
+
 // Constructor for US_Astfem_RSA structure
 US_Astfem_RSA::US_Astfem_RSA( US_Model&                model,
                               US_SimulationParameters& params,
@@ -42,6 +193,7 @@ US_Astfem_RSA::US_Astfem_RSA( US_Model&                model,
                              // refer to display on experimental grid.
    show_movie      = false;  // Flag used to see a movie i.e. movement of scans.
    dbg_level       = 0  ;    // Flag used to choose a debug level.
+   nthreads        = 0  ;    // Thread count, 0 for default.
 }
 
 //!< Takes the experimental data i.e. 'exp_data' as input and updates the scans
@@ -69,6 +221,7 @@ US_Astfem_RSA::US_Astfem_RSA( US_Model&                model,
 //!< care for non-reacting systems and calculate_ra2 takes care for reacting systems.
 int US_Astfem_RSA::calculate( US_DataIO::RawData& exp_data )
 {
+   US_PROF_SCOPE( "astfem.calculate" );
    US_AstfemMath::MfemInitial* vC0 = NULL; // Initial concentration for multiple components
    US_AstfemMath::MfemInitial  CT0;        // Initial  concentration vector
    US_AstfemMath::MfemData     simdata;    // Contains scans on the simulation grid
@@ -171,37 +324,49 @@ DbgLv(1)<< "RSA:calc:    cdset_speed" << af_params.cdset_speed;
 
    // Read in any timestate that exists and set up the internal
    //  simulation speed profile
-   if ( simparams.tsobj == NULL  ||
-        simparams.sim_speed_prof.count() < 1 )
-   {  // Timestate is not properly loaded
-DbgLv(1)<<"RSA:calc: timestate does not exist";
-#ifdef NO_DB
-      QString tmst_fpath = "../" + temp_Id_name() + ".time_state.tmst";
+   load_timestate( exp_data );
 
-      if ( ! QFile( tmst_fpath ).exists() )
-         US_AstfemMath::writetimestate( tmst_fpath, simparams, exp_data );
-#else
-      QString tmst_fpath = US_Settings::tmpDir() + "/" + temp_Id_name() + ".time_state.tmst";
-      US_AstfemMath::writetimestate( tmst_fpath, simparams, exp_data );
-#endif
-      simparams.simSpeedsFromTimeState( tmst_fpath );
-   }
-   else
-   {  // Timestate object and speed profile exist are properly loaded
-DbgLv(1) << "RSA:calc : timestate exists and timestateobject,sscount="
- << simparams.tsobj << simparams.sim_speed_prof.count();
+#ifndef NO_DB
+   // Simulate a large non-interacting model in concurrent blocks,
+   //  by default only when called from the main thread
+   if ( size_cv >= PAR_MIN_COMPS  &&  system.associations.isEmpty()  &&
+        simparams.sim_speed_prof.count() > 0  &&
+        !simparams.firstScanIsConcentration  &&
+        !show_movie  &&  !simout_flag  &&  !US_Parallel::in_worker()  &&
+        ( nthreads > 1  ||  ( nthreads == 0  &&
+          qApp != NULL  &&
+          QThread::currentThread() == qApp->thread() ) ) )
+   {
+      int nthr     = ( nthreads > 0 ) ? nthreads : US_Parallel::threads();
+
+      if ( nthr > 1 )
+         return calculate_parallel( exp_data, nthr );
    }
+#endif
 
    int nstep    = simparams.speed_step.size();     // Number of speed steps
    int nspstep  = simparams.sim_speed_prof.size(); // Number of speed profiles
-DbgLv(1) << "RSA:calc: ss size" << nstep << "ssp size" << nspstep;
+   const US_SimulationParameters::SpeedTable* stab = simparams.speedTable();
+DbgLv(1) << "RSA:calc: ss size" << nstep << "ssp size" << nspstep
+ << "speed table" << ( stab != NULL );
+
+   if ( stab != NULL )
+   {  // Share the time,omega2t vectors derived when the timestate was loaded
+      time_end     = stab->time_e_step;
+      w2t_end      = stab->w2t_e_step;
+      accel_times  = stab->time_e_accel;
+      accel_w2ts   = stab->w2t_e_accel;
+   }
 
    for ( int istep = 0; istep < nspstep; istep++ )
    {  // Fill time,omega2t work vectors for each step
-      time_end    << simparams.sim_speed_prof[ istep ].time_e_step;
-      w2t_end     << simparams.sim_speed_prof[ istep ].w2t_e_step;
-      accel_times << simparams.sim_speed_prof[ istep ].time_e_accel;
-      accel_w2ts  << simparams.sim_speed_prof[ istep ].w2t_e_accel;
+      if ( stab == NULL )
+      {
+         time_end    << simparams.sim_speed_prof[ istep ].time_e_step;
+         w2t_end     << simparams.sim_speed_prof[ istep ].w2t_e_step;
+         accel_times << simparams.sim_speed_prof[ istep ].time_e_accel;
+         accel_w2ts  << simparams.sim_speed_prof[ istep ].w2t_e_accel;
+      }
 
 //*DEBUG*
 if(dbg_level>0) {
@@ -812,38 +977,30 @@ QDateTime clcSt5 = QDateTime::currentDateTime();
       US_AstfemMath::MfemData* ed = &af_data;
       simparams.sim    = ( exp_data.channel == 'S' );
 
-      if ( simparams.tsobj == NULL  ||
-           simparams.sim_speed_prof.count() < 1 )
-      {  // Timestate is not properly loaded
-DbgLv(1) << "timestate file does not exist";
-#ifdef NO_DB
-         QString tmst_fpath = "../" + temp_Id_name() + ".time_state.tmst";
+      load_timestate( exp_data );
+DbgLv(1) << "SS2: ss size" << simparams.speed_step.size()
+ << "ssp size" << simparams.sim_speed_prof.size();
 
-         if ( ! QFile( tmst_fpath ).exists() )
-            US_AstfemMath::writetimestate( tmst_fpath, simparams, exp_data );
-#else
-         QString tmst_fpath = US_Settings::tmpDir() + "/" + temp_Id_name() + ".time_state.tmst";
-         US_AstfemMath::writetimestate( tmst_fpath, simparams, exp_data );
-#endif
-         simparams.simSpeedsFromTimeState( tmst_fpath );
-DbgLv(1)<<"after writing timestate file" << simparams.sim_speed_prof.count();
-      }
+      const US_SimulationParameters::SpeedTable* stab = simparams.speedTable();
 
-      else
-      {  // Timestate exists and is loaded properly
-DbgLv(1) << "rsa : timestate file exists and timestateobject = "
- << simparams.tsobj << simparams.sim_speed_prof.count() ;
+      if ( stab != NULL )
+      {  // Share the work time,omega2t vectors of the loaded timestate
+         time_end     = stab->time_e_step;
+         w2t_end      = stab->w2t_e_step;
+         accel_times  = stab->time_e_accel;
+         accel_w2ts   = stab->w2t_e_accel;
       }
-DbgLv(1) << "SS2: ss size" << simparams.speed_step.size()
- << "ssp size" << simparams.sim_speed_prof.size();
 
-      for ( int step = 0; step < simparams.sim_speed_prof.size(); step++ )
-      {  // Fill work time,omega2t vectors with values for each step
-         time_end    << simparams.sim_speed_prof[ step ].time_e_step;
-         w2t_end     << simparams.sim_speed_prof[ step ].w2t_e_step;
-         accel_times << simparams.sim_speed_prof[ step ].time_e_accel;
-         accel_w2ts  << simparams.sim_speed_prof[ step ].w2t_e_accel;
+      else
+      {
+         for ( int step = 0; step < simparams.sim_speed_prof.size(); step++ )
+         {  // Fill work time,omega2t vectors with values for each step
+            time_end    << simparams.sim_speed_prof[ step ].time_e_step;
+            w2t_end     << simparams.sim_speed_prof[ step ].w2t_e_step;
+            accel_times << simparams.sim_speed_prof[ step ].time_e_accel;
+            accel_w2ts  << simparams.sim_speed_prof[ step ].w2t_e_accel;
 DbgLv(1)<< "subha: rsa readings: " << accel_times[step] << accel_w2ts[step];
+         }
       }
 
       if ( simparams.sim_speed_prof.count() > 0 )
@@ -1173,6 +1330,126 @@ DbgLv(1) << "RSA:calc: ++ ASTFEM CALC DONE ++";
    return 0;
 }
 
+// Calculate non-interacting components concurrently in blocks
+int US_Astfem_RSA::calculate_parallel( US_DataIO::RawData& exp_data,
+                                       int nthr )
+{
+   int size_cv     = system.components.size();
+   int nscan       = exp_data.scanCount();
+DbgLv(1) << "RSA:calc: PARALLEL  size_cv" << size_cv << "nthr" << nthr;
+
+   // Each block simulates into a copy of the data with zero concentrations
+   US_DataIO::RawData zdata = exp_data;
+
+   for ( int ss = 0; ss < nscan; ss++ )
+      zdata.scanData[ ss ].rvalues.fill( 0.0 );
+
+   US_AstfemCompTask comptask;
+   comptask.model           = &system;
+   comptask.simparams       = &simparams;
+   comptask.zdata           = &zdata;
+   comptask.use_time        = use_time;
+   comptask.time_correction = time_correction;
+   comptask.stopFlag        = &stopFlag;
+   comptask.dbg_level       = dbg_level;
+   comptask.tmodel .resize( nthr );
+   comptask.tparams.resize( nthr );
+   comptask.tconcs .resize( nthr );
+   comptask.wdata  .resize( nthr );
+   comptask.tastfem.fill( NULL, nthr );
+
+#ifndef NO_DB
+   emit current_component( 1 );
+   qApp->processEvents();
+#endif
+
+   US_Parallel::run( &comptask, size_cv, nthr, 2 );
+
+   for ( int tt = 0; tt < nthr; tt++ )
+      delete comptask.tastfem[ tt ];      // Engines of used thread slots
+
+   if ( stopFlag ) return 1;
+
+   // Sum the per-thread concentrations into the experiment data
+   int npts        = zdata.pointCount();
+   int kused       = 0;
+
+   for ( int tt = 0; tt < nthr; tt++ )
+   {
+      if ( comptask.tconcs[ tt ].isEmpty() )
+         continue;             // Thread slot ran no blocks
+
+      const double*       tconc = comptask.tconcs[ tt ].constData();
+      US_DataIO::RawData* tdata = &comptask.wdata [ tt ];
+
+      for ( int ss = 0; ss < nscan; ss++ )
+      {
+         double* econc = exp_data.scanData[ ss ].rvalues.data();
+         int     kpts  = qMin( exp_data.scanData[ ss ].rvalues.size(), npts );
+
+         for ( int rr = 0; rr < kpts; rr++ )
+            econc[ rr ] += tconc[ ss * npts + rr ];
+      }
+
+      if ( kused++ == 0 )
+      {  // Store scan attributes as set by the simulations
+         exp_data.description = tdata->description;
+         exp_data.cell        = tdata->cell;
+         exp_data.xvalues     = tdata->xvalues;
+
+         for ( int ss = 0; ss < nscan; ss++ )
+         {
+            US_DataIO::Scan* escan = &exp_data.scanData[ ss ];
+            US_DataIO::Scan* tscan = &tdata->scanData  [ ss ];
+            escan->temperature     = tscan->temperature;
+            escan->rpm             = tscan->rpm;
+            escan->seconds         = tscan->seconds;
+            escan->omega2t         = tscan->omega2t;
+            escan->plateau         = tscan->plateau;
+         }
+      }
+   }
+
+   // Return any speed steps filled in from the timestate
+   simparams.speed_step = comptask.speed_step;
+   simparams.sim        = ( exp_data.channel == 'S' );
+
+#ifndef NO_DB
+   emit current_component( size_cv );
+   emit current_component( -1 );
+   qApp->processEvents();
+#endif
+
+DbgLv(1) << "RSA:calc: ++ ASTFEM PARALLEL CALC DONE ++";
+   return 0;
+}
+
+// Insure a timestate and simulation speed profile are loaded
+void US_Astfem_RSA::load_timestate( US_DataIO::RawData& exp_data )
+{
+   if ( simparams.tsobj == NULL  ||
+        simparams.sim_speed_prof.count() < 1 )
+   {  // Timestate is not properly loaded
+DbgLv(1)<<"RSA:calc: timestate does not exist";
+#ifdef NO_DB
+      QString tmst_fpath = "../" + temp_Id_name() + ".time_state.tmst";
+
+      if ( ! QFile( tmst_fpath ).exists() )
+         US_AstfemMath::writetimestate( tmst_fpath, simparams, exp_data );
+#else
+      QString tmst_fpath = US_Settings::tmpDir() + "/" + temp_Id_name() + ".time_state.tmst";
+      US_AstfemMath::writetimestate( tmst_fpath, simparams, exp_data );
+#endif
+      simparams.simSpeedsFromTimeState( tmst_fpath );
+DbgLv(1)<<"RSA:calc: after writing timestate file" << simparams.sim_speed_prof.count();
+   }
+   else
+   {  // Timestate object and speed profile exist are properly loaded
+DbgLv(1) << "RSA:calc : timestate exists and timestateobject,sscount="
+ << simparams.tsobj << simparams.sim_speed_prof.count();
+   }
+}
+
 //----------------
 // Nowhere used !!
 //----------------
@@ -1533,6 +1810,7 @@ int US_Astfem_RSA::calculate_ni( double rpm_start, double rpm_stop, int step,
                                  US_AstfemMath::MfemData& simdata,
                                  bool accel )
 {
+   US_PROF_SCOPE( "astfem.calculate_ni" );
 #ifdef NO_DB
    static int      Nsave  = 0;
    static int      Nsavea = 0;
@@ -1753,6 +2031,14 @@ clcSt3 = QDateTime::currentDateTime();
    double rpm_inc     = ( rpm_stop - rpm_start ) / time_dif;// Increment in rotor speed
    double rpm_current = rpm_start; // Update the rotor speed
 
+   // Omega squared of a constant speed zone, from any speed table
+   const US_SimulationParameters::SpeedTable* stab = simparams.speedTable();
+   bool   stab_om2    = ( stab != NULL  &&  rpm_inc == 0.0  &&
+                          step < stab->omega2_avg.count()  &&
+                          rpm_start == simparams.sim_speed_prof[ step ].avg_speed );
+   double omega2_cz   = stab_om2 ? stab->omega2_avg[ step ]
+                                 : sq( rpm_start * M_PI / 30.0 );
+
 
    int ntsteps        = af_params.time_steps; // Number of time steps
 
@@ -1893,7 +2179,8 @@ ttT3+=(clcSt3.msecsTo(clcSt4));
          simscan.rpm       = (int) rpm_current;        // Rotor speed of scan
          simscan.time      = last_time + af_params.dt; // Time of the scan
          w2t_integral     += ( simscan.time - last_time )      // Omega_2_t
-                            * sq( rpm_current * M_PI / 30.0 ); //  increment
+                            * ( stab_om2 ? omega2_cz           //  increment
+                                : sq( rpm_current * M_PI / 30.0 ) );
          simscan.omega_s_t = w2t_integral;             // Omega_2_t of the scan
       }
 
@@ -3415,6 +3702,7 @@ void US_Astfem_RSA::Reaction_dfdy( double* y0, double** dfdy )
 int US_Astfem_RSA::calculate_ra2( double rpm_start, double rpm_stop, US_AstfemMath::MfemInitial* C_init,
                                   US_AstfemMath::MfemData& simdata,  bool accel )
 {
+   US_PROF_SCOPE( "astfem.calculate_ra2" );
    int Mcomp = af_params.s.size();
 
    US_AstfemMath::MfemScan simscan;
@@ -3629,7 +3917,8 @@ DbgLv(1) << "RSA: newX3 Nx" << Nx << "C0[00] C0[m0] C0[0n] C0[mn]"
 
    QVector< double > CT0vec( Nx );
    QVector< double > CT1vec( Nx );
-   QVector< double > rhVec ( Nx );
+   QVector< double > rhVec ( Mcomp * Nx );
+   QVector< double* > rhPtrs( Mcomp );
    double* CT0 = CT0vec.data();
    double* CT1 = CT1vec.data();
 
@@ -3644,8 +3933,31 @@ DbgLv(1) << "RSA: newX3 Nx" << Nx << "C0[00] C0[m0] C0[0n] C0[mn]"
    }
 DbgLv(1) << "RSA: newX3  CT0 CTn" << CT1[0] << CT1[Nx-1];
 
+   // Each component system gets its own right hand side, so that the
+   //  systems may be solved concurrently when they are large enough
+   for ( int ii = 0; ii < Mcomp; ii++ )
+      rhPtrs[ ii ] = rhVec.data() + ii * Nx;
+
+   US_Ra2Solver ra2solve;
+   ra2solve.CA     = CA;
+   ra2solve.CB     = CB;
+   ra2solve.C0     = C0;
+   ra2solve.C1     = C1;
+   ra2solve.rhs    = rhPtrs.data();
+   ra2solve.Nx     = Nx;
+   ra2solve.fixed  = ( accel || fixedGrid );
+
+   int nthr_ra2    = 1;
+   if ( Mcomp > 1  &&  ( Mcomp * Nx ) >= RA2_PAR_POINTS )
+   {  // By default, only use threads when called from the main thread
+      if ( nthreads > 0 )
+         nthr_ra2        = nthreads;
+      else if ( qApp != NULL  &&
+                QThread::currentThread() == qApp->thread() )
+         nthr_ra2        = US_Parallel::threads();
+   }
+
    // Time evolution
-   double* right_hand_side = rhVec.data();
 #ifndef NO_DB
    int     stepinc = 1000;
    int     stepmax = ( Nt + 2 ) / stepinc + 1;
@@ -3720,77 +4032,11 @@ DbgLv(2) << "TMS:RSA:ra:  kkk" << kkk << "CT0[0] CT0[n]"
          }
       }
 
-      if ( accel || fixedGrid )    // For fixed grid
-      {
-         for ( int i = 0; i < Mcomp; i++ )
-         {
-            right_hand_side[ 0 ] = - CB[ i ][ 1 ][ 0 ] * C0[ i ][ 0 ]
-                                   - CB[ i ][ 2 ][ 0 ] * C0[ i ][ 1 ];
-
-            for ( int j = 1; j < Nx - 1; j++ )
-            {
-               right_hand_side[ j ] = - CB[ i ][ 0 ][ j ] * C0[ i ][ j - 1 ]
-                                      - CB[ i ][ 1 ][ j ] * C0[ i ][ j     ]
-                                      - CB[ i ][ 2 ][ j ] * C0[ i ][ j + 1 ];
-            }
-
-            int j = Nx - 1;
-
-            right_hand_side[ j ] = -CB[ i ][ 0 ][ j ] * C0[ i ][ j - 1 ]
-                                  - CB[ i ][ 1 ][ j ] * C0[ i ][ j     ];
-
-            US_AstfemMath::tridiag( CA[ i ][ 0 ], CA[ i ][ 1 ], CA[ i ][ 2 ],
-                                    right_hand_side, C1[ i ], Nx );
-         }
-      }
-
-      else // Moving grid
-      {
-//DbgLv(2) << "TMS:RSA:ra:   (0)MovGrid: C0[00] C0[0n] C0[m0] C0[1n]"
-// << C0[0][0] << C0[0][Nx-1] << C0[Mcomp-1][0] << C0[Mcomp-1][Nx-1];
-//DbgLv(2) << "TMS:RSA:ra:   (0)MovGrid: C1[00] C1[0n] C1[m0] C1[1n]"
-// << C1[0][0] << C1[0][Nx-1] << C1[Mcomp-1][0] << C1[Mcomp-1][Nx-1];
-         for ( int i = 0; i < Mcomp; i++ )
-         {
-            // Calculate the right hand side vector
-            right_hand_side[ 0 ] = - CB[ i ][ 2 ][ 0 ] * C0[ i ][ 0 ]
-                                   - CB[ i ][ 3 ][ 0 ] * C0[ i ][ 1 ];
-
-            right_hand_side[ 1 ] = - CB[ i ][ 1 ][ 1 ] * C0[ i ][ 0 ]
-                                   - CB[ i ][ 2 ][ 1 ] * C0[ i ][ 1 ]
-                                   - CB[ i ][ 3 ][ 1 ] * C0[ i ][ 2 ];
-
-            for ( int j = 2; j < Nx - 1; j++ )
-            {
-               right_hand_side[ j ] = - CB[ i ][ 0 ][ j ] * C0[ i ][ j - 2 ]
-                                      - CB[ i ][ 1 ][ j ] * C0[ i ][ j - 1 ]
-                                      - CB[ i ][ 2 ][ j ] * C0[ i ][ j     ]
-                                      - CB[ i ][ 3 ][ j ] * C0[ i ][ j + 1 ];
-            }
-
-            int j = Nx - 1;
-            right_hand_side[ j ] = - CB[ i ][ 0 ][ j ] * C0[ i ][ j - 2 ]
-                                   - CB[ i ][ 1 ][ j ] * C0[ i ][ j - 1 ]
-                                   - CB[ i ][ 2 ][ j ] * C0[ i ][ j     ];
-
-DbgLv(2) << "TMS:RSA:ra:   MovGrid:  i" << i << "CB[0]" << CB[i][2][0]
- << CB[i][3][0] << CB[i][1][1] << CB[i][2][1] << CB[i][3][1];
-DbgLv(2) << "TMS:RSA:ra:   MovGrid:   i" << i << "CA[0]" << CA[i][0][0]
- << CA[i][1][0] << CA[i][0][0] << CA[i][1][0] << CA[i][2][0];
-
-            US_AstfemMath::QuadSolver( CA[ i ][ 0 ], CA[ i ][ 1 ], CA[ i ][ 2 ],
-                                       CA[ i ][ 3 ], right_hand_side, C1[ i ],
-                                       Nx );
-DbgLv(2) << "TMS:RSA:ra:   MovGrid:    i" << i << "C1[i]" << C1[i][0]
- << C1[i][Nx-4] << C1[i][Nx-3] << C1[i][Nx-2] << C1[i][Nx-1];
-DbgLv(2) << "TMS:RSA:ra:   MovGrid:    i" << i << "C0[i]" << C0[i][0]
- << C0[i][Nx-4] << C0[i][Nx-3] << C0[i][Nx-2] << C0[i][Nx-1];
-         }
-         //DbgLv(2) << "TMS:RSA:ra:   MovGrid: CA[000] rs[0]" << CA[0][0][0]
-         // << right_hand_side[0] << "CB[000]" << CB[0][0][0];
-         //DbgLv(2) << "TMS:RSA:ra:   MovGrid: C1[00] C1[0n] C1[m0] C1[1n]"
-         // << C1[0][0] << C1[0][Nx-1] << C1[Mcomp-1][0] << C1[Mcomp-1][Nx-1];
-      }
+      // Solve the sedimentation step of each component's system
+      if ( nthr_ra2 > 1 )
+         US_Parallel::run( &ra2solve, Mcomp, nthr_ra2 );
+      else
+         ra2solve.run_range( 0, Mcomp, 0 );
 
       // Reaction part: instantaneous reaction at each node
       //
@@ -3848,60 +4094,11 @@ DbgLv(2) << "TMS:RSA:ra(2):   C1[10] C1[11] C1[1k] C1[1n]"
          }
       }
 
-      if ( accel || fixedGrid )                     // For fixed grid
-      {
-         for ( int i = 0; i < Mcomp; i++ )
-         {
-            right_hand_side[ 0 ] = - CB[ i ][ 1 ][ 0 ] * C0[ i ][ 0 ]
-                                   - CB[ i ][ 2 ][ 0 ] * C0[ i ][ 1 ];
-
-            for ( int j = 1; j < Nx - 1; j++ )
-            {
-               right_hand_side[ j ] = - CB[ i ][ 0 ][ j ] * C0[ i ][ j - 1 ]
-                                      - CB[ i ][ 1 ][ j ] * C0[ i ][ j     ]
-                                      - CB[ i ][ 2 ][ j ] * C0[ i ][ j + 1 ];
-            }
-
-            int j = Nx - 1;
-            right_hand_side[ j ] = - CB[ i ][ 0 ][ j ] * C0[ i ][ j - 1 ]
-                                   - CB[ i ][ 1 ][ j ] * C0[ i ][ j     ];
-
-            US_AstfemMath::tridiag( CA[ i ][ 0 ], CA[ i ][ 1 ], CA[ i ][ 2 ],
-                                    right_hand_side, C1[ i ], Nx );
-         }
-      }
-      else // Moving grid
-      {
-         for ( int i = 0; i < Mcomp; i++ )
-         {
-            // Calculate the right hand side vector //
-            right_hand_side[ 0 ] = - CB[ i ][ 2 ][ 0 ] * C0[ i ][ 0 ]
-                                   - CB[ i ][ 3 ][ 0 ] * C0[ i ][ 1 ];
-
-            right_hand_side[ 1 ] = - CB[ i ][ 1 ][ 1 ] * C0[ i ][ 0 ]
-                                   - CB[ i ][ 2 ][ 1 ] * C0[ i ][ 1 ]
-                                   - CB[ i ][ 3 ][ 1 ] * C0[ i ][ 2 ];
-
-            for ( int j = 2; j < Nx - 1; j++ )
-            {
-               right_hand_side[ j ] = - CB[ i ][ 0 ][ j ] * C0[ i ][ j - 2 ]
-                                      - CB[ i ][ 1 ][ j ] * C0[ i ][ j - 1 ]
-                                      - CB[ i ][ 2 ][ j ] * C0[ i ][ j     ]
-                                      - CB[ i ][ 3 ][ j ] * C0[ i ][ j + 1 ];
-            }
-
-            int j = Nx - 1;
-            right_hand_side[ j ] = - CB[ i ][ 0 ][ j ] * C0[ i ][ j - 2 ]
-                                   - CB[ i ][ 1 ][ j ] * C0[ i ][ j - 1 ]
-                                   - CB[ i ][ 2 ][ j ] * C0[ i ][ j     ];
-
-            US_AstfemMath::QuadSolver( CA[ i ][ 0 ], CA[ i ][ 1 ],
-                                       CA[ i ][ 2 ], CA[ i ][ 3 ],
-                                       right_hand_side, C1[ i ], Nx );
-         }
-         //DbgLv(2) << "TMS:RSA:ra:   MovGrid: C1[00] C1[0n] C1[m0] C1[1n]"
-         // << C1[0][0] << C1[0][Nx-1] << C1[Mcomp-1][0] << C1[Mcomp-1][Nx-1];
-      }
+      // Solve the sedimentation step of each component's system
+      if ( nthr_ra2 > 1 )
+         US_Parallel::run( &ra2solve, Mcomp, nthr_ra2 );
+      else
+         ra2solve.run_range( 0, Mcomp, 0 );
 
       // End of 2nd half step of sedimentation
 
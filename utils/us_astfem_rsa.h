@@ -59,6 +59,11 @@ class US_UTIL_EXTERN US_Astfem_RSA : public QObject
       //! \param flag  Integer debug print level (dbg_level).
       void set_debug_flag      ( int  flag ){ dbg_level       = flag; };
 
+      //! \brief Set the number of threads used within calculate().
+      //! \param nthr  Thread count; 1 for serial, 0 (default) for the
+      //!              US_Settings count when called from the main thread.
+      void set_thread_count    ( int  nthr ){ nthreads        = nthr; };
+
       void set_buffer( US_Buffer );
 
    signals:
@@ -124,6 +129,7 @@ class US_UTIL_EXTERN US_Astfem_RSA : public QObject
       double tot_conc;        //!< Total concentration in model
       int    Nx;              //!< Number of points used in radial direction
       int    dbg_level;       //!< Debug level
+      int    nthreads;        //!< Thread count (0 for default)
 
       US_AstfemMath::AstFemParameters af_params;  //!< Parameters used for adaptive
                                                   //!<  space time finite element solution
@@ -183,6 +189,16 @@ class US_UTIL_EXTERN US_Astfem_RSA : public QObject
       int    calculate_ni   ( double, double, int, US_AstfemMath::MfemInitial&,
                               US_AstfemMath::MfemData&, bool );
 
+      //!< Calculates non-interacting components concurrently, in blocks
+      //!< each simulated by a separate US_Astfem_RSA object
+      //!< Input : 1. Experimental data to which simulations are added
+      //         : 2. Number of threads to use ( int )
+      int    calculate_parallel( US_DataIO::RawData&, int );
+
+      //!< Insures that a timestate and simulation speed profile are loaded
+      //!< Input : Experimental data used to create any temporary timestate
+      void   load_timestate ( US_DataIO::RawData& );
+
       //!< Does mesh generation
       //!< Input  : 1. Qvector containing ( omega )^s/D values
       //            2. mesh type ( int )
@@ -6,6 +6,40 @@
 #include "us_math2.h"
 #include "us_matrix.h"
 #include "us_util.h"
+#include "us_settings.h"
+#include "us_profiler.h"
+
+#define _EDC_MAGIC_  0x55454443    // "UEDC"
+#define _EDC_VERS_   2             // Format (and edit code) version
+#define _EDC_MAXMB_  1024          // Cache size limit in megabytes
+#define _EDC_MAXDAY_ 30            // Age limit of cache files in days
+
+// Write a vector of doubles as a count and raw values
+static void put_doubles( QDataStream& ds, const QVector< double >& vals )
+{
+   ds << (qint32)vals.size();
+   ds.writeRawData( (const char*)vals.constData(),
+                    vals.size() * sizeof( double ) );
+}
+
+// Read a vector of doubles written by put_doubles()
+static void get_doubles( QDataStream& ds, QVector< double >& vals )
+{
+   qint32 nvals  = 0;
+   ds >> nvals;
+
+   if ( nvals < 0  ||  ds.status() != QDataStream::Ok )
+   {
+      ds.setStatus( QDataStream::ReadCorruptData );
+      return;
+   }
+
+   vals.resize( nvals );
+   int nbytes    = nvals * sizeof( double );
+
+   if ( ds.readRawData( (char*)vals.data(), nbytes ) != nbytes )
+      ds.setStatus( QDataStream::ReadPastEnd );
+}
 
 // Return the count of readings points
 int US_DataIO::RawData::pointCount( )
@@ -501,6 +535,7 @@ void US_DataIO::write( QDataStream& ds, const char* c, int len, quint32& crc )
 
 int US_DataIO::readRawData( const QString& file, RawData& data )
 {
+   US_PROF_SCOPE( "dataio.read_raw" );
    QFile ff( file );
    if ( ! ff.open( QIODevice::ReadOnly ) ) return CANTOPEN;
    QDataStream ds( &ff );
@@ -995,19 +1030,16 @@ int US_DataIO::loadData( const QString&         directory,
                          const QString&         editFilename,
                          QVector< EditedData >& data )
 {
-   QVector< RawData > raw;
-
-   return loadData( directory, editFilename, data, raw );
+   return loadEdited( directory, editFilename, data, NULL );
 }
 
 int US_DataIO::loadData( const QString&  directory, 
                          const QString&  editFilename,
                          EditedData&     data )
 {
-   QVector< RawData    > raw;
    QVector< EditedData > editedData;
 
-   int result = loadData( directory, editFilename, editedData, raw );
+   int result = loadEdited( directory, editFilename, editedData, NULL );
    
    if ( result == OK ) 
       data = editedData[ 0 ];
@@ -1021,6 +1053,16 @@ int US_DataIO::loadData( const QString&         directory,
                          QVector< EditedData >& data,
                          QVector< RawData    >& raw )
 {
+   return loadEdited( directory, editFilename, data, &raw );
+}
+
+// Load edited data, and raw data if wanted, using any cached edited data
+int US_DataIO::loadEdited( const QString&         directory, 
+                           const QString&         editFilename,
+                           QVector< EditedData >& data,
+                           QVector< RawData    >* raw )
+{
+   US_PROF_SCOPE( "dataio.load_data" );
    QString ftriple     = editFilename.section( ".", -2, -2 );
    // Determine raw file name by removing editID
    QString rawDataFile = editFilename;
@@ -1045,11 +1087,37 @@ int US_DataIO::loadData( const QString&         directory,
 //qDebug() << "dIO:ldEd: rawDataFile" << rawDataFile;
 //qDebug() << "dIO:ldEd: edtFileRead" << edtFileRead;
 
-   // Get the raw data
+   // Use cached edited data if it exists
+   QString cachePath   = editCacheFile( directory + "/" + rawDataFile,
+                                        directory + "/" + edtFileRead,
+                                        editFilename );
    RawData dd;
-   ioError result = (ioError)readRawData( directory + "/" + rawDataFile, dd );
+   ioError result;
+
+   if ( ! cachePath.isEmpty() )
+   {
+      EditedData ced;
+
+      if ( readEditCache( cachePath, ced ) )
+      {
+         US_PROF_COUNT( "dataio.edit_cache_hits", 1 );
+
+         if ( raw != NULL )
+         {  // The raw data is still wanted
+            result = (ioError)readRawData( directory + "/" + rawDataFile, dd );
+            if ( result != OK ) throw result;
+            *raw << dd;
+         }
+
+         data << ced;
+         return OK;
+      }
+   }
+
+   // Get the raw data
+   result = (ioError)readRawData( directory + "/" + rawDataFile, dd );
    if ( result != OK ) throw result;
-   raw << dd;
+   if ( raw != NULL ) *raw << dd;
    qApp->processEvents();
 
    // Get the edit data
@@ -1196,10 +1264,220 @@ int US_DataIO::loadData( const QString&         directory,
       }
    }
 
+   if ( ! cachePath.isEmpty() )
+      writeEditCache( cachePath, ed );
+
    data << ed;
    return OK;
 }
 
+// Get the path of the cache file for edited data, or an empty string if
+//  the cache is off or the data files cannot be read
+QString US_DataIO::editCacheFile( const QString& rawPath,
+                                  const QString& editPath,
+                                  const QString& editFilename )
+{
+#ifdef NO_DB
+   // Every MPI rank loads the data in a shared work directory:  no cache
+   Q_UNUSED( rawPath );
+   Q_UNUSED( editPath );
+   Q_UNUSED( editFilename );
+   return QString();
+#else
+   if ( ! qgetenv( "US_NO_EDIT_CACHE" ).isEmpty() )
+      return QString();
+
+   // Get the raw data GUID from the raw file header
+   QFile fr( rawPath );
+   char  rhead[ 26 ];
+
+   if ( ! fr.open( QIODevice::ReadOnly )  ||  fr.read( rhead, 26 ) != 26  ||
+        strncmp( rhead, "UCDA", 4 ) != 0 )
+      return QString();
+
+   fr.close();
+   QString rawGuid = US_Util::uuid_unparse( (uchar*)rhead + 10 );
+
+   // Hash the edit file (which holds the edit GUID) along with its name
+   QFile fe( editPath );
+
+   if ( ! fe.open( QIODevice::ReadOnly ) )
+      return QString();
+
+   QCryptographicHash hash( QCryptographicHash::Md5 );
+   hash.addData( fe.readAll() );
+   hash.addData( editFilename.toUtf8() );
+   fe.close();
+
+   // A re-exported raw file may keep its GUID:  add its size and time,
+   //  and the cache version, so that edit code changes invalidate it
+   QFileInfo fir( rawPath );
+   hash.addData( QString( "%1:%2:%3" ).arg( fir.size() )
+                 .arg( fir.lastModified().toTime_t() )
+                 .arg( _EDC_VERS_ ).toLatin1() );
+
+   return US_Settings::workBaseDir() + "/cache/" + rawGuid + "."
+          + QString( hash.result().toHex() ) + ".edc";
+#endif
+}
+
+// Read cached edited data by mapping its file
+bool US_DataIO::readEditCache( const QString& path, EditedData& ed )
+{
+   US_PROF_SCOPE( "dataio.read_edit_cache" );
+   QFile ff( path );
+
+   if ( ! ff.open( QIODevice::ReadOnly ) )
+      return false;
+
+   qint64 fsize    = ff.size();
+   uchar* mdata    = ( fsize > 0 ) ? ff.map( 0, fsize ) : NULL;
+
+   if ( mdata == NULL )
+      return false;
+
+   QByteArray  bytes = QByteArray::fromRawData( (const char*)mdata,
+                                                (int)fsize );
+   QDataStream ds( bytes );
+   ds.setVersion( QDataStream::Qt_4_6 );
+   quint32     magic = 0;
+   quint32     vers  = 0;
+   ds >> magic >> vers;
+
+   if ( magic != _EDC_MAGIC_  ||  vers != _EDC_VERS_ )
+   {
+      ff.unmap( mdata );
+      return false;
+   }
+
+   qint32 nspeed   = 0;
+   qint32 nscan    = 0;
+
+   ds >> ed.expType >> ed.runID >> ed.editID >> ed.dataType >> ed.cell
+      >> ed.channel >> ed.wavelength >> ed.description >> ed.editGUID
+      >> ed.dataGUID >> ed.meniscus >> ed.plateau >> ed.baseline
+      >> ed.ODlimit >> ed.floatingData >> nspeed;
+
+   ed.speedData.clear();
+
+   for ( int ii = 0; ii < nspeed  &&  ds.status() == QDataStream::Ok; ii++ )
+   {
+      SpeedData sd;
+      qint32    first;
+      qint32    count;
+
+      ds >> first >> count >> sd.speed >> sd.meniscus >> sd.dataLeft
+         >> sd.dataRight;
+
+      sd.first_scan  = first;
+      sd.scan_count  = count;
+      ed.speedData << sd;
+   }
+
+   get_doubles( ds, ed.xvalues );
+   ds >> nscan;
+   ed.scanData.resize( qMax( nscan, 0 ) );
+
+   for ( int ii = 0; ii < nscan  &&  ds.status() == QDataStream::Ok; ii++ )
+   {
+      Scan* sc       = &ed.scanData[ ii ];
+
+      ds >> sc->temperature >> sc->rpm >> sc->seconds >> sc->omega2t
+         >> sc->wavelength >> sc->plateau >> sc->delta_r >> sc->nz_stddev;
+
+      get_doubles( ds, sc->rvalues );
+      get_doubles( ds, sc->stddevs );
+      ds >> sc->interpolated;
+   }
+
+   bool ok         = ( ds.status() == QDataStream::Ok );
+   ff.unmap( mdata );
+   ff.close();
+
+   return ok;
+}
+
+// Write edited data to a cache file
+void US_DataIO::writeEditCache( const QString& path, const EditedData& ed )
+{
+   US_PROF_SCOPE( "dataio.write_edit_cache" );
+   QString cdir    = QFileInfo( path ).absolutePath();
+   QDir().mkpath( cdir );
+   pruneEditCache( cdir );
+
+   // Write to a uniquely named temporary file, then rename it into place,
+   //  so concurrent loads (on any host) never see a partial cache file
+   QTemporaryFile ff( path + ".XXXXXX" );
+   ff.setAutoRemove( false );
+
+   if ( ! ff.open() )
+      return;
+
+   QString tpath   = ff.fileName();
+
+   QDataStream ds( &ff );
+   ds.setVersion( QDataStream::Qt_4_6 );
+
+   ds << (quint32)_EDC_MAGIC_ << (quint32)_EDC_VERS_;
+   ds << ed.expType << ed.runID << ed.editID << ed.dataType << ed.cell
+      << ed.channel << ed.wavelength << ed.description << ed.editGUID
+      << ed.dataGUID << ed.meniscus << ed.plateau << ed.baseline
+      << ed.ODlimit << ed.floatingData << (qint32)ed.speedData.size();
+
+   for ( int ii = 0; ii < ed.speedData.size(); ii++ )
+   {
+      const SpeedData* sd = &ed.speedData[ ii ];
+
+      ds << (qint32)sd->first_scan << (qint32)sd->scan_count << sd->speed
+         << sd->meniscus << sd->dataLeft << sd->dataRight;
+   }
+
+   put_doubles( ds, ed.xvalues );
+   ds << (qint32)ed.scanData.size();
+
+   for ( int ii = 0; ii < ed.scanData.size(); ii++ )
+   {
+      const Scan* sc = &ed.scanData[ ii ];
+
+      ds << sc->temperature << sc->rpm << sc->seconds << sc->omega2t
+         << sc->wavelength << sc->plateau << sc->delta_r << sc->nz_stddev;
+
+      put_doubles( ds, sc->rvalues );
+      put_doubles( ds, sc->stddevs );
+      ds << sc->interpolated;
+   }
+
+   bool ok         = ( ds.status() == QDataStream::Ok );
+   ff.close();
+
+   // Another process may have written the same cache file meanwhile
+   if ( ! ok  ||  QFile::exists( path )  ||  ! QFile::rename( tpath, path ) )
+      QFile::remove( tpath );
+}
+
+// Prune the edited data cache:  remove files (including temporaries left
+//  by failed writes) past the age limit, then the oldest files until the
+//  cache is within its size limit
+void US_DataIO::pruneEditCache( const QString& cdir )
+{
+   QDir          dir( cdir );
+   QFileInfoList cfiles = dir.entryInfoList( QStringList( "*.edc*" ),
+                                             QDir::Files, QDir::Time );
+   QDateTime     oldest = QDateTime::currentDateTime()
+                          .addDays( -_EDC_MAXDAY_ );
+   qint64        maxsz  = (qint64)_EDC_MAXMB_ * 1024 * 1024;
+   qint64        total  = 0;
+
+   // Files are listed newest first
+   for ( int ii = 0; ii < cfiles.size(); ii++ )
+   {
+      total        += cfiles[ ii ].size();
+
+      if ( total > maxsz  ||  cfiles[ ii ].lastModified() < oldest )
+         QFile::remove( cfiles[ ii ].absoluteFilePath() );
+   }
+}
+
 // Adjust interference data
 void US_DataIO::adjust_interference( RawData& data, const EditValues& ev )
 {
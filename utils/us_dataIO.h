@@ -296,6 +296,13 @@ class US_UTIL_EXTERN US_DataIO
       /*! Load edited data into a data structure.  This is the method most
           analysis programs will call to read data into memory.  It uses
           the functions readRawData and readEdits.
+
+          Fully edited data is cached in a binary file under the "cache"
+          subdirectory of the work base directory, keyed by the raw data
+          GUID and a hash of the edit file and its name, so a later load
+          of the same edited data maps the cached file instead of applying
+          the edits again.  Setting the environment variable
+          US_NO_EDIT_CACHE turns the cache off.
           \param directory    The directory of the auc files
           \param editFilename The the file with the edited parameters
           \param data         The location where the edited data is placed
@@ -388,5 +395,14 @@ class US_UTIL_EXTERN US_DataIO
                                const QVector< double >&, QVector< double >& );
       static QList< double >
                calc_residuals( int, const QVector< Scan >& );
+
+      static int     loadEdited    ( const QString&, const QString&,
+                                     QVector< EditedData >&,
+                                     QVector< RawData >* );
+      static QString editCacheFile ( const QString&, const QString&,
+                                     const QString& );
+      static bool    readEditCache ( const QString&, EditedData& );
+      static void    writeEditCache( const QString&, const EditedData& );
+      static void    pruneEditCache( const QString& );
 };
 #endif
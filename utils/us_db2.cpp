@@ -530,13 +530,15 @@ int US_DB2::numRows( void )
 }
 #endif
 
+// Size of each piece of a blob streamed to or from the database
+#define BLOB_CHUNK 1048576
+
 #ifdef NO_DB
 int US_DB2::writeBlobToDB( const QString& , const QString& , const int ) { return 0; }
 #else
 int US_DB2::writeBlobToDB( const QString& filename, 
     const QString& procedure, const int tableID )
 {
-   // First let's read the file
    QFile fin( filename );
 
    if ( ! fin.open( QIODevice::ReadOnly ) )
@@ -546,9 +548,482 @@ int US_DB2::writeBlobToDB( const QString& filename,
       return ERROR;
    }
 
-   QByteArray blobData = fin.readAll();
+   int status = writeBlobDevice( &fin, filename, procedure, tableID );
    fin.close();
 
+   return status;
+}
+#endif
+
+#ifdef NO_DB
+int US_DB2::writeBlobDevice( QIODevice* , const QString& , const QString& ,
+                             const int ) { return 0; }
+#else
+int US_DB2::writeBlobDevice( QIODevice* fin, const QString& filename, 
+    const QString& procedure, const int tableID )
+{
+   if ( fin->size() < 1 )
+   {
+      error = QString( "writeBlob: no data in file " ) + filename;
+      db_errno = ERROR;
+      return ERROR;
+   }
+
+   if ( tableID == 0 )
+   {
+      error = QString( "writeBlob: don't know which record data belongs to in " ) + filename;
+      db_errno = ERROR;
+      return ERROR;
+   }
+
+   // Clear out any unused result sets
+   if ( result )
+      mysql_free_result( result ); 
+
+   while ( mysql_next_result( db ) == 0 )
+   {
+      result = mysql_store_result( db );
+      mysql_free_result( result );
+   }
+   result = NULL;
+
+   // Prepare the call with the blob as a long-data parameter
+   QByteArray sqlQuery = ( "CALL " + procedure + "( ?, ?, ?, ?, ? )" ).toLatin1();
+   MYSQL_STMT* stmt    = mysql_stmt_init( db );
+
+   if ( stmt == NULL  ||
+        mysql_stmt_prepare( stmt, sqlQuery.constData(), sqlQuery.size() ) != 0 )
+   {  // Older servers cannot prepare CALL:  send it all in one query
+      if ( stmt != NULL )
+         mysql_stmt_close( stmt );
+
+      return writeBlobQuery( fin, filename, procedure, tableID );
+   }
+
+   QByteArray    uguid    = guid  .toLatin1();
+   QByteArray    upasswd  = userPW.toLatin1();
+   char          md5hex[ 33 ];
+   unsigned long lguid    = uguid  .size();
+   unsigned long lpasswd  = upasswd.size();
+   unsigned long lcheck   = 32;
+   int           recID    = tableID;
+
+   MYSQL_BIND bind[ 5 ];
+   memset( bind, 0, sizeof( bind ) );
+
+   bind[ 0 ].buffer_type   = MYSQL_TYPE_STRING;
+   bind[ 0 ].buffer        = uguid.data();
+   bind[ 0 ].buffer_length = lguid;
+   bind[ 0 ].length        = &lguid;
+   bind[ 1 ].buffer_type   = MYSQL_TYPE_STRING;
+   bind[ 1 ].buffer        = upasswd.data();
+   bind[ 1 ].buffer_length = lpasswd;
+   bind[ 1 ].length        = &lpasswd;
+   bind[ 2 ].buffer_type   = MYSQL_TYPE_LONG;
+   bind[ 2 ].buffer        = (char*)&recID;
+   bind[ 3 ].buffer_type   = MYSQL_TYPE_LONG_BLOB;
+   bind[ 4 ].buffer_type   = MYSQL_TYPE_STRING;
+   bind[ 4 ].buffer        = md5hex;
+   bind[ 4 ].buffer_length = lcheck;
+   bind[ 4 ].length        = &lcheck;
+
+   if ( mysql_stmt_bind_param( stmt, bind ) != 0 )
+   {
+      error = QString( "MySQL error: " ) + mysql_stmt_error( stmt );
+      mysql_stmt_close( stmt );
+      db_errno = ERROR;
+      return ERROR;
+   }
+
+   // Stream the file in chunks, accumulating the checksum as we go
+   QCryptographicHash hash( QCryptographicHash::Md5 );
+   QByteArray         chunk;
+
+   while ( ! fin->atEnd() )
+   {
+      chunk = fin->read( BLOB_CHUNK );
+      hash.addData( chunk );
+
+      if ( mysql_stmt_send_long_data( stmt, 3, chunk.constData(),
+                                      chunk.size() ) != 0 )
+      {
+         error = QString( "MySQL error: " ) + mysql_stmt_error( stmt );
+         mysql_stmt_close( stmt );
+         db_errno = ERROR;
+         return ERROR;
+      }
+   }
+
+   // The checksum parameter buffer is read at execute time
+   memcpy( md5hex, hash.result().toHex().constData(), lcheck );
+
+   if ( mysql_stmt_execute( stmt ) != 0 )
+   {
+      error = QString( "MySQL error: " ) + mysql_stmt_error( stmt );
+      mysql_stmt_close( stmt );
+      db_errno = ERROR;
+      return ERROR;
+   }
+
+   // The first result set is status
+   db_errno = stmtStatus( stmt );
+   stmtDrain( stmt );
+   mysql_stmt_close( stmt );
+
+   if ( db_errno == BAD_CHECKSUM )
+   {
+      error = QString( "writeBlob: data transmission error (MD5 checksum)" ) ;
+
+      return BAD_CHECKSUM;
+   }
+
+   else if ( db_errno != OK )
+   {
+      error = QString( "MySQL error: " ) + lastError();
+
+      return db_errno;
+   }
+
+   return db_errno;
+}
+#endif
+
+#ifdef NO_DB
+int US_DB2::readBlobFromDB( const QString& , const QString& , const int ) { return 0; }
+#else
+int US_DB2::readBlobFromDB( const QString& filename, 
+    const QString& procedure, const int tableID )
+{
+   // Write to a temporary file, so a bad transfer leaves any old file alone
+   QString    tmpname  = filename + ".part";
+   QFile      fout( tmpname );
+
+   if ( ! fout.open( QIODevice::WriteOnly ) )
+   {
+      error = QString( "readBlob: could not write file " ) + filename;
+      db_errno = ERROR;
+      return ERROR;
+   }
+
+   int status = readBlobDevice( &fout, filename, procedure, tableID );
+   fout.close();
+
+   if ( status == OK )
+   {
+      QFile::remove( filename );
+
+      if ( ! QFile::rename( tmpname, filename ) )
+      {
+         error    = QString( "readBlob: could not write file " ) + filename;
+         db_errno = ERROR;
+         status   = ERROR;
+      }
+   }
+
+   if ( status != OK )
+      QFile::remove( tmpname );
+
+   return status;
+}
+#endif
+
+#ifdef NO_DB
+int US_DB2::readBlobDevice( QIODevice* , const QString& , const QString& ,
+                            const int ) { return 0; }
+#else
+int US_DB2::readBlobDevice( QIODevice* fout, const QString& filename, 
+    const QString& procedure, const int tableID )
+{
+   // Make sure that we clear out any unused
+   //   result sets
+   if ( result )
+      mysql_free_result( result ); 
+
+   while ( mysql_next_result( db ) == 0 )
+   {
+      result = mysql_store_result( db );
+      mysql_free_result( result );
+   }
+   result = NULL;
+   error  = "";
+
+   QByteArray sqlQuery = ( "CALL " + procedure + "( ?, ?, ? )" ).toLatin1();
+   MYSQL_STMT* stmt    = mysql_stmt_init( db );
+
+   if ( stmt == NULL  ||
+        mysql_stmt_prepare( stmt, sqlQuery.constData(), sqlQuery.size() ) != 0 )
+   {  // Older servers cannot prepare CALL:  read it all in one query
+      if ( stmt != NULL )
+         mysql_stmt_close( stmt );
+
+      return readBlobQuery( fout, filename, procedure, tableID );
+   }
+
+   QByteArray    uguid    = guid  .toLatin1();
+   QByteArray    upasswd  = userPW.toLatin1();
+   unsigned long lguid    = uguid  .size();
+   unsigned long lpasswd  = upasswd.size();
+   int           recID    = tableID;
+
+   MYSQL_BIND bind[ 3 ];
+   memset( bind, 0, sizeof( bind ) );
+
+   bind[ 0 ].buffer_type   = MYSQL_TYPE_STRING;
+   bind[ 0 ].buffer        = uguid.data();
+   bind[ 0 ].buffer_length = lguid;
+   bind[ 0 ].length        = &lguid;
+   bind[ 1 ].buffer_type   = MYSQL_TYPE_STRING;
+   bind[ 1 ].buffer        = upasswd.data();
+   bind[ 1 ].buffer_length = lpasswd;
+   bind[ 1 ].length        = &lpasswd;
+   bind[ 2 ].buffer_type   = MYSQL_TYPE_LONG;
+   bind[ 2 ].buffer        = (char*)&recID;
+
+   if ( mysql_stmt_bind_param( stmt, bind ) != 0  ||
+        mysql_stmt_execute   ( stmt )       != 0 )
+   {
+      error = QString( "MySQL error: " ) + mysql_stmt_error( stmt );
+      mysql_stmt_close( stmt );
+      db_errno = ERROR;
+      return ERROR;
+   }
+
+   // First result set is status
+   db_errno = stmtStatus( stmt );
+
+   if ( db_errno == OK  &&  mysql_stmt_next_result( stmt ) != 0 )
+      db_errno = NOROWS;
+
+   if ( db_errno != OK )
+   {
+      if ( error.isEmpty() )
+         error = QString( "readBlob: no data for record %1 (status %2)" )
+                 .arg( tableID ).arg( db_errno );
+
+      stmtDrain( stmt );
+      mysql_stmt_close( stmt );
+      return db_errno;
+   }
+
+   // Now get the result data:  bind the blob with a zero-length buffer,
+   //  so the fetch only reports its length, then pull it out by column
+   //  offset. Note that the client library still receives the whole row;
+   //  what is saved is the escaped copy and the whole-blob QByteArray.
+   char          md5buf[ 64 ];
+   unsigned long lblob    = 0;
+   unsigned long lmd5     = 0;
+
+   MYSQL_BIND rbind[ 2 ];
+   memset( rbind, 0, sizeof( rbind ) );
+
+   rbind[ 0 ].buffer_type   = MYSQL_TYPE_LONG_BLOB;
+   rbind[ 0 ].length        = &lblob;
+   rbind[ 1 ].buffer_type   = MYSQL_TYPE_STRING;
+   rbind[ 1 ].buffer        = md5buf;
+   rbind[ 1 ].buffer_length = sizeof( md5buf );
+   rbind[ 1 ].length        = &lmd5;
+
+   int fstat = mysql_stmt_bind_result( stmt, rbind );
+
+   if ( fstat == 0 )
+      fstat = mysql_stmt_fetch( stmt );
+
+   if ( fstat != 0  &&  fstat != MYSQL_DATA_TRUNCATED )
+   {
+      error = ( fstat == MYSQL_NO_DATA )
+              ? QString( "readBlob: no data for record %1" ).arg( tableID )
+              : QString( "MySQL error: " ) + mysql_stmt_error( stmt );
+      stmtDrain( stmt );
+      mysql_stmt_close( stmt );
+      db_errno = ERROR;
+      return ERROR;
+   }
+
+   QByteArray checksum( md5buf, (int)qMin( lmd5, (unsigned long)32 ) );
+
+   QCryptographicHash hash( QCryptographicHash::Md5 );
+   QByteArray         chunk( BLOB_CHUNK, '\0' );
+   MYSQL_BIND         cbind;
+   memset( &cbind, 0, sizeof( cbind ) );
+   unsigned long      lchunk   = 0;
+   cbind.buffer_type  = MYSQL_TYPE_LONG_BLOB;
+   cbind.buffer       = chunk.data();
+   cbind.length       = &lchunk;
+
+   for ( unsigned long offset = 0; offset < lblob; offset += BLOB_CHUNK )
+   {
+      unsigned long nbytes = qMin( lblob - offset, (unsigned long)BLOB_CHUNK );
+      cbind.buffer_length  = nbytes;
+
+      if ( mysql_stmt_fetch_column( stmt, &cbind, 0, offset ) != 0 )
+      {
+         error    = QString( "MySQL error: " ) + mysql_stmt_error( stmt );
+         db_errno = ERROR;
+         break;
+      }
+
+      hash.addData( chunk.constData(), nbytes );
+
+      if ( fout->write( chunk.constData(), nbytes ) != (qint64)nbytes )
+      {
+         error    = QString( "readBlob: could not write file " ) + filename;
+         db_errno = ERROR;
+         break;
+      }
+   }
+
+   stmtDrain( stmt );
+   mysql_stmt_close( stmt );
+
+   if ( db_errno == OK  &&  checksum != hash.result().toHex() )
+   {
+      error = QString( "readBlob: data transmission error (MD5 checksum)" ) ;
+
+      db_errno = BAD_CHECKSUM;
+   }
+
+   return db_errno;
+}
+#endif
+
+#ifndef NO_DB
+// Get the status value from the first result set of a prepared CALL
+int US_DB2::stmtStatus( MYSQL_STMT* stmt )
+{
+   int        status = ERROR;
+   MYSQL_BIND sbind;
+   memset( &sbind, 0, sizeof( sbind ) );
+
+   sbind.buffer_type  = MYSQL_TYPE_LONG;
+   sbind.buffer       = (char*)&status;
+
+   if ( mysql_stmt_field_count( stmt ) < 1           ||
+        mysql_stmt_bind_result( stmt, &sbind ) != 0  ||
+        mysql_stmt_fetch( stmt ) != 0 )
+   {
+      error  = QString( "MySQL error: " ) + mysql_stmt_error( stmt );
+      status = ERROR;
+   }
+
+   // Discard any remaining rows of the status set
+   while ( mysql_stmt_fetch( stmt ) == 0 ) ;
+   mysql_stmt_free_result( stmt );
+
+   return status;
+}
+
+// Discard all remaining rows and result sets of a prepared CALL
+void US_DB2::stmtDrain( MYSQL_STMT* stmt )
+{
+   do
+   {
+      if ( mysql_stmt_field_count( stmt ) > 0 )
+      {
+         while ( mysql_stmt_fetch( stmt ) == 0 ) ;
+         mysql_stmt_free_result( stmt );
+      }
+   } while ( mysql_stmt_next_result( stmt ) == 0 );
+}
+#endif
+
+// Worker for one connection of a concurrent blob transfer batch
+class US_DB2BlobWorker : public QRunnable
+{
+   public:
+      US_DB2BlobWorker( const QString& a_pw,
+            QVector< US_DB2::BlobTransfer* >& a_xfers, QAtomicInt& a_next )
+         : masterPW( a_pw ), xfers( a_xfers ), next( a_next ) {}
+
+      void run()
+      {
+#ifndef NO_DB
+         mysql_thread_init();
+#endif
+         {
+            US_DB2 db( masterPW );
+            int    nxfer = xfers.size();
+            int    jx    = next.fetchAndAddOrdered( 1 );
+
+            while ( jx < nxfer )
+            {
+               US_DB2::BlobTransfer* xfer = xfers[ jx ];
+
+               if ( ! db.isConnected() )
+                  xfer->status = US_DB2::NOT_CONNECTED;
+
+               else if ( xfer->upload )
+                  xfer->status = db.writeBlobToDB ( xfer->filename,
+                                    xfer->procedure, xfer->tableID );
+
+               else
+                  xfer->status = db.readBlobFromDB( xfer->filename,
+                                    xfer->procedure, xfer->tableID );
+
+               xfer->error  = ( xfer->status == US_DB2::OK )
+                              ? QString( "" ) : db.lastError();
+               jx           = next.fetchAndAddOrdered( 1 );
+            }
+         }
+#ifndef NO_DB
+         mysql_thread_end();
+#endif
+      }
+
+   private:
+      QString                            masterPW;
+      QVector< US_DB2::BlobTransfer* >&  xfers;
+      QAtomicInt&                        next;
+};
+
+int US_DB2::transferBlobs( const QString& masterPW,
+      QList< BlobTransfer >& xfers, int nconns )
+{
+   int nxfer   = xfers.size();
+   nconns      = qMax( 1, qMin( nconns, nxfer ) );
+
+   if ( nxfer < 1 )
+      return OK;
+
+#ifndef NO_DB
+   // The client library must be initialized before any threads use it
+   mysql_library_init( 0, NULL, NULL );
+#endif
+
+   QVector< BlobTransfer* > pxfers;
+   for ( int ii = 0; ii < nxfer; ii++ )
+   {
+      xfers[ ii ].status = ERROR;
+      pxfers << &xfers[ ii ];
+   }
+
+   QThreadPool pool;
+   QAtomicInt  next( 0 );
+   pool.setMaxThreadCount( nconns );
+
+   for ( int ii = 0; ii < nconns; ii++ )
+      pool.start( new US_DB2BlobWorker( masterPW, pxfers, next ) );
+
+   pool.waitForDone();
+
+   for ( int ii = 0; ii < nxfer; ii++ )
+   {
+      if ( xfers[ ii ].status != OK )
+         return xfers[ ii ].status;
+   }
+
+   return OK;
+}
+
+#ifdef NO_DB
+int US_DB2::writeBlobQuery( QIODevice* , const QString& , const QString& ,
+                            const int ) { return 0; }
+#else
+int US_DB2::writeBlobQuery( QIODevice* fin, const QString& filename, 
+    const QString& procedure, const int tableID )
+{
+   // First let's read the data
+   QByteArray blobData = fin->readAll();
+
    if ( blobData.size() < 1 )
    {
       error = QString( "writeBlob: no data in file " ) + filename;
@@ -650,9 +1125,10 @@ int US_DB2::writeBlobToDB( const QString& filename,
 #endif
 
 #ifdef NO_DB
-int US_DB2::readBlobFromDB( const QString& , const QString& , const int ) { return 0; }
+int US_DB2::readBlobQuery( QIODevice* , const QString& , const QString& ,
+                           const int ) { return 0; }
 #else
-int US_DB2::readBlobFromDB( const QString& filename, 
+int US_DB2::readBlobQuery( QIODevice* fout, const QString& filename, 
     const QString& procedure, const int tableID )
 {
    // First let's build the query
@@ -711,7 +1187,6 @@ int US_DB2::readBlobFromDB( const QString& filename,
       result = NULL;
 
       // Since we got data, let's write it out
-      QFile fout( filename );
       if ( checksum != calculated )
       {
          error = QString( "readBlob: data transmission error (MD5 checksum)" ) ;
@@ -719,19 +1194,12 @@ int US_DB2::readBlobFromDB( const QString& filename,
          db_errno = BAD_CHECKSUM;
       }
 
-      else if ( ! fout.open( QIODevice::WriteOnly ) )
+      else if ( fout->write( aucData ) != aucData.size() )
       {
          error = QString( "readBlob: could not write file " ) + filename;
 
          db_errno = ERROR;
       }
-
-      else
-      {
-         fout.write( aucData );
-         fout.close();
-      }
-if(!error.isEmpty()) qDebug() << error;
    }
 
    return db_errno;
@@ -807,22 +1275,37 @@ int US_DB2::writeAucToDB( const QString&, int ) { return 0; }
 #else
 int US_DB2::writeAucToDB( const QString& filename, int tableID ) 
 {
-   // First compress th file
-   US_Gzip gz;
-   int     retCode = gz.gzip( filename );
-   
-   QString fn = filename;
+   // Compress the file contents in memory and upload the gzip stream
+   QFile fin( filename );
+
+   if ( ! fin.open( QIODevice::ReadOnly ) )
+   {
+      error = QString( "writeAuc: cannot open file " ) + filename;
+      db_errno = ERROR;
+      return ERROR;
+   }
+
+   QByteArray aucData = fin.readAll();
+   fin.close();
 
-   if ( retCode == 0 )
-   {  
-      fn  += ".gz";  // gzip renames the file
-      retCode = writeBlobToDB( fn, "upload_aucData", tableID );
+   // Compress as one gzip member (one thread): older clients read only
+   //  the first member of a stream, and the blob is shared with them
+   QByteArray gzData;
+   US_Gzip    gz;
+   int        gzstat  = gz.gzip( aucData, gzData,
+                                 QFileInfo( filename ).fileName(), 1 );
 
-      // Now uncompress the file
-      gz.gzip( fn );
+   if ( gzstat != GZIP_OK )
+   {
+      error = QString( "writeAuc: " ) + gz.explain( gzstat );
+      db_errno = ERROR;
+      return ERROR;
    }
 
-   return retCode;
+   QBuffer gzbuf( &gzData );
+   gzbuf.open( QIODevice::ReadOnly );
+
+   return writeBlobDevice( &gzbuf, filename, "upload_aucData", tableID );
 }
 #endif
 
@@ -831,30 +1314,56 @@ int US_DB2::readAucFromDB( const QString&, int ) { return 0; }
 #else
 int US_DB2::readAucFromDB( const QString& filename, int tableID ) 
 {
-   QString fn = filename + ".gz";
+   // Download the blob into memory
+   QByteArray blobData;
+   QBuffer    blobbuf( &blobData );
+   blobbuf.open( QIODevice::WriteOnly );
+
+   int retCode = readBlobDevice( &blobbuf, filename, "download_aucData",
+                                 tableID );
+   blobbuf.close();
+
+   if ( retCode != OK )
+      return retCode;
 
-   int retCode = readBlobFromDB( fn, "download_aucData", tableID );
+   // Decompress it if it is gzipped (has the gzip magic number)
+   QByteArray aucData;
 
-   if ( retCode == OK )
+   if ( blobData.size() > 1  &&
+        blobData[ 0 ] == '\037'  &&  blobData[ 1 ] == '\213' )
    {
-      // Check to see if it is a gzipped file
-      char  buf[ 2 ];
-      QFile t( fn );
-      t.open( QIODevice::ReadOnly );
-      t.peek( buf, 2 );
-      t.close();
+      US_Gzip gz;
+      int     gzstat  = gz.gunzip( blobData, aucData );
 
-      // Look for gzip magic number
-      if ( buf[ 0 ] == '\037'  &&  buf[ 1 ] == '\213' )
+      if ( gzstat != GZIP_OK )
       {
-         US_Gzip gz;
-         retCode = gz.gunzip( fn );
-      }
-      else // not a gz file, jsut rename it
-      {
-         QFile::rename( fn, filename ); 
+         error = QString( "readAuc: " ) + gz.explain( gzstat );
+         db_errno = ERROR;
+         return ERROR;
       }
    }
+   else // not gzipped, just use it as is
+   {
+      aucData  = blobData;
+   }
+
+   // Write to a temporary file, so a failed write leaves any old file alone
+   QString tmpname  = filename + ".part";
+   QFile   fout( tmpname );
+
+   if ( ! fout.open( QIODevice::WriteOnly )  ||
+        fout.write( aucData ) != aucData.size() )
+   {
+      fout.close();
+      QFile::remove( tmpname );
+      error = QString( "readAuc: could not write file " ) + filename;
+      db_errno = ERROR;
+      return ERROR;
+   }
+
+   fout.close();
+   QFile::remove( filename );
+   QFile::rename( tmpname, filename );
 
    return retCode;
 }
@@ -251,7 +251,8 @@ class US_UTIL_EXTERN US_DB2
                corresponding binary information into the same record 
                using writeBlobToDB(). WriteBlobToDB() will return 
                dbStatus.ERROR if the file cannot be opened, or pass through
-               any error codes returned by the db.
+               any error codes returned by the db. The file is streamed to
+               the server in chunks as long data of a prepared statement.
 
         \param filename The complete and absolute pathname of the file with
                the binary data. WriteBlobToDB() will try to open the file
@@ -275,7 +276,8 @@ class US_UTIL_EXTERN US_DB2
                to read the corresponding binary information to a file 
                using readBlobFromDB(). ReadBlobFromDB() will return 
                dbStatus.ERROR if the file cannot be opened, or pass through
-               any error codes returned by the db.
+               any error codes returned by the db. The blob is fetched
+               unbuffered and written to the file in chunks by column offset.
 
         \param filename The complete and absolute pathname of the file to
                write the binary data to. ReadBlobFromDB() will try to open 
@@ -323,6 +325,34 @@ class US_UTIL_EXTERN US_DB2
     */
     int           writeAucToDB( const QString&, int );
 
+    //! \brief One entry in a batch of concurrent blob transfers
+    struct BlobTransfer
+    {
+      QString filename;    //!< Complete path of the local file
+      QString procedure;   //!< Name of the upload or download procedure
+      int     tableID;     //!< Primary-key index of the record with the blob
+      bool    upload;      //!< Flag: upload (true) or download (false)
+      int     status;      //!< Returned dbStatus of the transfer
+      QString error;       //!< Returned error text of a failed transfer
+    };
+
+    /*! \brief Runs a batch of blob uploads and downloads concurrently over
+               a small pool of connections. Each connection is opened with
+               the currently defined database and runs its transfers through
+               writeBlobToDB() or readBlobFromDB(), so each blob is streamed
+               in chunks rather than held in memory.
+
+        \param masterPW  Master password to decrypt DB password
+        \param xfers     List of transfers; the status and error members
+                         of each entry are set on return.
+        \param nconns    Maximum number of simultaneous connections
+
+        \return OK if all transfers succeeded; otherwise the status of
+                the first transfer that failed.
+    */
+    static int    transferBlobs( const QString&, QList< BlobTransfer >&,
+                                 int = 4 );
+
     /*! \brief Returns a text string containing the most recent error encountered
         by the US3 database system. If a query did not result in an error,
         lastError() might return a text string describing the previous error,
@@ -386,6 +416,24 @@ class US_UTIL_EXTERN US_DB2
 
     QString    buildQuery      ( const QStringList& );
     QString    buildQuerySelect( const QStringList& );
+
+    // Blob transfers from or to an open device, with the name of
+    //  the file for messages
+    int        writeBlobDevice ( QIODevice*, const QString&, const QString&,
+                                 const int );
+    int        readBlobDevice  ( QIODevice*, const QString&, const QString&,
+                                 const int );
+
+    // Single-query blob transfers, used when a server
+    //  cannot prepare a CALL statement
+    int        writeBlobQuery  ( QIODevice*, const QString&, const QString&,
+                                 const int );
+    int        readBlobQuery   ( QIODevice*, const QString&, const QString&,
+                                 const int );
+#ifndef NO_DB
+    int        stmtStatus      ( MYSQL_STMT* );
+    void       stmtDrain       ( MYSQL_STMT* );
+#endif
 };
 #endif
 
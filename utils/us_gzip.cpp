@@ -13,6 +13,18 @@
 #include <QFileInfo> 
 #include <QDataStream>
 #include <QDateTime>
+#include <QBuffer>
+
+// Device I/O, defined ahead of the Windows renames of read and write
+static qint64 device_read( QIODevice* dev, char* buf, qint64 size )
+{
+  return dev->read( buf, size );
+}
+
+static qint64 device_write( QIODevice* dev, const char* buf, qint64 size )
+{
+  return dev->write( buf, size );
+}
 
 #include <stdlib.h>
 #include <stdio.h>
@@ -46,6 +58,8 @@
 using namespace std;
 
 #include "us_gzip.h"
+#include "us_parallel.h"
+#include "us_profiler.h"
 
 #ifdef WIN32
 #  define ssize_t long
@@ -196,8 +210,45 @@ using namespace gzip_data;
 US_Gzip::US_Gzip()
 {
   static_dtree[ 0 ].Len = 0;
+  in_dev    = NULL;
+  out_dev   = NULL;
+  crc_reg   = (ulg) 0xffffffffL;
+  insize    = 0;
+  inptr     = 0;
+  outcnt    = 0;
 }
 
+// Task to compress the blocks of a batch as separate gzip members
+class US_GzipBlockTask : public US_RangeTask
+{
+  public:
+    const QByteArray* batch;     // Input data of a batch of blocks
+    QByteArray*       members;   // Compressed member of each block
+    QString           name;      // File name for the first member
+    QAtomicInt        error;     // First error of any block
+
+    void run_range( int begin, int end, int )
+    {
+      US_Gzip* gz = new US_Gzip;   // Too large for a worker's stack
+
+      for ( int jj = begin; jj < end; jj++ )
+      {
+        int boff  = jj * GZIP_BLOCKSIZE;
+        int blen  = qMin( batch->size() - boff, GZIP_BLOCKSIZE );
+        QByteArray block = QByteArray::fromRawData(
+                             batch->constData() + boff, blen );
+
+        int stat  = gz->gzip( block, members[ jj ],
+                              ( jj == 0 ) ? name : QString(), 1 );
+
+        if ( stat != GZIP_OK )
+          error.testAndSetOrdered( GZIP_OK, stat );
+      }
+
+      delete gz;
+    }
+};
+
 int US_Gzip::gzip( const QString& filename )
 {
   bytes_out = 0;
@@ -210,9 +261,118 @@ int US_Gzip::gunzip( const QString& filename )
   return treat_file( filename, true );
 }
 
+int US_Gzip::gzip( const QByteArray& input, QByteArray& output,
+                   const QString& name, int nthreads )
+{
+  QBuffer ibuf;
+  QBuffer obuf( &output );
+  ibuf.setData( input );
+  output.clear();
+  output.reserve( input.size() / 4 + 64 );
+  ibuf.open( QIODevice::ReadOnly );
+  obuf.open( QIODevice::WriteOnly );
+
+  return gzip( &ibuf, &obuf, name, nthreads );
+}
+
+int US_Gzip::gunzip( const QByteArray& input, QByteArray& output )
+{
+  QBuffer ibuf;
+  QBuffer obuf( &output );
+  ibuf.setData( input );
+  output.clear();
+  output.reserve( input.size() * 4 );
+  ibuf.open( QIODevice::ReadOnly );
+  obuf.open( QIODevice::WriteOnly );
+
+  return gunzip( &ibuf, &obuf );
+}
+
+int US_Gzip::gzip( QIODevice* input, QIODevice* output,
+                   const QString& name, int nthreads )
+{
+  US_PROF_SCOPE( "gzip.gzip" );
+  int nthr  = US_Parallel::threads( nthreads );
+  bytes_out = 0;
+
+  if ( nthr < 2 )
+  {  // Compress the whole input as a single member
+    in_dev    = input;
+    out_dev   = output;
+    int stat  = deflate_member( name, (time_t) 0 );
+    in_dev    = NULL;
+    out_dev   = NULL;
+    return stat;
+  }
+
+  // Compress batches of blocks in parallel, writing members in order
+  US_GzipBlockTask      task;
+  QVector< QByteArray > members;
+  qint64 nbatch = (qint64) nthr * 2 * GZIP_BLOCKSIZE;
+  bool   first  = true;
+
+  while ( first  ||  ! input->atEnd() )
+  {
+    QByteArray batch( (int) nbatch, '\0' );
+    qint64 nread     = device_read( input, batch.data(), nbatch );
+    if ( nread < 0 ) return GZIP_READERROR;
+    batch.resize( (int) nread );
+    int nblock       = ( batch.size() + GZIP_BLOCKSIZE - 1 ) / GZIP_BLOCKSIZE;
+    nblock           = qMax( nblock, 1 );
+
+    members.fill( QByteArray(), nblock );
+    task.batch       = &batch;
+    task.members     = members.data();
+    task.name        = first ? name : QString();
+    task.error       = GZIP_OK;
+
+    US_Parallel::run( &task, nblock, nthr, 1 );
+
+    int stat         = task.error;
+    if ( stat != GZIP_OK ) return stat;
+
+    for ( int ii = 0; ii < nblock; ii++ )
+    {
+      int mlen         = members[ ii ].size();
+
+      if ( device_write( output, members[ ii ].constData(), mlen ) != mlen )
+        return GZIP_WRITEERROR;
+
+      bytes_out       += (off_t) mlen;
+    }
+
+    first            = false;
+  }
+
+  US_PROF_COUNT( "gzip.bytes_out_kb", bytes_out / 1024 );
+  return GZIP_OK;
+}
+
+int US_Gzip::gunzip( QIODevice* input, QIODevice* output )
+{
+  US_PROF_SCOPE( "gzip.gunzip" );
+  QString name;
+  time_t  mtime;
+
+  in_dev    = input;
+  out_dev   = output;
+  bytes_out = 0;
+  insize    = 0;
+  inptr     = 0;
+  outcnt    = 0;
+
+  int stat  = read_header( name, mtime, false );
+
+  if ( stat == GZIP_OK )
+    stat      = inflate_members();
+
+  in_dev    = NULL;
+  out_dev   = NULL;
+  return stat;
+}
+
 int US_Gzip::treat_file( const QString& iname, bool decompress )
 {
-  //unsigned int crc;
   time_t       filetime;
   QFileInfo    filename( iname );
 
@@ -228,6 +388,12 @@ int US_Gzip::treat_file( const QString& iname, bool decompress )
   
   filetime = lastMod.toTime_t();
 
+  in_dev   = NULL;
+  out_dev  = NULL;
+  insize   = 0;
+  inptr    = 0;
+  outcnt   = 0;
+
   ifd = open( iname.toLatin1().constData(), O_RDONLY | O_BINARY );
   if ( ifd < 0 ) return GZIP_READERROR;
 
@@ -239,185 +405,218 @@ int US_Gzip::treat_file( const QString& iname, bool decompress )
 
   if ( decompress )
   {
-    ssize_t count;
+    QString embedded_name( "" );
+    int     stat = read_header( embedded_name, filetime, false );
 
-    // Two byte signature
-    char signature[2];
-    count = read( ifd, signature, 2 );
-    
-    if ( count != 2 )
+    if ( stat != GZIP_OK )
     {
       close( ifd );
-      return GZIP_READERROR;
+      return stat;
     }
 
-    if ( signature[0] != (char) 0x1f  || 
-         signature[1] != (char) 0x8b ) return GZIP_NOTGZ;
+    if ( ! embedded_name.isEmpty() ) oname = embedded_name;
 
-    // One byte method.  Only 0x08, deflate, is supported
-    char method;
-    count = read( ifd, &method, 1 );
+    // Open the output file but check that it doesn't exist first
+    QFileInfo output_file( oname );
 
-    if ( count != 1 )
-    {
-      close( ifd );
-      return GZIP_READERROR;
-    }
-    
-    // One byte flags.  00111111.  Only bit 3 ( file name present ) is supported
-    // Bit 0 is ignored.  Bits 1,2,4,5 (multi-part, extra field, comment,
-    // encrypyion) are flagged as unsupported.
+    if ( output_file.exists() ) return GZIP_OUTFILEEXISTS;
 
-    char flags;
-    count = read( ifd, &flags, 1 );
+    ofd    = open( oname.toLatin1().constData(), 
+                   O_CREAT | O_WRONLY | O_BINARY , 0664 );
+
+    // Expand compressed data, of all members
+    stat   = inflate_members();
 
-    if ( count != 1 )
+    if ( stat != GZIP_OK )
     {
       close( ifd );
-      return GZIP_READERROR;
+      close( ofd );
+      unlink( oname.toLatin1().constData() );
+      return stat;
     }
+  }
+//////////////////////////////////////////////////////
+  else  // compress the input file
+  {
+    // Check output file -- exists? writable?
+    QFileInfo filename( oname );
+////    if ( filename.exists() ) return GZIP_OUTFILEEXISTS;
 
-    if ( flags & 0x36 ) return GZIP_OPTIONNOTSUPPORTED;
+    ofd = open( oname.toLatin1().constData(), 
+                O_CREAT | O_WRONLY | O_BINARY, 0664 );
+    if ( ofd < 0 ) return GZIP_WRITEERROR;
 
-    // Four bytes.  File modification time in Unix format.
-    count = read( ifd, (char*) &filetime, 4 );
+    int stat = deflate_member( iname, filetime );
 
-    if ( count != 4 )
+    if ( stat != GZIP_OK )
     {
       close( ifd );
-      return GZIP_READERROR;
+      close( ofd );
+      return stat;
     }
+  }
 
-    char timestring[40];
-#ifdef WIN32
-    //ctime_s( timestring, sizeof( timestring ),  &filetime );
-    int stringCount = sprintf( timestring, "%s", ctime( &filetime ) );
-#else
-    ctime_r( &filetime, timestring );
+  // Get input file data
+  struct stat ifstat;
+  fstat( ifd, &ifstat );
+
+  // Close files
+  close( ifd );
+  close( ofd );
+
+  // Set the permissions 
+  chmod( oname.toLatin1().constData(), ifstat.st_mode & 07777 );
+
+  int stat = GZIP_OK;
+#ifndef Q_OS_WIN
+  // Change the ownership (may fail if not root)
+  stat = chown( oname.toLatin1().constData(), ifstat.st_uid, ifstat.st_gid );
 #endif
 
-    timestring[24] = 0;
+  // Reset oname metadata to ifile metadata
+  
+  struct utimbuf timep;
 
-    // One byte.   Extra flags (depend on compression method).
-    // FAST = 4 ( -1 compression ) or SLOW = 2 ( -9 compression )
+  timep.actime  = ifstat.st_atime;
+  timep.modtime = filetime;
+  utime( oname.toLatin1().constData(), &timep );
 
-    char extra;
-    // QString extraString;
+  // Now delete the input file
+  unlink( iname.toLatin1().constData() );
 
-    count = read( ifd, &extra, 1 );
-    if ( count != 1 )
-    {
-      close( ifd );
-      return GZIP_READERROR;
-    }
+  return stat;
+}
 
-    // One byte OS.  0x03 = UNIX, 0x0b = WIN32
-    // This parameter can be ignored.
+#define wp outcnt
+#define GETBYTE() (inptr < insize ? inbuf[inptr++] : (wp = w, fill_inbuf(0)))
 
-    char OS;
-    count = read( ifd, &OS, 1 );
-    
-    if ( count != 1 )
-    {
-      close( ifd );
-      return GZIP_READERROR;
-    }
+/* ========================================================================
+ *  Get the next byte of the gzip stream, through the input buffer,
+ *  returning EOF at the end of input if eof_ok is set.
+ */
+int US_Gzip::get_byte( int eof_ok )
+{
+  if ( inptr < insize ) return inbuf[ inptr++ ];
 
-    // Variable bytes  Optional original file name, zero terminated.
+  outcnt = 0;
+  return fill_inbuf( eof_ok );
+}
 
-    QString embedded_name( "" );
-    char    c;
+/* ========================================================================
+ *  Read the header of a gzip member.  At the end of input, if eof_ok is
+ *  set, return EOF instead of an error.
+ */
+int US_Gzip::read_header( QString& embedded_name, time_t& filetime,
+                          bool eof_ok )
+{
+  try
+  {
+    // Two byte signature
+    int  c = get_byte( eof_ok );
+    if ( c == EOF ) return EOF;
 
-    if ( flags & 0x08 ) // Filename present
-    {
-      while ( true )
-      {
-        count = read( ifd, &c, 1 );
-        
-        if ( count != 1 )
-        {
-          close( ifd );
-          return GZIP_READERROR;
-        }
+    if ( c != 0x1f  ||  get_byte( 0 ) != 0x8b ) return GZIP_NOTGZ;
 
-        if ( c == 0 ) break;
-        embedded_name.append( c );
-      } 
+    // One byte method.  Only 0x08, deflate, is supported
+    get_byte( 0 );
 
-      oname = embedded_name;
-    }
+    // One byte flags.  00111111.  Only bit 3 ( file name present ) is supported
+    // Bit 0 is ignored.  Bits 1,2,4,5 (multi-part, extra field, comment,
+    // encrypyion) are flagged as unsupported.
 
-    // Open the output file but check that it doesn't exist first
-    QFileInfo output_file( oname );
+    int flags = get_byte( 0 );
 
-    if ( output_file.exists() ) return GZIP_OUTFILEEXISTS;
+    if ( flags & 0x36 ) return GZIP_OPTIONNOTSUPPORTED;
 
-    ofd    = open( oname.toLatin1().constData(), 
-                   O_CREAT | O_WRONLY | O_BINARY , 0664 );
-    outcnt = 0;
+    // Four bytes.  File modification time in Unix format.
+    ulg mtime = 0;
 
-    updcrc( NULL, 0 );           /* initialize crc */
+    for ( int i = 0; i < 4; i++ ) mtime |= (ulg) get_byte( 0 ) << ( 8 * i );
 
-    // Expand compressd data
-    try
-    {
-      inflate();
-    }
-    catch ( int inflate_error )
-    {
-      close( ifd );
-      close( ofd );
-      unlink( oname.toLatin1().constData() );
-      return inflate_error;
-    }
+    if ( mtime != 0 ) filetime = (time_t) mtime;
 
-#define wp outcnt
-#define GETBYTE() (inptr < insize ? inbuf[inptr++] : (wp = w, fill_inbuf(0)))
-    unsigned w = 0;  // Dummy to make define above work
+    // One byte.   Extra flags (depend on compression method).
+    // FAST = 4 ( -1 compression ) or SLOW = 2 ( -9 compression )
+    get_byte( 0 );
 
-    // CRC
-    unsigned char buf[ 4 ];
+    // One byte OS.  0x03 = UNIX, 0x0b = WIN32
+    // This parameter can be ignored.
+    get_byte( 0 );
 
-    for ( int i = 0; i < 4; i++ ) buf[ i ] = GETBYTE();
-    
-    crc = buf[ 3 ] << 24 | buf[ 2 ] << 16 | buf[ 1 ] << 8 | buf[ 0 ];
+    // Variable bytes  Optional original file name, zero terminated.
+    embedded_name = "";
 
-    /* Validate decompression */
-    if ( crc != updcrc(outbuf, 0) ) 
+    if ( flags & 0x08 ) // Filename present
     {
-      close( ifd );
-      close( ofd );
-      unlink( oname.toLatin1().constData() );
-      return GZIP_CRCERROR;
+      while ( ( c = get_byte( 0 ) ) != 0 )
+        embedded_name.append( QChar( c ) );
     }
+  }
+  catch ( int read_error )
+  {
+    return read_error;
+  }
 
-    // uncompressed input size modulo 2^32
+  return GZIP_OK;
+}
 
-    for ( int i = 0; i < 4; i++ ) buf[ i ] = GETBYTE();
+/* ========================================================================
+ *  Inflate the data of a gzip member whose header has been read, then
+ *  validate it with the crc and length of the member trailer.
+ */
+int US_Gzip::inflate_member( void )
+{
+  off_t         mbytes = bytes_out;   // Output count at member start
+  unsigned char buf[ 8 ];
 
-    ulg size = buf[ 3 ] << 24 | buf[ 2 ] << 16 | buf[ 1 ] << 8 | buf[ 0 ];
+  outcnt = 0;
+  updcrc( NULL, 0 );           /* initialize crc */
 
-    if ( size != (unsigned int) bytes_out )
-    {
-      close( ifd );
-      close( ofd );
-      unlink( oname.toLatin1().constData() );
-      return GZIP_LENGTHERROR;
-    }
+  try
+  {
+    inflate();
+
+    for ( int i = 0; i < 8; i++ ) buf[ i ] = get_byte( 0 );
   }
-//////////////////////////////////////////////////////
-  else  // compress the input file
+  catch ( int inflate_error )
   {
-    // Check output file -- exists? writable?
-    QFileInfo filename( oname );
-////    if ( filename.exists() ) return GZIP_OUTFILEEXISTS;
+    return inflate_error;
+  }
 
-    ofd = open( oname.toLatin1().constData(), 
-                O_CREAT | O_WRONLY | O_BINARY, 0664 );
-    if ( ofd < 0 ) return GZIP_WRITEERROR;
+  // CRC
+  crc = buf[ 3 ] << 24 | buf[ 2 ] << 16 | buf[ 1 ] << 8 | buf[ 0 ];
+
+  /* Validate decompression */
+  if ( crc != updcrc( outbuf, 0 ) ) return GZIP_CRCERROR;
 
-    outcnt   = 0;
-    bytes_in = 0;
+  // uncompressed input size modulo 2^32
+  ulg size = buf[ 7 ] << 24 | buf[ 6 ] << 16 | buf[ 5 ] << 8 | buf[ 4 ];
+
+  if ( size != (unsigned int) ( bytes_out - mbytes ) ) return GZIP_LENGTHERROR;
+
+  return GZIP_OK;
+}
+
+/* ========================================================================
+ *  Inflate the member whose header has been read and any members that
+ *  follow it, as written by a parallel compression.
+ */
+int US_Gzip::inflate_members( void )
+{
+  QString name;
+  time_t  mtime;
+  int     stat = GZIP_OK;
+
+  while ( stat == GZIP_OK )
+  {
+    stat = inflate_member();
+
+    if ( stat == GZIP_OK )
+      stat = read_header( name, mtime, true );
+  }
+
+  return ( stat == EOF ) ? GZIP_OK : stat;
+}
 
 #define flush_output(w) (wp=(w),flush_window())
 
@@ -453,25 +652,36 @@ int US_Gzip::treat_file( const QString& iname, bool decompress )
 #define DEFLATED    8
 #define ORIG_NAME   0x08       /* bit 3 set: original file name present */
 
-    try
-    {
-      /* Write the header to the gzip file. See algorithm.doc for the format */
-      put_byte( GZIP_MAGIC[0] ); /* magic header */
-      put_byte( GZIP_MAGIC[1] );
-      put_byte( DEFLATED );      /* compression method */
+/* ========================================================================
+ *  Compress the whole input as one gzip member, recording the base name
+ *  of the given file name (if any) and the given time stamp.
+ */
+int US_Gzip::deflate_member( const QString& iname, time_t time_stamp )
+{
+  outcnt   = 0;
+  bytes_in = 0;
 
-      uch flags = ORIG_NAME;     /* general purpose bit flags */
-      put_byte( flags );         /* general flags */
+  if ( strlen( iname.toLatin1().constData() ) > 255 ) 
+     return GZIP_FILENAMEERROR;
+
+  try
+  {
+    /* Write the header to the gzip file. See algorithm.doc for the format */
+    put_byte( GZIP_MAGIC[0] ); /* magic header */
+    put_byte( GZIP_MAGIC[1] );
+    put_byte( DEFLATED );      /* compression method */
 
-      /* original time stamp (modification time) */
-      time_t time_stamp = lastMod.toTime_t();  
-      put_long( (ulg) time_stamp == ( time_stamp & 0xffffffff ) ? 
-          (ulg) time_stamp : (ulg) 0);
+    uch flags = iname.isEmpty() ? 0 : ORIG_NAME; /* general purpose flags */
+    put_byte( flags );         /* general flags */
+
+    /* original time stamp (modification time) */
+    put_long( (ulg) time_stamp == ( time_stamp & 0xffffffff ) ? 
+        (ulg) time_stamp : (ulg) 0);
 
 #define SLOW 2
-      uch deflate_flags = SLOW;  // Compression level 9
-      /* Write deflated file to zip file */
-      put_byte( (uch) deflate_flags ); /* extra flags */
+    uch deflate_flags = SLOW;  // Compression level 9
+    /* Write deflated file to zip file */
+    put_byte( (uch) deflate_flags ); /* extra flags */
 
 #ifdef WIN32
 #  define OS_CODE 0x0b 
@@ -479,66 +689,46 @@ int US_Gzip::treat_file( const QString& iname, bool decompress )
 #  define OS_CODE 0x03
 #endif
 
-      put_byte( OS_CODE );                  /* OS identifier */
-
-      if ( strlen( iname.toLatin1().constData() ) > 255 ) 
-         return GZIP_FILENAMEERROR;
+    put_byte( OS_CODE );                  /* OS identifier */
 
+    if ( flags & ORIG_NAME )
+    {
       char f[256];
       strcpy( f, iname.toLatin1().constData() );
       char* p = base_name( f ); /* Don't save the directory part. */
       do { put_byte( *p ); } while ( *p++ );
-                        
-      crc = updcrc( 0, 0 );
-
-      bi_init();
-      ct_init();
-      lm_init();
-      deflate();
-    
-      /* Write the crc and uncompressed size */
-      put_long( crc );
-      put_long( (ulg) bytes_in );
-    }
-    catch ( int error )
-    {
-      close( ifd );
-      close( ofd );
-      return error;
     }
+                      
+    crc = updcrc( 0, 0 );
+
+    bi_init();
+    ct_init();
+    lm_init();
+    deflate();
+  
+    /* Write the crc and uncompressed size */
+    put_long( crc );
+    put_long( (ulg) bytes_in );
 
     flush_outbuf();
   }
+  catch ( int error )
+  {
+    return error;
+  }
 
-  // Get input file data
-  struct stat ifstat;
-  fstat( ifd, &ifstat );
-
-  // Close files
-  close( ifd );
-  close( ofd );
-
-  // Set the permissions 
-  chmod( oname.toLatin1().constData(), ifstat.st_mode & 07777 );
-
-  int stat = GZIP_OK;
-#ifndef Q_OS_WIN
-  // Change the ownership (may fail if not root)
-  stat = chown( oname.toLatin1().constData(), ifstat.st_uid, ifstat.st_gid );
-#endif
-
-  // Reset oname metadata to ifile metadata
-  
-  struct utimbuf timep;
-
-  timep.actime  = ifstat.st_atime;
-  timep.modtime = filetime;
-  utime( oname.toLatin1().constData(), &timep );
+  return GZIP_OK;
+}
 
-  // Now delete the input file
-  unlink( iname.toLatin1().constData() );
+/* ========================================================================
+ *  Read from the input device or file.
+ */
+int US_Gzip::read_input( char* buf, unsigned size )
+{
+  if ( in_dev != NULL )
+    return (int) device_read( in_dev, buf, size );
 
-  return stat;
+  return (int) read( ifd, buf, size );
 }
 
 /* ========================================================================
@@ -1565,7 +1755,7 @@ int US_Gzip::fill_inbuf( int eof_ok )
   insize = 0;
   do 
   {
-    len = read ( ifd, (char*) inbuf + insize, INBUFSIZ - insize );
+    len = read_input( (char*) inbuf + insize, INBUFSIZ - insize );
     if ( len == 0 ) break;
     if ( len == -1 ) 
     {
@@ -1614,22 +1804,20 @@ ulg US_Gzip::updcrc( uch* s, unsigned n )
 {
   register ulg c;         /* temporary variable */
 
-  static ulg crc_internal = (ulg) 0xffffffffL; /* shift register contents */
-
   if ( s == NULL) 
   {
      c = 0xffffffffL;
   } 
   else 
   {
-     c = crc_internal;
+     c = crc_reg;
      if ( n ) do 
      {
        c = crc_32_tab[ ( (int) c ^ ( *s++ ) ) & 0xff ] ^ ( c >> 8 );
      } while ( --n );
   }
 
-  crc_internal = c;
+  crc_reg = c;
   return c ^ 0xffffffffL;       /* (instead of ~c for 64-bit machines) */
 }
 
@@ -1646,6 +1834,14 @@ void US_Gzip::write_buf( int fd, void* buf, unsigned cnt )
 {
   unsigned  n;
 
+  if ( out_dev != NULL )
+  {  // Write to the output device
+    if ( device_write( out_dev, (char*) buf, cnt ) != (qint64) cnt )
+      throw GZIP_WRITEERROR;
+
+    return;
+  }
+
   while ( ( n = write( fd, buf, cnt) ) != cnt) 
   {
     if ( n == (unsigned) (-1) ) 
@@ -1979,7 +2175,7 @@ int US_Gzip::file_read( char* buf, unsigned int size )
 {
     unsigned len;
 
-    len = read( ifd, buf, size );
+    len = read_input( buf, size );
     if ( len == 0 ) return (int) len;
     
     if ( len == (unsigned) -1 ) 
@@ -2,7 +2,10 @@
 #define US_GZIP_H
 
 #include <qstring.h>
+#include <qbytearray.h>
+#include <qiodevice.h>
 #include <sys/types.h>
+#include <time.h>
 #include "us_extern.h"
 
 // Error codes
@@ -21,6 +24,10 @@
 #define   GZIP_FILENAMEERROR     11
 #define   GZIP_INTERNAL          12
 
+//! Size of the input blocks compressed as separate gzip members
+//! when compressing in parallel
+#define   GZIP_BLOCKSIZE    0x100000
+
 
 typedef unsigned char  uch;
 typedef unsigned short ush;
@@ -47,6 +54,41 @@ class US_UTIL_EXTERN US_Gzip
      * \returns An error code.  Zero for no error */
     int     gunzip ( const QString& ); 
 
+    /*! Compress data in memory
+     * \param input    The data to be compressed.
+     * \param output   The returned gzip stream.
+     * \param name     The original file name to record, if any.
+     * \param nthreads Number of threads (0 for default).  With more than
+     *                 one, each GZIP_BLOCKSIZE block of input is compressed
+     *                 as a separate member of a multi-member gzip stream.
+     *                 Older US_Gzip versions read only the first member,
+     *                 so use one thread for data shared with other
+     *                 clients (database blobs, archives).
+     * \return An error code.  Zero for no error */
+    int     gzip   ( const QByteArray&, QByteArray&,
+                     const QString& = QString(), int = 0 );
+
+    /*! Decompress data in memory
+     * \param input    The gzip stream, possibly multi-member.
+     * \param output   The returned decompressed data.
+     * \return An error code.  Zero for no error */
+    int     gunzip ( const QByteArray&, QByteArray& );
+
+    /*! Compress from one open device to another
+     * \param input    The open device from which to read data.
+     * \param output   The open device to which to write the gzip stream.
+     * \param name     The original file name to record, if any.
+     * \param nthreads Number of threads (0 for default), as for buffers.
+     * \return An error code.  Zero for no error */
+    int     gzip   ( QIODevice*, QIODevice*,
+                     const QString& = QString(), int = 0 );
+
+    /*! Decompress from one open device to another
+     * \param input    The open device from which to read the gzip stream.
+     * \param output   The open device to which to write data.
+     * \return An error code.  Zero for no error */
+    int     gunzip ( QIODevice*, QIODevice* );
+
     /*! Explain an error
      * \param error  The error code that was returned gzip or gunzip
      * \return A string that corresponds to the error code */ 
@@ -77,6 +119,9 @@ class US_UTIL_EXTERN US_Gzip
 
     int      ifd;           /* input file descriptor */
     int      ofd;           /* output file descriptor */
+    QIODevice* in_dev;      /* input device, used instead of ifd if set */
+    QIODevice* out_dev;     /* output device, used instead of ofd if set */
+    ulg      crc_reg;       /* crc shift register contents */
 
 #define INBUFSIZ    0x8000  /* input buffer size */
 #define INBUF_EXTRA     64  /* required by unlzw() */
@@ -110,6 +155,12 @@ class US_UTIL_EXTERN US_Gzip
     uch window[ 2L * WSIZE               ];
 
     int     treat_file     ( const QString&, bool );
+    int     deflate_member ( const QString&, time_t );
+    int     read_header    ( QString&, time_t&, bool );
+    int     inflate_member ( void );
+    int     inflate_members( void );
+    int     get_byte       ( int );
+    int     read_input     ( char*, unsigned );
     QString make_ofname    ( const QString&, bool );
     int     huft_build     ( unsigned*, unsigned, unsigned, ush*, ush*,
                                          struct huft**, int* );
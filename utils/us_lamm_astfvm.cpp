@@ -5,8 +5,20 @@
 #include "us_constants.h"
 #include "us_astfem_rsa.h"
 #include "us_settings.h"
+#include "us_profiler.h"
 #include "us_dataIO.h"
 
+// Resize a work vector, reserving geometrically growing capacity so that
+//  repeated resizes during mesh adaptation and time steps do not reallocate
+template< class T > static T* grow_buffer( QVector< T >& vec, int size )
+{
+   if ( size > vec.capacity() )
+      vec.reserve( qMax( size, ( vec.capacity() * 3 ) / 2 ) );
+
+   vec.resize( size );
+   return vec.data();
+}
+
 /////////////////////////
 //
 // Mesh
@@ -14,7 +26,6 @@
 /////////////////////////
 US_LammAstfvm::Mesh::Mesh( double xl, double xr, int Nelem, int Opt )
 {
-   int i;
    dbg_level    = US_Settings::us_debug();
 
    // constants
@@ -23,14 +34,29 @@ US_LammAstfvm::Mesh::Mesh( double xl, double xr, int Nelem, int Opt )
    MonCutoff    = 1000;
    SmoothingWt  = 0.7;
    SmoothingCyl = 4;
- 
-   Ne      = Nelem;
-   Nv      = Ne + 1;
-   Eid     = new int    [ Ne ];
-   RefLev  = new int    [ Ne ];
-   Mark    = new int    [ Ne ];
-   MeshDen = new double [ Ne ];
-   x       = new double [ Nv ];
+
+   Reset( xl, xr, Nelem, Opt );
+}
+
+/////////////////////////
+//
+// ~Mesh
+//
+/////////////////////////
+US_LammAstfvm::Mesh::~Mesh()
+{
+}
+
+/////////////////////////
+//
+// Reset
+//
+/////////////////////////
+void US_LammAstfvm::Mesh::Reset( double xl, double xr, int Nelem, int Opt )
+{
+   int i;
+
+   Resize( Nelem );
 
    // uniform
    if ( Opt == 0 )
@@ -48,16 +74,18 @@ US_LammAstfvm::Mesh::Mesh( double xl, double xr, int Nelem, int Opt )
 
 /////////////////////////
 //
-// ~Mesh
+// Resize
 //
 /////////////////////////
-US_LammAstfvm::Mesh::~Mesh()
+void US_LammAstfvm::Mesh::Resize( int Nelem )
 {
-    delete [] x;
-    delete [] Eid;
-    delete [] RefLev;
-    delete [] MeshDen;
-    delete [] Mark;
+   Ne      = Nelem;
+   Nv      = Ne + 1;
+   x       = grow_buffer( xv,       Nv );
+   Eid     = grow_buffer( Eidv,     Ne );
+   RefLev  = grow_buffer( RefLevv,  Ne );
+   MeshDen = grow_buffer( MeshDenv, Ne );
+   Mark    = grow_buffer( Markv,    Ne );
 }
 
 /////////////////////////
@@ -71,10 +99,10 @@ void US_LammAstfvm::Mesh::ComputeMeshDen_D3( double *u0, double *u1 )
    int     i2;
    double  h;
 
-   double* D20 = new double [ Ne ];
-   double* D21 = new double [ Ne ];
-   double* D30 = new double [ Nv ];
-   double* D31 = new double [ Nv ];
+   double* D20 = grow_buffer( D2v, Ne + Ne );
+   double* D21 = D20 + Ne;
+   double* D30 = grow_buffer( D3v, Nv + Nv );
+   double* D31 = D30 + Nv;
    // 2nd derivative on elems
    for ( i = 0; i < Ne; i++ )
    {
@@ -115,11 +143,6 @@ void US_LammAstfvm::Mesh::ComputeMeshDen_D3( double *u0, double *u1 )
    }
 
    Smoothing( Ne, MeshDen, SmoothingWt, SmoothingCyl );
-
-   delete [] D20;
-   delete [] D21;
-   delete [] D30;
-   delete [] D31;
 }
 
 
@@ -169,12 +192,7 @@ void US_LammAstfvm::Mesh::Unrefine( double alpha )
 {
    int     i;
    int     i1;
-   int     Nv1;
    int     Ne1;
-   double* x1;
-   int*    Eid1;          // elem id
-   int*    RefLev1;       // refinement level of an elem
-   double* MeshDen1;      // desired mesh density
 
    while( 1 )
    {
@@ -199,53 +217,34 @@ void US_LammAstfvm::Mesh::Unrefine( double alpha )
 
       if ( Ne1 == Ne ) return;     // no more unrefine
 
-      // reallocate memory for the new mesh
-      Nv1      = Ne1 + 1;
-      Eid1     = new int    [ Ne1 ];
-      RefLev1  = new int    [ Ne1 ];
-      MeshDen1 = new double [ Ne1 ];
-      x1       = new double [ Nv1 ];
-      
-      // loop to combine eligible elem pairs
-      x1[ 0 ]  = x[ 0 ];
+      // combine eligible elem pairs in place, in a single forward pass;
+      //  the output index never passes the input index
       i1       = 0;
 
       for ( i = 0; i < Ne; i++ )
       {
-         if ( Mark[ i ] == 1  &&  Mark[ i + 1 ] == 1 )
+         if ( i < Ne - 1  &&  Mark[ i ] == 1  &&  Mark[ i + 1 ] == 1 )
          {  // combine two elems
-            x1[ i1 + 1 ]   = x[ i + 2 ];
-            Eid1[ i1 ]     = Eid[ i ] / 2;
-            RefLev1[ i1 ]  = RefLev[ i ] - 1;
-            MeshDen1[ i1 ] = ( MeshDen[ i ] + MeshDen[ i + 1 ] ) / 2;
+            x[ i1 + 1 ]    = x[ i + 2 ];
+            Eid[ i1 ]      = Eid[ i ] / 2;
+            RefLev[ i1 ]   = RefLev[ i ] - 1;
+            MeshDen[ i1 ]  = ( MeshDen[ i ] + MeshDen[ i + 1 ] ) / 2;
             i1++;
             i++;
          }
          
          else
          {  // no change
-            x1[ i1 + 1 ]   = x[ i + 1 ];
-            Eid1[ i1 ]     = Eid[ i ];
-            RefLev1[ i1 ]  = RefLev[ i ];
-            MeshDen1[ i1 ] = MeshDen[ i ];
+            x[ i1 + 1 ]    = x[ i + 1 ];
+            Eid[ i1 ]      = Eid[ i ];
+            RefLev[ i1 ]   = RefLev[ i ];
+            MeshDen[ i1 ]  = MeshDen[ i ];
             i1++;
           }
       }
-       
-      // delete memory for old mesh  
-      delete [] x;
-      delete [] Eid;
-      delete [] RefLev;
-      delete [] MeshDen;
-      delete [] Mark;
-
-      Ne      = Ne1;
-      Nv      = Nv1;
-      x       = x1;
-      Eid     = Eid1;
-      MeshDen = MeshDen1;
-      RefLev  = RefLev1;
-      Mark    = new int [ Ne1 ];
+
+      // shrink to the new mesh size (buffer capacity is kept)
+      Resize( Ne1 );
 
    } // while
 
@@ -261,12 +260,8 @@ void US_LammAstfvm::Mesh::Refine( double beta )
 {
    int     k;
    int     ke;
-   int     Nv1;
+   int     Ne0;
    int     Ne1;           // number of elements
-   int*    Eid1;          // element id
-   int*    RefLev1;       // refinement level of an element
-   double* MeshDen1;      // desired mesh density
-   double* x1;
   
    while( 1 )
    {
@@ -300,55 +295,43 @@ void US_LammAstfvm::Mesh::Refine( double beta )
      
       if ( Ne1 == Ne ) return;     // no more elements need refine
 
-      // allocate memory for new mesh
-      Nv1      = Ne1 + 1;
-      x1       = new double [ Nv1 ];
-      Eid1     = new int    [ Ne1 ];
-      RefLev1  = new int    [ Ne1 ];
-      MeshDen1 = new double [ Ne1 ];
+      // grow to the new mesh size, then split marked elements in place
+      //  in a single backward pass; the output index never falls below
+      //  the input index
+      Ne0      = Ne;
+      Resize( Ne1 );
+      ke       = Ne1;
 
-      ke       = 0;
-      x1[ 0 ]  = x[ 0 ];
-
-      for ( k = 0; k < Ne; k++ )
+      for ( k = Ne0 - 1; k >= 0; k-- )
       {
+         double xk0  = x[ k ];
+         double xk1  = x[ k + 1 ];
+         int    eidk = Eid[ k ];
+         int    rlvk = RefLev[ k ];
+         double mdnk = MeshDen[ k ];
+
          if ( Mark[ k ] == 0 )
          {     // no refine on elem-k
-            x1[ ke + 1 ]   = x[ k + 1 ];
-            Eid1[ ke ]     = Eid[ k ];
-            RefLev1[ ke ]  = RefLev[ k ];
-            MeshDen1[ ke ] = MeshDen[ k ];
-            ke++;
+            ke--;
+            x[ ke + 1 ]        = xk1;
+            Eid[ ke ]          = eidk;
+            RefLev[ ke ]       = rlvk;
+            MeshDen[ ke ]      = mdnk;
          }
         
          else
          {      // refine k-th elem
-            x1[ ke + 1 ]       = ( x[ k ] + x[ k + 1 ] ) / 2;
-            Eid1[ ke ]         = Eid[ k ] * 2;
-            RefLev1[ ke ]      = RefLev[ k ] + 1;
-            MeshDen1[ ke ]     = MeshDen[ k ];
-
-            x1[ ke + 2 ]       = x[ k + 1 ];
-            Eid1[ ke + 1 ]     = Eid1[ ke ] + 1;
-            RefLev1[ ke + 1 ]  = RefLev1[ ke ];
-            MeshDen1[ ke + 1 ] = MeshDen[ k ];
-            ke += 2;
+            ke -= 2;
+            x[ ke + 2 ]        = xk1;
+            x[ ke + 1 ]        = ( xk0 + xk1 ) / 2;
+            Eid[ ke ]          = eidk * 2;
+            Eid[ ke + 1 ]      = eidk * 2 + 1;
+            RefLev[ ke ]       = rlvk + 1;
+            RefLev[ ke + 1 ]   = rlvk + 1;
+            MeshDen[ ke ]      = mdnk;
+            MeshDen[ ke + 1 ]  = mdnk;
          } // if 
       } // for
-
-      delete [] x;
-      delete [] Eid;
-      delete [] RefLev;
-      delete [] Mark;
-      delete [] MeshDen;
-
-      Ne      = Ne1;
-      Nv      = Nv1;
-      x       = x1;
-      Eid     = Eid1;
-      RefLev  = RefLev1;
-      MeshDen = MeshDen1;
-      Mark    = new int [ Ne1 ];
    } // while
 }
 
@@ -394,6 +377,8 @@ void US_LammAstfvm::Mesh::InitMesh( double s, double D, double w2 )
    double  x2;
    double* u0;
    double* u1;
+   QVector< double > u0v;
+   QVector< double > u1v;
 
    D0  = 1.e-4;
    nu0 = s * w2 / D0;
@@ -407,8 +392,8 @@ void US_LammAstfvm::Mesh::InitMesh( double s, double D, double w2 )
 
    for ( t = 0; t < 1; t = t + 0.1 ) 
    {
-      u0 = new double [ 2 * Nv - 1 ];
-      u1 = new double [ 2 * Nv - 1 ];
+      u0 = grow_buffer( u0v, 2 * Nv - 1 );
+      u1 = grow_buffer( u1v, 2 * Nv - 1 );
 
       nu = pow( nu1, t ) * pow( nu0, 1 - t );
 
@@ -428,9 +413,6 @@ void US_LammAstfvm::Mesh::InitMesh( double s, double D, double w2 )
       }
 
       RefineMesh( u0, u1, 1.e-4 );
-
-      delete [] u0;
-      delete [] u1;
    }
 }
 
@@ -691,6 +673,7 @@ US_LammAstfvm::US_LammAstfvm( US_Model&                rmodel,
    : QObject( parent ), model( rmodel ), simparams( rsimparms )
 {
    comp_x   = 0;           // initial model component index
+   msh      = NULL;        // radial grid, created on first use
 
    dbg_level       = US_Settings::us_debug();
    stopFlag        = false;
@@ -732,12 +715,15 @@ US_LammAstfvm::~US_LammAstfvm()
 {
    if ( NonIdealCaseNo == 2 ) delete saltdata;
 
+   delete msh;
+
    return;
 }
 
 // primary method to calculate solutions for all species
 int US_LammAstfvm::calculate( US_DataIO::RawData& sim_data )
 {
+   US_PROF_SCOPE( "astfvm.calculate" );
    auc_data = &sim_data;
 
    // use given data to create form for internal data; zero initial concs.
@@ -792,7 +778,6 @@ int US_LammAstfvm::solve_component( int compx )
    double* u1;
    double* u1p0;
    double* u1p;
-   double* dtmp;
    double  total_t = ( param_b - param_m ) * 2.0
                    / ( param_s * param_w2 * param_m );
    double  dt      = log( param_b / param_m )
@@ -862,7 +847,11 @@ DbgLv(2) << "NonIdeal2: new saltdata  comp_x" << comp_x;
    conc1.resize( ncs );
    rads. resize( ncs );
 
-   Mesh *msh = new Mesh( param_m, param_b, 100, 0 );
+   // reuse the mesh (and its buffers) of any previous component
+   if ( msh == NULL )
+      msh = new Mesh( param_m, param_b, 100, 0 );
+   else
+      msh->Reset( param_m, param_b, 100, 0 );
 
    msh->InitMesh( param_s, param_D, param_w2 );
    int mropt = 1;                   // mesh refine option;
@@ -909,12 +898,12 @@ timer.start();
    // initialization
    N0    = msh->Nv;
    N0u   = N0 + N0 - 1;
-   x0    = new double [ N0  ];
-   u0    = new double [ N0u ];
+   x0    = grow_buffer( wk_x0, N0  );
+   u0    = grow_buffer( wk_u0, N0u );
    N1    = N0;
    N1u   = N0u;
-   x1    = new double [ N1  ];
-   u1    = new double [ N1u ];
+   x1    = grow_buffer( wk_x1, N1  );
+   u1    = grow_buffer( wk_u1, N1u );
 
    for ( int jj = 0; jj < N0; jj++ )
    {  // initialize X and U values
@@ -1004,7 +993,7 @@ DbgLv(2) << "LAsc:  u0 0,1,2...,N" << u0[0] << u0[1] << u0[2]
       }
 ktime1+=timer.restart();
 
-      u1p0  = new double [ N0u ];
+      u1p0  = grow_buffer( wk_u1p0, N0u );
       LammStepSedDiff_P( t0, dt, N0-1, x0, u0, u1p0 );
 ktime2+=timer.restart();
 
@@ -1016,23 +1005,18 @@ ktime3+=timer.restart();
 
          N1    = msh->Nv;
          N1u   = N1 + N1 - 1;
-         u1p   = new double [ N1u ];
-
-         delete [] x1;
-         x1    = new double [ N1 ];
+         u1p   = grow_buffer( wk_u1p, N1u );
+         x1    = grow_buffer( wk_x1,  N1  );
 
          for ( int jj = 0; jj < N1; jj++ )
             x1[ jj ] = msh->x[ jj ];
 
          ProjectQ( N0-1, x0, u1p0, N1-1, x1, u1p );
 
-         delete [] u1;
-         u1    = new double [ N1u ];
+         u1    = grow_buffer( wk_u1, N1u );
 
 ktime4+=timer.restart();
          LammStepSedDiff_C( t0, dt, N0-1, x0, u0, N1-1, x1, u1p, u1 );
-
-         delete [] u1p;
       }
 
       else
@@ -1115,8 +1099,6 @@ DbgLv(2) << "LAsc: istep" << istep;
          if ( stopFlag )  break;
       }
 
-      delete [] u1p0;
-
       if ( kt >= nts )
          break;   // if all scans updated, we are done
 
@@ -1125,12 +1107,12 @@ DbgLv(2) << "LAsc: istep" << istep;
       // switch x,u arrays for next iteration
       N0    = N1;
       N0u   = N1u;
-      dtmp  = x0;
-      x0    = x1;
-      x1    = dtmp;
-      dtmp  = u0;
-      u0    = u1;
-      u1    = dtmp;
+      wk_x0.swap( wk_x1 );
+      wk_u0.swap( wk_u1 );
+      x0    = wk_x0.data();
+      x1    = wk_x1.data();
+      u0    = wk_u0.data();
+      u1    = wk_u1.data();
    }
 
    if ( dbg_level > 0 )
@@ -1169,12 +1151,7 @@ DbgLv(2) << "LAsc: istep" << istep;
       DbgLv(2) << "  Integral Min Max Mean" << cimn << cimx << ciav;
       DbgLv(2) << "  ( range of" << cidf << "=" << cidp << " percent of mean )";
    }
-    
-   delete [] x0;  // clean up
-   delete [] u0;
-   delete [] x1;
-   delete [] u1;
-   delete msh;
+
 ktime6+=timer.elapsed();
 DbgLv(2) << "compx" << comp_x << "times 1-6"
  << ktime1 << ktime2 << ktime3 << ktime4 << ktime5 << ktime6;
@@ -1267,8 +1244,8 @@ void US_LammAstfvm::LammStepSedDiff_C( double t, double dt, int M0,
    double *x0, double *u0, int M1, double *x1, double *u1p, double *u1 )
 {
    int     Ng        = 2 * M1;     // number of x_star points
-   int*    ke        = new int    [ Ng ];
-   double* MemDouble = new double [ 12 * Ng + 15 ];
+   int*    ke        = grow_buffer( wk_ke,  Ng );
+   double* MemDouble = grow_buffer( wk_mem, 12 * Ng + 15 );
    double* flux_p[ 3 ];
 
    double  dt2     = dt * 0.5;
@@ -1404,7 +1381,7 @@ ktim4+=timer.restart();
    // calculate Flux(u0,t) at all xg0
    // (i) Compute ux at nodes as average of Du from left and right
 
-   double* ux = new double [ M0 + 1 ];     // D_x(u0) at all x0
+   double* ux = grow_buffer( wk_ux, M0 + 1 );  // D_x(u0) at all x0
 
    for ( int j = 1; j < M0; j++ )         // internal nodes
    {
@@ -1441,15 +1418,14 @@ ktim4+=timer.restart();
       }
    }
 
-   delete [] ux;
-
    //
    // assemble the linear system of equations
    //
-   double** Mtx = new double* [ Ng + 1 ];
-   double*  rhs = new double  [ Ng + 1 ];
+   double** Mtx = grow_buffer( wk_mtxp, Ng + 1 );
+   double*  rhs = grow_buffer( wk_rhs,  Ng + 1 );
+   double*  mtx = grow_buffer( wk_mtx,  ( Ng + 1 ) * 5 );
    for ( int i = 0; i <= Ng; i++ )
-      Mtx[ i ] = new double [ 5 ];
+      Mtx[ i ] = mtx + i * 5;
 
 ktim5+=timer.restart();
    // Assemble the coefficient matrix
@@ -1515,15 +1491,6 @@ ktim7+=timer.restart();
    LsSolver53( Ng, Mtx, rhs, u1 );
 ktim8+=timer.restart();
 
-   for ( int i = 0; i <= Ng; i++ )
-      delete [] Mtx[ i ];
-
-   delete [] Mtx;
-   delete [] rhs;
-
-
-   delete [] ke;
-   delete [] MemDouble;
 DbgLv(2) << " Diff_C times 1-8" << ktim1 << ktim2 << ktim3 << ktim4
    << ktim5 << ktim6 << ktim7 << ktim8;
 }
@@ -1832,8 +1799,8 @@ void US_LammAstfvm::ProjectQ( int M0, double *x0, double *u0,
    double  intgrl;
    double  phi[ 3 ];
 
-   int*    ke  = new int    [ M1 + 1 ];
-   double* xi  = new double [ M1 + 1 ];
+   int*    ke  = grow_buffer( wk_pke, M1 + 1 );
+   double* xi  = grow_buffer( wk_pxi, M1 + 1 );
 
    LocateStar( M0 + 1, x0, M1 + 1, x1, ke, xi );
 
@@ -1857,9 +1824,6 @@ void US_LammAstfvm::ProjectQ( int M0, double *x0, double *u0,
       u1[ j2 + 1 ] =  1.5  * intgrl / ( x1[ j + 1 ] - x1[ j ] )
                     - 0.25 * ( u1[ j2 ] + u1[ j2 + 2 ] );
    }
-
-   delete [] ke;
-   delete [] xi;
 }
 
 
@@ -37,6 +37,13 @@ class US_UTIL_EXTERN US_LammAstfvm : public QObject
             //! \brief Destroy mesh
             ~Mesh();
 
+            //! \brief Reset mesh, reusing its buffers
+            //! \param xl    Left X (radius) value
+            //! \param xr    Right X (radius) value
+            //! \param Nelem Number of elements
+            //! \param Opt   Mesh option (0 for uniform)
+            void Reset( double, double, int, int );
+
             //! \brief Initialize mesh
             //! \param s  Sedimentation coefficient
             //! \param D  Diffusion coefficient
@@ -66,7 +73,16 @@ class US_UTIL_EXTERN US_LammAstfvm : public QObject
             double* MeshDen;  // desired mesh density
             int*    Mark;     // ref/unref marker
 
+            QVector< double > xv;        // buffers behind the arrays above,
+            QVector< int >    Eidv;      //  with capacity kept across
+            QVector< int >    RefLevv;   //  mesh adaptations
+            QVector< double > MeshDenv;
+            QVector< int >    Markv;
+            QVector< double > D2v;       // 2nd derivatives work buffer
+            QVector< double > D3v;       // 3rd derivatives work buffer
+
             // private functions
+            void Resize( int );
             void ComputeMeshDen_D3( double*, double* );
             void Smoothing( int, double*, double, int );
             void Unrefine(  double );
@@ -233,6 +249,22 @@ class US_UTIL_EXTERN US_LammAstfvm : public QObject
       double  d_coeff[ 6 ];    // SD Adjust buffer density coefficients
       double  v_coeff[ 6 ];    // SD Adjust buffer viscosity coefficients
 
+      // work buffers reused across time steps and components
+      QVector< double >  wk_x0;    // grid at time t
+      QVector< double >  wk_x1;    // grid at time t+dt
+      QVector< double >  wk_u0;    // solution at time t
+      QVector< double >  wk_u1;    // solution at time t+dt
+      QVector< double >  wk_u1p0;  // predicted solution on grid x0
+      QVector< double >  wk_u1p;   // predicted solution on grid x1
+      QVector< int >     wk_ke;    // LammStepSedDiff_C element indexes
+      QVector< double >  wk_mem;   // LammStepSedDiff_C point arrays
+      QVector< double >  wk_ux;    // LammStepSedDiff_C node derivatives
+      QVector< double >  wk_mtx;   // LammStepSedDiff_C matrix rows
+      QVector< double* > wk_mtxp;  // LammStepSedDiff_C row pointers
+      QVector< double >  wk_rhs;   // LammStepSedDiff_C right hand side
+      QVector< int >     wk_pke;   // ProjectQ element indexes
+      QVector< double >  wk_pxi;   // ProjectQ xi coordinates
+
       // private functions
 
       //! \brief Get the non-ideal case number from model parameters
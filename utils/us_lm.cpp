@@ -32,6 +32,7 @@
 #include <math.h>
 #include <float.h>
 #include "us_lm.h"
+#include "us_parallel.h"
 
 // 
 //US_LM::US_LM()
@@ -64,8 +65,6 @@
    */
 
 
-   double (*lm_use_norm) ( int n, const double *x );
-
    //*************************************************************************/
    //  set message texts (indexed by status.info)
    //*************************************************************************/
@@ -102,7 +101,7 @@
 
 US_LM::LM_Control::LM_Control( double ftol, double xtol, double gtol,
       double epsilon, double stepbound, int maxcall, int scale_diag,
-      int printflags )
+      int printflags, double (*norm)( int, const double* ) )
 {
    this->ftol       = ftol;
    this->xtol       = xtol;
@@ -112,6 +111,7 @@ US_LM::LM_Control::LM_Control( double ftol, double xtol, double gtol,
    this->maxcall    = maxcall;
    this->scale_diag = scale_diag;
    this->printflags = printflags;
+   this->norm       = norm;
 }
 
 US_LM::LM_Status::LM_Status( double fnorm, int nfev, int info )
@@ -129,6 +129,39 @@ US_LM::LM_CurveData::LM_CurveData( double* t, double* y,
    this->f          = f;
 }
 
+US_LM::LM_CurveDataC::LM_CurveDataC( double* t, double* y,
+      double(*f)( double, double*, void* ), void* fdata )
+{
+   this->t          = t;
+   this->y          = y;
+   this->f          = f;
+   this->fdata      = fdata;
+}
+
+// Range task that evaluates forward-difference Jacobian columns. Each
+//  column has its own perturbed parameter vector and function values.
+class US_LmJacobianTask : public US_RangeTask
+{
+   public:
+      int         m;          // Number of functions
+      int         n;          // Number of parameters
+      double*     jpar;       // Perturbed parameter vectors (n by n)
+      double*     fjac;       // Function values for each column (m by n)
+      int*        jinfo;      // Evaluate info for each column
+      const void* data;       // Evaluate data
+      void (*evaluate) ( double *par, int m_dat, const void *data,
+                         double *fvec, int *info );
+
+      void run_range( int begin, int end, int )
+      {
+         for ( int jj = begin; jj < end; jj++ )
+         {
+            jinfo[ jj ] = 0;
+            (*evaluate)( jpar + jj * n, m, data, fjac + jj * m, jinfo + jj );
+         }
+      }
+};
+
 QString US_LM::lm_statmsg( US_LM::LM_Status *status, bool longmsg )
 {
    QString statmsg = longmsg
@@ -174,7 +207,7 @@ QString US_LM::lm_statmsg( US_LM::LM_Status *status, bool longmsg )
             printf("  par: ");
             for (i = 0; i < n_par; ++i)
                printf(" %18.11g", par[i]);
-            printf(" => norm: %18.11g", (*lm_use_norm)(m_dat, fvec));
+            printf(" => norm: %18.11g", lm_enorm(m_dat, fvec));
          }
 
          if( printflags & 3 )
@@ -198,7 +231,8 @@ QString US_LM::lm_statmsg( US_LM::LM_Status *status, bool longmsg )
                const LM_Control *control, LM_Status *status,
                void (*printout) (int n_par, double *par, int m_dat,
                                  const void *data, const double *fvec,
-                                 int printflags, int iflag, int iter, int nfev) )
+                                 int printflags, int iflag, int iter, int nfev),
+               int nthreads )
       {
 
          /*** allocate work space. ***/
@@ -246,6 +280,10 @@ QString US_LM::lm_statmsg( US_LM::LM_Status *status, bool longmsg )
             for( j=0; j<n_par; ++j )
                diag[j] = 1;
 
+         /* the norm is chosen per call, so concurrent fits may differ */
+         double (*lm_use_norm) ( int n, const double *x ) =
+            ( control->norm != NULL ) ? control->norm : lm_enorm;
+
          /*** perform fit. ***/
 
          status->info = 0;
@@ -256,7 +294,8 @@ QString US_LM::lm_statmsg( US_LM::LM_Status *status, bool longmsg )
                    ( control->scale_diag ? 1 : 2 ),
                    control->stepbound, &(status->info),
                    &(status->nfev), fjac, ipvt, qtf, wa1, wa2, wa3, wa4,
-                   evaluate, printout, control->printflags, data );
+                   evaluate, printout, control->printflags, data, nthreads,
+                   lm_use_norm );
 
          if ( printout )
             (*printout)( n, par, m, data, fvec,
@@ -296,7 +335,8 @@ QString US_LM::lm_statmsg( US_LM::LM_Status *status, bool longmsg )
                   void (*printout) (int n_par, double *par, int m_dat,
                                     const void *data, const double *fvec,
                                     int printflags, int iflag, int iter, int nfev),
-                  int printflags, const void *data )
+                  int printflags, const void *data, int nthreads,
+                  double (*lm_use_norm) ( int n, const double *x ) )
       {
          /*
           *   The purpose of lmdif is to minimize the sum of the squares of
@@ -448,6 +488,11 @@ QString US_LM::lm_statmsg( US_LM::LM_Status *status, bool longmsg )
           *      data is an input pointer to an arbitrary structure that is passed to
           *        evaluate. Typically, it contains experimental data to be fitted.
           *
+          *      nthreads is the number of threads on which the n evaluations of
+          *        a Jacobian are done concurrently (1 for serial, 0 for the
+          *        default count). With more than one, evaluate must be safe to
+          *        call from several threads at once.
+          *
           */
          int i, iter, j;
          double actred, delta, dirder, eps, fnorm, fnorm1, gnorm, par, pnorm,
@@ -463,6 +508,25 @@ QString US_LM::lm_statmsg( US_LM::LM_Status *status, bool longmsg )
          temp = MAX(epsfcn, LM_MACHEP);
          eps = sqrt(temp); /* for calculating the Jacobian by forward differences */
 
+         /* work space for a Jacobian evaluated in parallel */
+         bool par_jac = ( n > 1  &&  US_Parallel::threads( nthreads ) > 1 );
+         QVector< double > v_jpar;
+         QVector< double > v_jstep;
+         QVector< int    > v_jinfo;
+         US_LmJacobianTask jtask;
+         if ( par_jac ) {
+            v_jpar .resize( n * n );
+            v_jstep.resize( n );
+            v_jinfo.resize( n );
+            jtask.m        = m;
+            jtask.n        = n;
+            jtask.jpar     = v_jpar .data();
+            jtask.fjac     = fjac;
+            jtask.jinfo    = v_jinfo.data();
+            jtask.data     = data;
+            jtask.evaluate = evaluate;
+         }
+
          /*** lmdif: check input parameters for errors. ***/
 
          if ((n <= 0) || (m < n) || (ftol < 0.)
@@ -507,20 +571,48 @@ QString US_LM::lm_statmsg( US_LM::LM_Status *status, bool longmsg )
 
             /*** outer: calculate the Jacobian. ***/
 
-            for (j = 0; j < n; j++) {
-               temp = x[j];
-               step = MAX(eps*eps, eps * fabs(temp));
-               x[j] = temp + step; /* replace temporarily */
-               *info = 0;
-               (*evaluate) (x, m, data, wa4, info);
-               ++(*nfev);
-               if( printout )
-                  (*printout) (n, x, m, data, wa4, printflags, 1, iter, *nfev);
-               if (*info < 0)
-                  return; /* user requested break */
-               for (i = 0; i < m; i++)
-                  fjac[j*m+i] = (wa4[i] - fvec[i]) / step;
-               x[j] = temp; /* restore */
+            if (par_jac) {
+               /* evaluate all the perturbed parameter vectors at once */
+               double *jpar  = v_jpar .data();
+               double *jstep = v_jstep.data();
+               for (j = 0; j < n; j++) {
+                  for (i = 0; i < n; i++)
+                     jpar[j*n+i] = x[i];
+                  temp = x[j];
+                  jstep[j] = MAX(eps*eps, eps * fabs(temp));
+                  jpar[j*n+j] = temp + jstep[j];
+               }
+
+               US_Parallel::run( &jtask, n, nthreads );
+
+               for (j = 0; j < n; j++) {
+                  ++(*nfev);
+                  if( printout )
+                     (*printout) (n, &jpar[j*n], m, data, &fjac[j*m],
+                                  printflags, 1, iter, *nfev);
+                  if (v_jinfo[j] < 0) {
+                     *info = v_jinfo[j];
+                     return; /* user requested break */
+                  }
+                  for (i = 0; i < m; i++)
+                     fjac[j*m+i] = (fjac[j*m+i] - fvec[i]) / jstep[j];
+               }
+            } else {
+               for (j = 0; j < n; j++) {
+                  temp = x[j];
+                  step = MAX(eps*eps, eps * fabs(temp));
+                  x[j] = temp + step; /* replace temporarily */
+                  *info = 0;
+                  (*evaluate) (x, m, data, wa4, info);
+                  ++(*nfev);
+                  if( printout )
+                     (*printout) (n, x, m, data, wa4, printflags, 1, iter, *nfev);
+                  if (*info < 0)
+                     return; /* user requested break */
+                  for (i = 0; i < m; i++)
+                     fjac[j*m+i] = (wa4[i] - fvec[i]) / step;
+                  x[j] = temp; /* restore */
+               }
             }
 #ifdef LMFIT_DEBUG_MATRIX
             /* print the entire matrix */
@@ -606,7 +698,7 @@ QString US_LM::lm_statmsg( US_LM::LM_Status *status, bool longmsg )
                /*** inner: determine the levenberg-marquardt parameter. ***/
 
                lm_lmpar( n, fjac, m, ipvt, diag, qtf, delta, &par,
-                         wa1, wa2, wa4, wa3 );
+                         wa1, wa2, wa4, wa3, lm_use_norm );
                /* used return values are fjac (partly), par, wa1=x, wa3=diag*x */
 
                for (j = 0; j < n; j++)
@@ -754,7 +846,8 @@ QString US_LM::lm_statmsg( US_LM::LM_Status *status, bool longmsg )
 
    void US_LM::lm_lmpar(int n, double *r, int ldr, int *ipvt, double *diag,
                  double *qtb, double delta, double *par, double *x,
-                 double *sdiag, double *aux, double *xdi)
+                 double *sdiag, double *aux, double *xdi,
+                 double (*lm_use_norm) ( int n, const double *x ))
       {
          /*     Given an m by n matrix a, an n by n nonsingular diagonal
           *     matrix d, an m-vector b, and a positive number delta,
@@ -1400,9 +1493,10 @@ QString US_LM::lm_statmsg( US_LM::LM_Status *status, bool longmsg )
                      const LM_Control *control, LM_Status *status )
    {
       LM_CurveData data( (double*)t, (double*)y, f );
-      lm_use_norm = lm_enorm;
+      LM_Control   lcontrol = *control;
+      lcontrol.norm         = lm_enorm;
       lmmin( n_par, par, m_dat, (const void*) &data,
-             lmcurve_evaluate, control, status, lm_printout_std );
+             lmcurve_evaluate, &lcontrol, status, lm_printout_std );
    }
 
    void US_LM::lmcurve_fit_rmsd( int n_par, double *par, int m_dat, 
@@ -1412,10 +1506,36 @@ QString US_LM::lm_statmsg( US_LM::LM_Status *status, bool longmsg )
                           )
    {
       LM_CurveData data( (double*)t, (double*)y, f );
-      lm_use_norm = lm_rmsdnorm;
+      LM_Control   lcontrol = *control;
+      lcontrol.norm         = lm_rmsdnorm;
+
+      lmmin( n_par, par, m_dat, (const void*) &data,
+             lmcurve_evaluate, &lcontrol, status, lm_printout_std );
+   }
+
+   void US_LM::lmcurve_evaluate_c( double *par, int m_dat, const void *data,
+                                   double *fvec, int * /* info */ )
+   {
+      const LM_CurveDataC* cdata = (const LM_CurveDataC*)data;
+
+      for ( int i = 0; i < m_dat; i++ )
+         fvec[i] = cdata->y[i] - cdata->f( cdata->t[i], par, cdata->fdata );
+   }
+
+   // Reentrant curve fit:  all state is in the data passed to lmmin, and
+   //  the norm is the one given in the control.
+   void US_LM::lmcurve_fit_c( int n_par, double *par, int m_dat,
+                              const double *t, const double *y,
+                              double (*f)( double t, double *par,
+                                           void *fdata ),
+                              void *fdata, const LM_Control *control,
+                              LM_Status *status, int nthreads )
+   {
+      LM_CurveDataC data( (double*)t, (double*)y, f, fdata );
 
       lmmin( n_par, par, m_dat, (const void*) &data,
-             lmcurve_evaluate, control, status, lm_printout_std );
+             lmcurve_evaluate_c, control, status, lm_printout_std,
+             nthreads );
    }
 
 
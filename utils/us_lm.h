@@ -40,11 +40,14 @@ class US_UTIL_EXTERN US_LM
             int maxcall;      //!< maximum number of iterations.
             int scale_diag;   //!< TESTWISE automatic diag rescaling?
             int printflags;   //!< OR'ed to produce more noise
+            //! norm of residue and step vectors (NULL for lm_enorm)
+            double (*norm)( int, const double* );
 
             //! Constructor for LM_Control class
             LM_Control( double = LM_USRTOL, double = LM_USRTOL,
                         double = LM_USRTOL, double = LM_USRTOL,
-                        double = 100.0, int = 100, int = 1, int = 0 );
+                        double = 100.0, int = 100, int = 1, int = 0,
+                        double (*)( int, const double* ) = 0 );
       };
 
       //! Collection of output status parameters from LM computations.
@@ -72,6 +75,20 @@ class US_UTIL_EXTERN US_LM
                           double(*)( double, double* ) );
       };
 
+      //! Collection of LM Curve data, with a context passed to the function
+      class US_UTIL_EXTERN LM_CurveDataC
+      {
+         public:
+            double* t;                                //!< test value array
+            double* y;                                //!< Y value array
+            double (*f)( double , double*, void* );   //!< Function for eval.
+            void*   fdata;                            //!< Function context
+
+            //! Constructor for LM_CurveDataC class
+            LM_CurveDataC( double*, double*,
+                           double(*)( double, double*, void* ), void* );
+      };
+
       //! Recommended control parameter settings.
       const LM_Control lm_control_double;  //!< controls in double format
       const LM_Control lm_control_float;   //!< controls in float format
@@ -92,13 +109,17 @@ class US_UTIL_EXTERN US_LM
       static double lm_enorm( int, const double * );
 
       //! The actual minimization. */
+      //! With nthreads other than 1, the Jacobian columns are evaluated
+      //!  concurrently (0 for the default thread count), so evaluate must
+      //!  then be safe to call from several threads at once.
       static void lmmin( int n_par, double *par, int m_dat, const void *data, 
                          void (*evaluate) (double *par, int m_dat,
                          const void *data, double *fvec, int *info ),
                          const LM_Control* control, LM_Status* status,
                          void (*printout) (int n_par, double *par,
                            int m_dat, const void *data, const double *fvec,
-                           int printflags, int iflag, int iter, int nfev ) );
+                           int printflags, int iflag, int iter, int nfev ),
+                         int nthreads = 1 );
 
 
       /** Legacy low-level interface. **/
@@ -115,7 +136,10 @@ class US_UTIL_EXTERN US_LM
                             void (*printout) ( int n_par, double *par,
                                int m_dat, const void *data, const double *fvec,
                                int printflags, int iflag, int iter, int nfev ),
-                            int printflags, const void *data );
+                            int printflags, const void *data,
+                            int nthreads = 1,
+                            double (*lm_use_norm) ( int n, const double *x )
+                               = lm_enorm );
 
 //      extern const char *lm_infmsg[];
 //      extern const char *lm_shortmsg[];
@@ -139,13 +163,29 @@ class US_UTIL_EXTERN US_LM
                                     const LM_Control* control,
                                     LM_Status*  status );
 
+      //! Evaluate functions, passing a context to the curve function
+      static void lmcurve_evaluate_c( double *par, int m_dat,
+                                      const void *data,
+                                      double *fvec, int * /* info */ );
+
+      //! Reentrant LM Curve Fit, with a context passed to the curve
+      //!  function and a Jacobian evaluated on nthreads threads
+      //!  (0 for the default thread count). The norm is control->norm.
+      static void lmcurve_fit_c( int n_par, double *par, int m_dat,
+                                 const double *t, const double *y,
+                                 double (*f)( double t, double *par,
+                                              void *fdata ),
+                                 void *fdata, const LM_Control* control,
+                                 LM_Status* status, int nthreads = 0 );
+
    //*************************************************************************/
    //  lm_lmdif (low-level, modified legacy interface for full control)
    //*************************************************************************/
 
    static void lm_lmpar( int n, double *r, int ldr, int *ipvt, double *diag,
                   double *qtb, double delta, double *par, double *x,
-                  double *sdiag, double *aux, double *xdi );
+                  double *sdiag, double *aux, double *xdi,
+                  double (*lm_use_norm) ( int n, const double *x ) );
    static void lm_qrfac( int m, int n, double *a, int pivot, int *ipvt,
                   double *rdiag, double *acnorm, double *wa );
    static void lm_qrsolv( int n, double *r, int ldr, int *ipvt, double *diag,
@@ -10,6 +10,8 @@
 #include "us_constants.h"
 #include "us_dataIO.h"
 #include "us_matrix.h"
+#include "us_parallel.h"
+#include "us_profiler.h"
 #include "us_settings.h"
 
 #ifdef _BF_NNLS_
@@ -806,6 +808,7 @@ int US_Math2::nnls( double* a, int a_dim1, int m, int n,
                     int*    indexp 
                   ) 
 {
+   US_PROF_SCOPE( "math.nnls" );
 #ifdef _BF_NNLS_
    /* If there is an external NNLS algorithm implementation, execute it */
    qDebug() << "BF-NNLS: NNLS size (m, n) = (" << m << ", " << n << ")";
@@ -1136,6 +1139,170 @@ int US_Math2::nnls( double* a, int a_dim1, int m, int n,
    return ret;
 }
 
+// Range task that solves a block of NNLS problems sharing one A matrix.
+//  Each B is first solved by the QR factors of A; only when that
+//  unconstrained solution has negative values is a full NNLS done.
+class US_NnlsBatchTask : public US_RangeTask
+{
+   public:
+      const double* a;        // A matrix (m by n, column major)
+      const double* qr;       // Householder vectors and R (m by n)
+      const double* rdiag;    // Diagonal of R
+      const double* b;        // B vectors (m per problem)
+      double*       x;        // X vectors (n per problem)
+      int           m;        // Rows of A
+      int           n;        // Columns of A
+      bool          fast;     // Flag:  QR solutions are usable
+      QAtomicInt    nfull;    // Count of full NNLS solutions
+
+      void run_range( int begin, int end, int )
+      {
+         QVector< double > wa( m * n );    // Work vectors for the block
+         QVector< double > wb( m );
+         QVector< double > ww( n );
+         QVector< double > wz( m );
+         QVector< int    > wi( n );
+         int kfull    = 0;
+
+         for ( int pp = begin; pp < end; pp++ )
+         {
+            const double* bp = b + (qint64)pp * m;
+            double*       xp = x + (qint64)pp * n;
+
+            if ( fast  &&  solve_qr( bp, wb.data(), xp ) )
+               continue;
+
+            // Otherwise, solve with non-negativity constraints
+            memcpy( wa.data(), a,  m * n * sizeof( double ) );
+            memcpy( wb.data(), bp, m * sizeof( double ) );
+            US_Math2::nnls( wa.data(), m, m, n, wb.data(), xp, NULL,
+                            ww.data(), wz.data(), wi.data() );
+            kfull++;
+         }
+
+         nfull.fetchAndAddOrdered( kfull );
+      }
+
+   private:
+      // Solve R*X = Q'*B; return whether all of X is non-negative
+      bool solve_qr( const double* bp, double* qb, double* xp )
+      {
+         memcpy( qb, bp, m * sizeof( double ) );
+
+         for ( int kk = 0; kk < n; kk++ )
+         {  // Apply each Householder reflection to B
+            const double* vk = qr + kk * m;
+            double        sm = 0.0;
+
+            for ( int ii = kk; ii < m; ii++ )
+               sm          += vk[ ii ] * qb[ ii ];
+
+            double tt    = -sm / vk[ kk ];
+
+            for ( int ii = kk; ii < m; ii++ )
+               qb[ ii ]    += tt * vk[ ii ];
+         }
+
+         for ( int kk = n - 1; kk >= 0; kk-- )
+         {  // Back-substitute through the upper triangle
+            double sm    = qb[ kk ];
+
+            for ( int jj = kk + 1; jj < n; jj++ )
+               sm          -= qr[ jj * m + kk ] * xp[ jj ];
+
+            xp[ kk ]     = sm / rdiag[ kk ];
+
+            if ( xp[ kk ] < 0.0 )
+               return false;
+         }
+
+         return true;
+      }
+};
+
+// Solve many NNLS problems that share one A matrix
+int US_Math2::nnls_batch( const double* a, const int m, const int n,
+                          const int nrhs, const double* b, double* x,
+                          const int nthreads )
+{
+   US_PROF_SCOPE( "math.nnls_batch" );
+   if ( m <= 0  ||  n <= 0  ||  nrhs <= 0  ||  a == NULL  ||  b == NULL  ||
+        x == NULL )
+      return 0;
+
+   // Factor A once, as Householder vectors plus the upper triangle R
+   QVector< double > qr( m * n );
+   QVector< double > rdiag( n, 0.0 );
+   double* qa   = qr.data();
+   double  rmax = 0.0;
+   bool    fast = ( m >= n );
+   memcpy( qa, a, m * n * sizeof( double ) );
+
+   for ( int kk = 0; kk < n  &&  fast; kk++ )
+   {
+      double* vk   = qa + kk * m;
+      double  anrm = 0.0;
+
+      for ( int ii = kk; ii < m; ii++ )
+         anrm        += sq( vk[ ii ] );
+
+      anrm         = sqrt( anrm );
+
+      if ( anrm == 0.0 )
+      {  // A zero column:  A is rank deficient
+         fast         = false;
+         break;
+      }
+
+      anrm         = ( vk[ kk ] < 0.0 ) ? -anrm : anrm;
+
+      for ( int ii = kk; ii < m; ii++ )
+         vk[ ii ]    /= anrm;
+
+      vk[ kk ]    += 1.0;
+
+      for ( int jj = kk + 1; jj < n; jj++ )
+      {  // Apply the reflection to the remaining columns
+         double* vj   = qa + jj * m;
+         double  sm   = 0.0;
+
+         for ( int ii = kk; ii < m; ii++ )
+            sm          += vk[ ii ] * vj[ ii ];
+
+         double tt    = sm / vk[ kk ];
+
+         for ( int ii = kk; ii < m; ii++ )
+            vj[ ii ]    -= tt * vk[ ii ];
+      }
+
+      rdiag[ kk ]  = -anrm;
+      rmax         = qMax( rmax, qAbs( anrm ) );
+   }
+
+   for ( int kk = 0; kk < n  &&  fast; kk++ )
+   {  // Use QR solutions only if A has full column rank
+      if ( qAbs( rdiag[ kk ] ) <= ( rmax * 1.0e-12 ) )
+         fast         = false;
+   }
+
+   US_NnlsBatchTask task;
+   task.a       = a;
+   task.qr      = qa;
+   task.rdiag   = rdiag.data();
+   task.b       = b;
+   task.x       = x;
+   task.m       = m;
+   task.n       = n;
+   task.fast    = fast;
+   task.nfull   = 0;
+
+   US_Parallel::run( &task, nrhs, nthreads, 64 );
+
+   int nfull    = task.nfull;
+   US_PROF_COUNT( "math.nnls_batch_full", nfull );
+   return nfull;
+}
+
 /*****************************************************************************
  *
  *  Compute orthogonal rotation matrix:
@@ -262,6 +262,25 @@ class US_UTIL_EXTERN US_Math2
          int*    indexp = NULL
          );
 
+      //! \brief Solve many NNLS problems that share one A matrix.
+      //!
+      //! A is factored once by Householder QR. Each B is first solved
+      //! without constraints from the factors, and that solution is kept
+      //! if it has no negative values, as it is then also the NNLS one.
+      //! Any other B, or all B if A is rank deficient, is solved by nnls().
+      //! Blocks of B vectors are solved in parallel.
+      //! \param a        The m by n A matrix, column major (unchanged)
+      //! \param m        Rows of A (values in each B)
+      //! \param n        Columns of A (values in each X)
+      //! \param nrhs     Number of B vectors
+      //! \param b        The B vectors, m values each, end-to-end
+      //! \param x        On exit, the X vectors, n values each, end-to-end
+      //! \param nthreads Maximum threads to use (0 for default)
+      //! \return         Number of B vectors solved by full NNLS
+      static int nnls_batch( const double*, const int, const int,
+                             const int, const double*, double*,
+                             const int = 0 );
+
       /*! \brief Remove high frequency noise from a signal
           \param array   Data to be smoothed.  This array will be modified.
           \param smooth  Number of values to smooth to be considered when 
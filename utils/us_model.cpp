@@ -1,6 +1,7 @@
 //! \file us_model.cpp
 
 #include "us_model.h"
+#include "us_model_mc.h"
 #include "us_constants.h"
 #include "us_settings.h"
 #include "us_util.h"
@@ -697,39 +698,7 @@ int US_Model::load_stream( QXmlStreamReader& xml )
          else if ( xml.name() == "analyte" )
          {
             SimulationComponent sc;
-            a = xml.attributes();
-
-            sc.analyteGUID  = a.value( "analyteGUID" ).toString();
-
-            sc.name         = a.value( "name"       ).toString();
-            QString avbar   = a.value( "vbar20"     ).toString();
-            sc.vbar20       = avbar.isEmpty() ? TYPICAL_VBAR : avbar.toDouble();
-            sc.mw           = a.value( "mw"         ).toString().toDouble();
-            sc.s            = a.value( "s"          ).toString().toDouble();
-            sc.D            = a.value( "D"          ).toString().toDouble();
-            sc.f            = a.value( "f"          ).toString().toDouble();
-            sc.f_f0         = a.value( "f_f0"       ).toString().toDouble();
-            sc.extinction   = a.value( "extinction" ).toString().toDouble();
-            QString aaxia   = a.value( "axial"      ).toString();
-            sc.axial_ratio  = aaxia.isEmpty() ? 10.0 : aaxia.toDouble();
-            sc.sigma        = a.value( "sigma"      ).toString().toDouble();
-            sc.delta        = a.value( "delta"      ).toString().toDouble();
-
-            sc.molar_concentration  = a.value( "molar"  ).toString().toDouble();
-            sc.signal_concentration = a.value( "signal" ).toString().toDouble();
-            sc.oligomer     = a.value( "oligomer"   ).toString().toInt();
-
-            if ( sc.oligomer < 1 )
-            {
-               sc.oligomer     = a.value( "stoich"     ).toString().toInt();
-               sc.oligomer     = ( sc.oligomer > 0 ) ? sc.oligomer : 1;
-            }
-
-            sc.shape        =
-                   (ShapeType)a.value( "shape"      ).toString().toInt();
-            sc.analyte_type = a.value( "type"       ).toString().toInt();
-
-            mfem_scans( xml, sc );
+            read_component( xml, sc );
 
             read_next = false; // Skip the next read
 
@@ -756,119 +725,15 @@ int US_Model::load_stream( QXmlStreamReader& xml )
 // Load from a multiple-model stream and create an MC composite model
 int US_Model::load_multi_model( QTextStream& tsi )
 {
-   int result    = US_DB2::OK;
-   QString mline, mdesc, mcont;
-   nmcixs        = 0;
-   mcixmls.clear();
-
-   // Read and save the first three XML lines
-   QString line1 = tsi.readLine() + "\n";
-   QString line2 = tsi.readLine() + "\n";
-   QString line3 = tsi.readLine() + "\n";
-
-   // Read remaining lines and save description,contents of all models
-   while ( ! tsi.atEnd() )
-   {
-      mline         = tsi.readLine();
-      if ( mline.contains( "</ModelData>" ) )
-         break;
+   // Read all iterations in one pass, then compose from their components
+   US_ModelMC mcmodel;
+   int result    = mcmodel.load_xml( tsi.readAll() );
 
-      if ( mline.contains( "<model " ) )
-      {  // At model tag, create initial contents
-         mcont         = line1 + line2 + line3 + mline + "\n";
-         // Parse description and save it, if first iteration
-         if ( nmcixs == 0 )
-         {
-            int idx       = qMax( mline.indexOf( "description=" ), 0 );
-            mdesc         = QString( mline ).mid( idx, 200 ).section( "\"", 1, 1 );
-         }
-      }
+   if ( result == US_DB2::OK )
+      result        = mcmodel.composite( *this );
 
-      else if ( mline.contains( "</model>" ) )
-      {  // At end of model section, save a model content and bump count
-         mcont         = mcont + mline + "\n</ModelData>\n";
-         mcixmls << mcont;
-         nmcixs++;
-      }
-
-      else
-      {  // For any other type of line, add it to contents;
-         mcont         = mcont + mline + "\n";
-      }
-   }
-
-   QVector< SimulationComponent >  mmcomps;
-   QVector< Association >          mmassos;
-   int ncnstv    = 0;
-   int ncnstk    = 0;
-
-   // Build composite components and associations
-   for ( int ii = 0; ii < nmcixs; ii++ )
-   {
-      mcont            = mcixmls[ ii ];
-      QXmlStreamReader xml( mcont );
-      load_stream( xml );
-
-      mmcomps << components;
-      mmassos << associations;
-
-      if ( constant_vbar() )  ncnstv++;
-      if ( constant_ff0()  )  ncnstk++;
-   }
-
-   // Compress and scale components to only unique solute points
-
-   components  .clear();
-   associations.clear();
-   double sclnrm = 1.0 / (double)nmcixs;    // Scale for concentrations
-   bool cnst_vb  = ( ncnstv >= ncnstk );    // Flag for constant vbar
-   QStringList sklist;                      // List of all solute points
-   QStringList skvals;                      // List of unique solute points
-
-   for ( int ii = 0; ii < mmcomps.size(); ii++ )
-   {  // Build list of solute point strings and list of unique ones
-      double sval   = mmcomps[ ii ].s * 1.0e+13;
-      double kval   = cnst_vb ? mmcomps[ ii ].f_f0 : mmcomps[ ii ].vbar20;
-      QString skval = QString().sprintf( "%10.4f %8.5f", sval, kval );
-      sklist << skval; 
-      if ( ! skvals.contains( skval ) )
-         skvals << skval;
-   }
-
-   int nskl      = sklist.size();
-   int nskv      = skvals.size();
-   skvals.sort();                     // Sort solute points
-   SimulationComponent scomp;
-
-   for ( int ii = 0; ii < nskv; ii ++ )
-   {  // Average concentration at each unique solute point
-      QString skval = skvals[ ii ];   // Identifying solute point string
-      double conc   = 0.0;
-
-      for ( int jj = 0; jj < nskl; jj++ )
-      {  // Search all solute points
-         if ( skval == sklist[ jj ] )
-         {  // If a match, sum the concentration
-            scomp      = mmcomps[ jj ];
-            conc      += scomp.signal_concentration;
-         }
-      }
-
-      scomp.name                 = QString().sprintf( "SC%04d", ii + 1 );
-      scomp.signal_concentration = conc * sclnrm;
-      components << scomp;
-   }
-
-   if ( mmassos.size() > 0 )
-      associations << mmassos[ 0 ];
-
-   QString mdsc1 = QString( mdesc ).section( ".",  0, -3 );
-   QString mdsc2 = QString( mdesc ).section( ".", -2, -2 )
-                                   .section( "_",  0, -2 );
-   QString mdsc3 = QString( mdesc ).section( ".", -1, -1 );
-   QString miter = QString().sprintf( "_mcN%03i", nmcixs );
-   description   = mdsc1 + "." + mdsc2 + miter + "." + mdsc3;
-qDebug() << "MDL:LMM: miter" << miter << "desc" << description << mdesc;
+   else
+      message       = mcmodel.message;
 
    return result;
 }
@@ -893,6 +758,45 @@ void US_Model::write_mm_stream( QTextStream& tso )
    }
 }
 
+// Parse a component from an XML stream positioned at an analyte element
+void US_Model::read_component( QXmlStreamReader& xml,
+                               SimulationComponent& sc )
+{
+   QXmlStreamAttributes a = xml.attributes();
+
+   sc.analyteGUID  = a.value( "analyteGUID" ).toString();
+
+   sc.name         = a.value( "name"       ).toString();
+   QString avbar   = a.value( "vbar20"     ).toString();
+   sc.vbar20       = avbar.isEmpty() ? TYPICAL_VBAR : avbar.toDouble();
+   sc.mw           = a.value( "mw"         ).toString().toDouble();
+   sc.s            = a.value( "s"          ).toString().toDouble();
+   sc.D            = a.value( "D"          ).toString().toDouble();
+   sc.f            = a.value( "f"          ).toString().toDouble();
+   sc.f_f0         = a.value( "f_f0"       ).toString().toDouble();
+   sc.extinction   = a.value( "extinction" ).toString().toDouble();
+   QString aaxia   = a.value( "axial"      ).toString();
+   sc.axial_ratio  = aaxia.isEmpty() ? 10.0 : aaxia.toDouble();
+   sc.sigma        = a.value( "sigma"      ).toString().toDouble();
+   sc.delta        = a.value( "delta"      ).toString().toDouble();
+
+   sc.molar_concentration  = a.value( "molar"  ).toString().toDouble();
+   sc.signal_concentration = a.value( "signal" ).toString().toDouble();
+   sc.oligomer     = a.value( "oligomer"   ).toString().toInt();
+
+   if ( sc.oligomer < 1 )
+   {
+      sc.oligomer     = a.value( "stoich"     ).toString().toInt();
+      sc.oligomer     = ( sc.oligomer > 0 ) ? sc.oligomer : 1;
+   }
+
+   sc.shape        =
+          (ShapeType)a.value( "shape"      ).toString().toInt();
+   sc.analyte_type = a.value( "type"       ).toString().toInt();
+
+   mfem_scans( xml, sc );
+}
+
 // Read scan C0 values from an XML stream
 void US_Model::mfem_scans( QXmlStreamReader& xml, SimulationComponent& sc )
 {
@@ -127,6 +127,12 @@ class US_UTIL_EXTERN US_Model
       //!               filled in by calculations.
       bool update_coefficients( void );
 
+      //! \brief Parse a component from an XML stream at an analyte element
+      //! \param xml   - XML stream positioned at an analyte start element;
+      //!                on return, it is positioned at the following element
+      //! \param sc    - Reference to the component to fill
+      static void read_component( QXmlStreamReader&, SimulationComponent& );
+
       //! \brief Calculate any missing coefficient values in an analyte component
       //! \returns    - Success if values already existed or were successfully
       //!               filled in by calculations.
@@ -263,7 +269,7 @@ class US_UTIL_EXTERN US_Model
       //! \brief Load a model from a local disk file
       int  load_disk       ( const QString& );
       //! \brief Parse and load an initial concentration vector
-      void mfem_scans      ( QXmlStreamReader&, SimulationComponent& );
+      static void mfem_scans( QXmlStreamReader&, SimulationComponent& );
       //! \brief Parse the associations part of a model XML
       void get_associations( QXmlStreamReader&, Association& );
                            
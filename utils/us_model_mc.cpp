@@ -0,0 +1,285 @@
+//! \file us_model_mc.cpp
+
+#include "us_model_mc.h"
+#include "us_settings.h"
+#include "us_profiler.h"
+
+// Flag whether component values in a range have a small spread
+static bool constant_range( const QVector< US_Model::SimulationComponent >&
+                            comps, const int cfirst, const int clast,
+                            const bool vbar, const double tolerance )
+{
+   if ( cfirst >= clast )
+      return true;
+
+   double valmin = vbar ? comps[ cfirst ].vbar20 : comps[ cfirst ].f_f0;
+   double valmax = valmin;
+
+   for ( int ii = cfirst + 1; ii < clast; ii++ )
+   {
+      double val    = vbar ? comps[ ii ].vbar20 : comps[ ii ].f_f0;
+      valmin        = qMin( valmin, val );
+      valmax        = qMax( valmax, val );
+   }
+
+   return ( ( valmax - valmin ) < tolerance );
+}
+
+// Constructor of the MC model container
+US_ModelMC::US_ModelMC()
+{
+   clear();
+}
+
+// Clear all contents
+void US_ModelMC::clear( void )
+{
+   components.clear();
+   xml_text  .clear();
+   comp_offs .clear();
+   text_offs .clear();
+   text_lens .clear();
+   head_len   = 0;
+   comp_offs << 0;
+   message    = "";
+}
+
+// Load from the text of a multi-model XML file
+int US_ModelMC::load_xml( const QString& xtext )
+{
+   US_PROF_SCOPE( "model.mc_load_xml" );
+   clear();
+   xml_text      = xtext;
+
+   // The first three lines are the header of each iteration's XML
+   int lnx       = 0;
+
+   for ( int ii = 0; ii < 3  &&  lnx >= 0; ii++ )
+   {
+      lnx           = xml_text.indexOf( "\n", lnx );
+      lnx           = ( lnx < 0 ) ? lnx : ( lnx + 1 );
+   }
+
+   if ( lnx < 0 )
+   {
+      message       = QObject::tr( "Incomplete multi-model XML header" );
+      return US_DB2::ERROR;
+   }
+
+   head_len      = lnx;
+
+   // Find the text span of each model, from its tag line to its end line
+   int mbeg      = -1;
+   int tlen      = xml_text.length();
+
+   while ( lnx < tlen )
+   {
+      int lnend     = xml_text.indexOf( "\n", lnx );
+      lnend         = ( lnend < 0 ) ? tlen : lnend;
+      QStringRef mline = xml_text.midRef( lnx, lnend - lnx );
+
+      if ( mline.contains( "</ModelData>" ) )
+         break;
+
+      if ( mline.contains( "<model " ) )
+         mbeg          = lnx;
+
+      else if ( mline.contains( "</model>" )  &&  mbeg >= 0 )
+      {
+         text_offs    << mbeg;
+         text_lens    << ( lnend - mbeg );
+         mbeg          = -1;
+      }
+
+      lnx           = lnend + 1;
+   }
+
+   // Read the components of all models in one pass
+   QXmlStreamReader xml( xml_text );
+   bool read_next = true;
+   int  nmodel    = 0;
+
+   while ( ! xml.atEnd() )
+   {
+      if ( read_next ) xml.readNext();
+      read_next     = true;
+
+      if ( ! xml.isStartElement() )
+         continue;
+
+      if ( xml.name() == "model" )
+      {  // Each model after the first ends the components of the previous
+         if ( nmodel++ > 0 )
+            comp_offs << components.size();
+      }
+
+      else if ( xml.name() == "analyte" )
+      {
+         US_Model::SimulationComponent sc;
+         US_Model::read_component( xml, sc );
+         components << sc;
+         read_next     = false;
+      }
+   }
+
+   if ( nmodel > 0 )
+      comp_offs << components.size();
+
+   if ( nmodel != text_offs.size() )
+   {
+      message       = QObject::tr( "Model count mismatch: %1 parsed, %2 found" )
+                      .arg( nmodel ).arg( text_offs.size() );
+      clear();
+      return US_DB2::ERROR;
+   }
+
+   US_PROF_COUNT( "model.mc_components", components.size() );
+   return ( nmodel > 0 ) ? US_DB2::OK : US_DB2::NO_MODEL;
+}
+
+// Load from a multi-model XML file
+int US_ModelMC::load( const QString& fpath )
+{
+   QFile file( fpath );
+
+   if ( ! file.open( QIODevice::ReadOnly | QIODevice::Text ) )
+   {
+      message       = QObject::tr( "Cannot open " ) + fpath;
+      return US_DB2::ERROR;
+   }
+
+   QTextStream tsi( &file );
+   int result    = load_xml( tsi.readAll() );
+   file.close();
+   return result;
+}
+
+// Get the complete model XML of an iteration
+QString US_ModelMC::iteration_xml( const int iter ) const
+{
+   return xml_text.left( head_len )
+        + xml_text.mid( text_offs[ iter ], text_lens[ iter ] )
+        + "\n</ModelData>\n";
+}
+
+// Load the complete model of an iteration
+int US_ModelMC::iteration_model( const int iter, US_Model& model ) const
+{
+   if ( iter < 0  ||  iter >= iterations() )
+      return US_DB2::NO_MODEL;
+
+   return model.load_string( iteration_xml( iter ) );
+}
+
+// Build the composite model of all iterations
+int US_ModelMC::composite( US_Model& model ) const
+{
+   US_PROF_SCOPE( "model.mc_composite" );
+   int niters    = iterations();
+
+   if ( niters < 1 )
+      return US_DB2::NO_MODEL;
+
+   // Model attributes are those of the last iteration; associations,
+   //  those of the first
+   int result    = iteration_model( niters - 1, model );
+
+   if ( result != US_DB2::OK )
+      return result;
+
+   QVector< US_Model::Association > assocs;
+
+   if ( iteration_xml( 0 ).contains( "<association" ) )
+   {
+      US_Model imodel;
+      iteration_model( 0, imodel );
+      assocs        = imodel.associations;
+   }
+
+   // Solute points have constant vbar if more iterations do than
+   //  have constant f/f0
+   int ncnstv    = 0;
+   int ncnstk    = 0;
+
+   for ( int ii = 0; ii < niters; ii++ )
+   {
+      int cfirst    = comp_offs[ ii ];
+      int clast     = comp_offs[ ii + 1 ];
+      if ( constant_range( components, cfirst, clast, true,  1.0e-4 ) )
+         ncnstv++;
+      if ( constant_range( components, cfirst, clast, false, 1.0e-3 ) )
+         ncnstk++;
+   }
+
+   bool cnst_vb  = ( ncnstv >= ncnstk );
+
+   // Sum concentrations at each unique solute point, matched by numeric
+   //  keys of s to 4 places (x 1.0e+13) and vbar or f/f0 to 5 places
+   typedef QPair< qint64, qint64 > SKey;
+   QHash< SKey, int >   ukeys;
+   QVector< SKey >      keys;
+   QVector< double >    concs;
+   QVector< int >       compxs;
+
+   for ( int ii = 0; ii < components.size(); ii++ )
+   {
+      const US_Model::SimulationComponent* sc = &components[ ii ];
+      double kval   = cnst_vb ? sc->f_f0 : sc->vbar20;
+      SKey   skey( qRound64( sc->s * 1.0e+17 ), qRound64( kval * 1.0e+5 ) );
+      int    ukx    = ukeys.value( skey, -1 );
+
+      if ( ukx < 0 )
+      {  // New solute point
+         ukx           = keys.size();
+         ukeys.insert( skey, ukx );
+         keys         << skey;
+         concs        << 0.0;
+         compxs       << ii;
+      }
+
+      concs [ ukx ] += sc->signal_concentration;
+      compxs[ ukx ]  = ii;      // Values are those of the last match
+   }
+
+   // Sort the solute points and build the composite components
+   QVector< QPair< SKey, int > > sorted;
+
+   for ( int ii = 0; ii < keys.size(); ii++ )
+      sorted << qMakePair( keys[ ii ], ii );
+
+   qSort( sorted );
+   double sclnrm = 1.0 / (double)niters;   // Scale for concentrations
+
+   model.components  .clear();
+   model.components  .reserve( sorted.size() );
+   model.associations = assocs;
+
+   for ( int ii = 0; ii < sorted.size(); ii++ )
+   {
+      int ukx       = sorted[ ii ].second;
+      US_Model::SimulationComponent scomp = components[ compxs[ ukx ] ];
+      scomp.name                 = QString().sprintf( "SC%04d", ii + 1 );
+      scomp.signal_concentration = concs[ ukx ] * sclnrm;
+      model.components << scomp;
+   }
+
+   // Keep the iteration contents and compose the MC description
+   model.monteCarlo   = true;
+   model.nmcixs       = niters;
+   model.mcixmls.clear();
+
+   for ( int ii = 0; ii < niters; ii++ )
+      model.mcixmls << iteration_xml( ii );
+
+   QString mline = xml_text.mid( text_offs[ 0 ], 400 );
+   int     idx   = qMax( mline.indexOf( "description=" ), 0 );
+   QString mdesc = QString( mline ).mid( idx, 200 ).section( "\"", 1, 1 );
+   QString mdsc1 = QString( mdesc ).section( ".",  0, -3 );
+   QString mdsc2 = QString( mdesc ).section( ".", -2, -2 )
+                                   .section( "_",  0, -2 );
+   QString mdsc3 = QString( mdesc ).section( ".", -1, -1 );
+   QString miter = QString().sprintf( "_mcN%03i", niters );
+   model.description  = mdsc1 + "." + mdsc2 + miter + "." + mdsc3;
+
+   return US_DB2::OK;
+}
@@ -0,0 +1,80 @@
+//! \file us_model_mc.h
+#ifndef US_MODEL_MC_H
+#define US_MODEL_MC_H
+
+#include <QtCore>
+#include "us_extern.h"
+#include "us_model.h"
+
+//! \brief Container of the iterations of a Monte Carlo composite model
+//!
+//! A multi-model MC file holds one complete model XML per iteration.
+//! This class reads such a file in a single streaming pass, storing the
+//! components of all iterations end-to-end in one contiguous vector and
+//! recording where the text of each iteration lies, so that the full
+//! model of an iteration is only parsed when it is asked for. Solute
+//! points are matched by numeric keys when building the composite.
+class US_UTIL_EXTERN US_ModelMC
+{
+   public:
+      //! \brief Constructor for the US_ModelMC class
+      US_ModelMC();
+
+      //! \brief Load from the text of a multi-model XML file
+      //! \param xtext  Multi-model XML text
+      //! \returns      The \ref US_DB2 return code for the operation
+      int  load_xml     ( const QString& );
+
+      //! \brief Load from a multi-model XML file
+      //! \param fpath  Full path to the file
+      //! \returns      The \ref US_DB2 return code for the operation
+      int  load         ( const QString& );
+
+      //! \brief Get the number of iterations
+      int  iterations   ( void ) const { return comp_offs.size() - 1; }
+
+      //! \brief Get the index of the first component of an iteration
+      //! \param iter   Iteration index
+      int  first_component( const int iter ) const
+      { return comp_offs[ iter ]; }
+
+      //! \brief Get the number of components of an iteration
+      //! \param iter   Iteration index
+      int  component_count( const int iter ) const
+      { return comp_offs[ iter + 1 ] - comp_offs[ iter ]; }
+
+      //! \brief Get the complete model XML of an iteration
+      //! \param iter   Iteration index
+      //! \returns      Model XML text of the iteration
+      QString iteration_xml ( const int ) const;
+
+      //! \brief Load the complete model of an iteration
+      //! \param iter   Iteration index
+      //! \param model  Reference to the model to load
+      //! \returns      The \ref US_DB2 return code for the operation
+      int  iteration_model  ( const int, US_Model& ) const;
+
+      //! \brief Build the composite model of all iterations
+      //!
+      //! The composite has one component for each distinct solute point,
+      //! with its concentration averaged over the iterations. Its other
+      //! values are those of the last iteration's model.
+      //! \param model  Reference to the model to build
+      //! \returns      The \ref US_DB2 return code for the operation
+      int  composite        ( US_Model& ) const;
+
+      //! Components of all iterations, end-to-end
+      QVector< US_Model::SimulationComponent > components;
+
+      QString message;  //!< Message of the last error
+
+   private:
+      QString      xml_text;    // Multi-model XML text
+      int          head_len;    // Length of text preceding the first model
+      QVector< int > comp_offs; // Component offsets of iterations, plus end
+      QVector< int > text_offs; // Text offsets of iterations
+      QVector< int > text_lens; // Text lengths of iterations
+
+      void clear       ( void );
+};
+#endif
@@ -0,0 +1,117 @@
+//! \file us_parallel.cpp
+#include "us_parallel.h"
+#include "us_settings.h"
+
+// Flag set for threads that are executing run() blocks
+static QThreadStorage< int* > worker_flag;
+
+// Pool runnable that takes blocks of a range until none remain
+class US_RangeRunner : public QRunnable
+{
+   public:
+      US_RangeRunner( US_RangeTask* a_task, QAtomicInt* a_next,
+                      QSemaphore* a_done, int a_count, int a_block,
+                      int a_thrx )
+         : task( a_task ), next( a_next ), done( a_done ),
+           count( a_count ), block( a_block ), thrx( a_thrx ) {}
+
+      void run()
+      {
+         bool nested = worker_flag.hasLocalData();
+
+         if ( ! nested )
+            worker_flag.setLocalData( new int( 1 ) );
+
+         int begin  = next->fetchAndAddOrdered( block );
+
+         while ( begin < count )
+         {
+            task->run_range( begin, qMin( begin + block, count ), thrx );
+            begin      = next->fetchAndAddOrdered( block );
+         }
+
+         if ( ! nested )
+            worker_flag.setLocalData( NULL );
+
+         if ( done != NULL )
+            done->release();
+      }
+
+   private:
+      US_RangeTask* task;
+      QAtomicInt*   next;
+      QSemaphore*   done;
+      int           count;
+      int           block;
+      int           thrx;
+};
+
+// Return the number of threads to use
+int US_Parallel::threads( int nthreads )
+{
+   if ( nthreads < 1 )
+   {
+#ifdef NO_DB
+      // MPI processes already occupy the cores:  default to serial
+      nthreads  = 1;
+#else
+      // A configured count is used as is; else the ideal thread count
+      nthreads  = US_Settings::threads_set() ? US_Settings::threads()
+                                             : QThread::idealThreadCount();
+#endif
+   }
+
+   return qMax( 1, nthreads );
+}
+
+// Run a range task, dividing its blocks over the calling and pool threads
+void US_Parallel::run( US_RangeTask* task, int count, int nthreads,
+      int grain )
+{
+   if ( count < 1 )
+      return;
+
+   grain      = qMax( 1, grain );
+   nthreads   = threads( nthreads );
+   nthreads   = qMin( nthreads, ( count + grain - 1 ) / grain );
+
+   if ( nthreads < 2  ||  in_worker() )
+   {  // Serial:  one block on this thread
+      task->run_range( 0, count, 0 );
+      return;
+   }
+
+   // Several blocks per thread, to balance uneven block costs
+   int        block    = qMax( grain, count / ( nthreads * 4 ) );
+   QAtomicInt next( 0 );
+   QSemaphore done( 0 );
+
+   for ( int thrx = 1; thrx < nthreads; thrx++ )
+   {
+      US_RangeRunner* runner = new US_RangeRunner( task, &next, &done,
+                                                   count, block, thrx );
+      runner->setAutoDelete( true );
+      QThreadPool::globalInstance()->start( runner );
+   }
+
+   // The calling thread works too, as slot 0
+   US_RangeRunner self( task, &next, NULL, count, block, 0 );
+   self.run();
+
+   // All blocks are now taken, so runners still queued have nothing left
+   //  to do but finish. The caller may itself be a pool thread (any
+   //  QRunnable), so give up its pool slot while waiting; otherwise a
+   //  saturated pool could never start the queued runners.
+   if ( ! done.tryAcquire( nthreads - 1 ) )
+   {
+      QThreadPool::globalInstance()->releaseThread();
+      done.acquire( nthreads - 1 );
+      QThreadPool::globalInstance()->reserveThread();
+   }
+}
+
+// Return whether the current thread is executing run() blocks
+bool US_Parallel::in_worker( void )
+{
+   return worker_flag.hasLocalData()  &&  worker_flag.localData() != NULL;
+}
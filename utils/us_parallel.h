@@ -0,0 +1,59 @@
+//! \file us_parallel.h
+#ifndef US_PARALLEL_H
+#define US_PARALLEL_H
+
+#include <QtCore>
+
+#include "us_extern.h"
+
+//! \brief A task whose work is divided over a range of indexes
+//!
+//! Derived classes implement run_range() to process one contiguous
+//! block of indexes. The thread slot index may be used to select
+//! per-thread work buffers, so no locking is needed inside a block.
+//!
+class US_UTIL_EXTERN US_RangeTask
+{
+   public:
+      virtual ~US_RangeTask() {}
+
+      //! \brief Process a block of indexes
+      //!
+      //! \param begin  First index of the block
+      //! \param end    One past the last index of the block
+      //! \param thrx   Thread slot index (0 to nthreads-1)
+      virtual void run_range( int, int, int ) = 0;
+};
+
+//! \brief Utilities for running range tasks on the global thread pool
+//!
+//! All methods are static. Blocks of a range are handed out dynamically
+//! to the calling thread and to pool threads, and run() returns when all
+//! blocks are done. A run() issued from inside a run() block executes
+//! serially on that thread. Any other caller, including a QRunnable on
+//! the global pool, releases its pool slot while it waits for the last
+//! blocks, so nested use never deadlocks a saturated pool.
+//!
+class US_UTIL_EXTERN US_Parallel
+{
+   public:
+      //! \brief Return the number of threads to use
+      //!
+      //! \param nthreads  Requested count; 0 for the US_Settings value
+      //!                  if one is set, else the ideal thread count
+      //!                  (always 1 in NO_DB builds).
+      //! \returns         Thread count, at least 1
+      static int  threads( int = 0 );
+
+      //! \brief Run a task over indexes 0 to count-1
+      //!
+      //! \param task      Task to run
+      //! \param count     Number of indexes in the range
+      //! \param nthreads  Maximum threads to use (0 for default)
+      //! \param grain     Minimum number of indexes in a block
+      static void run( US_RangeTask*, int, int = 0, int = 1 );
+
+      //! \brief Return whether the current thread is a run() worker
+      static bool in_worker( void );
+};
+#endif
@@ -0,0 +1,437 @@
+//! \file us_pcsa_lm.cpp
+
+#include "us_pcsa_lm.h"
+#include "us_parallel.h"
+#include "us_settings.h"
+#include "us_model.h"
+
+// Evaluation context of a single refinement
+class US_PcsaLMFit
+{
+   public:
+      US_PcsaLMFit( const US_PcsaLM* a_plm, const int a_npar )
+         : plm( a_plm ), ffcall( 0 ), npar( a_npar ), brmsd( 1e+99 )
+      {
+         bpar[ 0 ]     = 0.0;
+         bpar[ 1 ]     = 0.0;
+      }
+
+      const US_PcsaLM*         plm;        // Refinement settings
+      QMutex                   mutex;      // Lock for best-evaluation update
+      QAtomicInt               ffcall;     // Fit function call counter
+      int                      npar;       // Number of L-M parameters
+      double                   bpar[ 2 ];  // Parameters of best evaluation
+      double                   brmsd;      // RMSD of best evaluation
+      US_SolveSim::Simulation  bsim;       // Simulation of best evaluation
+      QVector< US_ZSolute >    bisols;     // Input solutes of best evaluation
+};
+
+// Thread that refines model records until none remain
+class US_PcsaLMThread : public QThread
+{
+   public:
+      US_PcsaLMThread( US_PcsaLM* a_plm, US_ModelRecord* a_mrecs,
+                       const US_LM::LM_Control* a_control,
+                       US_LM::LM_Status* a_stats, QAtomicInt* a_next,
+                       const int a_nrefs, const int a_nthreads )
+         : plm( a_plm ), mrecs( a_mrecs ), control( a_control ),
+           stats( a_stats ), next( a_next ), nrefs( a_nrefs ),
+           nthreads( a_nthreads ) {}
+
+      void run()
+      {
+         int jj     = next->fetchAndAddOrdered( 1 );
+
+         while ( jj < nrefs )
+         {
+            plm->refine( mrecs[ jj ], *control, stats[ jj ], nthreads );
+            jj         = next->fetchAndAddOrdered( 1 );
+         }
+      }
+
+   private:
+      US_PcsaLM*                plm;
+      US_ModelRecord*           mrecs;
+      const US_LM::LM_Control*  control;
+      US_LM::LM_Status*         stats;
+      QAtomicInt*               next;
+      int                       nrefs;
+      int                       nthreads;
+};
+
+// Constructor for the PCSA L-M refinement class
+US_PcsaLM::US_PcsaLM( QList< US_SolveSim::DataSet* >& a_dsets,
+      const int a_offset, const int a_dcount, const int a_ctype,
+      const int a_stype, const int a_nlpts )
+   : dsets( a_dsets ), offset( a_offset ), dcount( a_dcount ),
+   ctype( a_ctype ), stype( a_stype ), nlpts( a_nlpts )
+{
+   dbg_level   = US_Settings::us_debug();
+   int attr_x  = ( stype >> 6 ) & 7;
+   int attr_y  = ( stype >> 3 ) & 7;
+   xscl        = ( attr_x == US_ZSolute::ATTR_S ) ? 1.0e-13 : 1.0;
+   yscl        = ( attr_y == US_ZSolute::ATTR_S ) ? 1.0e-13 : 1.0;
+   noisflag    = 0;
+   alpha       = 0.0;
+   xmin        = 0.0;
+   xmax        = 0.0;
+   ymin        = 0.0;
+   ymax        = 0.0;
+   minyv       = -1e+99;
+   maxyv       =  1e+99;
+   minp1       = -1e+99;
+   maxp1       =  1e+99;
+   minp2       = -1e+99;
+   maxp2       =  1e+99;
+
+   set_options( 0, 0.0, 0.0 );
+}
+
+// Set the extents of the curves
+void US_PcsaLM::set_extents( const double a_xmin, const double a_xmax,
+      const double a_ymin, const double a_ymax )
+{
+   xmin        = a_xmin;
+   xmax        = a_xmax;
+   ymin        = a_ymin;
+   ymax        = a_ymax;
+}
+
+// Set the (elite) limits beyond which evaluations are rejected
+void US_PcsaLM::set_limits( const double a_minyv, const double a_maxyv,
+      const double a_minp1, const double a_maxp1, const double a_minp2,
+      const double a_maxp2 )
+{
+   minyv       = a_minyv;
+   maxyv       = a_maxyv;
+   minp1       = a_minp1;
+   maxp1       = a_maxp1;
+   minp2       = a_minp2;
+   maxp2       = a_maxp2;
+}
+
+// Set simulation options
+void US_PcsaLM::set_options( const int a_noisflag, const double a_alpha,
+      const double a_zval )
+{
+   noisflag    = a_noisflag;
+   alpha       = a_alpha;
+   zval        = a_zval;
+
+   if ( zval == 0.0 )
+   {  // Default z is the data set's z coefficient or its vbar
+      zval        = dsets[ offset ]->zcoeffs[ 0 ];
+      zval        = ( zval == 0.0 ) ? dsets[ offset ]->vbar20 : zval;
+   }
+}
+
+// Return the number of L-M parameters for the curve type
+int US_PcsaLM::npars( void ) const
+{
+   return ( ctype == CTYPE_HL ) ? 1 : 2;
+}
+
+// Compute the y values at the start and end of a curve
+void US_PcsaLM::curve_ends( const double* par, double& ystart,
+      double& yend ) const
+{
+   if ( ctype == CTYPE_IS  ||  ctype == CTYPE_DS )
+   {
+      double ystr   = ( ctype == CTYPE_IS ) ? ymin : ymax;
+      double ydif   = ( ctype == CTYPE_IS ) ? ( ymax - ymin ) : ( ymin - ymax );
+      double p1fac  = sqrt( 2.0 * qMax( par[ 0 ], minp1 ) );
+      ystart        = ystr + ydif * ( 0.5 * erf( ( 0.0 - par[ 1 ] ) / p1fac )
+                                      + 0.5 );
+      yend          = ystr + ydif * ( 0.5 * erf( ( 1.0 - par[ 1 ] ) / p1fac )
+                                      + 0.5 );
+   }
+
+   else if ( ctype == CTYPE_HL )
+   {
+      ystart        = par[ 0 ];
+      yend          = par[ 0 ];
+   }
+
+   else
+   {
+      ystart        = par[ 0 ];
+      yend          = par[ 0 ] + par[ 1 ] * ( xmax - xmin );
+   }
+}
+
+// Compute the input solutes of a curve
+void US_PcsaLM::curve_solutes( const double* par,
+      QVector< US_ZSolute >& zsols ) const
+{
+   double prng   = (double)( nlpts - 1 );
+   double xrng   = xmax - xmin;
+   US_ZSolute isol( 0.0, 0.0, zval, 0.0 );
+   zsols.clear();
+   zsols.reserve( nlpts );
+
+   if ( ctype == CTYPE_IS  ||  ctype == CTYPE_DS )
+   {  // Sigmoid curve
+      double ystr   = ( ctype == CTYPE_IS ) ? ymin : ymax;
+      double ydif   = ( ctype == CTYPE_IS ) ? ( ymax - ymin ) : ( ymin - ymax );
+      double p1fac  = sqrt( 2.0 * qMax( par[ 0 ], minp1 ) );
+      double xinc   = 1.0 / prng;
+      double xoff   = 0.0;
+
+      for ( int kk = 0; kk < nlpts; kk++ )
+      {
+         double efac   = 0.5 * erf( ( xoff - par[ 1 ] ) / p1fac ) + 0.5;
+         isol.x        = ( xmin + xoff * xrng ) * xscl;
+         isol.y        = ( ystr + ydif * efac ) * yscl;
+         zsols << isol;
+         xoff         += xinc;
+      }
+   }
+
+   else
+   {  // Straight or horizontal line
+      double ystart;
+      double yend;
+      curve_ends( par, ystart, yend );
+      double xinc   = xrng / prng;
+      double yinc   = ( yend - ystart ) / prng;
+      double xval   = xmin;
+      double yval   = ystart;
+
+      for ( int kk = 0; kk < nlpts; kk++ )
+      {
+         isol.x        = xval * xscl;
+         isol.y        = yval * yscl;
+         zsols << isol;
+         xval         += xinc;
+         yval         += yinc;
+      }
+   }
+}
+
+// Test whether curve parameters are within the limits (with a little
+//  wiggle room)
+bool US_PcsaLM::within_limits( const double* par ) const
+{
+   double ylow   = minyv - 0.1;
+   double yhigh  = maxyv + 0.1;
+   double par1   = par[ 0 ];
+   double par2   = par[ 1 ];
+   double ystart;
+   double yend;
+   curve_ends( par, ystart, yend );
+
+   if ( ctype == CTYPE_HL )
+   {
+      return ( par1 >= ( minp1 - 0.1 )  &&  par1 <= ( maxp1 + 0.1 )  &&
+               par1 >= ylow             &&  par1 <= yhigh );
+   }
+
+   bool   sigm   = ( ctype == CTYPE_IS  ||  ctype == CTYPE_DS );
+   double p1lo   = minp1 - ( sigm ? 0.00001 : 0.1  );
+   double p1hi   = maxp1 + ( sigm ? 0.00001 : 0.1  );
+   double p2lo   = minp2 - 0.01;
+   double p2hi   = maxp2 + ( sigm ? 0.01    : 0.02 );
+
+   return ( par1   >= p1lo  &&  par1   <= p1hi   &&
+            par2   >= p2lo  &&  par2   <= p2hi   &&
+            ystart >= ylow  &&  ystart <= yhigh  &&
+            yend   >= ylow  &&  yend   <= yhigh );
+}
+
+// Compute the simulation and residuals for given input solutes.
+//  Simulation writes to the simulation parameters of its data sets, so
+//  each evaluation works on its own copies of the fitted data sets (the
+//  experimental data vectors are implicitly shared, not deep-copied).
+double US_PcsaLM::evaluate( US_SolveSim::Simulation& sim_vals ) const
+{
+   QVector< US_SolveSim::DataSet > dset_wk( dcount );
+   QList< US_SolveSim::DataSet* >  wdsets = dsets;
+
+   for ( int ee = 0; ee < dcount; ee++ )
+   {  // Local copy of each fitted data set, in place of the shared one
+      dset_wk[ ee ]            = *( dsets[ offset + ee ] );
+      wdsets[ offset + ee ]    = &dset_wk[ ee ];
+   }
+
+   US_SolveSim solvesim( wdsets, 0, false );
+
+   solvesim.calc_residuals( offset, dcount, sim_vals );
+
+   return sqrt( sim_vals.variance );
+}
+
+// Curve-fit evaluate function (return RMSD). Each call builds and solves
+//  its own simulation, so calls for different parameters may be
+//  concurrent; only the best-evaluation update is locked.
+double US_PcsaLM::fit_function( double t, double* par, void* fdata )
+{
+   if ( t != 0.0 )
+   { // If not t[0], return immediately
+      return 0.0;
+   }
+
+   US_PcsaLMFit*    fit  = (US_PcsaLMFit*)fdata;
+   const US_PcsaLM* plm  = fit->plm;
+   int    dbg_level      = plm->dbg_level;
+   int    ffcall         = fit->ffcall.fetchAndAddOrdered( 1 ) + 1;
+   double wpar[ 2 ];
+   wpar[ 0 ]             = par[ 0 ];
+   wpar[ 1 ]             = ( fit->npar > 1 ) ? par[ 1 ] : 0.0;
+
+   // After 1st few calls, test if parameters are within limits
+   if ( ffcall > 3  &&  ! plm->within_limits( wpar ) )
+   {
+DbgLv(1) << "PcLM: call" << ffcall << "par1 par2" << wpar[0] << wpar[1]
+ << "*OUT-OF-LIMITS*";
+      return 1e+99;
+   }
+
+   QTime ftimer;
+   ftimer.start();
+   US_SolveSim::Simulation sim_vals;
+   sim_vals.noisflag     = plm->noisflag;
+   sim_vals.dbg_level    = dbg_level;
+   sim_vals.alpha        = plm->alpha;
+
+   plm->curve_solutes( wpar, sim_vals.zsolutes );
+   QVector< US_ZSolute > isols = sim_vals.zsolutes;
+
+   // Evaluate the model
+   double rmsd           = plm->evaluate( sim_vals );
+
+   fit->mutex.lock();
+
+   if ( rmsd < fit->brmsd )
+   {  // Save the best evaluation so far
+      fit->brmsd            = rmsd;
+      fit->bpar[ 0 ]        = wpar[ 0 ];
+      fit->bpar[ 1 ]        = wpar[ 1 ];
+      fit->bsim             = sim_vals;
+      fit->bisols           = isols;
+   }
+
+   fit->mutex.unlock();
+DbgLv(1) << "PcLM: call" << ffcall << "par1 par2" << wpar[0] << wpar[1]
+ << "rmsd" << rmsd << "eval time" << ftimer.elapsed() << "ms.";
+
+   return rmsd;
+}
+
+// Refine a model record
+void US_PcsaLM::refine( US_ModelRecord& mrec,
+      const US_LM::LM_Control& control, US_LM::LM_Status& status,
+      const int nthreads )
+{
+   int    npar   = npars();
+   int    m_dat  = 3;     // Only the first function value is non-zero
+   double tarray[ 3 ] = { 0.0, 1.0, 2.0 };
+   double yarray[ 3 ] = { 0.0, 0.0, 0.0 };
+   double par   [ 2 ];
+   par[ 0 ]      = mrec.par1;
+   par[ 1 ]      = mrec.par2;
+   US_PcsaLMFit fit( this, npar );
+
+   // Fit by the RMSD norm, as lmcurve_fit_rmsd does
+   US_LM::LM_Control lcontrol = control;
+   lcontrol.norm  = US_LM::lm_rmsdnorm;
+
+#ifdef NO_DB
+   // Simulations keep static work arrays in NO_DB builds
+   Q_UNUSED( nthreads );
+   int    nthr   = 1;
+#else
+   int    nthr   = nthreads;
+#endif
+
+   US_LM::lmcurve_fit_c( npar, par, m_dat, tarray, yarray,
+                         &US_PcsaLM::fit_function, (void*)&fit,
+                         &lcontrol, &status, nthr );
+DbgLv(1) << "PcLM: refine: par1 par2" << par[0] << par[1]
+ << "nfev info" << status.nfev << status.info << "best rmsd" << fit.brmsd;
+
+   if ( fit.brmsd >= 1e+99 )
+      return;        // No evaluation within limits:  leave record as is
+
+   // Replace the record with the best evaluated curve
+   double ystart;
+   double yend;
+   curve_ends( fit.bpar, ystart, yend );
+
+   mrec.ctype     = ctype;
+   mrec.stype     = stype;
+   mrec.str_y     = ystart;
+   mrec.end_y     = yend;
+   mrec.par1      = fit.bpar[ 0 ];
+   mrec.par2      = fit.bpar[ 1 ];
+   mrec.par3      = 0.0;
+   mrec.variance  = fit.bsim.variance;
+   mrec.rmsd      = fit.brmsd;
+   mrec.xmin      = xmin;
+   mrec.xmax      = xmax;
+   mrec.ymin      = ymin;
+   mrec.ymax      = ymax;
+   mrec.isolutes  = fit.bisols;
+   mrec.csolutes  = fit.bsim.zsolutes;
+   mrec.ti_noise  = fit.bsim.ti_noise;
+   mrec.ri_noise  = fit.bsim.ri_noise;
+   mrec.sim_data  = fit.bsim.sim_data;
+   mrec.residuals = fit.bsim.residuals;
+
+   // Construct a rudimentary model from the computed solutes
+   mrec.model     = US_Model();
+   mrec.model.variance = mrec.variance;
+
+   for ( int ii = 0; ii < mrec.csolutes.size(); ii++ )
+   {
+      US_Model::SimulationComponent mcomp;
+      US_ZSolute::set_mcomp_values( mcomp, mrec.csolutes[ ii ], stype, true );
+
+      mrec.model.components << mcomp;
+   }
+}
+
+// Refine several model records at once
+void US_PcsaLM::refine_all( QVector< US_ModelRecord >& mrecs,
+      const US_LM::LM_Control& control,
+      QVector< US_LM::LM_Status >& statuses, const int nthreads )
+{
+   int nrefs     = mrecs.size();
+   statuses.fill( US_LM::LM_Status(), nrefs );
+
+   if ( nrefs < 1 )
+      return;
+
+   US_ModelRecord*   recs  = mrecs   .data();
+   US_LM::LM_Status* stats = statuses.data();
+
+#ifndef NO_DB
+   // At most one refinement per thread; each refinement thread takes
+   //  records in turn, with a share of the threads for its Jacobians
+   int nthr      = US_Parallel::threads( nthreads );
+   int nlmt      = qMin( nthr, nrefs );
+   int jthr      = qMax( 1, nthr / nlmt );
+   QAtomicInt next( 0 );
+   QList< US_PcsaLMThread* > lmthrs;
+
+   for ( int jj = 0; jj < nlmt; jj++ )
+      lmthrs << new US_PcsaLMThread( this, recs, &control, stats, &next,
+                                     nrefs, jthr );
+
+   for ( int jj = 1; jj < nlmt; jj++ )
+      lmthrs[ jj ]->start();
+
+   // The calling thread refines records too
+   lmthrs[ 0 ]->run();
+
+   for ( int jj = 0; jj < nlmt; jj++ )
+   {
+      lmthrs[ jj ]->wait();
+      delete lmthrs[ jj ];
+   }
+#else
+   // Refinements are done one at a time in NO_DB builds
+   for ( int jj = 0; jj < nrefs; jj++ )
+      refine( recs[ jj ], control, stats[ jj ], 1 );
+#endif
+DbgLv(1) << "PcLM: refine_all: nrefs" << nrefs << "nthreads" << nthreads;
+}
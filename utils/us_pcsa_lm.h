@@ -0,0 +1,125 @@
+//! \file us_pcsa_lm.h
+#ifndef US_PCSA_LM_H
+#define US_PCSA_LM_H
+
+#include <QtCore>
+
+#include "us_extern.h"
+#include "us_lm.h"
+#include "us_solve_sim.h"
+#include "us_pcsa_modelrec.h"
+
+#ifndef DbgLv
+#define DbgLv(a) if(dbg_level>=a)qDebug()
+#endif
+
+//! \brief Levenberg-Marquardt refinement of PCSA model records
+
+/*! \class US_PcsaLM
+ *
+    This class refines the curve parameters of PCSA model records with
+    a Levenberg-Marquardt fit whose evaluations are full simulations of
+    the curve's solutes. All the state of a refinement is held in its own
+    evaluation context, so several records may be refined at once; and
+    the finite-difference Jacobian columns of a refinement are evaluated
+    concurrently on the thread pool.
+*/
+class US_UTIL_EXTERN US_PcsaLM
+{
+   public:
+      //! \brief Constructor for the PCSA L-M refinement class
+      //! \param dsets   Data sets list
+      //! \param offset  Index of the first data set to fit
+      //! \param dcount  Number of data sets to fit
+      //! \param ctype   Curve type (CTYPE_SL, CTYPE_IS, ...)
+      //! \param stype   Solute type mask
+      //! \param nlpts   Number of solute points on a curve
+      US_PcsaLM( QList< US_SolveSim::DataSet* >&, const int, const int,
+                 const int, const int, const int );
+
+      //! \brief Set the extents of the curves
+      //! \param xmin    X-value minimum
+      //! \param xmax    X-value maximum
+      //! \param ymin    Y-value minimum
+      //! \param ymax    Y-value maximum
+      void set_extents( const double, const double, const double,
+                        const double );
+
+      //! \brief Set the limits beyond which evaluations are rejected
+      //! \param minyv   Y-value minimum
+      //! \param maxyv   Y-value maximum
+      //! \param minp1   Par1 minimum
+      //! \param maxp1   Par1 maximum
+      //! \param minp2   Par2 minimum
+      //! \param maxp2   Par2 maximum
+      void set_limits( const double, const double, const double,
+                       const double, const double, const double );
+
+      //! \brief Set simulation options
+      //! \param noisflag  Noise flag: 0(none), 1(ti), 2(ri), 3(both)
+      //! \param alpha     Tikhonov regularization parameter
+      //! \param zval      Z-value of the solutes (0.0 for data set's)
+      void set_options( const int, const double, const double = 0.0 );
+
+      //! \brief Return the number of L-M parameters for the curve type
+      int  npars( void ) const;
+
+      //! \brief Compute the input solutes of a curve
+      //! \param par      Curve parameters (par1, par2)
+      //! \param zsols    Returned input solutes
+      void curve_solutes( const double*, QVector< US_ZSolute >& ) const;
+
+      //! \brief Refine a model record
+      //! \param mrec     Model record to refine, replaced by the refined
+      //! \param control  L-M control parameters
+      //! \param status   Returned L-M status
+      //! \param nthreads Threads for Jacobian evaluations (0 for default)
+      void refine( US_ModelRecord&, const US_LM::LM_Control&,
+                   US_LM::LM_Status&, const int = 0 );
+
+      //! \brief Refine several model records at once
+      //! \param mrecs    Model records to refine, each replaced by refined
+      //! \param control  L-M control parameters
+      //! \param statuses Returned L-M status of each record
+      //! \param nthreads Total threads to use (0 for default)
+      void refine_all( QVector< US_ModelRecord >&, const US_LM::LM_Control&,
+                       QVector< US_LM::LM_Status >&, const int = 0 );
+
+      //! \brief Curve function for US_LM::lmcurve_fit_c (returns RMSD)
+      //! \param t        Curve point (only t=0 is evaluated)
+      //! \param par      Curve parameters
+      //! \param fdata    Evaluation context of a refinement
+      //! \returns        RMSD of the fit with the curve's solutes
+      static double fit_function( double, double*, void* );
+
+   private:
+      QList< US_SolveSim::DataSet* >  dsets;   // Data sets list
+
+      int        offset;       // First data set index
+      int        dcount;       // Data sets count
+      int        ctype;        // Curve type
+      int        stype;        // Solute type mask
+      int        nlpts;        // Solute points per curve
+      int        noisflag;     // Noise flag
+      int        dbg_level;    // Debug level
+
+      double     xmin;         // X-value minimum
+      double     xmax;         // X-value maximum
+      double     ymin;         // Y-value minimum
+      double     ymax;         // Y-value maximum
+      double     zval;         // Z-value of solutes
+      double     xscl;         // X scale factor (1e-13 for s)
+      double     yscl;         // Y scale factor (1e-13 for s)
+      double     minyv;        // Limit y minimum
+      double     maxyv;        // Limit y maximum
+      double     minp1;        // Limit par1 minimum
+      double     maxp1;        // Limit par1 maximum
+      double     minp2;        // Limit par2 minimum
+      double     maxp2;        // Limit par2 maximum
+      double     alpha;        // Regularization parameter
+
+      bool   within_limits( const double* ) const;
+      void   curve_ends   ( const double*, double&, double& ) const;
+      double evaluate     ( US_SolveSim::Simulation& ) const;
+};
+#endif
@@ -0,0 +1,591 @@
+//! \file us_profiler.cpp
+#include <string.h>
+
+#include "us_profiler.h"
+#include "us_memory.h"
+
+#define PROF_NBUCKETS  48       // Duration histogram buckets (log2 ns)
+#define PROF_MXEVENTS  500000   // Maximum trace events kept per thread
+
+// Statistics of one scope or counter on one thread
+typedef struct prof_stat_s
+{
+   qint64  count;                     // Scopes recorded or values added
+   qint64  total;                     // Total nanoseconds or value sum
+   qint64  vmin;                      // Minimum duration or value
+   qint64  vmax;                      // Maximum duration or value
+   qint64  hist[ PROF_NBUCKETS ];     // Duration histogram
+   int     kind;                      // 0 (unused), 1 (scope), 2 (counter)
+} ProfStat;
+
+// One timeline event
+typedef struct prof_event_s
+{
+   int     id;                        // Scope identifier
+   qint64  start;                     // Start nanoseconds
+   qint64  dur;                       // Duration nanoseconds
+} ProfEvent;
+
+// Recording buffer of one thread, written only by that thread
+class US_ProfThread
+{
+   public:
+      int                   tid;      // Thread index
+      qint64                ndrop;    // Events dropped beyond maximum
+      QVector< ProfStat >   stats;    // Statistics by identifier
+      QVector< ProfEvent >  events;   // Timeline events
+};
+
+// Thread-local reference to a buffer. The reference is deleted when its
+//  thread ends, while the buffer lives on for collection.
+typedef struct prof_thread_ref_s
+{
+   US_ProfThread*  buf;
+} ProfThreadRef;
+
+static QMutex                    prof_mutex;   // Registry and thread list
+static QStringList               prof_names;   // Names by identifier
+static QHash< QString, int >     prof_ids;     // Identifiers by name
+static QList< US_ProfThread* >   prof_threads; // All thread buffers
+static QThreadStorage< ProfThreadRef* > prof_local;
+static QElapsedTimer             prof_clock;   // Profiling clock
+static long int                  prof_rssmax = 0L;
+
+bool US_Profiler::prof_on    = false;
+bool US_Profiler::prof_trace = false;
+
+// Write the statistics (and trace) of this process at application exit
+static void prof_write_at_exit( void )
+{
+   QString prefix   = QString( qgetenv( "US_PROFILE_OUT" ) );
+
+   if ( prefix.isEmpty() )
+      prefix           = QDir::tempPath() + "/us_profile_" + QString::number(
+                            QCoreApplication::applicationPid() );
+
+   QList< QByteArray > packs;
+   packs << US_Profiler::serialize( 0 );
+   US_Profiler::write_json( prefix + ".json", packs );
+
+   if ( US_Profiler::tracing() )
+      US_Profiler::write_trace( prefix + ".trace.json", packs );
+}
+
+// Start the clock and set any mode given by the environment
+static int prof_init( void )
+{
+   prof_clock.start();
+   QByteArray env   = qgetenv( "US_PROFILE" ).trimmed().toLower();
+   int        mode  = US_Profiler::OFF;
+
+   if ( env == "trace"  ||  env == "2" )
+      mode             = US_Profiler::TRACE;
+
+   else if ( ! env.isEmpty()  &&  env != "0"  &&  env != "off" )
+      mode             = US_Profiler::STATS;
+
+   US_Profiler::set_mode( mode );
+
+   if ( mode != US_Profiler::OFF )
+      qAddPostRoutine( prof_write_at_exit );
+
+   return mode;
+}
+
+static int prof_init_mode = prof_init();
+
+// Return the buffer of the current thread, creating it on first use
+static US_ProfThread* prof_buffer( void )
+{
+   if ( prof_local.hasLocalData() )
+      return prof_local.localData()->buf;
+
+   ProfThreadRef* ref = new ProfThreadRef;
+   ref->buf           = new US_ProfThread;
+   ref->buf->ndrop    = 0;
+   {
+      QMutexLocker locker( &prof_mutex );
+      ref->buf->tid      = prof_threads.size();
+      prof_threads << ref->buf;
+   }
+
+   prof_local.setLocalData( ref );
+   return ref->buf;
+}
+
+// Return the statistics entry of an identifier, growing the vector if need be
+static ProfStat* prof_stat( US_ProfThread* tb, const int id )
+{
+   int nstat     = tb->stats.size();
+
+   if ( id >= nstat )
+   {
+      tb->stats.resize( id + 1 );
+      memset( (void*)( tb->stats.data() + nstat ), 0,
+              sizeof( ProfStat ) * ( id + 1 - nstat ) );
+   }
+
+   return tb->stats.data() + id;
+}
+
+// Set the profiling mode
+void US_Profiler::set_mode( int mode )
+{
+   prof_on       = ( mode != OFF );
+   prof_trace    = ( mode == TRACE );
+}
+
+// Return the profiling mode
+int US_Profiler::mode( void )
+{
+   return prof_trace ? TRACE : ( prof_on ? STATS : OFF );
+}
+
+// Return the identifier of a name, registering it if need be
+int US_Profiler::scope_id( const char* name )
+{
+   QMutexLocker locker( &prof_mutex );
+   QString      sname( name );
+
+   if ( prof_ids.contains( sname ) )
+      return prof_ids[ sname ];
+
+   int id        = prof_names.size();
+   prof_names << sname;
+   prof_ids[ sname ] = id;
+   return id;
+}
+
+// Return nanoseconds on the profiling clock
+qint64 US_Profiler::now_ns( void )
+{
+   return prof_clock.nsecsElapsed();
+}
+
+// Record a completed scope
+void US_Profiler::record( const int id, const qint64 start, const qint64 dur )
+{
+   US_ProfThread* tb = prof_buffer();
+   ProfStat*      st = prof_stat( tb, id );
+
+   st->vmin      = ( st->count == 0 ) ? dur : qMin( st->vmin, dur );
+   st->vmax      = ( st->count == 0 ) ? dur : qMax( st->vmax, dur );
+   st->count++;
+   st->total    += dur;
+   st->kind      = 1;
+
+   int    bk     = 0;
+   qint64 bval   = dur;
+
+   while ( bval > 1  &&  bk < ( PROF_NBUCKETS - 1 ) )
+   {
+      bval        >>= 1;
+      bk++;
+   }
+
+   st->hist[ bk ]++;
+
+   if ( prof_trace )
+   {
+      if ( tb->events.size() < PROF_MXEVENTS )
+      {
+         ProfEvent ev;
+         ev.id         = id;
+         ev.start      = start;
+         ev.dur        = dur;
+         tb->events << ev;
+      }
+      else
+         tb->ndrop++;
+   }
+}
+
+// Add a value to a counter
+void US_Profiler::count( const int id, const qint64 value )
+{
+   ProfStat* st  = prof_stat( prof_buffer(), id );
+
+   st->vmin      = ( st->count == 0 ) ? value : qMin( st->vmin, value );
+   st->vmax      = ( st->count == 0 ) ? value : qMax( st->vmax, value );
+   st->count++;
+   st->total    += value;
+   st->kind      = 2;
+}
+
+// Sample resident memory into a counter
+void US_Profiler::memory_mark( const int id )
+{
+   long int rss  = US_Memory::rss_now();
+   {
+      QMutexLocker locker( &prof_mutex );
+      prof_rssmax   = qMax( prof_rssmax, rss );
+   }
+
+   count( id, (qint64)rss );
+}
+
+// Clear all recorded data
+void US_Profiler::reset( void )
+{
+   QMutexLocker locker( &prof_mutex );
+
+   for ( int ii = 0; ii < prof_threads.size(); ii++ )
+   {
+      prof_threads[ ii ]->stats .clear();
+      prof_threads[ ii ]->events.clear();
+      prof_threads[ ii ]->ndrop = 0;
+   }
+
+   prof_rssmax   = 0L;
+}
+
+// Pack all thread data as lines of text:
+//   R rank maxrss-kb threads dropped-events
+//   N id name
+//   S tid id count total min max [bucket:count ...]
+//   C tid id count sum min max
+//   E tid id start duration
+QByteArray US_Profiler::serialize( const int rank )
+{
+   QMutexLocker locker( &prof_mutex );
+   QByteArray   pack;
+   QTextStream  ts( &pack, QIODevice::WriteOnly );
+   long int     rssmax  = prof_rssmax;
+   qint64       ndrop   = 0;
+   US_Memory::rss_max( rssmax );
+
+   for ( int tt = 0; tt < prof_threads.size(); tt++ )
+      ndrop        += prof_threads[ tt ]->ndrop;
+
+   ts << "R " << rank << " " << (qint64)rssmax << " " << prof_threads.size()
+      << " " << ndrop << "\n";
+
+   for ( int ii = 0; ii < prof_names.size(); ii++ )
+      ts << "N " << ii << " " << prof_names[ ii ] << "\n";
+
+   for ( int tt = 0; tt < prof_threads.size(); tt++ )
+   {
+      US_ProfThread* tb = prof_threads[ tt ];
+
+      for ( int ii = 0; ii < tb->stats.size(); ii++ )
+      {
+         const ProfStat* st = tb->stats.data() + ii;
+
+         if ( st->kind == 0 )
+            continue;
+
+         ts << ( st->kind == 1 ? "S " : "C " ) << tb->tid << " " << ii
+            << " " << st->count << " " << st->total
+            << " " << st->vmin  << " " << st->vmax;
+
+         if ( st->kind == 1 )
+         {
+            for ( int bk = 0; bk < PROF_NBUCKETS; bk++ )
+            {
+               if ( st->hist[ bk ] > 0 )
+                  ts << " " << bk << ":" << st->hist[ bk ];
+            }
+         }
+
+         ts << "\n";
+      }
+
+      for ( int ii = 0; ii < tb->events.size(); ii++ )
+      {
+         const ProfEvent* ev = tb->events.data() + ii;
+         ts << "E " << tb->tid << " " << ev->id << " " << ev->start
+            << " " << ev->dur << "\n";
+      }
+   }
+
+   ts.flush();
+   return pack;
+}
+
+// Merged statistics of a name over all threads and processes
+typedef struct prof_merged_s
+{
+   ProfStat    stat;                  // Merged statistics
+   int         nthr;                  // Thread-and-process count
+} ProfMerged;
+
+// Parse packs, merging statistics by name and optionally writing events
+static void prof_parse( const QList< QByteArray >& a_packs,
+      QMap< QString, ProfMerged >& merged, QList< qint64 >& rsss,
+      QList< qint64 >& drops, QTextStream* tts )
+{
+   QList< QByteArray > packs = a_packs;
+
+   if ( packs.isEmpty() )
+      packs << US_Profiler::serialize( 0 );
+
+   bool first_ev = true;
+
+   for ( int pp = 0; pp < packs.size(); pp++ )
+   {
+      QTextStream ts( packs[ pp ], QIODevice::ReadOnly );
+      QStringList names;
+      int         rank  = pp;
+
+      while ( ! ts.atEnd() )
+      {
+         QString     line  = ts.readLine();
+         QStringList flds  = line.split( " ", QString::SkipEmptyParts );
+
+         if ( flds.size() < 3 )
+            continue;
+
+         QString rtype = flds[ 0 ];
+
+         if ( rtype == "R"  &&  flds.size() > 4 )
+         {
+            rank           = flds[ 1 ].toInt();
+            rsss  << flds[ 2 ].toLongLong();
+            drops << flds[ 4 ].toLongLong();
+
+            if ( tts != NULL )
+            {
+               *tts << ( first_ev ? "\n" : ",\n" )
+                    << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":"
+                    << rank << ",\"args\":{\"name\":\"rank " << rank
+                    << "\"}}";
+               first_ev       = false;
+            }
+         }
+
+         else if ( rtype == "N" )
+         {
+            int id         = flds[ 1 ].toInt();
+
+            while ( names.size() <= id )
+               names << QString();
+
+            names[ id ]    = flds[ 2 ];
+         }
+
+         else if ( ( rtype == "S"  ||  rtype == "C" )  &&  flds.size() > 6 )
+         {
+            int id         = flds[ 2 ].toInt();
+
+            if ( id >= names.size() )
+               continue;
+
+            qint64  cnt    = flds[ 3 ].toLongLong();
+            qint64  tot    = flds[ 4 ].toLongLong();
+            qint64  vmn    = flds[ 5 ].toLongLong();
+            qint64  vmx    = flds[ 6 ].toLongLong();
+            QString name   = names[ id ];
+
+            if ( ! merged.contains( name ) )
+            {
+               ProfMerged mrg;
+               memset( (void*)&mrg.stat, 0, sizeof( ProfStat ) );
+               mrg.stat.vmin  = vmn;
+               mrg.stat.vmax  = vmx;
+               mrg.stat.kind  = ( rtype == "S" ) ? 1 : 2;
+               mrg.nthr       = 0;
+               merged[ name ] = mrg;
+            }
+
+            ProfMerged* mrg = &merged[ name ];
+            mrg->stat.count += cnt;
+            mrg->stat.total += tot;
+            mrg->stat.vmin   = qMin( mrg->stat.vmin, vmn );
+            mrg->stat.vmax   = qMax( mrg->stat.vmax, vmx );
+            mrg->nthr++;
+
+            for ( int jj = 7; jj < flds.size(); jj++ )
+            {
+               int bk         = flds[ jj ].section( ":", 0, 0 ).toInt();
+
+               if ( bk >= 0  &&  bk < PROF_NBUCKETS )
+                  mrg->stat.hist[ bk ] += flds[ jj ].section( ":", 1, 1 )
+                                          .toLongLong();
+            }
+         }
+
+         else if ( rtype == "E"  &&  tts != NULL  &&  flds.size() > 4 )
+         {
+            int id         = flds[ 2 ].toInt();
+
+            if ( id >= names.size() )
+               continue;
+
+            // Trace-event times are in microseconds
+            *tts << ( first_ev ? "\n" : ",\n" )
+                 << "{\"name\":\"" << names[ id ]
+                 << "\",\"cat\":\"us\",\"ph\":\"X\",\"ts\":"
+                 << QString::number( flds[ 3 ].toDouble() * 1.0e-3, 'f', 3 )
+                 << ",\"dur\":"
+                 << QString::number( flds[ 4 ].toDouble() * 1.0e-3, 'f', 3 )
+                 << ",\"pid\":" << rank << ",\"tid\":" << flds[ 1 ] << "}";
+            first_ev       = false;
+         }
+      }
+   }
+}
+
+// Return names sorted by descending total
+static QStringList prof_by_total( QMap< QString, ProfMerged >& merged,
+                                  const int kind )
+{
+   QList< QPair< qint64, QString > > totals;
+   QStringList names = merged.keys();
+
+   for ( int ii = 0; ii < names.size(); ii++ )
+   {
+      if ( merged[ names[ ii ] ].stat.kind == kind )
+         totals << qMakePair( -merged[ names[ ii ] ].stat.total, names[ ii ] );
+   }
+
+   qSort( totals );
+   names.clear();
+
+   for ( int ii = 0; ii < totals.size(); ii++ )
+      names << totals[ ii ].second;
+
+   return names;
+}
+
+// Return a text table of scope statistics
+QString US_Profiler::report( const QList< QByteArray >& packs )
+{
+   QMap< QString, ProfMerged > merged;
+   QList< qint64 > rsss;
+   QList< qint64 > drops;
+   prof_parse( packs, merged, rsss, drops, NULL );
+
+   QStringList names = prof_by_total( merged, 1 );
+   QString     rtext = QString().sprintf( "%-36s %10s %12s %12s %12s %12s\n",
+                          "Scope", "Count", "Total(ms)", "Mean(us)",
+                          "Min(us)", "Max(us)" );
+
+   for ( int ii = 0; ii < names.size(); ii++ )
+   {
+      ProfStat* st  = &merged[ names[ ii ] ].stat;
+      double  cnt   = (double)qMax( st->count, (qint64)1 );
+      rtext        += QString().sprintf( "%-36s %10lld %12.3f %12.3f"
+                         " %12.3f %12.3f\n", qPrintable( names[ ii ] ),
+                         st->count, (double)st->total * 1.0e-6,
+                         (double)st->total * 1.0e-3 / cnt,
+                         (double)st->vmin * 1.0e-3,
+                         (double)st->vmax * 1.0e-3 );
+   }
+
+   names         = prof_by_total( merged, 2 );
+
+   for ( int ii = 0; ii < names.size(); ii++ )
+   {
+      ProfStat* st  = &merged[ names[ ii ] ].stat;
+      rtext        += QString().sprintf( "%-36s %10lld  sum %lld"
+                         "  min %lld  max %lld\n", qPrintable( names[ ii ] ),
+                         st->count, st->total, st->vmin, st->vmax );
+   }
+
+   return rtext;
+}
+
+// Write a JSON summary of merged statistics
+bool US_Profiler::write_json( const QString& path,
+                              const QList< QByteArray >& packs )
+{
+   QMap< QString, ProfMerged > merged;
+   QList< qint64 > rsss;
+   QList< qint64 > drops;
+   prof_parse( packs, merged, rsss, drops, NULL );
+
+   QFile fout( path );
+
+   if ( ! fout.open( QIODevice::WriteOnly | QIODevice::Text ) )
+      return false;
+
+   QTextStream ts( &fout );
+   ts << "{\n  \"processes\": " << rsss.size() << ",\n";
+   ts << "  \"maxrss_kb\": [";
+
+   for ( int ii = 0; ii < rsss.size(); ii++ )
+      ts << ( ii == 0 ? " " : ", " ) << rsss[ ii ];
+
+   ts << " ],\n  \"dropped_events\": [";
+
+   for ( int ii = 0; ii < drops.size(); ii++ )
+      ts << ( ii == 0 ? " " : ", " ) << drops[ ii ];
+
+   ts << " ],\n  \"scopes\": [";
+
+   QStringList names = prof_by_total( merged, 1 );
+
+   for ( int ii = 0; ii < names.size(); ii++ )
+   {
+      ProfMerged* mrg = &merged[ names[ ii ] ];
+      ProfStat*   st  = &mrg->stat;
+      double      cnt = (double)qMax( st->count, (qint64)1 );
+
+      ts << ( ii == 0 ? "\n" : ",\n" )
+         << "    { \"name\": \"" << names[ ii ] << "\", \"count\": "
+         << st->count << ", \"threads\": " << mrg->nthr
+         << ", \"total_ms\": "
+         << QString::number( (double)st->total * 1.0e-6, 'f', 3 )
+         << ", \"mean_us\": "
+         << QString::number( (double)st->total * 1.0e-3 / cnt, 'f', 3 )
+         << ", \"min_us\": "
+         << QString::number( (double)st->vmin * 1.0e-3, 'f', 3 )
+         << ", \"max_us\": "
+         << QString::number( (double)st->vmax * 1.0e-3, 'f', 3 )
+         << ", \"hist_log2_ns\": [";
+
+      bool first    = true;
+
+      for ( int bk = 0; bk < PROF_NBUCKETS; bk++ )
+      {
+         if ( st->hist[ bk ] > 0 )
+         {
+            ts << ( first ? " " : ", " ) << "[ " << bk << ", "
+               << st->hist[ bk ] << " ]";
+            first         = false;
+         }
+      }
+
+      ts << " ] }";
+   }
+
+   ts << "\n  ],\n  \"counters\": [";
+   names         = prof_by_total( merged, 2 );
+
+   for ( int ii = 0; ii < names.size(); ii++ )
+   {
+      ProfStat* st  = &merged[ names[ ii ] ].stat;
+
+      ts << ( ii == 0 ? "\n" : ",\n" )
+         << "    { \"name\": \"" << names[ ii ] << "\", \"count\": "
+         << st->count << ", \"sum\": " << st->total
+         << ", \"min\": " << st->vmin << ", \"max\": " << st->vmax << " }";
+   }
+
+   ts << "\n  ]\n}\n";
+   ts.flush();
+   fout.close();
+   return true;
+}
+
+// Write timeline events in Chrome trace-event format
+bool US_Profiler::write_trace( const QString& path,
+                               const QList< QByteArray >& packs )
+{
+   QFile fout( path );
+
+   if ( ! fout.open( QIODevice::WriteOnly | QIODevice::Text ) )
+      return false;
+
+   QMap< QString, ProfMerged > merged;
+   QList< qint64 > rsss;
+   QList< qint64 > drops;
+   QTextStream ts( &fout );
+
+   ts << "{\"traceEvents\":[";
+   prof_parse( packs, merged, rsss, drops, &ts );
+   ts << "\n],\"displayTimeUnit\":\"ms\"}\n";
+   ts.flush();
+   fout.close();
+   return true;
+}
@@ -0,0 +1,167 @@
+//! \file us_profiler.h
+#ifndef US_PROFILER_H
+#define US_PROFILER_H
+
+#include <QtCore>
+
+#include "us_extern.h"
+
+//! \brief Low-overhead profiling of named scopes, counters and memory
+//!
+//! Profiling is off by default and is switched on at run time, either by
+//! set_mode() or by the US_PROFILE environment variable ("stats" or "1"
+//! for statistics, "trace" for statistics plus a timeline). When off, a
+//! profiled scope costs one test of a static flag. With US_PROFILE set,
+//! a program writes its statistics (and any trace) when its application
+//! object is destroyed, to files named by the US_PROFILE_OUT prefix
+//! (default "us_profile_<pid>" in the system temporary directory).
+//!
+//! Each thread records into its own buffer, so recording takes no locks:
+//! per-scope counts, total, minimum and maximum durations and a histogram
+//! of durations in power-of-2 nanosecond buckets, plus (when tracing)
+//! timeline events. Counters accumulate values such as allocation sizes,
+//! and memory marks sample the resident memory size (RSS).
+//!
+//! serialize() packs the buffers of all threads as text, which may be
+//! passed between processes (e.g., MPI ranks). The write functions merge
+//! any number of such texts into a JSON statistics summary or a trace in
+//! Chrome trace-event format. Data should be collected when profiled work
+//! is finished, since other threads' buffers are read without locking.
+//!
+//! All methods are static.
+//!
+class US_UTIL_EXTERN US_Profiler
+{
+   public:
+      //! \brief Profiling modes
+      enum ProfMode { OFF = 0, STATS = 1, TRACE = 2 };
+
+      //! \brief Return whether profiling is on
+      static bool   enabled   ( void ) { return prof_on; }
+
+      //! \brief Return whether timeline events are recorded
+      static bool   tracing   ( void ) { return prof_trace; }
+
+      //! \brief Set the profiling mode
+      //! \param mode  OFF, STATS or TRACE
+      static void   set_mode  ( int );
+
+      //! \brief Return the current profiling mode
+      static int    mode      ( void );
+
+      //! \brief Return the identifier of a named scope or counter
+      //!
+      //! \param name  Name without spaces, usually "module.function";
+      //!              an existing identifier is returned if registered
+      //! \returns     Identifier for record() and count()
+      static int    scope_id  ( const char* );
+
+      //! \brief Return nanoseconds since the start of profiling
+      static qint64 now_ns    ( void );
+
+      //! \brief Record a completed scope on the current thread
+      //! \param id     Scope identifier
+      //! \param start  Start time in nanoseconds
+      //! \param dur    Duration in nanoseconds
+      static void   record    ( const int, const qint64, const qint64 );
+
+      //! \brief Add a value to a counter on the current thread
+      //! \param id     Counter identifier
+      //! \param value  Value to add (e.g., kilobytes allocated)
+      static void   count     ( const int, const qint64 );
+
+      //! \brief Sample the resident memory into a named counter
+      //! \param id     Counter identifier
+      static void   memory_mark( const int );
+
+      //! \brief Clear all recorded data
+      static void   reset     ( void );
+
+      //! \brief Pack the data of all threads as text
+      //! \param rank   Process rank to tag the data with
+      //! \returns      Packed data
+      static QByteArray serialize( const int = 0 );
+
+      //! \brief Return a text table of scope statistics
+      //! \param packs  Packed data of one or more processes
+      //!               (empty for this process)
+      static QString report     ( const QList< QByteArray >& );
+
+      //! \brief Write a JSON summary of scope and counter statistics
+      //! \param path   Output file path
+      //! \param packs  Packed data of one or more processes
+      //!               (empty for this process)
+      //! \returns      Success flag
+      static bool   write_json ( const QString&, const QList< QByteArray >& );
+
+      //! \brief Write timeline events in Chrome trace-event format
+      //! \param path   Output file path
+      //! \param packs  Packed data of one or more processes
+      //!               (empty for this process)
+      //! \returns      Success flag
+      static bool   write_trace( const QString&, const QList< QByteArray >& );
+
+   private:
+      static bool   prof_on;      // Flag profiling on
+      static bool   prof_trace;   // Flag timeline tracing on
+};
+
+//! \brief Timer of a profiled scope, recorded when stopped or destroyed
+class US_ProfScope
+{
+   public:
+      //! \brief Start timing a scope
+      //! \param id  Scope identifier from US_Profiler::scope_id()
+      US_ProfScope( const int a_id ) : id( a_id ),
+         start( US_Profiler::enabled() ? US_Profiler::now_ns() : -1 ) {}
+
+      ~US_ProfScope() { stop(); }
+
+      //! \brief Stop timing and record the scope, if not yet recorded
+      void stop( void )
+      {
+         if ( start >= 0 )
+         {
+            US_Profiler::record( id, start, US_Profiler::now_ns() - start );
+            start   = -1;
+         }
+      }
+
+   private:
+      int    id;
+      qint64 start;
+};
+
+#define US_PROF_CAT2(a,b) a##b
+#define US_PROF_CAT(a,b)  US_PROF_CAT2(a,b)
+
+//! Profile the rest of the enclosing block as a named scope
+#define US_PROF_SCOPE(name) \
+   static const int US_PROF_CAT(prof_id_,__LINE__) = \
+      US_Profiler::scope_id( name ); \
+   US_ProfScope US_PROF_CAT(prof_sc_,__LINE__)( US_PROF_CAT(prof_id_,__LINE__) )
+
+//! Begin a named scope that ends at US_PROF_END with the same tag
+#define US_PROF_BEGIN(tag,name) \
+   static const int prof_id_##tag = US_Profiler::scope_id( name ); \
+   US_ProfScope prof_sc_##tag( prof_id_##tag )
+
+//! End a scope begun by US_PROF_BEGIN
+#define US_PROF_END(tag) prof_sc_##tag.stop()
+
+//! Add a value to a named counter
+#define US_PROF_COUNT(name,value) \
+   do { if ( US_Profiler::enabled() ) { \
+      static const int US_PROF_CAT(prof_ct_,__LINE__) = \
+         US_Profiler::scope_id( name ); \
+      US_Profiler::count( US_PROF_CAT(prof_ct_,__LINE__), value ); } \
+   } while ( 0 )
+
+//! Sample resident memory into a named counter
+#define US_PROF_MEMORY(name) \
+   do { if ( US_Profiler::enabled() ) { \
+      static const int US_PROF_CAT(prof_mm_,__LINE__) = \
+         US_Profiler::scope_id( name ); \
+      US_Profiler::memory_mark( US_PROF_CAT(prof_mm_,__LINE__) ); } \
+   } while ( 0 )
+#endif
@@ -326,10 +326,14 @@ int US_Settings::threads( void )
 void US_Settings::set_threads( int threads )
 {
   QSettings settings( US3, "UltraScan" );
-  if ( threads == 1 )
-    settings.remove( "threads" );
-  else
-    settings.setValue( "threads", threads );
+  // Always store it, so that an explicit count of 1 is kept as set
+  settings.setValue( "threads", threads );
+}
+
+bool US_Settings::threads_set( void )
+{
+  QSettings settings( US3, "UltraScan" );
+  return settings.contains( "threads" );
 }
 
 // Noise Dialog:  0 -> Auto, 1 -> Dialog
@@ -127,6 +127,10 @@ class US_UTIL_EXTERN US_Settings
     //!        This is normally the number of processors or cores in 
     //!        the local computer.
     static void        set_threads( int );
+    //! \brief Get whether a thread count has been set explicitly.
+    //!        If not, threads() returns 1 but callers may choose
+    //!        their own default.
+    static bool        threads_set( void );
 
     //! \brief Get the noise dialog flag (0==Auto [def], 1==Dialog)
     static int         noise_dialog( void );
@@ -1130,12 +1130,49 @@ int US_SimulationParameters::simSpeedsFromTimeState( const QString tmst_fpath )
    tsobj            = new US_TimeState();        // Create TimeState
    tsobj->open_read_data( tmst_fpath, true );    // Open with prefetch
    ssProfFromTimeState( tsobj, sim_speed_prof ); // Create SSP vector
+   buildSpeedTable();                            // Share derived values
    int dbg_level    = US_Settings::us_debug();
 DbgLv(1) << "SP: ssFts: ispeed" << sim_speed_prof[0].rotorspeed
  << "ssp count" << sim_speed_prof.count();
    return sim_speed_prof.count();                // Return number steps
 }
 
+// Build the speed table shared by all copies of these parameters
+void US_SimulationParameters::buildSpeedTable( void )
+{
+   SpeedTable* stab = new SpeedTable;
+   stab->tsobj      = tsobj;
+
+   for ( int step = 0; step < sim_speed_prof.count(); step++ )
+   {
+      SimSpeedProf* ssp = &sim_speed_prof[ step ];
+      double omega_r    = (double)ssp->rotorspeed * M_PI / 30.0;
+      double omega_a    = ssp->avg_speed * M_PI / 30.0;
+
+      stab->time_e_accel << ssp->time_e_accel;
+      stab->w2t_e_accel  << ssp->w2t_e_accel;
+      stab->time_e_step  << ssp->time_e_step;
+      stab->w2t_e_step   << ssp->w2t_e_step;
+      stab->omega2_rotor << sq( omega_r );
+      stab->omega2_avg   << sq( omega_a );
+   }
+
+   speed_table      = QSharedPointer< const SpeedTable >( stab );
+}
+
+// Return the shared speed table, if still valid for the speed profile
+const US_SimulationParameters::SpeedTable*
+   US_SimulationParameters::speedTable( void ) const
+{
+   const SpeedTable* stab = speed_table.data();
+
+   if ( stab == NULL  ||  stab->tsobj != tsobj  ||
+        stab->time_e_step.count() != sim_speed_prof.count() )
+      return NULL;
+
+   return stab;
+}
+
 // Create a referenced simulation speed step profile from an opened
 // TimeState object pointed to.
 int US_SimulationParameters::ssProfFromTimeState( US_TimeState* tsobj,
@@ -1156,10 +1193,6 @@ DbgLv(1) << "Sim parms:ssProf: ssps.count" << ssps.count();
    int sskx         = fkeys.indexOf( "SetSpeed" );
    int rskx         = fkeys.indexOf( "RawSpeed" );
    int w2kx         = fkeys.indexOf( "Omega2T" );
-   QString tmfm     = ( tmkx < 0 ) ? "" : ffmts[ tmkx ];  // Formats
-   QString ssfm     = ( sskx < 0 ) ? "" : ffmts[ sskx ];
-   QString rsfm     = ( rskx < 0 ) ? "" : ffmts[ rskx ];
-   QString w2fm     = ( w2kx < 0 ) ? "" : ffmts[ w2kx ];
    // Do we have the keys we need?
    bool have_keys   = ( tmkx >= 0 )  &&  ( sskx >= 0 )  &&
                       ( rskx >= 0 )  &&  ( w2kx >= 0 );
@@ -1167,11 +1200,21 @@ DbgLv(1) << "Sim parms:ssProf: have_keys" << have_keys;
    if ( ! have_keys )
       return -1;                           // Do not have needed keys
 
+   // Get whole columns of the fields used
+   const double* tmcol = tsobj->time_column( "Time"     );
+   const double* sscol = tsobj->time_column( "SetSpeed" );
+   const double* rscol = tsobj->time_column( "RawSpeed" );
+   const double* w2col = tsobj->time_column( "Omega2T"  );
+   const double* sccol = tsobj->time_column( "Scan"     );
+   if ( tmcol == NULL  ||  sscol == NULL  ||  rscol == NULL  ||
+        w2col == NULL )
+      return -1;                           // Columns are not available
+
    int nrec         = tsobj->time_count(); // Total time record count
+   int lrec         = nrec - 1;            // Last record index
    QList< int >  cspeeds;                  // Constant speeds list
 
    // Do an initial pass through timestate records to get constant speeds
-   tsobj->read_record( 0 );
    int ss1          = 0;
    int ss2          = 0;
    int ss3          = 0;
@@ -1179,10 +1222,7 @@ DbgLv(1) << "Sim parms:ssProf: have_keys" << have_keys;
    {
       ss1              = ss2;              // Set-speed two back
       ss2              = ss3;              // Previous set-speed
-      tsobj->read_record();
-      ss3              = ssfm == "F4" ?
-            (int)qRound( tsobj->time_dvalue( "SetSpeed" ) ) :
-                         tsobj->time_ivalue( "SetSpeed" );  // Current set speed
+      ss3              = (int)qRound( sscol[ tsx ] ); // Current set speed
 
       //if ( ss3 == ss2  &&  ss2 == ss1  &&  ss3 > 0 )
       if ( ss3 == ss2  &&  ss2 == ss1  &&  ss3 > 5000 )
@@ -1194,25 +1234,19 @@ DbgLv(1) << "Sim parms:ssProf: have_keys" << have_keys;
 DbgLv(1) << "Sim parms:ssProf: cspeeds" << cspeeds;
 
    // Now do a pass through records to accumulate full step records
-   tsobj->read_record( 0 );                // Read the first record
+   int rx           = 0;                   // Start at the first record
 DbgLv(1) << "Sim parms:ssProf: nrec" << nrec;
    int tm_p         = 0;                   // Previous acceleration time
-   int tm_c         = tmfm == "F4" ?
-         (int)qRound( tsobj->time_dvalue( "Time" ) ) :
-                      tsobj->time_ivalue( "Time" );
+   int tm_c         = (int)qRound( tmcol[ rx ] );
    bool in_accel    = true;                // Flag in acceleration zone
    int naintvs      = 0;                   // Initial accel intervals
    int ndtimes      = 0;                   // Initial duration times
    int tsx1         = 0;                   // Initial time state index
    double w2_p      = 0.0;                 // Initial prev. omega2t
    int    ss_p      = 0;                   // Initial prev. set speed
-   double w2_c      = tsobj->time_dvalue( "Omega2T" );   // 1st omega2t
-   double rs_c      = rsfm == "F4" ?
-                      tsobj->time_dvalue( "RawSpeed" ) :
-              (double)tsobj->time_ivalue( "RawSpeed" );  // 1st raw speed
-   int    ss_c      = ssfm == "F4" ?
-         (int)qRound( tsobj->time_dvalue( "SetSpeed" ) ) :
-                      tsobj->time_ivalue( "SetSpeed" );  // 1st set speed
+   double w2_c      = w2col[ rx ];         // 1st omega2t
+   double rs_c      = rscol[ rx ];         // 1st raw speed
+   int    ss_c      = (int)qRound( sscol[ rx ] );        // 1st set speed
    double rs_p      = 0.0;                 // Initial prev. raw_speed
    ssp.w2t_b_accel  = 0.0;                 // Set some SimSpeedProf values
    ssp.rotorspeed   = 0.0;
@@ -1229,17 +1263,11 @@ DbgLv(1) << "Sim parms:ssProf: nrec" << nrec;
       tsx1++;
       naintvs++;
       tm_p             = tm_c;
-      tsobj->read_record();                // Read the second record
-      tm_c             = tmfm == "F4" ?                    // Current time
-            (int)qRound( tsobj->time_dvalue( "Time" ) ) :
-                         tsobj->time_ivalue( "Time" );
-      w2_c             = tsobj->time_dvalue( "Omega2T" );  // Current omega2t
-      rs_c             = rsfm == "F4" ?
-                         tsobj->time_dvalue( "RawSpeed" ) :
-                 (double)tsobj->time_ivalue( "RawSpeed" );  // Current raw speed
-      ss_c             = ssfm == "F4" ?
-            (int)qRound( tsobj->time_dvalue( "SetSpeed" ) ) :
-                         tsobj->time_ivalue( "SetSpeed" );  // Current set speed
+      rx               = qMin( rx + 1, lrec );  // Go to the next record
+      tm_c             = (int)qRound( tmcol[ rx ] );  // Current time
+      w2_c             = w2col[ rx ];             // Current omega2t
+      rs_c             = rscol[ rx ];             // Current raw speed
+      ss_c             = (int)qRound( sscol[ rx ] );  // Current set speed
       accel_c          = rs_c;             // First acceleration value
       sum_accel        = accel_c;          // Initial acceleration sum
    }
@@ -1263,21 +1291,15 @@ int tm_cep=tm_ci+150;
       accel_p          = accel_c;
       pscan            = iscan;
 
-      tsobj->read_record();                // Read the next record
+      rx               = qMin( rx + 1, lrec );  // Go to the next record
 
       // Get current record's values
-      tm_c             = tmfm == "F4" ?
-            (int)qRound( tsobj->time_dvalue( "Time" ) ) :
-                         tsobj->time_ivalue( "Time" );
+      tm_c             = (int)qRound( tmcol[ rx ] );
       tm_c            -= tm_off;
-      w2_c             = tsobj->time_dvalue( "Omega2T" );
-      rs_c             = rsfm == "F4" ?
-                         tsobj->time_dvalue( "RawSpeed" ) :
-                 (double)tsobj->time_ivalue( "RawSpeed" );
-      ss_c             = ssfm == "F4" ?
-            (int)qRound( tsobj->time_dvalue( "SetSpeed" ) ) :
-                         tsobj->time_ivalue( "SetSpeed" );
-      iscan            = tsobj->time_ivalue( "Scan" );
+      w2_c             = w2col[ rx ];
+      rs_c             = rscol[ rx ];
+      ss_c             = (int)qRound( sscol[ rx ] );
+      iscan            = ( sccol != NULL ) ? (int)qRound( sccol[ rx ] ) : 0;
       accel_c          = rs_c - rs_p;      // Current acceleration
       int ss_c_ts      = ss_c;
 if (tm_c<tm_cep || (tsx+5)>nrec || in_accel)
@@ -1391,17 +1413,14 @@ DbgLv(1) << "Sim parms:ssProf:   rpmsz" << ssps[i1].rpm_timestate.count()
  << "w2tsz" << ssps[i1].w2t_timestate.count();
       for ( int i2 = 0; i2 < ssps[ i1 ].duration; i2++ )
       {
-int rst=
-         tsobj->read_record( rtimex );
-         ssps[ i1 ].rpm_timestate[ i2 ] = rsfm == "F4" ?
-                                          tsobj->time_dvalue( "RawSpeed" ) :
-                                  (double)tsobj->time_ivalue( "RawSpeed" );
-         ssps[ i1 ].w2t_timestate[ i2 ] = tsobj->time_dvalue( "Omega2T" );
+         rx                  = qMin( rtimex, lrec );
+         ssps[ i1 ].rpm_timestate[ i2 ] = rscol[ rx ];
+         ssps[ i1 ].w2t_timestate[ i2 ] = w2col[ rx ];
 if(i2<4 || (i2+5)>ssps[i1].duration)
  DbgLv(1) << "Sim parms:ssProf:    i2" << i2 << "rtimex" << rtimex
   << "rpm" << ssps[ i1 ].rpm_timestate[ i2 ]
-  << "w2t" << ssps[ i1 ].w2t_timestate[ i2 ] << "rd_stat" << rst;
-         rtimex              = -1;             // Flag "read-next"
+  << "w2t" << ssps[ i1 ].w2t_timestate[ i2 ];
+         rtimex++;                             // Go to the next record
       }
    }
 
@@ -22,6 +22,7 @@ class US_UTIL_EXTERN US_SimulationParameters
 
    class SpeedProfile;
    class SimSpeedProf;
+   class SpeedTable;
 
    US_SimulationParameters();
 
@@ -142,6 +143,15 @@ class US_UTIL_EXTERN US_SimulationParameters
    //! \returns           The number of speed steps created internally
    int speedstepsFromSSprof  ( void );
 
+   //! \brief Function to build the shared speed table from the internal
+   //!        simulation speed step profile and TimeState object
+   void buildSpeedTable      ( void );
+
+   //! \brief Return the shared speed table, if it matches the current
+   //!        TimeState object and simulation speed step profile
+   //! \returns  Pointer to speed table, or null if there is none
+   const SpeedTable* speedTable( void ) const;
+
    //! \brief Dump class contents to stderr
    void debug( void );
 
@@ -161,6 +171,9 @@ class US_UTIL_EXTERN US_SimulationParameters
    QVector< SimSpeedProf > sim_speed_prof;
    US_TimeState*           tsobj;
 
+   //! Speed table derived once from the TimeState, shared by all copies
+   QSharedPointer< const SpeedTable > speed_table;
+
    int       simpoints;         //!< number of radial grid points used in sim
    MeshType  meshType;          //!< Type of radial grid 
    GridType  gridType;          //!< Designation if grid is fixed or can move
@@ -249,6 +262,27 @@ class US_UTIL_EXTERN US_SimulationParameters
       QVector< double > rpm_timestate; //!< rpms from timestate reading 
       QVector< double > w2t_timestate; //!< w2ts from timestate reading
    };
+
+   //! \brief Immutable speed table of a simulation speed profile.
+   //!
+   //! Holds, for each simulation speed step, the times and omega-squared-t
+   //! values that end its acceleration zone and the step, along with the
+   //! mesh-independent coefficients that simulations derive from them.
+   //! It is built once, when a TimeState is loaded, and copies of the
+   //! parameters share it, so simulations on any thread read it directly
+   //! instead of re-deriving the profile for each solute.
+   class US_UTIL_EXTERN  SpeedTable
+   {
+      public:
+
+      const US_TimeState* tsobj;       //!< TimeState the table is built from
+      QList< int >     time_e_accel;   //!< Time at end of acceleration zone
+      QList< double >  w2t_e_accel;    //!< omega2t at end of acceleration
+      QList< int >     time_e_step;    //!< Time at end of step
+      QList< double >  w2t_e_step;     //!< omega2t at end of step
+      QList< double >  omega2_rotor;   //!< Omega squared at rotor speed
+      QList< double >  omega2_avg;     //!< Omega squared at average speed
+   };
 };
 
 #endif
@@ -77,4 +77,111 @@ QVector< US_Solute > US_Solute::create_solutes(
    return solute_vector;
 }
 
+// Construct an empty solute grid index
+US_SoluteGrid::US_SoluteGrid()
+{
+   define( 0.0, 0.0, 1, 0.0, 0.0, 1, 0.0 );
+}
+
+// Define the uniform grid of the index
+void US_SoluteGrid::define( double s_mn,   double s_mx,   int s_res,
+                            double ff0_mn, double ff0_mx, int ff0_res,
+                            double vbar20 )
+{
+   int nprs        = qMax( 1, ( s_res   - 1 ) );
+   int nprk        = qMax( 1, ( ff0_res - 1 ) );
+   int nlev        = ( 1 << max_level );
+   s_min           = s_mn;
+   k_min           = ff0_mn;
+   ldel_s          = qAbs( s_mx   - s_mn   ) / (double)( nprs * nlev );
+   ldel_k          = qAbs( ff0_mx - ff0_mn ) / (double)( nprk * nlev );
+   nlpt_s          = nprs * nlev + 1;
+   nlpt_k          = nprk * nlev + 1;
+   vbar            = vbar20;
+
+   points.clear();
+}
+
+// Clear the index
+void US_SoluteGrid::clear( void )
+{
+   points.clear();
+}
+
+// Add solutes to the index
+void US_SoluteGrid::add_solutes( const QVector< US_Solute >& solutes )
+{
+   int ixs;
+   int ixk;
+
+   for ( int ii = 0; ii < solutes.size(); ii++ )
+      points.insert( lattice_key( solutes[ ii ], ixs, ixk ) );
+}
+
+// Add lists of solutes to the index
+void US_SoluteGrid::add_solutes(
+      const QList< QVector< US_Solute > >& solute_list )
+{
+   for ( int ii = 0; ii < solute_list.size(); ii++ )
+      add_solutes( solute_list[ ii ] );
+}
+
+// Create new solutes at the lattice points around given solutes
+QVector< US_Solute > US_SoluteGrid::refine(
+      const QVector< US_Solute >& solutes, int level )
+{
+   QVector< US_Solute > new_solutes;
+
+   if ( level < 1  ||  level > max_level )
+      return new_solutes;
+
+   int lstep       = ( 1 << ( max_level - level ) );
+
+   for ( int ii = 0; ii < solutes.size(); ii++ )
+   {
+      int ixs;
+      int ixk;
+      lattice_key( solutes[ ii ], ixs, ixk );
+
+      // Test the 8 neighbors at this level's spacing
+      for ( int js = -1; js < 2; js++ )
+      {
+         int jxs         = ixs + js * lstep;
+         if ( jxs < 0  ||  jxs >= nlpt_s )  continue;
+
+         for ( int jk = -1; jk < 2; jk++ )
+         {
+            int jxk         = ixk + jk * lstep;
+            if ( jxk < 0  ||  jxk >= nlpt_k )  continue;
+
+            qint64 pkey     = ( (qint64)jxs << 32 ) | (qint64)jxk;
+            if ( points.contains( pkey ) )  continue;
+
+            points.insert( pkey );
+            double svl      = s_min + ldel_s * (double)jxs;
 
+            // Omit s values close to zero
+            if ( svl >= -1.0e-14  &&  svl <= 1.0e-14 ) continue;
+
+            new_solutes << US_Solute( svl, k_min + ldel_k * (double)jxk,
+                                      0.0, vbar );
+         }
+      }
+   }
+
+   return new_solutes;
+}
+
+// Get the lattice point of a solute and return its index key
+qint64 US_SoluteGrid::lattice_key( const US_Solute& sol,
+                                   int& ixs, int& ixk ) const
+{
+   ixs             = ( ldel_s > 0.0 )
+                     ? qRound( ( sol.s - s_min ) / ldel_s ) : 0;
+   ixk             = ( ldel_k > 0.0 )
+                     ? qRound( ( sol.k - k_min ) / ldel_k ) : 0;
+   ixs             = qMax( 0, qMin( ixs, nlpt_s - 1 ) );
+   ixk             = qMax( 0, qMin( ixk, nlpt_k - 1 ) );
+
+   return ( ( (qint64)ixs << 32 ) | (qint64)ixk );
+}
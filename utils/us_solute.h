@@ -87,4 +87,63 @@ class US_UTIL_EXTERN US_Solute
                     double ff0_min, double ff0_max, double ff0_step,
                     double cnstff0 );
 };
+
+//! \brief Spatial index of simulated solutes of a uniform s,f/f0 grid
+//!
+//! Solutes are indexed by their points on a lattice that is finer than
+//! the grid by a factor of 2 to the power max_level. Each refinement level
+//! halves the spacing around given solutes, and only lattice points not
+//! yet in the index are returned (and indexed) as new solutes. Adaptive
+//! grid refinement thereby simulates each point at most once.
+
+class US_UTIL_EXTERN US_SoluteGrid
+{
+   public:
+      //! Maximum refinement level
+      static const int max_level = 10;
+
+      US_SoluteGrid();
+
+      //! Define the uniform grid and clear the index
+      //! \param s_min   The minimum sedimentation value
+      //! \param s_max   The maximum sedimentation value
+      //! \param s_res   The number of grid points in s
+      //! \param ff0_min The minimum frictional ratio
+      //! \param ff0_max The maximum frictional ratio
+      //! \param ff0_res The number of grid points in f/f0
+      //! \param vbar    The vbar given to new solutes
+      void define( double, double, int, double, double, int, double );
+
+      //! Clear the index of simulated solutes
+      void clear ( void );
+
+      //! Add solutes to the index
+      //! \param solutes Solutes that have been simulated
+      void add_solutes( const QVector< US_Solute >& );
+
+      //! Add lists of solutes (e.g., subgrids) to the index
+      //! \param solute_list Lists of solutes that have been simulated
+      void add_solutes( const QList< QVector< US_Solute > >& );
+
+      //! Create the new solutes around given solutes at a refinement level
+      //! \param solutes Solutes (usually nonzero ones) to refine around
+      //! \param level   Refinement level (1 for half the grid spacing,...)
+      //! \returns       New solutes, which are then in the index
+      QVector< US_Solute > refine( const QVector< US_Solute >&, int );
+
+      //! Return the number of indexed solutes
+      int  count ( void ) const { return points.size(); }
+
+   private:
+      QSet< qint64 > points;     // Lattice points of indexed solutes
+      double s_min;              // Grid s minimum
+      double k_min;              // Grid f/f0 minimum
+      double ldel_s;             // Lattice s spacing
+      double ldel_k;             // Lattice f/f0 spacing
+      double vbar;               // Vbar of new solutes
+      int    nlpt_s;             // Lattice s points
+      int    nlpt_k;             // Lattice f/f0 points
+
+      qint64 lattice_key( const US_Solute&, int&, int& ) const;
+};
 #endif
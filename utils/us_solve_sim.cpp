@@ -5,6 +5,7 @@
 #include "us_math2.h"
 #include "us_constants.h"
 #include "us_memory.h"
+#include "us_profiler.h"
 //#include "us_gui_settings.h"
 
 // Define level-conditioned debug print that includes thread/processor
@@ -17,6 +18,9 @@
 // Define the default norm cutoff value
 #define _NORM_CUTOFF_   1.00
 
+// Define the radius tolerance (cm) for sharing wavelength simulations
+#define _MWL_RTOLER_    1.0e-5
+
 
 double zerothr = 0.020;    //!< zero threshold OD value
 double linethr = 0.050;    //!< linear threshold OD value
@@ -31,6 +35,8 @@ US_SolveSim::US_SolveSim( QList< DataSet* >& data_sets, int thrnrank,
    thrnrank( thrnrank ), signal_wanted( signal_wanted )
 {
    abort        = false;     // Default: no abort
+   simcache     = NULL;      // Default: no simulation cache
+   mwl_base     = -1;        // Default: no shared MWL simulations
    dbg_level    = 0;         // Default: no debug prints
    dbg_timing   = false;     // Default: no debug timing prints
    banddthr     = false;     // Default: no bandform data_threshold
@@ -92,6 +98,91 @@ US_SolveSim::Simulation::Simulation()
    noisflag      = 0;
 }
 
+// Create a simulation cache
+US_SolveSim::SimCache::SimCache( int maxmb )
+{
+   maxbytes      = (qint64)maxmb * 1024 * 1024;
+   nbytes        = 0;
+   nhits         = 0;
+}
+
+// Get the cached simulation of a solute, if it has been stored
+bool US_SolveSim::SimCache::fetch( const int dsx, const US_Solute& sol,
+                                   US_DataIO::RawData& sdata )
+{
+   QByteArray skey = key( dsx, sol );
+   QMutexLocker locker( &mutex );
+
+   if ( ! sims.contains( skey ) )
+      return false;
+
+   sdata         = sims[ skey ];   // Implicitly shared copy
+   nhits++;
+   return true;
+}
+
+// Store the simulation of a solute, dropping the oldest if over the limit
+void US_SolveSim::SimCache::store( const int dsx, const US_Solute& sol,
+                                   const US_DataIO::RawData& sdata )
+{
+   QByteArray skey = key( dsx, sol );
+   qint64 sbytes   = (qint64)sdata.scanCount() * sdata.pointCount()
+                     * sizeof( double );
+   QMutexLocker locker( &mutex );
+
+   if ( sims.contains( skey )  ||  sbytes > maxbytes )
+      return;
+
+   while ( ( nbytes + sbytes ) > maxbytes  &&  order.size() > 0 )
+   {  // Make room by dropping the oldest simulations
+      US_DataIO::RawData odata = sims.take( order.takeFirst() );
+      nbytes       -= (qint64)odata.scanCount() * odata.pointCount()
+                      * sizeof( double );
+   }
+
+   sims[ skey ]  = sdata;
+   order << skey;
+   nbytes       += sbytes;
+}
+
+// Remove all stored simulations
+void US_SolveSim::SimCache::clear( void )
+{
+   QMutexLocker locker( &mutex );
+   sims .clear();
+   order.clear();
+   nbytes        = 0;
+   nhits         = 0;
+}
+
+// Return the number of stored simulations
+int US_SolveSim::SimCache::count( void )
+{
+   QMutexLocker locker( &mutex );
+   return sims.size();
+}
+
+// Return the number of fetches that found a simulation
+int US_SolveSim::SimCache::hits( void )
+{
+   QMutexLocker locker( &mutex );
+   return nhits;
+}
+
+// Compose the lookup key of a data set's solute
+QByteArray US_SolveSim::SimCache::key( const int dsx, const US_Solute& sol )
+{
+   double kvals[ 5 ] = { (double)dsx, sol.s, sol.k, sol.v, sol.d };
+   return QByteArray( (const char*)kvals, sizeof( kvals ) );
+}
+
+// Compose the lookup key of a solute's shared MWL simulation
+static QByteArray solute_key( const US_Solute& sol )
+{
+   double kvals[ 4 ] = { sol.s, sol.k, sol.v, sol.d };
+   return QByteArray( (const char*)kvals, sizeof( kvals ) );
+}
+
 // Static function to check the grid size implied by data and model
 bool US_SolveSim::checkGridSize( QList< DataSet* >& data_sets,
                                  double s_max, QString& smsg )
@@ -165,6 +256,7 @@ void US_SolveSim::calc_residuals( int offset, int dataset_count, Simulation& sim
    bool padAB, QVector< double >* ASave, QVector< double >* BSave,
    QVector< double >* NSave )
 {
+   US_PROF_SCOPE( "solvesim.calc_residuals" );
    QVector< double > sv_nnls_a;
    QVector< double > sv_nnls_b;
 
@@ -229,6 +321,7 @@ if(thrnrank<2) DbgLv(1) << "CR:zthr lthr mxod mfac"
    for ( int ee = offset; ee < lim_offs; ee++ )
    {  // Count scan,point totals for all data sets
       DataSet* dset = data_sets[ ee ];
+      load_timestate( dset );   // Speed profile shared by all solutes
       nscans        = dset->run_data.scanCount();
       npoints       = dset->run_data.pointCount();
       ntotal       += ( nscans * npoints );
@@ -246,6 +339,8 @@ DbgLv(1) << "   CR:na nb nx" << navals << narows << nsolutes
 
    QVector< double > nnls_a( navals,   0.0 );
    QVector< double > nnls_b( narows,   0.0 );
+   US_PROF_COUNT( "solvesim.a_matrix_kb",
+                  ( (qint64)navals * sizeof( double ) ) / 1024 );
    QVector< double > nnls_x( nsolutes, 0.0 );
    QVector< double > tinvec( ntinois,  0.0 );
    QVector< double > rinvec( nrinois,  0.0 );
@@ -330,6 +425,7 @@ DbgLv(1) << "   CR:B fill kodl" << kodl;
 
    if ( abort ) return;
 
+   US_PROF_BEGIN( build_a, "solvesim.build_a" );
    QList< US_DataIO::RawData > simulations;       // All simulations, this run
    simulations.reserve( nsolutes * dataset_count );
 
@@ -340,6 +436,10 @@ DbgLv(1) << "   CR:B fill kodl" << kodl;
    int ka        = 0;                             // nnls_a output index
    int ksols     = 0;
    int stype     = data_sets[ offset ]->solute_type;
+   bool use_cache = ( simcache != NULL  &&  stype == 0  &&
+                      ! use_zsol  &&  ! banddthr );
+   bool use_mwl   = ( mwl_base >= 0  &&  stype == 0  &&
+                      ! use_zsol  &&  ! banddthr );
 
    if ( use_zsol )
       qSort( sim_vals.zsolutes );
@@ -428,62 +528,39 @@ DbgLv(2) << "   CR:BF s20wcorr D20wcorr" << dset->s20w_correction
 // << model.components[0].mw << model.components[0].vbar20
 // << model.components[0].D << model.components[0].signal_concentration;
 
+            // Reuse the simulation of this solute from a cache, if present
+            bool cached    = use_cache  &&
+                             simcache->fetch( ee, sim_vals.solutes[ cc ],
+                                              simdat );
+
+            // Other wavelengths of a cell interpolate its shared simulation
+            if ( ! cached  &&  use_mwl  &&  ee != mwl_base )
+               cached         = mwl_simulation( ee, sim_vals.solutes[ cc ],
+                                                simdat );
+
             // Initialize simulation data with the experiment's grid
 DbgLv(2) << "   CR:111  rss now" << US_Memory::rss_now() << "cc" << cc;
-            US_AstfemMath::initSimData( simdat, *edata, 0.0 );
+            if ( ! cached )
+               US_AstfemMath::initSimData( simdat, *edata, 0.0 );
 
 DbgLv(2) << "   CR:112  rss now" << US_Memory::rss_now() << "cc" << cc;
 if (dbg_level>1 && thrnrank<2 && cc==0) { model.debug(); dset->simparams.debug(); }
 
-            // Check if timestate file exists or not
-            if ( dset->simparams.tsobj == NULL  ||
-                 dset->simparams.sim_speed_prof.count() < 1 )
-            {  // Simparms does not yet have a loaded timestate
-DbgLv(0) << "solve_sim_calc_residuals_1 : TSOBJ" << dset->simparams.tsobj
- << "ssprof count" << dset->simparams.sim_speed_prof.count();
-               dset->simparams.tsobj = NULL;           // Insure TimeState object and
-               dset->simparams.sim_speed_prof.clear(); //  speed prof are both cleared.
-               QString runID     = edata->runID;
-#ifdef NO_DB
-               QString tmst_fpath = ( dset->tmst_file.isEmpty() ) ?
-                                    "../" + runID + ".time_state.tmst" :
-                                    dset->tmst_file;
-#else
-               QString tmst_fpath = US_Settings::resultDir() +"/" + runID +"/" + runID + ".time_state.tmst";
-#endif
-               QFileInfo check_file( tmst_fpath );
-
-               if ( ( check_file.exists() )  &&  ( check_file.isFile() ) )
-               {  // Timestate file exists
-                  bool intv_1sec  = US_AstfemMath::timestate_onesec( tmst_fpath, simdat );
-DbgLv(0) << "solve_sim_calc_residuals_1 : intv_1sec" << intv_1sec;
-
-                  if ( intv_1sec )
-                  {  // Timestate is already at 1-second interval, so load it
-                     dset->simparams.simSpeedsFromTimeState( tmst_fpath );
-DbgLv(0) << "solve_sim_calc_residuals_1 : sim_speed_prof count" << dset->simparams.sim_speed_prof.count()
- << " intv_1sec" << intv_1sec;
-                  }
-DbgLv(0) << "solve_sim_calc_residuals_1 : timestate file exists" << tmst_fpath
- << " timestateobject=" << dset->simparams.tsobj << "sspknt=" << dset->simparams.sim_speed_prof.count();
-DbgLv(0) << "solve_sim_calc_residuals_1 : ntimes" << dset->simparams.tsobj->time_count();
-               }
-               else
-               {  // Timestate file does not exist (will be created in astfem_rsa)
-DbgLv(0) << "solve_sim_1: timestate file does not exist" << tmst_fpath << dset->tmst_file;
-               }
-            }
-else
- DbgLv(1) << "solve_sim_1: timestate object exists  sspknt=" << dset->simparams.sim_speed_prof.count()
-  << " timestateobject=" << dset->simparams.tsobj;
-
 //DebugTime("BEG: clcr-NA-astfem");
-            US_Astfem_RSA astfem_rsa( model, dset->simparams );
+            if ( ! cached )
+            {  // Simulate the solute
+               US_Astfem_RSA astfem_rsa( model, dset->simparams );
 DbgLv(2) << "   CR:113  rss now" << US_Memory::rss_now() << "cc" << cc;
 
-            astfem_rsa.set_debug_flag( dbg_level );
+               astfem_rsa.set_debug_flag( dbg_level );
 
-            astfem_rsa.calculate( simdat );
+               astfem_rsa.calculate( simdat );
+            }
+
+            if ( use_mwl  &&  ee == mwl_base )
+            {  // Keep the simulation of a cell's first wavelength to share
+               mwl_sims[ solute_key( sim_vals.solutes[ cc ] ) ] = simdat;
+            }
 //DebugTime("END: clcr-NA-astfem");
 DbgLv(2) << "   CR:114  rss now" << US_Memory::rss_now() << "cc" << cc;
             if ( abort ) return;
@@ -580,7 +657,6 @@ DbgLv(1) << "CR: NNLS  &simdat" << &simdat;
 DbgLv(1) << "CR: NNLS  &model " << &model;
 DbgLv(1) << "CR: NNLS  &nnls_a" << &nnls_a;
 DbgLv(1) << "CR: NNLS  &simulations" << &simulations;
-DbgLv(1) << "CR: NNLS  astfem_rsa" << &astfem_rsa;
 //DebugTime("END:   clcr-NA-eeiter");
          }  // Each data set of constant vbar (stype=1)
 //DebugTime("END: clcr-NA-eeloop");
@@ -731,42 +807,6 @@ DbgLv(1) << "CR: cc" << cc << " use_zsol" << use_zsol;
 DbgLv(1) << "CR:  simdat nsc npt" << simdat.scanCount() << simdat.pointCount();
 
             // Calculate Astfem_RSA solution (Lamm equations)
-            //
-            if ( dset->simparams.tsobj == NULL  ||
-                 dset->simparams.sim_speed_prof.count() < 1 )
-            {  // Simparms does not yet have a loaded timestate
-DbgLv(0) << "solve_sim_calc_residuals_2 : TSOBJ" << dset->simparams.tsobj
- << "ssprof count" << dset->simparams.sim_speed_prof.count();
-               QString runID     = edata->runID;
-#ifdef NO_DB
-               QString tmst_fpath = ( dset->tmst_file.isEmpty() ) ?
-                                    "../" + runID + ".time_state.tmst" :
-                                    dset->tmst_file;
-#else
-               QString tmst_fpath = US_Settings::resultDir() +"/" + runID +"/" + runID + ".time_state.tmst";
-#endif
-               QFileInfo check_file( tmst_fpath );
-
-               if ( ( check_file.exists() )  &&  ( check_file.isFile() ) )
-               {  // Timestate file exists
-                  bool intv_1sec  = US_AstfemMath::timestate_onesec( tmst_fpath, simdat );
-DbgLv(1) << "solve_sim_calc_residuals_2 : intv_1sec" << intv_1sec;
-
-                  if ( intv_1sec )
-                  {
-                     dset->simparams.simSpeedsFromTimeState( tmst_fpath );
-DbgLv(0) << "solve_sim_calc_residuals_2 : sim_speed_prof count" << dset->simparams.sim_speed_prof.count()
- << " intv_1sec" << intv_1sec;
-                  }
-DbgLv(1) << "solve_sim_calc_residuals_2 : timestate file exists" << tmst_fpath
- << " timestateobject=" << dset->simparams.tsobj << "sspknt=" << dset->simparams.sim_speed_prof.count();
-DbgLv(1) << "solve_sim_calc_residuals_2 : ntimes" << dset->simparams.tsobj->time_count();
-               }
-               else
-               {  // Timestate file does not exist (will be created in astfem_rsa)
-DbgLv(1) << "solve_sim_2: timestate file does not exist" << tmst_fpath << dset->tmst_file;
-               }
-            }
 
             US_Astfem_RSA astfem_rsa( model, dset->simparams );
 
@@ -944,43 +984,6 @@ DbgLv(1)<<" Special case of custom grid";
                model.debug(); dset->simparams.debug();
             }
 
-            // Check if timestate file exists or not
-            if ( dset->simparams.tsobj == NULL  ||
-                 dset->simparams.sim_speed_prof.count() < 1 )
-            {  // Simparms does not yet have a loaded timestate
-DbgLv(0) << "solve_sim_calc_residuals_3 : TSOBJ" << dset->simparams.tsobj
- << "ssprof count" << dset->simparams.sim_speed_prof.count();
-               QString runID     = edata->runID;
-#ifdef NO_DB
-               QString tmst_fpath = ( dset->tmst_file.isEmpty() ) ?
-                                    "../" + runID + ".time_state.tmst" :
-                                    dset->tmst_file;
-#else
-               QString tmst_fpath = US_Settings::resultDir() +"/" + runID +"/" + runID + ".time_state.tmst";
-#endif
-               QFileInfo check_file( tmst_fpath );
-
-               if ( ( check_file.exists() )  &&  ( check_file.isFile() ) )
-               {  // Timestate file exists
-                  bool intv_1sec  = US_AstfemMath::timestate_onesec( tmst_fpath, simdat );
-DbgLv(1) << "solve_sim_calc_residuals_3 : intv_1sec" << intv_1sec;
-
-                  if ( intv_1sec )
-                  {
-                     dset->simparams.simSpeedsFromTimeState( tmst_fpath );
-DbgLv(0) << "solve_sim_calc_residuals_3 : sim_speed_prof count" << dset->simparams.sim_speed_prof.count()
- << " intv_1sec" << intv_1sec;
-                  }
-DbgLv(1) << "solve_sim_calc_residuals_3 : timestate file exists" << tmst_fpath
- << " timestateobject=" << dset->simparams.tsobj << "sspknt=" << dset->simparams.sim_speed_prof.count();
-DbgLv(1) << "solve_sim_calc_residuals_3 : ntimes" << dset->simparams.tsobj->time_count();
-               }
-               else
-               {  // Timestate file does not exist (will be created in astfem_rsa)
-DbgLv(1) << "solve_sim_3: timestate file does not exist" << tmst_fpath << dset->tmst_file;
-               }
-            }
-
             US_Astfem_RSA astfem_rsa( model, dset->simparams );
 
             astfem_rsa.set_debug_flag( dbg_level );
@@ -1199,6 +1202,7 @@ DbgLv(1)<< " norm cuts for #solutes=" << ksolutes << ":  count_cut" << count_cut
 #endif
 
 
+   US_PROF_END( build_a );
    int kstodo   = nsolutes / 50;          // Set steps count for NNLS
    kstodo       = max( kstodo, 2 );
 DbgLv(1) << "   CR:200  rss now" << US_Memory::rss_now() << "thrn" << thrnrank;
@@ -1425,6 +1429,12 @@ if(soluval>1.0)
 //            int sim_ix  = cc * dataset_count + ee - offset;
             US_DataIO::RawData*     idata = &simulations[ sim_ix ];
             US_DataIO::RawData*     sdata = &sim_vals.sim_data;
+
+            if ( use_cache )
+            {  // Keep the simulation of a nonzero solute for later calls
+               simcache->store( ee, sim_vals.solutes[ cc ], *idata );
+            }
+
             int nscans  = idata->scanCount();
             int npoints = idata->pointCount();
 if(lim_offs>1&&(thrnrank==1||thrnrank==11))
@@ -1742,12 +1752,266 @@ DebugTime("END:calcres");
    return;
 }
 
+// Insure a data set's timestate and simulation speed profile are loaded,
+//  so that all the solute simulations of the data set share one speed table
+void US_SolveSim::load_timestate( DataSet* dset )
+{
+   static QMutex mutex;
+
+   if ( dset->simparams.tsobj != NULL  &&
+        dset->simparams.sim_speed_prof.count() > 0 )
+      return;
+
+   QMutexLocker locker( &mutex );
+
+   if ( dset->simparams.tsobj != NULL  &&
+        dset->simparams.sim_speed_prof.count() > 0 )
+      return;                   // Loaded while waiting for the lock
+
+   US_PROF_SCOPE( "solvesim.load_timestate" );
+DbgLv(0) << "solve_sim_load_timestate : TSOBJ" << dset->simparams.tsobj
+ << "ssprof count" << dset->simparams.sim_speed_prof.count();
+   dset->simparams.tsobj = NULL;           // Insure TimeState object and
+   dset->simparams.sim_speed_prof.clear(); //  speed prof are both cleared.
+   US_DataIO::EditedData* edata = &dset->run_data;
+   QString runID     = edata->runID;
+#ifdef NO_DB
+   QString tmst_fpath = ( dset->tmst_file.isEmpty() ) ?
+                        "../" + runID + ".time_state.tmst" :
+                        dset->tmst_file;
+#else
+   QString tmst_fpath = US_Settings::resultDir() + "/" + runID + "/"
+                        + runID + ".time_state.tmst";
+#endif
+   QFileInfo check_file( tmst_fpath );
+   US_DataIO::RawData simdat;
+   US_AstfemMath::initSimData( simdat, *edata, 0.0 );
+
+   if ( check_file.exists()  &&  check_file.isFile()  &&
+        US_AstfemMath::timestate_onesec( tmst_fpath, simdat ) )
+   {  // Timestate is already at 1-second interval, so load it
+      dset->simparams.simSpeedsFromTimeState( tmst_fpath );
+DbgLv(0) << "solve_sim_load_timestate : timestate file loaded" << tmst_fpath
+ << "sspknt=" << dset->simparams.sim_speed_prof.count();
+   }
+
+   else
+   {  // Write a 1-second timestate from the speed steps and load it
+      qint64  procid     = QCoreApplication::applicationPid();
+      QString tmst_tname = runID + "p" + QString::number( procid )
+                           + ".time_state.tmst";
+#ifdef NO_DB
+      QString tmst_tpath = "../" + tmst_tname;
+#else
+      QString tmst_tpath = US_Settings::tmpDir() + "/" + tmst_tname;
+#endif
+      US_AstfemMath::writetimestate( tmst_tpath, dset->simparams, simdat );
+      dset->simparams.simSpeedsFromTimeState( tmst_tpath );
+DbgLv(0) << "solve_sim_load_timestate : timestate file written" << tmst_tpath
+ << "sspknt=" << dset->simparams.sim_speed_prof.count();
+   }
+}
+
+// Interpolate the shared simulation of a solute to a data set's grid
+bool US_SolveSim::mwl_simulation( int dsx, const US_Solute& solute,
+                                  US_DataIO::RawData& sdata )
+{
+   QHash< QByteArray, US_DataIO::RawData >::const_iterator
+      simx     = mwl_sims.constFind( solute_key( solute ) );
+
+   if ( simx == mwl_sims.constEnd() )
+      return false;
+
+   US_AstfemMath::initSimData( sdata, data_sets[ dsx ]->run_data, 0.0 );
+
+   if ( ! interpolate_sim( simx.value(), sdata ) )
+      return false;     // Outside the shared radius range:  simulate it
+
+   US_PROF_COUNT( "solvesim.mwl_shared_sims", 1 );
+   return true;
+}
+
+// Interpolate a simulation to the radius,time grid of an initialized one.
+//  Radii are interpolated linearly, and only within the source range;
+//  times are interpolated linearly, and held at the nearest source scan
+//  outside the source range. Returns false, leaving the output as is,
+//  if radii are out of range.
+bool US_SolveSim::interpolate_sim( const US_DataIO::RawData& bdata,
+                                   US_DataIO::RawData& sdata )
+{
+   int bscans    = bdata.scanData.size();
+   int bpoints   = bdata.xvalues .size();
+   int nscans    = sdata.scanData.size();
+   int npoints   = sdata.xvalues .size();
+
+   if ( bscans < 1  ||  bpoints < 1 )
+      return false;
+
+   // Refuse to extrapolate radially:  ends are not held constant
+   if ( npoints > 0  &&
+        ( sdata.xvalues[ 0 ] < ( bdata.xvalues[ 0 ] - _MWL_RTOLER_ )  ||
+          sdata.xvalues[ npoints - 1 ] >
+          ( bdata.xvalues[ bpoints - 1 ] + _MWL_RTOLER_ ) ) )
+      return false;
+
+   // Get the source index and weight of each output radius
+   QVector< int >    rxs( npoints );
+   QVector< double > rws( npoints );
+   int    jr     = 0;
+
+   for ( int rr = 0; rr < npoints; rr++ )
+   {
+      double radius  = sdata.xvalues[ rr ];
+
+      while ( jr < ( bpoints - 2 )  &&  bdata.xvalues[ jr + 1 ] < radius )
+         jr++;
+
+      double rlo     = bdata.xvalues[ jr ];
+      double rhi     = bdata.xvalues[ qMin( jr + 1, bpoints - 1 ) ];
+      double rwt     = ( rhi > rlo ) ? ( ( radius - rlo ) / ( rhi - rlo ) )
+                                     : 0.0;
+      rxs[ rr ]      = jr;
+      rws[ rr ]      = qMax( 0.0, qMin( 1.0, rwt ) );
+   }
+
+   int    jt     = 0;
+
+   for ( int ss = 0; ss < nscans; ss++ )
+   {
+      double time    = sdata.scanData[ ss ].seconds;
+
+      while ( jt < ( bscans - 2 )  &&  bdata.scanData[ jt + 1 ].seconds < time )
+         jt++;
+
+      int    jt2     = qMin( jt + 1, bscans - 1 );
+      double tlo     = bdata.scanData[ jt  ].seconds;
+      double thi     = bdata.scanData[ jt2 ].seconds;
+      double twt     = ( thi > tlo ) ? ( ( time - tlo ) / ( thi - tlo ) )
+                                     : 0.0;
+      twt            = qMax( 0.0, qMin( 1.0, twt ) );
+      const double* vlo = bdata.scanData[ jt  ].rvalues.constData();
+      const double* vhi = bdata.scanData[ jt2 ].rvalues.constData();
+      double*       vou = sdata.scanData[ ss  ].rvalues.data();
+
+      for ( int rr = 0; rr < npoints; rr++ )
+      {
+         int    jr1     = rxs[ rr ];
+         int    jr2     = qMin( jr1 + 1, bpoints - 1 );
+         double rwt     = rws[ rr ];
+         double clo     = vlo[ jr1 ] + rwt * ( vlo[ jr2 ] - vlo[ jr1 ] );
+         double chi     = vhi[ jr1 ] + rwt * ( vhi[ jr2 ] - vhi[ jr1 ] );
+         vou[ rr ]      = qMax( 0.0, clo + twt * ( chi - clo ) );
+      }
+   }
+
+   return true;
+}
+
+// Calculate residuals of wavelengths, sharing simulations within each cell
+void US_SolveSim::calc_residuals_mwl( int offset, int dataset_count,
+                                      QList< Simulation >& sim_vals )
+{
+   US_PROF_SCOPE( "solvesim.calc_residuals_mwl" );
+   int lim_offs  = offset + dataset_count;
+   Simulation isim_vals = sim_vals[ 0 ];   // Input solutes and settings
+
+   while ( sim_vals.size() < dataset_count )
+      sim_vals << isim_vals;
+
+   mwl_base      = -1;
+   mwl_sims.clear();
+
+   for ( int ee = offset; ee < lim_offs; ee++ )
+   {
+      if ( abort ) break;
+
+      if ( mwl_base < 0  ||
+           ! same_profile( data_sets[ mwl_base ], data_sets[ ee ] ) )
+      {  // First wavelength of a cell:  its simulations are shared
+         mwl_base      = ee;
+         mwl_sims.clear();
+      }
+
+      // Each wavelength block is an NNLS of the same solutes. The blocks
+      //  share no unknowns (concentrations and noise are per wavelength),
+      //  so solving them in turn solves the block-diagonal global NNLS
+      Simulation* wsim_vals  = &sim_vals[ ee - offset ];
+      wsim_vals->solutes     = isim_vals.solutes;
+      wsim_vals->alpha       = isim_vals.alpha;
+      wsim_vals->noisflag    = isim_vals.noisflag;
+      wsim_vals->dbg_level   = isim_vals.dbg_level;
+      wsim_vals->dbg_timing  = isim_vals.dbg_timing;
+      wsim_vals->ti_noise.clear();
+      wsim_vals->ri_noise.clear();
+      wsim_vals->variances.clear();
+
+      calc_residuals( ee, 1, *wsim_vals );
+DbgLv(1) << "CR-MWL: ee" << ee << "base" << mwl_base << "shared sims"
+ << mwl_sims.size() << "out solutes" << wsim_vals->solutes.size();
+   }
+
+   mwl_sims.clear();
+   mwl_base      = -1;
+}
+
+// Static function to check if data sets share a cell and speed profile
+bool US_SolveSim::same_profile( DataSet* dset1, DataSet* dset2 )
+{
+   const double rtoler = 1.0e-4;   // Relative tolerance of corrections
+   US_DataIO::EditedData* edat1 = &dset1->run_data;
+   US_DataIO::EditedData* edat2 = &dset2->run_data;
+   SIMPARAMS*             simp1 = &dset1->simparams;
+   SIMPARAMS*             simp2 = &dset2->simparams;
+
+   if ( edat1->runID != edat2->runID  ||  edat1->cell != edat2->cell  ||
+        edat1->channel != edat2->channel )
+      return false;
+
+   // Both must cover the same radial range, so none is extrapolated
+   int npts1    = edat1->xvalues.size();
+   int npts2    = edat2->xvalues.size();
+
+   if ( npts1 < 1  ||  npts2 < 1  ||
+        qAbs( edat1->xvalues[ 0 ] - edat2->xvalues[ 0 ] ) > _MWL_RTOLER_  ||
+        qAbs( edat1->xvalues[ npts1 - 1 ] - edat2->xvalues[ npts2 - 1 ] )
+        > _MWL_RTOLER_ )
+      return false;
+
+   if ( simp1->meniscus != simp2->meniscus  ||
+        simp1->bottom   != simp2->bottom    ||
+        simp1->band_forming  ||  simp2->band_forming  ||
+        simp1->speed_step.count() != simp2->speed_step.count() )
+      return false;
+
+   for ( int jj = 0; jj < simp1->speed_step.count(); jj++ )
+   {
+      if ( simp1->speed_step[ jj ].rotorspeed !=
+           simp2->speed_step[ jj ].rotorspeed  ||
+           simp1->speed_step[ jj ].time_first !=
+           simp2->speed_step[ jj ].time_first )
+         return false;
+   }
+
+   // Solutes convert to the same experimental space in both data sets
+   return ( dset1->vbar20 == dset2->vbar20  &&
+            qAbs( dset1->s20w_correction - dset2->s20w_correction )
+            <= ( rtoler * qAbs( dset1->s20w_correction ) )  &&
+            qAbs( dset1->D20w_correction - dset2->D20w_correction )
+            <= ( rtoler * qAbs( dset1->D20w_correction ) ) );
+}
+
 // Set abort flag
 void US_SolveSim::abort_work()
 {
    abort = true;
 }
 
+// Set the cache of solute simulations
+void US_SolveSim::set_cache( SimCache* cache )
+{
+   simcache = cache;
+}
+
 // Compute a_tilde, the average experiment signal at each time
 void US_SolveSim::compute_a_tilde( QVector< double >& a_tilde,
                                    const QVector< double >& nnls_b )
@@ -80,6 +80,57 @@ class US_UTIL_EXTERN US_SolveSim : public QObject
          US_DataIO::RawData    residuals;  //!< Residuals data (run-sim-noi)
     };
 
+    //! Class caching the simulations of single solutes across calls
+    //!
+    //! When a cache is given to calc_residuals(), the simulation of any
+    //! cached solute is reused, and the simulations of solutes found to
+    //! have a nonzero concentration are stored. Overlapping solute sets
+    //! (refinement depths and iterations) then simulate a solute once.
+    //! The oldest simulations are dropped when the size limit is reached.
+    //! A cache may be shared by threads. It must be cleared whenever the
+    //! simulation parameters (e.g., meniscus) change.
+    class US_UTIL_EXTERN SimCache
+    {
+      public:
+
+         //! \brief Create a simulation cache
+         //! \param maxmb  Maximum megabytes of stored simulations
+         SimCache( int = 512 );
+
+         //! \brief Get the cached simulation of a solute
+         //! \param dsx    Data set index
+         //! \param sol    Solute (s,k,v,d are matched)
+         //! \param sdata  Returned simulation, if cached
+         //! \returns      Flag if the simulation was found
+         bool fetch   ( const int, const US_Solute&, US_DataIO::RawData& );
+
+         //! \brief Store the simulation of a solute
+         //! \param dsx    Data set index
+         //! \param sol    Solute (s,k,v,d are matched)
+         //! \param sdata  Simulation to store
+         void store   ( const int, const US_Solute&,
+                        const US_DataIO::RawData& );
+
+         //! \brief Remove all stored simulations
+         void clear   ( void );
+
+         //! \brief Return the number of stored simulations
+         int  count   ( void );
+
+         //! \brief Return the number of fetches satisfied since clear
+         int  hits    ( void );
+
+      private:
+         QMutex                                  mutex;    // Access lock
+         QHash< QByteArray, US_DataIO::RawData > sims;     // Simulations
+         QList< QByteArray >                     order;    // Keys, oldest 1st
+         qint64                                  maxbytes; // Size limit
+         qint64                                  nbytes;   // Size stored
+         int                                     nhits;    // Fetches found
+
+         QByteArray key( const int, const US_Solute& );
+    };
+
     //! Constructor for the SolveSim class
     //!
     //! \param data_sets      The set of data sets for which to solve
@@ -115,9 +166,41 @@ class US_UTIL_EXTERN US_SolveSim : public QObject
                          QVector< double >* = 0, QVector< double >*  = 0,
                          QVector< double >* = 0 );
 
+    //! \brief Calculate simulations and residuals of multi-wavelength data
+    //!
+    //! Each data set is one wavelength, and the wavelengths of a cell are
+    //! consecutive. Each solute is simulated once per cell and speed
+    //! profile, on the grid of its first wavelength, and that simulation is
+    //! interpolated to the radius,time grids of the other wavelengths.
+    //! Since extinction differs by wavelength, each wavelength has its own
+    //! concentrations and noise, so no unknown is shared between them:
+    //! the global NNLS is block diagonal, one block per wavelength, and
+    //! is solved exactly as its independent blocks, one after another.
+    //! \param offset         Starting data-sets offset
+    //! \param dataset_count  Number of wavelength data sets
+    //! \param sim_vals       Simulation objects, one per data set. Input
+    //!                       solutes and settings are those of the first;
+    //!                       each is returned with its wavelength's results.
+    void calc_residuals_mwl( int, int, QList< Simulation >& );
+
+    //! \brief Static function to check if two data sets are wavelengths
+    //!        of one cell and speed profile, so that they may share
+    //!        solute simulations
+    //! \param dset1  First data set
+    //! \param dset2  Second data set
+    //! \returns      Flag of shared cell, radial range and speed profile
+    static bool same_profile( DataSet*, DataSet* );
+
     //! \brief Set a flag so that the worker aborts at the earliest opportunity
     void abort_work    ( void );
 
+    //! \brief Set a cache of solute simulations to use in calc_residuals()
+    //!
+    //! The cache is used for s,f/f0 grid solutes of constant vbar
+    //! (solute type 0) and is ignored for band-forming data.
+    //! \param cache  Pointer to simulation cache (or null for none)
+    void set_cache     ( SimCache* );
+
   signals:
     //! \brief emit a signal that includes a progress step count
     void work_progress ( int );
@@ -127,11 +210,14 @@ class US_UTIL_EXTERN US_SolveSim : public QObject
     enum attr_type { ATTR_S, ATTR_K, ATTR_W, ATTR_V, ATTR_D, ATTR_F };
 
     QList< DataSet* >& data_sets;     // Data sets for which to solve
+    SimCache*          simcache;      // Cache of solute simulations (or null)
+    QHash< QByteArray, US_DataIO::RawData > mwl_sims; // Shared MWL sims
 
     int                thrnrank;      // Thread number or processor rank (1,...)
     bool               signal_wanted; // Flag whether to emit progress signals
 
     int                d_offs;        // Current data offset
+    int                mwl_base;      // Data set of shared MWL sims, or -1
     int                noisflag;      // Calc-noise flag (0-3 for no|ti|ri|both)
     int                dbg_level;     // Debug level
     bool               dbg_timing;    // Flag whether to print timings
@@ -206,6 +292,17 @@ class US_UTIL_EXTERN US_SolveSim : public QObject
     void set_comp_attr     ( US_Model::SimulationComponent&,
                              US_Solute&, int );
 
+    // Insure a data set's timestate and speed profile are loaded
+    void load_timestate    ( DataSet* );
+
+    // Interpolate the shared simulation of a solute to a data set's grid
+    bool mwl_simulation    ( int, const US_Solute&, US_DataIO::RawData& );
+
+    // Interpolate a simulation to the radius,time grid of another
+    //  (false if that grid's radii lie outside the simulation's)
+    static bool interpolate_sim( const US_DataIO::RawData&,
+                                 US_DataIO::RawData& );
+
     // Output a debug print of time for a labelled event
     void DebugTime         ( QString );
 
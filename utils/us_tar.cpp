@@ -10,6 +10,108 @@
  */
 
 #include "us_tar.h"
+#include "us_gzip.h"
+
+// Device I/O, defined ahead of the Windows renames of open, read, write
+//  and close
+static bool device_open( QIODevice* dev, QIODevice::OpenMode mode )
+{
+   return dev->open( mode );
+}
+
+static void device_close( QIODevice* dev )
+{
+   dev->close();
+}
+
+static qint64 device_read( QIODevice* dev, char* buf, qint64 size )
+{
+   return dev->read( buf, size );
+}
+
+static qint64 device_write( QIODevice* dev, const char* buf, qint64 size )
+{
+   return dev->write( buf, size );
+}
+
+// Thread writing archive records to a device, so that reading the
+//  files to archive overlaps writing the archive
+class US_TarWriter : public QThread
+{
+   public:
+      US_TarWriter( QIODevice* a_dev ) : dev( a_dev ), done( false ),
+         failed( false ) {}
+
+      // Queue a record; returns false if writing has failed
+      bool put_record( const char* data, const int size )
+      {
+         QMutexLocker lock( &mutex );
+
+         while ( queue.size() >= MAX_QUEUED  &&  ! failed )
+            space.wait( &mutex );
+
+         if ( failed ) return false;
+
+         queue.enqueue( QByteArray( data, size ) );
+         ready.wakeOne();
+         return true;
+      }
+
+      // Write all queued records and stop; returns false if any failed
+      bool finish( void )
+      {
+         mutex.lock();
+         done = true;
+         ready.wakeOne();
+         mutex.unlock();
+
+         wait();
+         return ! failed;
+      }
+
+   protected:
+      void run( void )
+      {
+         while ( true )
+         {
+            mutex.lock();
+
+            while ( queue.isEmpty()  &&  ! done )
+               ready.wait( &mutex );
+
+            if ( queue.isEmpty() )
+            {  // Done and all records written
+               mutex.unlock();
+               break;
+            }
+
+            QByteArray record = queue.dequeue();
+            space.wakeOne();
+            mutex.unlock();
+
+            if ( device_write( dev, record.constData(), record.size() )
+                 != record.size() )
+            {
+               mutex.lock();
+               failed = true;
+               queue.clear();
+               space.wakeAll();
+               mutex.unlock();
+            }
+         }
+      }
+
+   private:
+      enum { MAX_QUEUED = 32 };     // Records queued before waiting
+
+      QIODevice*           dev;     // Output archive device
+      QQueue< QByteArray > queue;   // Records waiting to be written
+      QMutex               mutex;
+      QWaitCondition       ready;   // Signaled when a record is queued
+      QWaitCondition       space;   // Signaled when a record is written
+      bool                 done;    // Flag:  no more records will come
+      bool                 failed;  // Flag:  a write failed
+};
 
 #include <sys/stat.h>
 #include <fcntl.h>
@@ -50,6 +152,10 @@ using namespace std;
 
 US_Tar::US_Tar()
 {
+   ofd    = -1;
+   ifd    = -1;
+   idev   = NULL;
+   writer = NULL;
 }
 
 int US_Tar::create( const QString& archive, const QString& directory,
@@ -72,11 +178,155 @@ int US_Tar::create( const QString& archive, const QStringList& files,
    //     b.  Write the header to the archive
    //     c.  Copy the file to the archive
    // 3.  Write two null headers (512 bytes)
+   // 4.  If compressing, gzip the archive written to memory into the file
    
    QStringList all;
 
    if ( list ) list->clear();
 
+   int error = expand_files( files, all );
+   if ( error != TAR_OK ) return error;
+
+   if ( list ) *list = all;
+   // Process all files
+
+   bool    compress = archive.endsWith( ".gz" )  ||  archive.endsWith( ".tgz" );
+   QFile   afile( archive );
+   QBuffer abuf;
+
+   if ( ! device_open( &afile, QIODevice::WriteOnly | QIODevice::Truncate ) )
+      return TAR_CANNOTCREATE;
+
+   if ( compress )
+      device_open( &abuf, QIODevice::WriteOnly );
+
+   error = write_members( all, compress ? (QIODevice*)&abuf
+                                        : (QIODevice*)&afile );
+
+   if ( error == TAR_OK  &&  compress )
+   {  // Compress from memory to the file as one gzip member, since
+      //  other gunzip implementations may read only the first member
+      US_Gzip gz;
+      device_close( &abuf );
+      device_open ( &abuf, QIODevice::ReadOnly );
+
+      if ( gz.gzip( &abuf, &afile, QString(), 1 ) != GZIP_OK )
+         error = TAR_WRITEERROR;
+   }
+
+   device_close( &afile );
+
+   if ( error != TAR_OK )
+      afile.remove();
+
+   return error;
+}
+
+int US_Tar::update( const QString& archive, const QStringList& files,
+                    QStringList* list )
+{
+   // Create the whole archive if it is new or compressed
+   QFile afile( archive );
+
+   if ( ! afile.exists()  ||  archive.endsWith( ".gz" )  ||
+        archive.endsWith( ".tgz" ) )
+      return create( archive, files, list );
+
+   QStringList all;
+
+   if ( list ) list->clear();
+
+   int error = expand_files( files, all );
+   if ( error != TAR_OK ) return error;
+
+   // Get the size, time and place of the last copy of each member, the
+   //  length of superseded copies and the offset of the end-of-archive
+   QHash< QString, tar_member > members;
+   qint64 end_offset = 0;
+   qint64 dead_bytes = 0;
+
+   if ( ! device_open( &afile, QIODevice::ReadOnly ) )
+      return TAR_NOTFOUND;
+
+   idev  = &afile;
+   error = scan_members( members, end_offset, dead_bytes );
+
+   // Rewrite an unreadable archive or one with members no longer listed
+   QSet< QString > names;
+
+   for ( int ii = 0; ii < all.size(); ii++ )
+      names.insert( all[ ii ] );
+
+   QList< QString > archived = members.keys();
+
+   for ( int ii = 0; ii < archived.size()  &&  error == TAR_OK; ii++ )
+   {
+      if ( ! names.contains( archived[ ii ] ) )
+         error = TAR_ARCHIVEERROR;
+   }
+
+   if ( error != TAR_OK )
+   {
+      idev  = NULL;
+      device_close( &afile );
+      return create( archive, files, list );
+   }
+
+   if ( list ) *list = all;
+
+   // List the files that are new or changed. Tar times are in whole
+   //  seconds, so a same-size rewrite may keep its time:  compare the
+   //  content of files whose size and time match.
+   QStringList adds;
+
+   for ( int ii = 0; ii < all.size(); ii++ )
+   {
+      QFileInfo f( all[ ii ] );
+
+      if ( ! members.contains( all[ ii ] ) )
+      {
+         adds << all[ ii ];
+         continue;
+      }
+
+      if ( f.isDir() )
+         continue;
+
+      const tar_member& memb = members[ all[ ii ] ];
+
+      if ( memb.size  != f.size()  ||
+           memb.mtime != f.lastModified().toTime_t()  ||
+           ! same_content( &afile, all[ ii ], memb ) )
+      {
+         adds << all[ ii ];
+         dead_bytes += memb.length;
+      }
+   }
+
+   idev  = NULL;
+   device_close( &afile );
+
+   if ( adds.isEmpty() ) return TAR_OK;
+
+   // Compact the archive, rewriting it in full, once superseded copies of
+   //  members would make up a quarter of it
+   if ( dead_bytes * 4 >= end_offset )
+      return create( archive, files, list );
+
+   // Append the new members over the old end-of-archive blocks. What is
+   //  written always reaches past the old end, so nothing is left over.
+   if ( ! device_open( &afile, QIODevice::ReadWrite )  ||
+        ! afile.seek( end_offset ) )
+      return TAR_CANNOTCREATE;
+
+   error = write_members( adds, &afile );
+   device_close( &afile );
+
+   return error;
+}
+
+int US_Tar::expand_files( const QStringList& files, QStringList& all )
+{
    for ( int i = 0; i < files.size(); i++ )
    {
       QString   current = files[ i ];
@@ -111,19 +361,23 @@ int US_Tar::create( const QString& archive, const QStringList& files,
       // Block and character devices, pipes, and symbolic links should be ignored
    }
 
-   if ( list ) *list = all;
-   // Process all files
+   return TAR_OK;
+}
 
+int US_Tar::write_members( const QStringList& all, QIODevice* dev )
+{
 #ifndef O_BINARY
 # define O_BINARY 0
 #endif
 
-   ofd = open( archive.toLatin1().constData(), O_WRONLY | O_CREAT | O_BINARY, 0644 );
-   
-   if ( ofd < 0 ) return TAR_CANNOTCREATE;
+   // Records are written by a separate thread as files are read
+   US_TarWriter twriter( dev );
+   twriter.start();
 
-   QStringList::iterator it = all.begin();
-   blocks_written           = 0;
+   QStringList::const_iterator it = all.begin();
+   blocks_written = 0;
+   writer         = &twriter;
+   int error      = TAR_OK;
 
    try
    {
@@ -135,16 +389,18 @@ int US_Tar::create( const QString& archive, const QStringList& files,
 
       archive_end();
    }
-   catch ( int error )
+   catch ( int write_error )
    {
-      close( ifd );
-      close( ofd );
-      unlink( archive.toLatin1().constData() );
-      return error;
+      if ( ifd >= 0 ) close( ifd );
+      ifd   = -1;
+      error = write_error;
    }
 
-   close( ofd );
-   return TAR_OK;
+   if ( ! twriter.finish()  &&  error == TAR_OK )
+      error = TAR_WRITEERROR;
+
+   writer         = NULL;
+   return error;
 }
 
 void US_Tar::process_dir( const QString& path, QStringList& all )
@@ -327,6 +583,7 @@ void US_Tar::write_file( const QString& file )
       }
 
       close( ifd );
+      ifd = -1;
    }
 }
 
@@ -469,9 +726,8 @@ void US_Tar::flush_buffer( void )
       memset( location, 0, size );
    }
 
-   int ret = write( ofd, buffer, sizeof buffer );
-
-   if ( ret != sizeof buffer ) throw TAR_WRITEERROR;
+   if ( ! writer->put_record( (char*) buffer, sizeof buffer ) )
+      throw TAR_WRITEERROR;
 
    blocks_written = 0;
 }
@@ -493,8 +749,10 @@ int US_Tar::extract( const QString& archive, QStringList* list )
     */
   
    ofd = -1;  // Initialize output file to closed
-   ifd = open( archive.toLatin1().constData(), O_RDONLY | O_BINARY );
-   if ( ifd < 0 ) return TAR_NOTFOUND;
+   QFile   afile;
+   QBuffer abuf;
+   int     aerror = open_archive( archive, afile, abuf );
+   if ( aerror != TAR_OK ) return aerror;
 
    if ( list ) list->clear();
 
@@ -607,7 +865,7 @@ int US_Tar::extract( const QString& archive, QStringList* list )
 
             while ( bytes_to_write > sizeof buffer )
             {
-               size = read( ifd, buffer, sizeof buffer );
+               size = device_read( idev, (char*) buffer, sizeof buffer );
                if ( size != sizeof buffer ) throw TAR_READERROR;
 
                size = write( ofd, buffer, sizeof buffer );
@@ -616,14 +874,14 @@ int US_Tar::extract( const QString& archive, QStringList* list )
                bytes_to_write -= sizeof buffer;
             }
 
-            size = read( ifd, buffer, bytes_to_write );
+            size = device_read( idev, (char*) buffer, bytes_to_write );
             if ( size != (int) bytes_to_write ) throw TAR_READERROR;
 
             size = write( ofd, buffer, bytes_to_write );
             if ( size != (int) bytes_to_write ) throw TAR_WRITEERROR;
 
             // Skip to start of next block
-            lseek( ifd, skip, SEEK_CUR );
+            skip_bytes( skip );
 
             // Clost output file
             close( ofd );
@@ -663,7 +921,7 @@ int US_Tar::extract( const QString& archive, QStringList* list )
    }
    catch ( int error )
    {
-      close( ifd );
+      idev = NULL;
       if ( ofd > 0 ) close( ofd );
 
       // Cycle through files and delete everything created
@@ -675,7 +933,7 @@ int US_Tar::extract( const QString& archive, QStringList* list )
       return error;
    }
 
-   close( ifd );
+   idev = NULL;
 
    // Fix directory times
    for ( int i = 0; i < dirs.size(); i++ )
@@ -693,8 +951,10 @@ int US_Tar::extract( const QString& archive, QStringList* list )
 /////////////////////////////
 int US_Tar::list( const QString& archive, QStringList& files )
 {
-   ifd = open( archive.toLatin1().constData(), O_RDONLY | O_BINARY );
-   if ( ifd < 0 ) return TAR_NOTFOUND;
+   QFile   afile;
+   QBuffer abuf;
+   int     aerror = open_archive( archive, afile, abuf );
+   if ( aerror != TAR_OK ) return aerror;
 
    blocks_read = 0;
 
@@ -777,20 +1037,146 @@ int US_Tar::list( const QString& archive, QStringList& files )
             if (  skip == BLOCK_SIZE ) skip = 0;
 
             // Skip to start of next block
-            lseek( ifd, fsize + skip, SEEK_CUR );
+            skip_bytes( fsize + skip );
          }
       }  // while ( true )
    }
    catch ( int error )
    {
-      close( ifd );
+      idev = NULL;
+      return error;
+   }
+
+   idev = NULL;
+   return TAR_OK;
+}
+
+// Open an archive for reading, decompressing it in memory if gzipped
+int US_Tar::open_archive( const QString& archive, QFile& afile,
+                          QBuffer& abuf )
+{
+   afile.setFileName( archive );
+   if ( ! device_open( &afile, QIODevice::ReadOnly ) ) return TAR_NOTFOUND;
+
+   char magic[ 2 ];
+   idev = &afile;
+
+   if ( afile.peek( magic, 2 ) == 2  &&
+        magic[ 0 ] == '\037'  &&  magic[ 1 ] == '\213' )
+   {
+      US_Gzip gz;
+      device_open( &abuf, QIODevice::WriteOnly );
+      int gerror = gz.gunzip( &afile, &abuf );
+      device_close( &abuf );
+      device_close( &afile );
+
+      if ( gerror != GZIP_OK ) return TAR_READERROR;
+
+      device_open( &abuf, QIODevice::ReadOnly );
+      idev = &abuf;
+   }
+
+   return TAR_OK;
+}
+
+// Get the size and time of the last copy of each member of the archive,
+//  and the offset of the end-of-archive blocks
+int US_Tar::scan_members( QHash< QString, tar_member >& members,
+                          qint64& end_offset, qint64& dead_bytes )
+{
+   dead_bytes = 0;
+
+   try
+   {
+      while ( true )
+      {
+         // Read header
+         end_offset = idev->pos();
+         read_block();
+
+         // The archive ends with a zero block
+         if ( validate_header() ) break;
+
+         QString filename;   
+
+         if ( tar_header.header.typeflag == 'L' )
+            filename = get_long_filename();
+         else
+            filename = tar_header.header.name;
+
+         unsigned int fsize;
+         unsigned int mtime;
+         
+         sscanf( tar_header.header.size,  "%11o", &fsize );
+         sscanf( tar_header.header.mtime, "%11o", &mtime );
+
+         tar_member memb;
+         memb.size   = (qint64)fsize;
+         memb.mtime  = (uint)mtime;
+         memb.offset = idev->pos();
+
+         if ( tar_header.header.typeflag == '0' )
+         {
+            // Skip file data to the start of the next block
+            int skip = BLOCK_SIZE - fsize % BLOCK_SIZE;
+            if (  skip == BLOCK_SIZE ) skip = 0;
+
+            skip_bytes( fsize + skip );
+         }
+
+         memb.length = idev->pos() - end_offset;
+
+         // An earlier copy of the member is superseded
+         if ( members.contains( filename ) )
+            dead_bytes += members[ filename ].length;
+
+         members[ filename ] = memb;
+      }
+   }
+   catch ( int error )
+   {
       return error;
    }
 
-   close( ifd );
    return TAR_OK;
 }
 
+// Compare a file with the data of its archived copy
+bool US_Tar::same_content( QIODevice* dev, const QString& file,
+                           const tar_member& memb )
+{
+   QFile fi( file );
+
+   if ( ! dev->seek( memb.offset )  ||
+        ! device_open( &fi, QIODevice::ReadOnly ) )
+      return false;
+
+   const qint64 csize = BLOCK_SIZE * BLOCKING_FACTOR;
+   QByteArray   abuf( csize, '\0' );
+   QByteArray   fbuf( csize, '\0' );
+   qint64       left  = memb.size;
+   bool         same  = true;
+
+   while ( left > 0  &&  same )
+   {
+      qint64 nbyte = qMin( left, csize );
+
+      same   = ( device_read( dev, abuf.data(), nbyte ) == nbyte  &&
+                 device_read( &fi, fbuf.data(), nbyte ) == nbyte  &&
+                 memcmp( abuf.constData(), fbuf.constData(), nbyte ) == 0 );
+      left  -= nbyte;
+   }
+
+   device_close( &fi );
+   return same;
+}
+
+// Skip bytes of the input archive
+void US_Tar::skip_bytes( const qint64 nbytes )
+{
+   if ( ! idev->seek( idev->pos() + nbytes ) ) throw TAR_READERROR;
+}
+
 QString US_Tar::format_permissions( const unsigned int mode, const bool dir )
 {
    QString s = "----------";
@@ -888,7 +1274,7 @@ QString US_Tar::get_long_filename( void )
 
 void US_Tar::read_block( void )
 {
-   ssize_t size = read( ifd, tar_header.h, BLOCK_SIZE );
+   qint64 size = device_read( idev, (char*) tar_header.h, BLOCK_SIZE );
    if ( size != BLOCK_SIZE ) throw TAR_READERROR;
 }
 
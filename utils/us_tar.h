@@ -17,8 +17,16 @@
 #define TAR_ARCHIVEERROR        8
 #define TAR_MKDIRFAILED         9
 
+class US_TarWriter;
+
 //! A class to provide tar functions internally to a routine. The functions
-//! provided are create, extract, and list.
+//! provided are create, update, extract, and list.
+//!
+//! Archive records are written by a separate thread, so reading of member
+//! files overlaps writing of the archive. An archive whose name ends in
+//! ".gz" or ".tgz" is gzip-compressed as a single member when created, and
+//! any gzip-compressed archive is decompressed in memory when extracted
+//! or listed.
 class US_UTIL_EXTERN US_Tar
 {
    public:
@@ -40,6 +48,23 @@ class US_UTIL_EXTERN US_Tar
       //! \return        An error code. Zero for no error (see explain method).
       int     create ( const QString&, const QStringList&, 
                               QStringList* = 0 );
+
+      //! Update a tar file from a list of files, appending to it in place
+      //!
+      //! Files not yet archived, or whose size, modification time or
+      //! content has changed since they were, are appended after the last
+      //! member; when extracted, the last copy of a file is the one that
+      //! remains. The archive is written in full, as by create(), if it
+      //! does not yet exist, is compressed, holds a member no longer in the
+      //! list, or would have a quarter or more of its bytes in superseded
+      //! copies of members.
+      //!
+      //! \param archive The name of the tar file to be updated.
+      //! \param files   A list of names of files/directories to archive.
+      //! \param list    The optional output list of files in the archive.
+      //! \return        An error code. Zero for no error (see explain method).
+      int     update ( const QString&, const QStringList&,
+                              QStringList* = 0 );
       
       //! Extract from a tar file the files archived.
       //!
@@ -66,6 +91,8 @@ class US_UTIL_EXTERN US_Tar
       // Class variables
       int ofd;                 // Output file descriptor
       int ifd;                 // Input file descriptor
+      QIODevice*    idev;      // Input archive device
+      US_TarWriter* writer;    // Output archive record writer
 
       typedef struct posix_header
       {  /* byte offset */
@@ -103,8 +130,25 @@ class US_UTIL_EXTERN US_Tar
       int           blocks_read;
       int           archive_size;
 
+      // Last archived copy of a member, as found by scan_members()
+      typedef struct
+      {
+         qint64 size;        // Data size
+         uint   mtime;       // Modification time
+         qint64 offset;      // Archive offset of the data
+         qint64 length;      // Length of all its records, headers included
+      } tar_member;
+
       // Internal methods
 
+      int     expand_files        ( const QStringList&, QStringList& );
+      int     write_members       ( const QStringList&, QIODevice* );
+      int     open_archive        ( const QString&, QFile&, QBuffer& );
+      int     scan_members        ( QHash< QString, tar_member >&,
+                                    qint64&, qint64& );
+      bool    same_content        ( QIODevice*, const QString&,
+                                    const tar_member& );
+      void    skip_bytes          ( const qint64 );
       void    process_dir         ( const QString&, QStringList& );
       void    write_file          ( const QString& );
       void    write_long_filename ( const QString& );
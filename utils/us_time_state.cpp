@@ -20,15 +20,19 @@ US_TimeState::US_TimeState() : QObject()
    filei       = NULL;
    dso         = NULL;
    dsi         = NULL;
+   rbytes      = NULL;
+   mdata       = NULL;
    error_msg   = QString( "" );
    wr_open     = false;
    rd_open     = false;
    const_ti    = false;
+   pre_fetch   = false;
    ntimes      = 0;
    nvalues     = 0;
    timex       = -1;
    fhdr_size   = 0;
    rec_size    = 0;
+   nrecs       = 0;
    file_size   = (qint64)0;
    dbg_level   = US_Settings::us_debug();
    cdata       = (char*)cwork;
@@ -59,6 +63,7 @@ int US_TimeState::open_write_data( QString fpath,
    const_ti    = ( timeinc > 0.0 );
 
    fileo       = new QFile( filepath );
+   cdata       = (char*)cwork;
 
    if ( ! fileo->open( QIODevice::WriteOnly ) )
    {
@@ -413,6 +418,12 @@ int US_TimeState::open_read_data( QString fpath, const bool pfetch )
 
    filei       = new QFile( fpath );
    pre_fetch   = pfetch;
+   cdata       = (char*)cwork;
+   rbytes      = NULL;
+   mdata       = NULL;
+   timex       = -1;
+   nrecs       = 0;
+   cols.clear();
 
    if ( ! filei->open( QIODevice::ReadOnly ) )
    {  // Error opening file for read
@@ -425,16 +436,23 @@ int US_TimeState::open_read_data( QString fpath, const bool pfetch )
    file_size   = filei->size();
    filepath    = fpath;
    filename    = filepath.section( "/", -1, -1 );
+   // By default, map the file; pre-fetch if asked to or if it cannot map
+   mdata       = ( ! pre_fetch  &&  file_size > 0 )
+                 ? filei->map( 0, file_size ) : NULL;
+   pre_fetch   = ( mdata == NULL );
+
    if ( pre_fetch )
    {  // If pre-fetch, read in all data bytes and close file
       dbytes      = filei->readAll();
       dsi         = new QDataStream( dbytes );
+      rbytes      = dbytes.constData();
       filei->close();
       filei       = NULL;
    }
 
    else
-   {  // By default, create data stream from opened file
+   {  // Otherwise, access records in the mapped file bytes
+      rbytes      = (const char*)mdata;
       dsi         = new QDataStream( filei );
    }
    fvers       = QString( _TMST_VERS_ );
@@ -549,6 +567,9 @@ int US_TimeState::open_read_data( QString fpath, const bool pfetch )
    rec_size   = koff;                                  // Record size in bytes
    int ktimes = (int)( ( file_size - fhdr_size ) / rec_size ); // Number times
    ntimes     = ( ntimes == 0 ) ? ktimes : ntimes;     // Counted/given times
+   nrecs      = ktimes;                                // Records in bytes
+DbgLv(1) << "TS: open_read_data: ntimes nrecs" << ntimes << nrecs
+ << "mapped" << ( mdata != NULL ) << "pre_fetch" << pre_fetch;
 
    return status;
 }
@@ -615,7 +636,22 @@ int US_TimeState::read_record( const int rtimex )
       rec_size     = offs[ lstv ] + fm.mid( 1 ).toInt();
    }
 
-   if ( rtimex < 0  ||  ( rtimex - timex ) == 1 )
+   if ( rbytes != NULL )
+   {  // Mapped or pre-fetched bytes:  point to the record in place
+      int rx       = ( rtimex < 0 ) ? ( timex + 1 ) : rtimex;
+
+      if ( rx >= nrecs )
+      {  // Error if the record is beyond the end of the data
+         timex        = rx;
+         status       = 511;
+         return set_error( status );
+      }
+
+      timex        = rx;
+      cdata        = (char*)rbytes + fhdr_size + (qint64)rx * rec_size;
+   }
+
+   else if ( rtimex < 0  ||  ( rtimex - timex ) == 1 )
    {  // Set to next and read it in
       timex++;
       dsi->readRawData( cdata, rec_size );
@@ -715,41 +751,7 @@ double US_TimeState::time_dvalue( const QString key, int* stat )
    char* rdata = cdata + roff;
 
    if ( status == 0 )
-   {
-      char  cwrk[ 256 ];
-      char* cval  = (char*)cwrk;
-      char* eval  = cval + rlen;
-      double ivalue;
-
-      switch( rfmt )
-      {  // Fetch the value in this key's format; get double output value
-         case 0:                                 // I4
-            ivalue      = iword( rdata );
-            dvalue      = (double)ivalue;
-            break;
-         case 1:                                 // I2
-            ivalue      = hword( rdata );
-            dvalue      = (double)ivalue;
-            break;
-         case 2:                                 // I1
-            ivalue      = (unsigned int)rdata[ 0 ];
-            dvalue      = (double)ivalue;
-            break;
-         case 3:                                 // R4
-            dvalue      = dword( rdata );
-            break;
-         case 4:                                 // R8
-            dvalue      = d8word( rdata );
-            break;
-         case 5:                                 // Cnnn
-            memcpy( cval, rdata, rlen );
-            *eval       = '\0';
-            dvalue      = QString( cval ).left( rlen ).toDouble();
-            break;
-         default:                                // UNKNOWN
-            break;
-      }
-   }
+      dvalue      = field_dvalue( rdata, rfmt, rlen );
 
    if ( stat != NULL )
       *stat      = status;
@@ -795,7 +797,8 @@ QString US_TimeState::time_svalue( const QString key, int* stat )
             svalue      = QString::number( dvalue );
             break;
          case 5:                                 // Cnnn
-            svalue      = QString( rdata ).left( rlen );
+            svalue      = QString::fromLatin1( rdata,
+                                               qstrnlen( rdata, rlen ) );
             break;
          default:                                // UNKNOWN
             break;
@@ -807,6 +810,77 @@ QString US_TimeState::time_svalue( const QString key, int* stat )
    return svalue;
 }
 
+// Get all records' values of a field as a column of doubles
+const double* US_TimeState::time_column( const QString key, int* stat )
+{
+   const double* column = NULL;
+   int rfmt    = 0;
+   int rlen    = 4;
+   int roff    = 0;
+
+   // Fetch attributes of the specified key
+   int status  = key_parameters( key, &rfmt, &rlen, &roff );
+
+   if ( status == 0  &&  rbytes == NULL )
+   {  // Columns require opened input bytes
+      status      = 512;
+      set_error( status );
+   }
+
+   if ( status == 0 )
+   {
+      int keyx    = keys.indexOf( key );
+
+      if ( cols.size() < nvalues )
+         cols.resize( nvalues );
+
+      QVector< double >* dcol = &cols[ keyx ];
+
+      if ( dcol->size() != ntimes )
+      {  // Decode the field of all records the first time it is fetched
+         dcol->resize( ntimes );
+         double* dvals  = dcol->data();
+         char*   fdata  = (char*)rbytes + fhdr_size + roff;
+         int     ndata  = qMin( ntimes, nrecs );
+         double  dvalue = 0.0;
+
+         for ( int rx = 0; rx < ndata; rx++, fdata += rec_size )
+         {
+            dvalue         = field_dvalue( fdata, rfmt, rlen );
+            dvals[ rx ]    = dvalue;
+         }
+
+         for ( int rx = ndata; rx < ntimes; rx++ )
+            dvals[ rx ]    = dvalue;   // Any missing records repeat the last
+      }
+
+      column      = dcol->constData();
+   }
+
+   if ( stat != NULL )
+      *stat      = status;
+   return column;
+}
+
+// Find the index of the last record not later than a given time
+int US_TimeState::time_index( const double time )
+{
+   const double* times = time_column( "Time" );
+
+   if ( times == NULL  ||  ntimes < 1 )
+      return -1;
+
+   if ( const_ti  &&  time_inc > 0.0 )
+   {  // Constant increment:  compute the index directly
+      int rx      = (int)( ( time - times[ 0 ] ) / time_inc );
+      return qMax( 0, qMin( rx, ntimes - 1 ) );
+   }
+
+   // Otherwise, binary search for the last time not greater than given
+   const double* upper = qUpperBound( times, times + ntimes, time );
+   return qMax( 0, (int)( upper - times ) - 1 );
+}
+
 // Close the input data file
 int US_TimeState::close_read_data()
 {
@@ -815,10 +889,19 @@ int US_TimeState::close_read_data()
    if ( pre_fetch )
       dbytes.clear();                  // Clear data byte array
    else if ( filei != NULL )
+   {
+      if ( mdata != NULL )
+         filei->unmap( mdata );        // Unmap the file bytes
       filei->close();                  // Close the input file
+   }
 
    filei       = NULL;                 // Clear the file pointer
    dsi         = NULL;                 // Clear the data stream pointer
+   rbytes      = NULL;                 // Clear the record bytes pointers
+   mdata       = NULL;
+   cdata       = (char*)cwork;
+   nrecs       = 0;
+   cols.clear();                       // Clear any decoded columns
    rd_open     = false;                // Flag a closed file
 
 
@@ -845,6 +928,8 @@ QString US_TimeState::error_message( int status )
       {  502, _TR_( "Incompatible file format version: " ) },
       {  505, _TR_( "Read-XML-file open error" ) },
       {  510, _TR_( "Attempt to access previous time record" ) },
+      {  511, _TR_( "Time record index is beyond the data" ) },
+      {  512, _TR_( "Field columns need opened input data" ) },
       {  901, _TR_( "Invalid key parameters (key,fmt,len,off): " ) },
       {  999, _TR_( "UNKNOWN"        ) }
    };
@@ -1227,6 +1312,44 @@ double US_TimeState::d8word( char* cbuf )
    return *dptr;
 }
 
+// Utility to get a double from a field of given format flag and length.
+double US_TimeState::field_dvalue( char* rdata, const int rfmt,
+                                   const int rlen )
+{
+   double dvalue  = 0.0;
+   char   cwrk[ 256 ];
+   char*  cval    = (char*)cwrk;
+   char*  eval    = cval + rlen;
+
+   switch( rfmt )
+   {  // Fetch the value in this key's format; get double output value
+      case 0:                                 // I4
+         dvalue      = (double)iword( rdata );
+         break;
+      case 1:                                 // I2
+         dvalue      = (double)hword( rdata );
+         break;
+      case 2:                                 // I1
+         dvalue      = (double)( (unsigned int)rdata[ 0 ] );
+         break;
+      case 3:                                 // R4
+         dvalue      = dword( rdata );
+         break;
+      case 4:                                 // R8
+         dvalue      = d8word( rdata );
+         break;
+      case 5:                                 // Cnnn
+         memcpy( cval, rdata, rlen );
+         *eval       = '\0';
+         dvalue      = QString( cval ).left( rlen ).toDouble();
+         break;
+      default:                                // UNKNOWN
+         break;
+   }
+
+   return dvalue;
+}
+
 // Utility to store an integer as a half-word (I2) in a data byte array.
 void US_TimeState::store_hword( char* dba, int ival )
 {
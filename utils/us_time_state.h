@@ -19,6 +19,8 @@
 //! binary values as defined in a separate sister XML file.
 //!
 //! Functions are provided to write out a TMST object and to read one in.
+//! Input data is memory-mapped (or pre-fetched), so records are accessed
+//! in place; whole fields may also be fetched as contiguous columns.
 //!
 class US_UTIL_EXTERN US_TimeState : public QObject
 {
@@ -143,6 +145,24 @@ class US_UTIL_EXTERN US_TimeState : public QObject
       //! \return       String value for given key in current record.
       QString time_svalue( const QString, int* = 0 );
 
+      //! \brief Get all records' values of a field as a column of doubles.
+      //!
+      //! The column is decoded on the first call for a key and is kept
+      //! until the input data is closed. Decoding is not locked, so the
+      //! columns of an object shared by threads should be fetched before
+      //! it is shared.
+      //! \param key    Key of the field to fetch.
+      //! \param stat   Optional pointer for return of status value.
+      //! \return       Pointer to time_count() values (NULL if error).
+      const double* time_column( const QString, int* = 0 );
+
+      //! \brief Find the index of the record for a given time.
+      //! \param time   Time in seconds to look up.
+      //! \return       Index of the last record whose time is not greater
+      //!               than the given time (0 if before the first record),
+      //!               or -1 if there is no "Time" field column.
+      int time_index( const double );
+
       //! \brief Close the input data file.
       //! \return       Status flag (0->OK).
       int close_read_data( void );
@@ -212,6 +232,9 @@ class US_UTIL_EXTERN US_TimeState : public QObject
 
       QByteArray   dbytes;          //!< Pre-fetched TimeState binary bytes
 
+      const char*  rbytes;          //!< Mapped or pre-fetched input bytes.
+      uchar*       mdata;           //!< Memory-mapped input file bytes.
+
       QString      filename;        //!< TimeState binary base file name.
       QString      filepath;        //!< TimeState binary full file path.
       QString      fvers;           //!< File version string.
@@ -231,6 +254,7 @@ class US_UTIL_EXTERN US_TimeState : public QObject
       int          timex;           //!< Current time index.
       int          fhdr_size;       //!< File header size in bytes.
       int          rec_size;        //!< Data record size in bytes.
+      int          nrecs;           //!< Number of records in input bytes.
 
       double       time_inc;        //!< Time increment between records.
       double       time_first;      //!< Time at first data record.
@@ -244,6 +268,8 @@ class US_UTIL_EXTERN US_TimeState : public QObject
       QStringList  fmts;            //!< List of value field formats.
       QList< int > offs;            //!< List of field offsets in record.
 
+      QVector< QVector< double > > cols; //!< Decoded field columns.
+
    private slots:
 
       //! \brief Get an unsigned half-word (I2) from a data byte array.
@@ -258,6 +284,8 @@ class US_UTIL_EXTERN US_TimeState : public QObject
       double dword       ( char* );
       //! \brief Get a double (F8) from a data byte array.
       double d8word      ( char* );
+      //! \brief Get a double from a field of given format and length.
+      double field_dvalue( char*, const int, const int );
       //! \brief Put a half-word (I2) to a data byte array.
       void   store_hword ( char*, int );
       //! \brief Put a full-word (I4) to a data byte array.
@@ -0,0 +1,329 @@
+//! \file us_transform.cpp
+
+#include "us_transform.h"
+#include "us_math2.h"
+#include "us_parallel.h"
+
+// Range task that keys, then transforms, the data of a list of triples
+class US_TransformTask : public US_RangeTask
+{
+   public:
+      enum { KEYS, TRANSFORMS };
+
+      const QVector< US_DataIO::EditedData >* dataList; // All triples' data
+      US_Transform::TransformData*      trans;     // Transforms by triple
+      const QList< int >*               rows;      // Triple of each entry
+      const QVector< double >*          baselines; // Baseline of each entry
+      const QList< QList< int > >*      excludes;  // Excluded scans of each
+      QVector< QString >                keys;      // Key of each entry
+      QVector< int >                    todo;      // Entries to transform
+      QString                           params;    // Common parameters key
+      int                               stage;     // Stage to run
+      int                               flags;     // Transforms to compute
+      int                               npoints;   // Average g*(s) points
+      double                            positPct;  // Boundary position
+      double                            boundPct;  // Boundary percent
+      double                            tcorr;     // Time correction
+
+      void run_range( int begin, int end, int )
+      {
+         for ( int ii = begin; ii < end; ii++ )
+         {
+            if ( stage == KEYS )
+            {  // Key an entry by its data and all transform parameters
+               const QList< int >& excls = excludes->at( ii );
+               QString xparams = params
+                  + QString::number( baselines->at( ii ), 'e', 12 ) + ":";
+
+               for ( int jj = 0; jj < excls.size(); jj++ )
+                  xparams += QString::number( excls.at( jj ) ) + ",";
+
+               keys[ ii ] = US_Transform::key(
+                               dataList->at( rows->at( ii ) ), xparams );
+               continue;
+            }
+
+            int kk      = todo[ ii ];
+            const US_DataIO::EditedData& edata = dataList->at( rows->at( kk ) );
+            US_Transform::TransformData& trd   = trans[ rows->at( kk ) ];
+
+            if ( ( flags & US_Transform::TR_DCDT ) != 0 )
+               US_Transform::dcdt( edata, excludes->at( kk ),
+                     positPct, baselines->at( kk ), npoints, trd );
+
+            if ( ( flags & US_Transform::TR_MOMENT ) != 0 )
+               US_Transform::moment( edata, positPct,
+                     boundPct, baselines->at( kk ), tcorr, trd );
+
+            trd.key     = keys[ kk ];
+         }
+      }
+};
+
+// Bring transforms of triples up to date, concurrently by triple
+int US_Transform::transform( const QVector< US_DataIO::EditedData >& dataList,
+      QVector< TransformData >& trans, const QList< int >& rows,
+      const QVector< double >& baselines,
+      const QList< QList< int > >& excludes, int flags, int npoints,
+      double positPct, double boundPct, double tcorr )
+{
+   int ntrip   = dataList.size();
+   int nrows   = rows.size();
+
+   if ( trans.size() != ntrip )
+   {
+      trans.clear();
+      trans.resize( ntrip );
+   }
+
+   if ( nrows < 1 )
+      return 0;
+
+   US_TransformTask task;
+   task.dataList  = &dataList;
+   task.trans     = trans.data();
+   task.rows      = &rows;
+   task.baselines = &baselines;
+   task.excludes  = &excludes;
+   task.stage     = US_TransformTask::KEYS;
+   task.flags     = flags;
+   task.npoints   = npoints;
+   task.positPct  = positPct;
+   task.boundPct  = boundPct;
+   task.tcorr     = tcorr;
+   task.params    = QString::number( flags ) + ":"
+                  + QString::number( npoints ) + ":"
+                  + QString::number( positPct, 'e', 12 ) + ":";
+
+   if ( ( flags & TR_MOMENT ) != 0 )
+   {  // Only second moments depend on boundary percent and time correction
+      task.params  += QString::number( boundPct, 'e', 12 ) + ":"
+                    + QString::number( tcorr,    'e', 12 ) + ":";
+   }
+
+   task.keys.resize( nrows );
+
+   // Key the current data and parameters of each triple
+   US_Parallel::run( &task, nrows );
+
+   for ( int ii = 0; ii < nrows; ii++ )
+   {  // Transform only triples whose key no longer matches
+      if ( trans[ rows[ ii ] ].key != task.keys[ ii ] )
+         task.todo << ii;
+   }
+
+   if ( task.todo.size() > 0 )
+   {
+      task.stage  = US_TransformTask::TRANSFORMS;
+      US_Parallel::run( &task, task.todo.size() );
+   }
+
+   return task.todo.size();
+}
+
+// Compose the cache key of a triple's data and transform parameters
+QString US_Transform::key( const US_DataIO::EditedData& edata,
+      const QString& params )
+{
+   QCryptographicHash hash( QCryptographicHash::Md5 );
+   int    nscan  = edata.scanData.size();
+
+   hash.addData( (const char*)edata.xvalues.constData(),
+                 edata.xvalues.size() * sizeof( double ) );
+   hash.addData( (const char*)&edata.meniscus, sizeof( double ) );
+
+   for ( int ii = 0; ii < nscan; ii++ )
+   {  // Digest readings, plateau, time and speed of each scan
+      const US_DataIO::Scan* scan = &edata.scanData.at( ii );
+      double svals[ 3 ] = { scan->plateau, scan->seconds, scan->rpm };
+
+      hash.addData( (const char*)scan->rvalues.constData(),
+                    scan->rvalues.size() * sizeof( double ) );
+      hash.addData( (const char*)svals, sizeof( svals ) );
+   }
+
+   return edata.editGUID + ":" + params + QString( hash.result().toHex() );
+}
+
+// Compute the time-derivative (dC/dt) curves of a triple and their average
+void US_Transform::dcdt( const US_DataIO::EditedData& d,
+      const QList< int >& excls, double positionPct, double baseline,
+      int npoints, TransformData& trd )
+{
+   int     scanCount = d.scanData.size();
+   int     points    = d.xvalues.size();
+   int     skipped   = 0;
+   double  meniscus  = d.meniscus;
+   double  s_max     = 0.0;
+   double  s_min     = 9.9e10;
+
+   trd.dcRadii .clear();
+   trd.dcValues.clear();
+   trd.dcSeds  .clear();
+
+   while ( excls.contains( skipped ) ) skipped++;
+
+   int     previous  = skipped;
+
+   for ( int i = skipped + 1; i < scanCount; i++ )
+   {
+      if ( excls.contains( i ) ) continue;
+
+      const US_DataIO::Scan* thisScan = &d.scanData.at( i );
+      const US_DataIO::Scan* prevScan = &d.scanData.at( previous );
+
+      // These limits are for thisScan only:
+      double range       = thisScan->plateau - baseline;
+      double lower_limit = baseline + range * positionPct;
+      double dt          = thisScan->seconds - prevScan->seconds;
+      double plateau     = thisScan->plateau;
+      double prevPlateau = prevScan->plateau;
+      double omega       = thisScan->rpm * M_PI / 30.0;
+      double stime       = sq( omega ) * ( prevScan->seconds + dt / 2.0 );
+
+      QVector< double > radii;
+      QVector< double > dcvals;
+      QVector< double > svals;
+      radii .reserve( points );
+      dcvals.reserve( points );
+      svals .reserve( points );
+
+      for ( int j = 0; j < points; j++ )
+      {
+         double currentV  = thisScan->rvalues[ j ];
+         double previousV = prevScan->rvalues[ j ];
+
+         if ( currentV < lower_limit ) continue;
+
+         double dC        = previousV / prevPlateau - currentV / plateau;
+         double radius    = d.xvalues[ j ];
+         double sval      = 1.0e13 * log( radius / meniscus ) / stime;
+
+         radii  << radius;
+         dcvals << dC / dt;
+         svals  << sval;
+         s_max            = qMax( s_max, sval );
+         s_min            = qMin( s_min, sval );
+      }
+
+      trd.dcRadii  << radii;
+      trd.dcValues << dcvals;
+      trd.dcSeds   << svals;
+      previous     = i;
+   }
+
+   int     count     = trd.dcSeds.size();
+   trd.sMin          = s_min;
+   trd.sMax          = s_max;
+   trd.avgSeds.fill( 0.0, npoints );
+   trd.avgDcdt.fill( 0.0, npoints );
+
+   // Assign new equally spaced s-values for the x-axis
+   double increment  = ( s_max - s_min ) / npoints;
+
+   for ( int j = 0; j < npoints; j++ )
+      trd.avgSeds[ j ]  = s_min + j * increment;
+
+   // For each new s value, find the corresponding g*(s) through linear
+   // interpolation and add up, then average by the number of total scans
+   // included. Since s-values increase, each scan's search resumes where
+   // it left off for the previous s-value.
+
+   QVector< int > kstart( count, 1 );
+
+   for ( int j = 0; j < npoints; j++ )
+   {
+      double avgs  = trd.avgSeds[ j ];
+      double sum   = 0.0;
+
+      for ( int i = 0; i < count; i++ )
+      {
+         const QVector< double >& svals  = trd.dcSeds  [ i ];
+         const QVector< double >& dcvals = trd.dcValues[ i ];
+         int    size  = svals.size();
+         int    k     = kstart[ i ];
+
+         // Find index where svalue for the scan first exceeds
+         // the point on the x-axis
+         while ( k < size  &&  svals[ k ] < avgs ) k++;
+
+         kstart[ i ]  = k;
+
+         if ( k >= size ) break;          // Skip rest of scans
+
+         // Interpolate and apply y = mx + b
+         double m = ( dcvals[ k ] - dcvals[ k - 1 ] ) /
+                    ( svals [ k ] - svals [ k - 1 ] );
+         double b = dcvals[ k ] - m * svals[ k ];
+
+         sum     += m * avgs + b;
+      }
+
+      trd.avgDcdt[ j ]  = sum / ( count - 1 );
+   }
+}
+
+// Compute the second moment radius and sedimentation coefficient of scans
+void US_Transform::moment( const US_DataIO::EditedData& d,
+      double positionPct, double boundaryPct, double baseline,
+      double tcorr, TransformData& trd )
+{
+   int     scanCount = d.scanData.size();
+   int     points    = d.xvalues.size();
+
+   trd.smSkipped     = 0;
+   trd.smRadii.fill( 0.0, scanCount );
+   trd.smSeds .fill( 0.0, scanCount );
+
+   for ( int i = 0; i < scanCount; i++ )
+   {  // Count scans whose boundary has not cleared the meniscus
+      const US_DataIO::Scan* scan = &d.scanData.at( i );
+      double range  = scan->plateau - baseline;
+      double test_y = baseline + range * positionPct;
+
+      if ( scan->rvalues[ 0 ] > test_y ) trd.smSkipped++;
+   }
+
+   // Calculate the 2nd moment
+   for ( int i = 0; i < scanCount; i++ )
+   {
+      const US_DataIO::Scan* scan = &d.scanData.at( i );
+      double sum1   = 0.0;
+      double sum2   = 0.0;
+      int    count  = 0;
+
+      // The span is the boundary portion that is going to be analyzed (in
+      // percent)
+
+      double range  = ( scan->plateau - baseline ) * boundaryPct;
+      double test_y = range * positionPct;
+
+      while ( count < points  &&  scan->rvalues[ count ] - baseline < test_y )
+         count++;
+
+      if ( count == 0 ) count = 1;
+
+      while ( count < points )
+      {
+         double value  = scan->rvalues[ count ] - baseline;
+         double radius = d.xvalues[ count ];
+
+         if ( value >= test_y + range ) break;
+
+         double v0 = scan->rvalues[ count - 1 ] - baseline;
+         double dC = value - v0;
+
+         sum1 += dC * sq( radius );
+         sum2 += dC;
+         count++;
+      }
+
+      trd.smRadii[ i ] = sqrt( sum1 / sum2 ); // second moment points in cm
+
+      double omega = scan->rpm * M_PI / 30.0;
+
+      // second moment s
+      trd.smSeds [ i ] = 1.0e13 * log( trd.smRadii[ i ] / d.meniscus ) /
+                         ( sq( omega ) * ( scan->seconds - tcorr ) );
+   }
+}
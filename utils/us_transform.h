@@ -0,0 +1,88 @@
+//! \file us_transform.h
+#ifndef US_TRANSFORM_H
+#define US_TRANSFORM_H
+
+#include <QtCore>
+
+#include "us_extern.h"
+#include "us_dataIO.h"
+
+//! \brief Time-derivative (dC/dt) and second-moment transforms of edited
+//!        velocity data.  All methods are static and need no GUI, so that
+//!        analysis, combine and batch tools can share them.
+class US_UTIL_EXTERN US_Transform
+{
+   public:
+      //! \brief Time-derivative and second-moment transforms of one triple.
+      //!        Sedimentation coefficients (times 1e13) are not corrected;
+      //!        multiply them by the triple's s20,W correction to use them.
+      class TransformData
+      {
+         public:
+            QString                    key;       //!< Edit/parameters/data key
+            QList< QVector< double > > dcRadii;   //!< Radii of dC/dt curves
+            QList< QVector< double > > dcValues;  //!< dC/dt curves of scans
+            QList< QVector< double > > dcSeds;    //!< Sed.coeffs. of curves
+            QVector< double >          avgSeds;   //!< Average g*(s) sed.coeffs.
+            QVector< double >          avgDcdt;   //!< Average g*(s) values
+            double                     sMin;      //!< Minimum curves sed.coeff.
+            double                     sMax;      //!< Maximum curves sed.coeff.
+            QVector< double >          smRadii;   //!< Second moment radii
+            QVector< double >          smSeds;    //!< Second moment sed.coeffs.
+            int                        smSkipped; //!< Scans not cleared
+
+            TransformData() : sMin( 0.0 ), sMax( 0.0 ), smSkipped( 0 ) {}
+      };
+
+      //! Flags selecting the transforms to compute for triples
+      enum TransformType { TR_DCDT = 1, TR_MOMENT = 2 };
+
+      //! \brief Bring transforms of triples up to date, computing those
+      //!        whose data or parameters changed concurrently
+      //! \param dataList  Edited data of all triples
+      //! \param trans     Transforms by triple; sized to match dataList
+      //! \param rows      Triple indexes to bring up to date
+      //! \param baselines Baseline of each listed triple
+      //! \param excludes  Excluded scans of each listed triple
+      //! \param flags     Transforms to compute (TransformType bits)
+      //! \param npoints   Points in the average g*(s) curve
+      //! \param positPct  Boundary position fraction
+      //! \param boundPct  Boundary fraction (second moment)
+      //! \param tcorr     Time correction (second moment)
+      //! \returns         Number of triples transformed anew
+      static int     transform( const QVector< US_DataIO::EditedData >&,
+                                QVector< TransformData >&,
+                                const QList< int >&,
+                                const QVector< double >&,
+                                const QList< QList< int > >&,
+                                int, int, double, double, double );
+
+      //! \brief Compose the key of a triple's data and transform parameters
+      //! \param edata     Edited data of the triple
+      //! \param params    Transform parameters string
+      //! \returns         Key identifying data and parameters
+      static QString key   ( const US_DataIO::EditedData&, const QString& );
+
+      //! \brief Compute the dC/dt curves of a triple and their average
+      //! \param edata     Edited data of the triple
+      //! \param excls     Excluded scans
+      //! \param positPct  Boundary position fraction
+      //! \param baseline  Baseline of the triple
+      //! \param npoints   Points in the average g*(s) curve
+      //! \param trd       Transforms with dC/dt members set
+      static void    dcdt  ( const US_DataIO::EditedData&,
+                             const QList< int >&, double, double,
+                             int, TransformData& );
+
+      //! \brief Compute the second moment radius and sed.coeff. of scans
+      //! \param edata     Edited data of the triple
+      //! \param positPct  Boundary position fraction
+      //! \param boundPct  Boundary fraction
+      //! \param baseline  Baseline of the triple
+      //! \param tcorr     Time correction
+      //! \param trd       Transforms with second moment members set
+      static void    moment( const US_DataIO::EditedData&,
+                             double, double, double, double,
+                             TransformData& );
+};
+#endif